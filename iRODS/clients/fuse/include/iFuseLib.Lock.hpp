@@ -195,6 +195,7 @@ int getFileCachePath( const char *inPath, char *cachePath );
 int setAndMkFileCacheDir();
 int ifuseFileCacheWrite( fileCache_t *fileCache, char *buf, size_t size, off_t offset );
 int ifuseFileCacheRead( fileCache_t *fileCache, char *buf, size_t size, off_t offset );
+void ifuseFileCacheReleaseSpool( fileCache_t *fileCache );
 
 void _ifuseDisconnect( iFuseConn_t *tmpIFuseConn );
 
@@ -25,6 +25,18 @@
 #define NUM_NEWLY_CREATED_SLOT	5
 #define MAX_NEWLY_CREATED_TIME	5	/* in sec */
 
+/* block cache for files too large for the whole file read cache */
+#define DEF_BLOCK_CACHE_BLOCK_SIZE	(1024*1024)	/* 1 mb */
+#define DEF_BLOCK_CACHE_SIZE	(64*1024*1024)	/* 64 mb */
+#define DEF_READ_AHEAD_BLOCKS	8
+#define DEF_READ_AHEAD_THREADS	2
+#define SEQ_READ_THRESHOLD	2	/* sequential reads before readahead */
+#define NUM_BLOCK_HASH_SLOT	1031
+
+/* write-back spooling of newly created and truncated files */
+#define DEF_WRITE_BACK_SIZE	0	/* in mb, 0 disables write-back */
+#define SPOOL_WAIT_TIME	30	/* in sec, wait for spool space */
+
 #define FUSE_CACHE_DIR	"/tmp/fuseCache"
 
 #define IRODS_FREE		0
@@ -51,6 +63,31 @@ typedef enum {
     HAVE_NEWLY_CREATED_CACHE, /* has cache, updated from server copy */
 } cacheState_t;
 
+typedef enum {
+    BLOCK_FILLING, /* being read, wait on BlockCacheCond */
+    BLOCK_READY,
+    BLOCK_FAILED,
+} blockState_t;
+
+typedef struct FuseBlock {
+    char *key;
+    char *buf;
+    int len;    /* bytes read, short for the last block of a file */
+    blockState_t state;
+    int refCnt;
+    int unlinked;   /* out of the table, freed when refCnt drops to 0 */
+    struct FuseBlock *prev;     /* lru list, most recently used first */
+    struct FuseBlock *next;
+} fuseBlock_t;
+
+typedef struct ReadAheadJob {
+    char *objPath;
+    rodsLong_t firstBlock;
+    int numBlocks;
+    fuseBlock_t **blocks;   /* NULL for the blocks already cached */
+    struct ReadAheadJob *next;
+} readAheadJob_t;
+
 typedef struct ConnReqWait {
 #ifdef USE_BOOST
     boost::mutex* mutex;
@@ -128,6 +165,13 @@ typedef struct newlyCreatedFile {
     char *localPath;
     char *objPath;
     int mode;
+    /* set for a read only open of a file too large for the read cache.
+     * the fields below it are guarded by BlockCacheLock */
+    char *blockKey;
+    rodsLong_t nextReadOffset;
+    int seqReads;
+    rodsLong_t readAheadBlock;
+    rodsLong_t spooledBytes;    /* charged to the write-back spool */
 #ifdef USE_BOOST
     boost::mutex* mutex;
 #else
@@ -145,6 +189,8 @@ extern "C" {
 int
 initIFuseDesc();
 int initFileCache();
+int initBlockCache();
+int ifuseWriteBackEnabled();
 void initConn();
 int
 lockDesc( int descInx );
@@ -243,6 +289,13 @@ int
 getNewlyCreatedDescByPath( char *path );
 int
 renameLocalPath( PathCacheTable *pctable, char *from, char *to, char *toIrodsPath );
+int
+ifuseBlockCacheAttach( fileCache_t *fileCache, struct stat *stbuf );
+int
+ifuseBlockCacheRead( fileCache_t *fileCache, char *buf, size_t size,
+                     off_t offset );
+int
+ifuseBlockCacheInvalidate( const char *objPath );
 int	_chkCacheExpire( pathCacheQue_t *pathCacheQue );
 int _iFuseConnInuse( iFuseConn_t *iFuseConn );
 #ifdef  __cplusplus
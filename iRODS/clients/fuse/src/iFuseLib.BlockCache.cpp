@@ -0,0 +1,602 @@
+/*** For more information please refer to files in the COPYRIGHT directory ***/
+
+/* iFuseLib.BlockCache.cpp - block cache and readahead for files too large
+ * for the whole file read cache.
+ *
+ * Blocks are keyed by the block key of the file cache, which names the
+ * object with its size and modify time at open, and the block index. They
+ * are kept in memory up to BlockCacheSize bytes and evicted least recently
+ * used first. A block being read stays in the table in the BLOCK_FILLING
+ * state so other readers wait for it rather than read it again.
+ *
+ * A cached block is copied out without the file cache lock, which is only
+ * taken to read a missing block through the descriptor. Once the reads of
+ * a descriptor are sequential the blocks ahead of it are queued for the
+ * readahead threads, which read them over a connection and an open of
+ * their own.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <time.h>
+#include <assert.h>
+#include "irodsFs.hpp"
+#include "iFuseLib.hpp"
+#include "iFuseOper.hpp"
+#include "irods_hashtable.h"
+#include "irods_list.h"
+#include "iFuseLib.Lock.hpp"
+
+#define BLOCK_KEY_LEN	(MAX_NAME_LEN + NAME_LEN)
+
+static pthread_mutex_t BlockCacheLock;
+static pthread_cond_t BlockCacheCond;	/* a block is filled */
+static pthread_cond_t ReadAheadCond;	/* a readahead job is queued */
+
+/* NULL when the block cache is disabled */
+static Hashtable *BlockTable = NULL;
+static fuseBlock_t *BlockLruHead = NULL;
+static fuseBlock_t *BlockLruTail = NULL;
+static rodsLong_t BlockCacheBytes = 0;
+
+static rodsLong_t BlockCacheSize = DEF_BLOCK_CACHE_SIZE;
+static int BlockSize = DEF_BLOCK_CACHE_BLOCK_SIZE;
+static int ReadAheadBlocks = DEF_READ_AHEAD_BLOCKS;
+static int ReadAheadThreads = DEF_READ_AHEAD_THREADS;
+
+static readAheadJob_t *ReadAheadHead = NULL;
+static readAheadJob_t *ReadAheadTail = NULL;
+static int ReadAheadStarted = 0;
+
+static int
+getEnvInt( const char *name, int defValue ) {
+    char *tmpStr = getenv( name );
+    if ( tmpStr == NULL || strlen( tmpStr ) == 0 ) {
+        return defValue;
+    }
+    return atoi( tmpStr );
+}
+
+int
+initBlockCache() {
+    int cacheSizeMb = getEnvInt( "FuseBlockCacheSize",
+                                 DEF_BLOCK_CACHE_SIZE / ( 1024 * 1024 ) );
+    int blockSizeKb = getEnvInt( "FuseBlockCacheBlockSize",
+                                 DEF_BLOCK_CACHE_BLOCK_SIZE / 1024 );
+
+    if ( cacheSizeMb <= 0 ) {
+        rodsLog( LOG_DEBUG, "initBlockCache: block cache disabled" );
+        return 0;
+    }
+    if ( blockSizeKb <= 0 ) {
+        blockSizeKb = DEF_BLOCK_CACHE_BLOCK_SIZE / 1024;
+    }
+
+    BlockCacheSize = ( rodsLong_t ) cacheSizeMb * 1024 * 1024;
+    BlockSize = blockSizeKb * 1024;
+    if ( BlockCacheSize < BlockSize ) {
+        BlockCacheSize = BlockSize;
+    }
+    ReadAheadBlocks = getEnvInt( "FuseReadAheadBlocks", DEF_READ_AHEAD_BLOCKS );
+    ReadAheadThreads = getEnvInt( "FuseReadAheadThreads", DEF_READ_AHEAD_THREADS );
+    if ( ReadAheadThreads <= 0 ) {
+        ReadAheadBlocks = 0;
+    }
+
+    pthread_mutex_init( &BlockCacheLock, NULL );
+    pthread_cond_init( &BlockCacheCond, NULL );
+    pthread_cond_init( &ReadAheadCond, NULL );
+    BlockTable = newHashTable( NUM_BLOCK_HASH_SLOT );
+    if ( BlockTable == NULL ) {
+        return SYS_MALLOC_ERR;
+    }
+
+    rodsLog( LOG_DEBUG,
+             "initBlockCache: %d byte blocks, %lld bytes, readahead of %d blocks by %d threads",
+             BlockSize, BlockCacheSize, ReadAheadBlocks, ReadAheadThreads );
+    return 0;
+}
+
+static void
+makeBlockKey( const char *blockKey, rodsLong_t blockInx, char *outKey ) {
+    snprintf( outKey, BLOCK_KEY_LEN, "%s#%lld", blockKey, blockInx );
+}
+
+/* precond: lock BlockCacheLock for all the functions starting with _ */
+static void
+_lruRemove( fuseBlock_t *block ) {
+    if ( block->prev != NULL ) {
+        block->prev->next = block->next;
+    }
+    else {
+        BlockLruHead = block->next;
+    }
+    if ( block->next != NULL ) {
+        block->next->prev = block->prev;
+    }
+    else {
+        BlockLruTail = block->prev;
+    }
+    block->prev = block->next = NULL;
+}
+
+static void
+_lruPushFront( fuseBlock_t *block ) {
+    block->prev = NULL;
+    block->next = BlockLruHead;
+    if ( BlockLruHead != NULL ) {
+        BlockLruHead->prev = block;
+    }
+    else {
+        BlockLruTail = block;
+    }
+    BlockLruHead = block;
+}
+
+static void
+freeBlock( fuseBlock_t *block ) {
+    free( block->key );
+    free( block->buf );
+    free( block );
+}
+
+static void
+_unlinkBlock( fuseBlock_t *block ) {
+    deleteFromHashTable( BlockTable, block->key );
+    _lruRemove( block );
+    BlockCacheBytes -= BlockSize;
+    block->unlinked = 1;
+    if ( block->refCnt == 0 ) {
+        freeBlock( block );
+    }
+}
+
+static void
+_releaseBlock( fuseBlock_t *block ) {
+    block->refCnt--;
+    if ( block->unlinked && block->refCnt == 0 ) {
+        freeBlock( block );
+    }
+}
+
+/* add a BLOCK_FILLING block with a reference for the caller, evicting
+ * unused blocks as needed. NULL if there is no room */
+static fuseBlock_t *
+_allocBlock( const char *key ) {
+    fuseBlock_t *victim = BlockLruTail;
+    while ( BlockCacheBytes + BlockSize > BlockCacheSize && victim != NULL ) {
+        fuseBlock_t *prev = victim->prev;
+        if ( victim->state == BLOCK_READY && victim->refCnt == 0 ) {
+            _unlinkBlock( victim );
+        }
+        victim = prev;
+    }
+    if ( BlockCacheBytes + BlockSize > BlockCacheSize ) {
+        return NULL;
+    }
+
+    fuseBlock_t *block = ( fuseBlock_t * ) calloc( 1, sizeof( fuseBlock_t ) );
+    if ( block == NULL ) {
+        return NULL;
+    }
+    block->buf = ( char * ) malloc( BlockSize );
+    if ( block->buf == NULL ) {
+        free( block );
+        return NULL;
+    }
+    block->key = strdup( key );
+    block->state = BLOCK_FILLING;
+    block->refCnt = 1;
+
+    insertIntoHashTable( BlockTable, key, block );
+    _lruPushFront( block );
+    BlockCacheBytes += BlockSize;
+    return block;
+}
+
+/* record the outcome of a read of the block and drop the reference of
+ * the reader. len < 0 is an error */
+static void
+_completeBlock( fuseBlock_t *block, int len ) {
+    if ( len >= 0 ) {
+        block->len = len;
+        block->state = BLOCK_READY;
+    }
+    else {
+        block->state = BLOCK_FAILED;
+        if ( !block->unlinked ) {
+            _unlinkBlock( block );
+        }
+    }
+    pthread_cond_broadcast( &BlockCacheCond );
+    _releaseBlock( block );
+}
+
+static void
+freeReadAheadJob( readAheadJob_t *job ) {
+    free( job->objPath );
+    free( job->blocks );
+    free( job );
+}
+
+/* read the blocks of the job over a connection and an open of its own.
+ * blocks which cannot be read are failed, their readers fetch them */
+static void
+runReadAheadJob( readAheadJob_t *job ) {
+    iFuseConn_t *iFuseConn = NULL;
+    dataObjInp_t dataObjOpenInp;
+    rodsLong_t position = -1;
+    int fd = -1;
+    int status, i;
+
+    status = getAndUseIFuseConn( &iFuseConn );
+    if ( status >= 0 ) {
+        memset( &dataObjOpenInp, 0, sizeof( dataObjOpenInp ) );
+        rstrcpy( dataObjOpenInp.objPath, job->objPath, MAX_NAME_LEN );
+        dataObjOpenInp.openFlags = O_RDONLY;
+        status = fd = rcDataObjOpen( iFuseConn->conn, &dataObjOpenInp );
+        if ( fd < 0 ) {
+            rodsLogError( LOG_DEBUG, fd,
+                          "runReadAheadJob: rcDataObjOpen of %s error", job->objPath );
+        }
+    }
+
+    for ( i = 0; i < job->numBlocks; i++ ) {
+        fuseBlock_t *block = job->blocks[i];
+        if ( block == NULL ) {
+            continue;
+        }
+        if ( fd >= 0 ) {
+            rodsLong_t offset = ( job->firstBlock + i ) * BlockSize;
+            status = 0;
+            if ( position != offset ) {
+                openedDataObjInp_t dataObjLseekInp;
+                fileLseekOut_t *dataObjLseekOut = NULL;
+
+                bzero( &dataObjLseekInp, sizeof( dataObjLseekInp ) );
+                dataObjLseekInp.l1descInx = fd;
+                dataObjLseekInp.offset = offset;
+                dataObjLseekInp.whence = SEEK_SET;
+                status = rcDataObjLseek( iFuseConn->conn, &dataObjLseekInp,
+                                         &dataObjLseekOut );
+                if ( dataObjLseekOut != NULL ) {
+                    free( dataObjLseekOut );
+                }
+            }
+            if ( status >= 0 ) {
+                openedDataObjInp_t dataObjReadInp;
+                bytesBuf_t dataObjReadOutBBuf;
+
+                bzero( &dataObjReadInp, sizeof( dataObjReadInp ) );
+                dataObjReadOutBBuf.buf = block->buf;
+                dataObjReadOutBBuf.len = BlockSize;
+                dataObjReadInp.l1descInx = fd;
+                dataObjReadInp.len = BlockSize;
+                status = rcDataObjRead( iFuseConn->conn, &dataObjReadInp,
+                                        &dataObjReadOutBBuf );
+            }
+            position = status >= 0 ? offset + status : -1;
+        }
+
+        LOCK( BlockCacheLock );
+        _completeBlock( block, status );
+        UNLOCK( BlockCacheLock );
+        job->blocks[i] = NULL;
+    }
+
+    if ( fd >= 0 ) {
+        closeIrodsFd( iFuseConn->conn, fd );
+    }
+    if ( iFuseConn != NULL ) {
+        unuseIFuseConn( iFuseConn );
+    }
+}
+
+static void *
+readAheadWorker( void * ) {
+    while ( 1 ) {
+        LOCK( BlockCacheLock );
+        while ( ReadAheadHead == NULL ) {
+            pthread_cond_wait( &ReadAheadCond, &BlockCacheLock );
+        }
+        readAheadJob_t *job = ReadAheadHead;
+        ReadAheadHead = job->next;
+        if ( ReadAheadHead == NULL ) {
+            ReadAheadTail = NULL;
+        }
+        UNLOCK( BlockCacheLock );
+
+        runReadAheadJob( job );
+        freeReadAheadJob( job );
+    }
+    return NULL;
+}
+
+/* track the reads of the descriptor and, once they are sequential, keep
+ * ReadAheadBlocks blocks queued ahead of them. the window is topped up
+ * when half of it has been consumed */
+static void
+_readAhead( fileCache_t *fileCache, off_t offset, size_t size,
+            rodsLong_t lastBlock ) {
+    char key[BLOCK_KEY_LEN];
+    rodsLong_t firstAhead, lastAhead;
+    int i;
+
+    if ( ReadAheadBlocks <= 0 ) {
+        return;
+    }
+
+    if ( offset == fileCache->nextReadOffset ) {
+        fileCache->seqReads++;
+    }
+    else {
+        fileCache->seqReads = 0;
+        fileCache->readAheadBlock = 0;
+    }
+    fileCache->nextReadOffset = offset + size;
+
+    if ( fileCache->seqReads < SEQ_READ_THRESHOLD ||
+            fileCache->readAheadBlock > lastBlock + ReadAheadBlocks / 2 ) {
+        return;
+    }
+
+    firstAhead = lastBlock + 1;
+    if ( fileCache->readAheadBlock > firstAhead ) {
+        firstAhead = fileCache->readAheadBlock;
+    }
+    lastAhead = lastBlock + ReadAheadBlocks;
+    if ( lastAhead > ( fileCache->fileSize - 1 ) / BlockSize ) {
+        lastAhead = ( fileCache->fileSize - 1 ) / BlockSize;
+    }
+    if ( firstAhead > lastAhead ) {
+        return;
+    }
+
+    readAheadJob_t *job = ( readAheadJob_t * ) calloc( 1, sizeof( readAheadJob_t ) );
+    if ( job == NULL ) {
+        return;
+    }
+    job->blocks = ( fuseBlock_t ** ) calloc( lastAhead - firstAhead + 1,
+                  sizeof( fuseBlock_t * ) );
+    if ( job->blocks == NULL ) {
+        free( job );
+        return;
+    }
+    job->objPath = strdup( fileCache->objPath );
+    job->firstBlock = firstAhead;
+
+    int queued = 0;
+    for ( i = 0; firstAhead + i <= lastAhead; i++ ) {
+        makeBlockKey( fileCache->blockKey, firstAhead + i, key );
+        if ( lookupFromHashTable( BlockTable, key ) != NULL ) {
+            continue;
+        }
+        job->blocks[i] = _allocBlock( key );
+        if ( job->blocks[i] == NULL ) {
+            /* no room, the rest waits for the next read */
+            break;
+        }
+        queued++;
+    }
+    job->numBlocks = i;
+    fileCache->readAheadBlock = firstAhead + i;
+
+    if ( queued == 0 ) {
+        freeReadAheadJob( job );
+        return;
+    }
+
+    if ( ReadAheadTail != NULL ) {
+        ReadAheadTail->next = job;
+    }
+    else {
+        ReadAheadHead = job;
+    }
+    ReadAheadTail = job;
+    pthread_cond_signal( &ReadAheadCond );
+
+    while ( ReadAheadStarted < ReadAheadThreads ) {
+        pthread_t thr;
+        if ( pthread_create( &thr, NULL, readAheadWorker, NULL ) != 0 ) {
+            rodsLog( LOG_ERROR, "_readAhead: pthread_create failure, errno = %d",
+                     errno );
+            break;
+        }
+        pthread_detach( thr );
+        ReadAheadStarted++;
+    }
+}
+
+/* read len bytes at offset through the descriptor of the file cache */
+static int
+fetchByDesc( fileCache_t *fileCache, rodsLong_t offset, char *buf, int len ) {
+    int status, myError;
+
+    LOCK_STRUCT( *fileCache );
+    status = _iFuseFileCacheLseek( fileCache, offset );
+    if ( status >= 0 ) {
+        openedDataObjInp_t dataObjReadInp;
+        bytesBuf_t dataObjReadOutBBuf;
+
+        bzero( &dataObjReadInp, sizeof( dataObjReadInp ) );
+        dataObjReadOutBBuf.buf = buf;
+        dataObjReadOutBBuf.len = len;
+        dataObjReadInp.l1descInx = fileCache->iFd;
+        dataObjReadInp.len = len;
+
+        iFuseConn_t *conn = getAndUseConnByPath( fileCache->localPath, &status );
+        if ( status >= 0 ) {
+            status = rcDataObjRead( conn->conn, &dataObjReadInp, &dataObjReadOutBBuf );
+            unuseIFuseConn( conn );
+        }
+        if ( status >= 0 ) {
+            fileCache->offset += status;
+        }
+    }
+    UNLOCK_STRUCT( *fileCache );
+
+    if ( status < 0 ) {
+        if ( ( myError = getErrno( status ) ) > 0 ) {
+            return -myError;
+        }
+        else {
+            return -ENOENT;
+        }
+    }
+    return status;
+}
+
+/* copy up to len bytes at blockOffset in the block, reading the block if
+ * it is not cached. returns the bytes copied, short at the end of file */
+static int
+readFromBlock( fileCache_t *fileCache, rodsLong_t blockInx, int blockOffset,
+               char *buf, int len ) {
+    char key[BLOCK_KEY_LEN];
+    fuseBlock_t *block;
+    int status;
+
+    makeBlockKey( fileCache->blockKey, blockInx, key );
+
+    LOCK( BlockCacheLock );
+    block = ( fuseBlock_t * ) lookupFromHashTable( BlockTable, key );
+    if ( block != NULL ) {
+        block->refCnt++;
+        while ( block->state == BLOCK_FILLING ) {
+            pthread_cond_wait( &BlockCacheCond, &BlockCacheLock );
+        }
+        if ( block->state == BLOCK_READY ) {
+            if ( !block->unlinked ) {
+                _lruRemove( block );
+                _lruPushFront( block );
+            }
+            UNLOCK( BlockCacheLock );
+
+            /* a ready block does not change, the reference keeps it */
+            status = block->len - blockOffset;
+            if ( status > len ) {
+                status = len;
+            }
+            if ( status > 0 ) {
+                memcpy( buf, block->buf + blockOffset, status );
+            }
+            else {
+                status = 0;
+            }
+
+            LOCK( BlockCacheLock );
+            _releaseBlock( block );
+            UNLOCK( BlockCacheLock );
+            return status;
+        }
+        /* the read of the block failed, try it here */
+        _releaseBlock( block );
+    }
+    block = _allocBlock( key );
+    UNLOCK( BlockCacheLock );
+
+    if ( block == NULL ) {
+        /* no room, read around the cache */
+        return fetchByDesc( fileCache, blockInx * BlockSize + blockOffset,
+                            buf, len );
+    }
+
+    status = fetchByDesc( fileCache, blockInx * BlockSize, block->buf, BlockSize );
+    int copied = status;
+    if ( status >= 0 ) {
+        copied = status - blockOffset;
+        if ( copied > len ) {
+            copied = len;
+        }
+        if ( copied > 0 ) {
+            memcpy( buf, block->buf + blockOffset, copied );
+        }
+        else {
+            copied = 0;
+        }
+    }
+
+    LOCK( BlockCacheLock );
+    _completeBlock( block, status );
+    UNLOCK( BlockCacheLock );
+    return copied;
+}
+
+/* have the reads of a read only open of a large file go through the
+ * block cache */
+int
+ifuseBlockCacheAttach( fileCache_t *fileCache, struct stat *stbuf ) {
+    char blockKey[BLOCK_KEY_LEN];
+
+    if ( BlockTable == NULL || fileCache == NULL ) {
+        return 0;
+    }
+    snprintf( blockKey, BLOCK_KEY_LEN, "%s:%lld:%u", fileCache->objPath,
+              ( rodsLong_t ) stbuf->st_size, ( uint ) stbuf->st_mtime );
+    fileCache->blockKey = strdup( blockKey );
+    return 0;
+}
+
+int
+ifuseBlockCacheRead( fileCache_t *fileCache, char *buf, size_t size,
+                     off_t offset ) {
+    rodsLong_t blockInx, lastBlock;
+    int done = 0;
+
+    if ( offset >= fileCache->fileSize || size == 0 ) {
+        return 0;
+    }
+    if ( offset + ( rodsLong_t ) size > fileCache->fileSize ) {
+        size = fileCache->fileSize - offset;
+    }
+    lastBlock = ( offset + size - 1 ) / BlockSize;
+
+    LOCK( BlockCacheLock );
+    _readAhead( fileCache, offset, size, lastBlock );
+    UNLOCK( BlockCacheLock );
+
+    for ( blockInx = offset / BlockSize; blockInx <= lastBlock; blockInx++ ) {
+        rodsLong_t blockStart = blockInx * BlockSize;
+        int blockOffset = blockStart < offset ? offset - blockStart : 0;
+        int len = BlockSize - blockOffset;
+        if ( len > ( int ) size - done ) {
+            len = size - done;
+        }
+
+        int status = readFromBlock( fileCache, blockInx, blockOffset,
+                                    buf + done, len );
+        if ( status < 0 ) {
+            return done > 0 ? done : status;
+        }
+        done += status;
+        if ( status < len ) {
+            /* end of file */
+            break;
+        }
+    }
+
+    return done;
+}
+
+/* drop the cached blocks of an object which is written, truncated,
+ * renamed or removed */
+int
+ifuseBlockCacheInvalidate( const char *objPath ) {
+    fuseBlock_t *block, *next;
+    int len;
+
+    if ( BlockTable == NULL || objPath == NULL ) {
+        return 0;
+    }
+    len = strlen( objPath );
+
+    LOCK( BlockCacheLock );
+    for ( block = BlockLruHead; block != NULL; block = next ) {
+        next = block->next;
+        if ( strncmp( block->key, objPath, len ) == 0 && block->key[len] == ':' ) {
+            _unlinkBlock( block );
+        }
+    }
+    UNLOCK( BlockCacheLock );
+    return 0;
+}
@@ -18,10 +18,70 @@ concurrentList_t* FileCacheList;
 char *ReadCacheDir = NULL;
 char FuseCacheDir[MAX_NAME_LEN];
 
+/* write-back spool. newly created files keep being written to their cache
+ * file until released, as long as the spool has room, and are then put
+ * with rcDataObjPut, which uses parallel streams for large files */
+static rodsLong_t WriteBackSize = 0;	/* 0 means no write-back */
+static rodsLong_t SpoolBytes = 0;
+static pthread_mutex_t SpoolLock;
+static pthread_cond_t SpoolCond;
+
 int initFileCache() {
+    char *tmpStr;
+
     FileCacheList = newConcurrentList();
+
+    pthread_mutex_init( &SpoolLock, NULL );
+    pthread_cond_init( &SpoolCond, NULL );
+    WriteBackSize = ( rodsLong_t ) DEF_WRITE_BACK_SIZE * 1024 * 1024;
+    if ( ( tmpStr = getenv( "FuseWriteBackSize" ) ) != NULL && strlen( tmpStr ) > 0 ) {
+        WriteBackSize = ( rodsLong_t ) atoi( tmpStr ) * 1024 * 1024;
+    }
+    if ( WriteBackSize > 0 && WriteBackSize < MAX_NEWLY_CREATED_CACHE_SIZE ) {
+        WriteBackSize = MAX_NEWLY_CREATED_CACHE_SIZE;
+    }
     return 0;
 }
+
+int ifuseWriteBackEnabled() {
+    return WriteBackSize > 0;
+}
+
+/* charge bytes to the spool for the file cache, waiting up to
+ * SPOOL_WAIT_TIME for other files to be uploaded when it is full.
+ * returns -1 if there is still no room */
+static int reserveSpool( fileCache_t *fileCache, rodsLong_t bytes ) {
+    struct timespec timeout;
+
+    bzero( &timeout, sizeof( timeout ) );
+    timeout.tv_sec = time( 0 ) + SPOOL_WAIT_TIME;
+
+    LOCK( SpoolLock );
+    while ( SpoolBytes + bytes > WriteBackSize ) {
+        /* nothing else to wait for if the spool only holds this file */
+        if ( SpoolBytes == fileCache->spooledBytes ||
+                pthread_cond_timedwait( &SpoolCond, &SpoolLock, &timeout ) == ETIMEDOUT ) {
+            UNLOCK( SpoolLock );
+            return -1;
+        }
+    }
+    SpoolBytes += bytes;
+    fileCache->spooledBytes += bytes;
+    UNLOCK( SpoolLock );
+    return 0;
+}
+
+/* return the spool space of a file cache which was uploaded or freed */
+void ifuseFileCacheReleaseSpool( fileCache_t *fileCache ) {
+    if ( fileCache->spooledBytes == 0 ) {
+        return;
+    }
+    LOCK( SpoolLock );
+    SpoolBytes -= fileCache->spooledBytes;
+    fileCache->spooledBytes = 0;
+    pthread_cond_broadcast( &SpoolCond );
+    UNLOCK( SpoolLock );
+}
 int iFuseFileCacheLseek( fileCache_t *fileCache, off_t offset ) {
     LOCK_STRUCT( *fileCache );
     int status = _iFuseFileCacheLseek( fileCache, offset );
@@ -117,6 +177,7 @@ int _iFuseFileCacheFlush( fileCache_t *fileCache ) {
     }
 
     objFd = status;
+    ifuseFileCacheReleaseSpool( fileCache );
 
     if ( stbuf.st_size > MAX_READ_CACHE_SIZE ) {
         /* too big to keep */
@@ -184,6 +245,7 @@ int ifuseFileCacheSwapOut( fileCache_t *fileCache ) {
     }
 
     int objFd = status;
+    ifuseFileCacheReleaseSpool( fileCache );
 
     /* close cache file */
     status = close( fileCache->iFd );
@@ -197,6 +259,7 @@ int ifuseFileCacheSwapOut( fileCache_t *fileCache ) {
     }
     fileCache->iFd = objFd;
     fileCache->state = NO_FILE_CACHE;
+    UNLOCK_STRUCT( *fileCache );
 
     return status;
 
@@ -331,6 +394,7 @@ int _ifuseFileCacheWrite( fileCache_t *fileCache, char *buf, size_t size, off_t
         dataObjWriteInp.l1descInx = fileCache->iFd;
         dataObjWriteInp.len = size;
 
+        ifuseBlockCacheInvalidate( fileCache->objPath );
         conn = getAndUseConnByPath( fileCache->localPath, &status );
         status = rcDataObjWrite( conn->conn, &dataObjWriteInp, &dataObjWriteInpBBuf );
         unuseIFuseConn( conn );
@@ -353,15 +417,36 @@ int _ifuseFileCacheWrite( fileCache_t *fileCache, char *buf, size_t size, off_t
         }
     }
     else {
-        status = write( fileCache->iFd, buf, size );
-        if ( status < 0 ) {
-            return errno ? ( -1 * errno ) : -1;
+        int writeRemote = 0;
+        if ( WriteBackSize > 0 && fileCache->state == HAVE_NEWLY_CREATED_CACHE &&
+                ( rodsLong_t )( offset + size ) > fileCache->spooledBytes &&
+                reserveSpool( fileCache, offset + size - fileCache->spooledBytes ) < 0 ) {
+            if ( fileCache->spooledBytes >= MAX_NEWLY_CREATED_CACHE_SIZE ) {
+                /* no room for a large file, put what it has and write the
+                 * rest directly, as without write-back */
+                writeRemote = 1;
+            }
+            else {
+                /* a small file goes over the spool size rather than wait */
+                LOCK( SpoolLock );
+                SpoolBytes += offset + size - fileCache->spooledBytes;
+                fileCache->spooledBytes = offset + size;
+                UNLOCK( SpoolLock );
+            }
         }
-        fileCache->offset += status;
-        if ( fileCache->offset > fileCache->fileSize ) {
-            fileCache->fileSize = fileCache->offset;
+        if ( !writeRemote ) {
+            status = write( fileCache->iFd, buf, size );
+            if ( status < 0 ) {
+                return errno ? ( -1 * errno ) : -1;
+            }
+            fileCache->offset += status;
+            if ( fileCache->offset > fileCache->fileSize ) {
+                fileCache->fileSize = fileCache->offset;
+            }
         }
-        if ( fileCache->offset >= MAX_NEWLY_CREATED_CACHE_SIZE ) {
+        if ( writeRemote ||
+                ( ( WriteBackSize == 0 || fileCache->state != HAVE_NEWLY_CREATED_CACHE ) &&
+                  fileCache->offset >= MAX_NEWLY_CREATED_CACHE_SIZE ) ) {
             _iFuseFileCacheFlush( fileCache );
             fileCache->iFd = 0;
             /* reopen file */
@@ -381,6 +466,9 @@ int _ifuseFileCacheWrite( fileCache_t *fileCache, char *buf, size_t size, off_t
             }
 
             fileCache->iFd = status;
+            if ( writeRemote ) {
+                return _ifuseFileCacheWrite( fileCache, buf, size, offset );
+            }
         }
     }
     return status;
@@ -445,6 +533,10 @@ int _ifuseFileCacheRead( fileCache_t *fileCache, char *buf, size_t size, off_t o
     return status;
 }
 int ifuseFileCacheRead( fileCache_t *fileCache, char *buf, size_t size, off_t offset ) {
+    /* the block cache takes the lock only to read a missing block */
+    if ( fileCache->blockKey != NULL ) {
+        return ifuseBlockCacheRead( fileCache, buf, size, offset );
+    }
     LOCK_STRUCT( *fileCache );
     int status = _ifuseFileCacheRead( fileCache, buf, size, offset );
     UNLOCK_STRUCT( *fileCache );
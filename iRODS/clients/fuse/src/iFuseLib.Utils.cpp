@@ -26,6 +26,11 @@ fileCache_t *newFileCache( int iFd, char *objPath, char *localPath, char *cacheF
     fileCache->state = state;
     fileCache->status = 0;
     fileCache->offset = 0;
+    fileCache->blockKey = NULL;
+    fileCache->nextReadOffset = 0;
+    fileCache->seqReads = 0;
+    fileCache->readAheadBlock = 0;
+    fileCache->spooledBytes = 0;
     INIT_STRUCT_LOCK( *fileCache );
     return fileCache;
 }
@@ -103,6 +108,8 @@ int _freeFileCache( fileCache_t *fileCache ) {
     free( fileCache->fileCachePath );
     free( fileCache->localPath );
     free( fileCache->objPath );
+    free( fileCache->blockKey );
+    ifuseFileCacheReleaseSpool( fileCache );
     FREE_STRUCT_LOCK( *fileCache );
     free( fileCache );
     return 0;
@@ -411,6 +411,7 @@ irodsUnlink( const char *path ) {
 
     getAndUseIFuseConn( &iFuseConn );
     status = rcDataObjUnlink( iFuseConn->conn, &dataObjInp );
+    ifuseBlockCacheInvalidate( dataObjInp.objPath );
     if ( status >= 0 ) {
 #ifdef CACHE_FUSE_PATH
         pathNotExist( pctable, ( char * ) path );
@@ -598,6 +599,8 @@ irodsRename( const char *from, const char *to ) {
     /*    rodsLog (LOG_ERROR, "irodsrename: %s -> %s conn: %p", from, to, iFuseConn);*/
 
     status = rcDataObjRename( iFuseConn->conn, &dataObjRenameInp );
+    ifuseBlockCacheInvalidate( dataObjRenameInp.srcDataObjInp.objPath );
+    ifuseBlockCacheInvalidate( dataObjRenameInp.destDataObjInp.objPath );
 
     if ( status == CAT_NAME_EXISTS_AS_DATAOBJ ||
             status == SYS_DEST_SPEC_COLL_SUB_EXIST ) {
@@ -759,6 +762,7 @@ irodsTruncate( const char *path, off_t size ) {
 
     getAndUseIFuseConn( &iFuseConn );
     RECONNECT_IF_NECESSARY( status, iFuseConn, rcDataObjTruncate( iFuseConn->conn, &dataObjInp ) );
+    ifuseBlockCacheInvalidate( dataObjInp.objPath );
     if ( status >= 0 ) {
 
         pathCache_t *tmpPathCache = matchPathCache( pctable, path );
@@ -853,7 +857,34 @@ irodsOpen( const char *path, struct fuse_file_info *fi ) {
 
     /* do only O_RDONLY (0) */
     status = _irodsGetattr( iFuseConn, path, &stbuf );
-    if ( ( flags & ( O_WRONLY | O_RDWR ) ) != 0 || status < 0 || stbuf.st_size > MAX_READ_CACHE_SIZE ) {
+    if ( ifuseWriteBackEnabled() && ( flags & ( O_WRONLY | O_RDWR ) ) != 0 && status >= 0 &&
+            ( ( flags & O_TRUNC ) != 0 || stbuf.st_size == 0 ) ) {
+        /* the new content is spooled and put when the file is released */
+        unuseIFuseConn( iFuseConn );
+        fd = irodsMknodWithCache( ( char * ) path, stbuf.st_mode, cachePath );
+        if ( fd < 0 ) {
+            return fd;
+        }
+        ifuseBlockCacheInvalidate( objPath );
+
+        stbuf.st_size = 0;
+        fileCache_t *fileCache = addFileCache( fd, objPath, ( char * ) path, cachePath, stbuf.st_mode, 0, HAVE_NEWLY_CREATED_CACHE );
+        tmpPathCache = matchPathCache( pctable, path );
+        if ( tmpPathCache != NULL ) {
+            LOCK_STRUCT( *tmpPathCache );
+            addFileCacheForPath( tmpPathCache, fileCache );
+            UNLOCK_STRUCT( *tmpPathCache );
+        }
+        else {
+            pathExist( pctable, ( char * ) path, fileCache, &stbuf, NULL );
+        }
+        desc = newIFuseDesc( objPath, ( char * ) path, fileCache, &status );
+        if ( desc == NULL ) {
+            rodsLogError( LOG_ERROR, status, "irodsOpen: allocIFuseDesc of %s error", path );
+            return -ENOENT;
+        }
+    }
+    else if ( ( flags & ( O_WRONLY | O_RDWR ) ) != 0 || status < 0 || stbuf.st_size > MAX_READ_CACHE_SIZE ) {
         fd = rcDataObjOpen( iFuseConn->conn, &dataObjInp );
         unuseIFuseConn( iFuseConn );
 
@@ -863,6 +894,12 @@ irodsOpen( const char *path, struct fuse_file_info *fi ) {
         }
 
         fileCache_t *fileCache = addFileCache( fd, objPath, ( char * ) path, NULL, stbuf.st_mode, stbuf.st_size, NO_FILE_CACHE );
+        if ( ( flags & ( O_WRONLY | O_RDWR ) ) != 0 ) {
+            ifuseBlockCacheInvalidate( objPath );
+        }
+        else if ( status >= 0 ) {
+            ifuseBlockCacheAttach( fileCache, &stbuf );
+        }
         tmpPathCache  = matchPathCache( pctable, path );
         if ( tmpPathCache != NULL ) {
             LOCK_STRUCT( *tmpPathCache );
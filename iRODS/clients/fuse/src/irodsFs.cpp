@@ -171,6 +171,9 @@ main( int argc, char **argv ) {
     initIFuseDesc();
     initConn();
     initFileCache();
+    if ( initBlockCache() < 0 ) {
+        exit( 1 );
+    }
 
     status = fuse_main( argc, argv, &irodsOper, NULL );
 
@@ -968,6 +968,16 @@ doCommand( char *cmdToken[], rodsArguments_t* _rodsArgs = 0 ) {
         return 0;
     }
     if ( strcmp( cmdToken[0], "cu" ) == 0 ) {
+        if ( strcmp( cmdToken[1], "reconcile" ) == 0 ) {
+            char defaultCount[] = "100";
+            char *count = cmdToken[2];
+            if ( *count == '\0' ) {
+                count = defaultCount;
+            }
+            generalAdmin( 0, "calculate-usage", "reconcile", count,
+                          "", "", "", "", "", "", "" );
+            return 0;
+        }
         generalAdmin( 0, "calculate-usage", "", "", "",
                       "", "", "", "", "", "" );
         return 0;
@@ -2060,9 +2070,14 @@ usage( char *subOpt ) {
     };
 
     char *cuMsgs[] = {
-        " cu (calulate usage (for quotas))",
+        " cu [reconcile [Count]] (calulate usage (for quotas))",
         "Calculate (via DBMS SQL) the usage on resources for each user and",
         "determine if users are over quota.",
+        "When incremental_quota_usage is set in the server's advanced settings",
+        "the usage is kept up to date as data objects change, and",
+        "'cu reconcile Count' recalculates it for only the Count users (100",
+        "by default) whose usage was verified longest ago.  Run it regularly",
+        "to correct any drift without the cost of a full calculation.",
         "Also see suq, sgq, and lq.",
         ""
     };
@@ -100,7 +100,7 @@ usage() {
     char *msgs[] = {
         "Usage: iget [-fIKPQrUvVT] [-n replNumber] [-N numThreads] [-X restartFile]",
         "[-R resource] [--lfrestart lfRestartFile] [--retries count] [--purgec]",
-        "[--rlock] srcDataObj|srcCollection ... destLocalFile|destLocalDir",
+        "[--rlock] [--transfers count] srcDataObj|srcCollection ... destLocalFile|destLocalDir",
         " ",
         "Usage: iget [-fIKPQUvVT] [-n replNumber] [-N numThreads] [-X restartFile]",
         "[-R resource] [--lfrestart lfRestartFile] [--retries count] [--purgec]",
@@ -160,6 +160,12 @@ usage() {
         "server after 10 minutes of connection. This gets around the problem of",
         "sockets getting timed out by the firewall as reported by some users.",
         " ",
+        "The --transfers option downloads the data objects of a collection over",
+        "count connections at once, each connection taking the next object when it",
+        "is free. Large files still use parallel streams on their connection. It",
+        "cannot be used with -X or -P. With --lfrestart, each connection records its",
+        "restart info in lfRestartFile.N, N being the connection number.",
+        " ",
         "Options are:",
 
         " -f  force - write local files even it they exist already (overwrite them)",
@@ -190,6 +196,7 @@ usage() {
         "      the restart info.",
         " -t  ticket - ticket (string) to use for ticket-based access.",
         " --rlock - use advisory read lock for the download",
+        " --transfers count - download the files of a collection over count connections",
         " --kv_pass - pass quoted key-value strings through to the resource hierarchy,",
         "             of the form key1=value1;key2=value2",
         " -h  this help",
@@ -98,6 +98,7 @@ usage() {
         "             [-p physicalPath] [-R resource] [-X restartFile] [--link]",
         "             [--lfrestart lfRestartFile] [--retries count] [--wlock]",
         "             [--purgec] [--kv_pass=key-value-string] [--metadata=avu-string]",
+        "             [--transfers count]",
         "               localSrcFile|localSrcDir ...  destDataObj|destColl",
         "Usage: iput [-abfIkKPQtTUvV] [-D dataType] [-N numThreads] [-n replNum] ",
         "             [-p physicalPath] [-R resource] [-X restartFile] [--link]",
@@ -154,6 +155,12 @@ usage() {
         "server after 10 minutes of connection. This gets around the problem of",
         "sockets getting timed out by the server firewall as reported by some users.",
         " ",
+        "The --transfers option uploads the files of a directory over count",
+        "connections at once, each connection taking the next file when it is free.",
+        "Large files still use parallel streams on their connection. It cannot be",
+        "used with -b, -X or -P. With --lfrestart, each connection records its",
+        "restart information in lfRestartFile.N, N being the connection number.",
+        " ",
         "The -b option specifies the bulk upload operation which can do up to 50 uploads",
         "at a time to reduce overhead. If the -b option is specified with the -f option",
         "to overwrite existing files, the operation will work only if there is no",
@@ -201,6 +208,7 @@ usage() {
         "       on and the lfRestartFile input specifies a local file that contains",
         "       the restart information.",
         " --wlock - use advisory write (exclusive) lock for the upload",
+        " --transfers count - upload the files of a directory over count connections",
         " --kv_pass - pass quoted key-value strings throught to the resource hierarchy,",
         "             of the form key1=value1;key2=value2",
         " --metadata - atomically assign metadata after a data object is registered in",
@@ -260,6 +260,99 @@ showRuleExecBrief( char *name, int allFlag ) {
     return 0;
 }
 
+/*
+Via a general query, summarize the queue: how many rules are due and
+how long the oldest due rule has waited
+*/
+int
+showRuleExecSummary( char *name, int allFlag ) {
+    genQueryInp_t genQueryInp;
+    genQueryOut_t *genQueryOut = NULL;
+    char v1[BIG_STR];
+    int status, i;
+    int total = 0, waiting = 0, due = 0, running = 0, failed = 0;
+    long long lagSum = 0;
+    time_t maxLag = 0, nextDue = 0;
+    time_t now = time( NULL );
+
+    memset( &genQueryInp, 0, sizeof( genQueryInp_t ) );
+    addInxIval( &genQueryInp.selectInp, COL_RULE_EXEC_TIME, 1 );
+    addInxIval( &genQueryInp.selectInp, COL_RULE_EXEC_STATUS, 1 );
+    addInxIval( &genQueryInp.selectInp, COL_RULE_EXEC_ID, 1 );
+    if ( !allFlag ) {
+        snprintf( v1, BIG_STR, "='%s'", name );
+        addInxVal( &genQueryInp.sqlCondInp, COL_RULE_EXEC_USER_NAME, v1 );
+    }
+    genQueryInp.maxRows = MAX_SQL_ROWS;
+
+    status = rcGenQuery( Conn, &genQueryInp, &genQueryOut );
+    while ( status == 0 ) {
+        sqlResult_t *exeTime = getSqlResultByInx( genQueryOut, COL_RULE_EXEC_TIME );
+        sqlResult_t *exeStatus = getSqlResultByInx( genQueryOut, COL_RULE_EXEC_STATUS );
+        if ( exeTime == NULL || exeStatus == NULL ) {
+            status = UNMATCHED_KEY_OR_INDEX;
+            break;
+        }
+        for ( i = 0; i < genQueryOut->rowCnt; i++ ) {
+            time_t t = atol( &exeTime->value[exeTime->len * i] );
+            char *st = &exeStatus->value[exeStatus->len * i];
+            total++;
+            if ( strcmp( st, RE_FAILED ) == 0 ) {
+                failed++;
+            }
+            if ( strcmp( st, RE_RUNNING ) == 0 ) {
+                running++;
+            }
+            else if ( t > now ) {
+                waiting++;
+                if ( nextDue == 0 || t < nextDue ) {
+                    nextDue = t;
+                }
+            }
+            else {
+                due++;
+                lagSum += now - t;
+                if ( now - t > maxLag ) {
+                    maxLag = now - t;
+                }
+            }
+        }
+        if ( genQueryOut->continueInx <= 0 ) {
+            break;
+        }
+        genQueryInp.continueInx = genQueryOut->continueInx;
+        freeGenQueryOut( &genQueryOut );
+        status = rcGenQuery( Conn, &genQueryInp, &genQueryOut );
+    }
+    freeGenQueryOut( &genQueryOut );
+    clearGenQueryInp( &genQueryInp );
+
+    if ( status < 0 && status != CAT_NO_ROWS_FOUND ) {
+        printError( Conn, status, "rcGenQuery" );
+        return status;
+    }
+
+    if ( allFlag ) {
+        printf( "Rule-execution queue\n" );
+    }
+    else {
+        printf( "Rule-execution queue for user %s\n", name );
+    }
+    printf( "total:   %d\n", total );
+    printf( "due:     %d\n", due );
+    printf( "running: %d\n", running );
+    printf( "waiting: %d\n", waiting );
+    printf( "failed:  %d\n", failed );
+    if ( due > 0 ) {
+        printf( "lag:     oldest %d sec, mean %d sec\n", ( int ) maxLag,
+                ( int )( lagSum / due ) );
+    }
+    if ( nextDue > 0 ) {
+        printf( "next:    in %d sec\n", ( int )( nextDue - now ) );
+    }
+    return 0;
+}
+
 int
 main( int argc, char **argv ) {
 
@@ -274,7 +367,7 @@ main( int argc, char **argv ) {
 
     rodsLogLevel( LOG_ERROR );
 
-    status = parseCmdLineOpt( argc, argv, "alu:vVh", 0, &myRodsArgs );
+    status = parseCmdLineOpt( argc, argv, "alsu:vVh", 0, &myRodsArgs );
     if ( status ) {
         printf( "Use -h for help\n" );
         return 1;
@@ -319,7 +412,10 @@ main( int argc, char **argv ) {
     }
 
     nArgs = argc - myRodsArgs.optind;
-    if ( nArgs > 0 ) {
+    if ( myRodsArgs.sizeFlag == True ) {
+        status = showRuleExecSummary( userName, myRodsArgs.all );
+    }
+    else if ( nArgs > 0 ) {
         status = showRuleExec( userName, argv[myRodsArgs.optind],
                                myRodsArgs.all );
     }
@@ -343,11 +439,13 @@ Print the main usage/help information.
  */
 void usage() {
     char *msgs[] = {
-        "Usage: iqstat [-luvVh] [-u user] [ruleId]",
+        "Usage: iqstat [-alsvVh] [-u user] [ruleId]",
         "Show information about your pending iRODS rule executions",
         "or for the entered user.",
         " -a        display requests of all users",
         " -l        for long format",
+        " -s        summarize the queue: the number of rules due, running,",
+        "           waiting and failed, and how long the due rules have waited",
         " -u user   for the specified user",
         " ruleId for the specified rule",
         " ",
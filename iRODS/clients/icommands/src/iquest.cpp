@@ -161,6 +161,25 @@ queryAndShowStrCond( rcComm_t *conn, char *hint, char *format,
 
     genQueryInp.maxRows = MAX_SQL_ROWS;
     genQueryInp.continueInx = 0;
+
+    if ( noPageFlag ) {
+        /* no prompt between pages, let the server stream them */
+        do {
+            i = rcGenQueryStream( conn, &genQueryInp, &genQueryOut );
+            if ( i < 0 ) {
+                return i;
+            }
+            i = printGenQueryOut( stdout, format, hint,  genQueryOut );
+            freeGenQueryOut( &genQueryOut );
+            if ( i < 0 ) {
+                return i;
+            }
+        }
+        while ( genQueryInp.continueInx > 0 );
+
+        return 0;
+    }
+
     i = rcGenQuery( conn, &genQueryInp, &genQueryOut );
     if ( i < 0 ) {
         return i;
@@ -115,7 +115,8 @@ usage() {
 
     char *msgs[] = {
         "Usage: irepl [-aBMPQrTvV] [-n replNum] [-R destResource] [-S srcResource]",
-        "[-N numThreads] [-X restartFile] [--purgec]  [--rlock]dataObj|collection ... ",
+        "[-N numThreads] [-X restartFile] [--purgec]  [--rlock] [--transfers count]",
+        "dataObj|collection ... ",
         " ",
         "Replicate a file in iRODS to another storage resource.",
         " ",
@@ -173,6 +174,11 @@ usage() {
         " --purgec  Purge the staged cache copy after replicating an object to a",
         "     COMPOUND resource",
         " --rlock - use advisory read lock for the replication",
+        " --transfers count - with -r, the number of data objects the server",
+        "     replicates at once, each with its own copy.  The server limits the",
+        "     count and the number of replications which read from or write to one",
+        "     resource at a time.  A failure stops the replication of the collection.",
+        "     Not used with -X.",
         " -h  this help",
         " ",
         "Also see 'irsync' for other types of iRODS/local synchronization.",
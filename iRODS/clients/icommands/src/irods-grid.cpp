@@ -22,7 +22,7 @@
 
 irods::error usage() {
     std::cout << "usage:  'irods-grid action [ option ] target'" << std::endl;
-    std::cout << "action: ( required ) status, pause, resume, shutdown" << std::endl;
+    std::cout << "action: ( required ) status, pause, resume, shutdown, rule_profile" << std::endl;
     std::cout << "option: --force-after=seconds or --wait-forever" << std::endl;
     std::cout << "target: ( required ) --all, --hosts=\"<fqdn1>, <fqdn2>, ...\"" << std::endl;
 
@@ -40,7 +40,7 @@ irods::error parse_program_options(
     namespace po = boost::program_options;
     po::options_description opt_desc( "options" );
     opt_desc.add_options()
-    ( "action", "either 'status', 'shutdown', 'pause', or 'resume'" )
+    ( "action", "either 'status', 'shutdown', 'pause', 'resume', or 'rule_profile'" )
     ( "help", "show command usage" )
     ( "all", "operation applies to all servers in the grid" )
     ( "hosts", po::value<std::string>(), "operation applies to a list of hosts in the grid" )
@@ -48,7 +48,8 @@ irods::error parse_program_options(
     ( "wait-forever", "wait indefinitely for a graceful shutdown" )
     ( "shutdown", "gracefully shutdown a server(s)" )
     ( "pause", "refuse new client connections" )
-    ( "resume", "allow new client connections" );
+    ( "resume", "allow new client connections" )
+    ( "rule_profile", "report the rule and microservice timings" );
 
     po::positional_options_description pos_desc;
     pos_desc.add( "action", 1 );
@@ -82,6 +83,7 @@ irods::error parse_program_options(
             cmd_map[ "pause"    ] = irods::SERVER_CONTROL_PAUSE;
             cmd_map[ "resume"   ] = irods::SERVER_CONTROL_RESUME;
             cmd_map[ "shutdown" ] = irods::SERVER_CONTROL_SHUTDOWN;
+            cmd_map[ "rule_profile" ] = irods::SERVER_CONTROL_RULE_PROFILE;
 
             if ( cmd_map.end() == cmd_map.find( action ) ) {
                 std::cout << "invalid subcommand ["
@@ -382,7 +384,8 @@ int main(
         }
 
         if ( irods::SERVER_CONTROL_SUCCESS != rep_str ) {
-            if ( irods::SERVER_CONTROL_STATUS == cmd.command ) {
+            if ( irods::SERVER_CONTROL_STATUS == cmd.command ||
+                    irods::SERVER_CONTROL_RULE_PROFILE == cmd.command ) {
                 rep_str = format_grid_status( rep_str );
 
             }
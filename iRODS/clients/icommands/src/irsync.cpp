@@ -30,7 +30,7 @@ main( int argc, char **argv ) {
     int i;
 
 
-    optStr = "ahKlN:rR:svVZ";
+    optStr = "abhKlN:rR:svVZ";
 
     status = parseCmdLineOpt( argc, argv, optStr, 1, &myRodsArgs );
 
@@ -136,7 +136,8 @@ main( int argc, char **argv ) {
 void
 usage() {
     char *msgs[] = {
-        "Usage: irsync [-rahKsvV] [-N numThreads] [-R resource] [--link] [--age age_in_minutes]",
+        "Usage: irsync [-rabhKsvV] [-N numThreads] [-R resource] [--link] [--age age_in_minutes]",
+        "          [--manifest manifestFile]",
         "          sourceFile|sourceDirectory [....] targetFile|targetDirectory",
         " ",
         "Synchronize the data between a local copy (local file system) and",
@@ -176,6 +177,14 @@ usage() {
         "checksum value) is used for determining whether synchronization is needed.",
         "This mode gives a faster operation but the result is less accurate.",
         " ",
+        "When synchronizing a local directory to a collection, the sizes and",
+        "checksums of the objects in each collection are listed with one query",
+        "and compared locally, so only new and changed files are sent. The",
+        "--manifest option keeps the checksums of the local files in a file of",
+        "its own, keyed by path, inode, size and modification time, so an",
+        "unchanged file is not read again on the next run. With -b, the changed",
+        "files up to 4 MB are uploaded in batches through the bulk put.",
+        " ",
         "The command accepts multiple sourceFiles|sourceDirectories and a single",
         "targetFile|targetDirectory. It pretty much follows the syntax of the UNIX",
         "cp command with one exception- irsync of a single source directory to a ",
@@ -195,6 +204,9 @@ usage() {
         "always means the synchronization of the local directory foo1 to collection",
         "foo2, no matter whether foo2 exists.",
         " ",
+        " -b  bulk upload the changed small files when synchronizing a local",
+        "       directory to a collection. The checksums of the uploaded files",
+        "       are registered.",
         " -K  verify checksum - calculate and verify the checksum on the data",
         " -N  numThreads - the number of threads to use for the transfer. A value of",
         "       0 means no threading. By default (-N option not used) the server",
@@ -214,6 +226,8 @@ usage() {
         "      synchronization.",
         " --age age_in_minutes - The maximum age of the source copy in minutes for sync.",
         "      i.e., age larger than age_in_minutes will not be synced.",
+        " --manifest manifestFile - cache the checksums of the local files in",
+        "      manifestFile between runs. Valid only for rsync from local host to iRODS.",
         " ",
         "Also see 'irepl' for the replication and synchronization of physical",
         "copies (replica).",
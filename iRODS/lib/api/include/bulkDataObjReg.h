@@ -20,6 +20,8 @@
 
 #if defined(RODS_SERVER)
 #define RS_BULK_DATA_OBJ_REG rsBulkDataObjReg
+/* default number of objects registered per catalog transaction */
+#define DEFAULT_BULK_REG_BATCH_SIZE 1000
 /* prototype for the server handler */
 int
 rsBulkDataObjReg( rsComm_t *rsComm, genQueryOut_t *bulkDataObjRegInp,
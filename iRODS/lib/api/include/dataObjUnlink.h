@@ -23,6 +23,11 @@ dataObjUnlinkS( rsComm_t *rsComm, dataObjInp_t *dataObjUnlinkInp,
 int
 l3Unlink( rsComm_t *rsComm, dataObjInfo_t *dataObjInfo );
 int
+isStructFileDataType( const char *dataType );
+int
+l3UnlinkStructFileIndex( rsComm_t *rsComm, dataObjInfo_t *dataObjInfo,
+                         const char *location );
+int
 _rsDataObjUnlink( rsComm_t *rsComm, dataObjInp_t *dataObjUnlinkInp,
                   dataObjInfo_t **dataObjInfoHead );
 int
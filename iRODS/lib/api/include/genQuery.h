@@ -22,6 +22,10 @@ rsGenQuery( rsComm_t *rsComm, genQueryInp_t *genQueryInp,
 int
 _rsGenQuery( rsComm_t *rsComm, genQueryInp_t *genQueryInp,
              genQueryOut_t **genQueryOut );
+
+/* page size in bytes and the row limit per page for STREAM_QUERY */
+#define DEFAULT_GEN_QUERY_STREAM_PAGE_SIZE  (4*1024*1024)
+#define MAX_SQL_STREAM_ROWS                 (64*1024)
 #else
 #define RS_GEN_QUERY NULL
 #endif
@@ -34,6 +38,9 @@ extern "C" {
 int
 rcGenQuery( rcComm_t *conn, genQueryInp_t *genQueryInp,
             genQueryOut_t **genQueryOut );
+int
+rcGenQueryStream( rcComm_t *conn, genQueryInp_t *genQueryInp,
+                  genQueryOut_t **genQueryOut );
 
 #ifdef __cplusplus
 }
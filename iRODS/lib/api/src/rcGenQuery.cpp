@@ -96,3 +96,88 @@ rcGenQuery( rcComm_t *conn, genQueryInp_t *genQueryInp,
     return status;
 }
 
+/**
+ * \fn rcGenQueryStream (rcComm_t *conn, genQueryInp_t *genQueryInp, genQueryOut_t **genQueryOut)
+ *
+ * \brief Perform a general-query with the result pages streamed by the server.
+ *
+ * \user client
+ *
+ * \ingroup metadata
+ *
+ * \since 4.1.0
+ *
+ *
+ * \remark
+ * Same as rcGenQuery, but the first call sets STREAM_QUERY and the
+ * \n server then sends every page of the result without waiting for the
+ * \n continuation calls. Later calls read the next page from the
+ * \n connection. genQueryInp->maxRows sets the size of the first page
+ * \n only; the server sizes the later pages by bytes. Each call sets
+ * \n genQueryInp->continueInx from the page read, and the query is done
+ * \n when it is no longer positive. A server which does not stream
+ * \n answers with ordinary pages, and the later calls ask for them in
+ * \n the usual way.
+ *
+ * \note The connection cannot be used for anything else until the last
+ * \n page is read. A caller which stops early must disconnect.
+ *
+ * \usage
+ * \n genQueryInp.maxRows = MAX_SQL_ROWS;
+ * \n genQueryInp.continueInx = 0;
+ * \n do {
+ * \n     status = rcGenQueryStream (conn, &genQueryInp, &genQueryOut);
+ * \n     if (status < 0) break;
+ * \n     .... use and free genQueryOut
+ * \n } while (genQueryInp.continueInx > 0);
+ *
+ * \param[in] conn - A rcComm_t connection handle to the server
+ * \param[in,out] genQueryInp - input general-query structure
+ * \param[out] genQueryOut - output general-query structure, one page
+ * \return integer
+ * \retval 0 on success
+ *
+ * \sideeffect none
+ * \pre none
+ * \post none
+ * \sa rcGenQuery
+**/
+
+int
+rcGenQueryStream( rcComm_t *conn, genQueryInp_t *genQueryInp,
+                  genQueryOut_t **genQueryOut ) {
+    int status;
+
+    *genQueryOut = NULL;
+    if ( genQueryInp->continueInx == 0 ) {
+        genQueryInp->options |= STREAM_QUERY;
+        status = procApiRequest( conn, GEN_QUERY_AN,  genQueryInp, NULL,
+                                 ( void ** )genQueryOut, NULL );
+    }
+    else if ( genQueryInp->options & STREAM_QUERY ) {
+        /* the server already sent it */
+        status = readAndProcApiReply( conn, conn->apiInx,
+                                      ( void ** )genQueryOut, NULL );
+    }
+    else {
+        status = procApiRequest( conn, GEN_QUERY_AN,  genQueryInp, NULL,
+                                 ( void ** )genQueryOut, NULL );
+    }
+
+    if ( status == SYS_SVR_TO_CLI_GEN_QUERY_PAGE ) {
+        /* more to come */
+        status = 0;
+    }
+    else {
+        /* the server stopped streaming. Any pages left are asked for
+         * with continuation calls */
+        genQueryInp->options &= ~STREAM_QUERY;
+    }
+
+    if ( status >= 0 && *genQueryOut != NULL ) {
+        genQueryInp->continueInx = ( *genQueryOut )->continueInx;
+    }
+
+    return status;
+}
+
@@ -56,6 +56,8 @@ typedef struct {
     int irodsMaxSizeForSingleBuffer;
     int irodsDefaultNumberTransferThreads;
     int irodsTransBufferSizeForParaTrans;
+    int irodsTransPipelineDepth;
+    int irodsAuthSessionCache;
 
     // =-=-=-=-=-=-=-
     // override of plugin installation directory
@@ -24,6 +24,12 @@ namespace irods {
     const std::string AUTH_TTL_KEY( "a_ttl" );
     const std::string AUTH_PASSWORD_KEY( "a_pw" );
     const std::string AUTH_RESPONSE_KEY( "a_resp" );
+    const std::string AUTH_SESSION_KEY( "a_session" );
+
+/// =-=-=-=-=-=-=-
+/// @brief the a_session value which asks for a token for the
+///        connection, any other value is a token to resume with
+    const std::string AUTH_SESSION_NEW( "new" );
 
 }; // namespace irods
 
@@ -51,6 +51,36 @@ namespace irods {
         "maximum_temporary_password_lifetime_in_seconds" );
     const std::string CFG_MAX_NUMBER_OF_CONCURRENT_RE_PROCS(
         "maximum_number_of_concurrent_rule_engine_server_processes" );
+    const std::string CFG_AGENT_POOL_SIZE(
+        "agent_pool_size" );
+    const std::string CFG_AGENT_POOL_MAX_REQUESTS_PER_AGENT(
+        "agent_pool_maximum_requests_per_agent" );
+    const std::string CFG_BULK_REGISTRATION_BATCH_SIZE(
+        "bulk_registration_batch_size" );
+    const std::string CFG_ADAPTIVE_NUMBER_OF_TRANSFER_THREADS(
+        "adaptive_number_of_transfer_threads" );
+    const std::string CFG_GEN_QUERY_STREAM_PAGE_SIZE(
+        "gen_query_stream_page_size_in_bytes" );
+    const std::string CFG_INCREMENTAL_QUOTA_USAGE(
+        "incremental_quota_usage" );
+    const std::string CFG_RESOURCE_CACHE_LIFETIME(
+        "resource_cache_lifetime_in_seconds" );
+    const std::string CFG_RULE_ENGINE_SERVER_QUEUE_RESYNC(
+        "rule_engine_server_queue_resync_in_seconds" );
+    const std::string CFG_RULE_ENGINE_PROFILING(
+        "rule_engine_profiling" );
+    const std::string CFG_MAX_NUMBER_OF_COLL_REPL_WORKERS(
+        "maximum_number_of_collection_replication_workers" );
+    const std::string CFG_MAX_NUMBER_OF_REPLS_PER_RESC(
+        "maximum_number_of_concurrent_replications_per_resource" );
+    const std::string CFG_COLLECTION_DELETE_BATCH_SIZE(
+        "collection_delete_batch_size" );
+    const std::string CFG_MAX_NUMBER_OF_COLL_DELETE_WORKERS(
+        "maximum_number_of_collection_delete_workers" );
+    const std::string CFG_AUTH_SESSION_LIFETIME(
+        "authentication_session_lifetime_in_seconds" );
+    const std::string CFG_ROUND_ROBIN_CONTEXT_UPDATE_INTERVAL(
+        "round_robin_context_update_interval" );
 
     // service_account_environment.json keywords
     const std::string CFG_IRODS_USER_NAME_KW( "irods_user_name" );
@@ -111,6 +141,10 @@ namespace irods {
         "irods_maximum_number_of_transfer_threads" );
     const std::string CFG_IRODS_TRANS_BUFFER_SIZE_FOR_PARA_TRANS(
         "irods_transfer_buffer_size_for_parallel_transfer_in_megabytes" );
+    const std::string CFG_IRODS_TRANS_PIPELINE_DEPTH(
+        "irods_transfer_pipeline_depth" );
+    const std::string CFG_IRODS_AUTH_SESSION_CACHE(
+        "irods_authentication_session_cache" );
 
     // legacy ssl environment variables
     const std::string CFG_IRODS_SSL_CA_CERTIFICATE_PATH(
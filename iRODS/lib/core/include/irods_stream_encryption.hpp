@@ -0,0 +1,115 @@
+#ifndef __IRODS_STREAM_ENCRYPTION_HPP__
+#define __IRODS_STREAM_ENCRYPTION_HPP__
+
+// =-=-=-=-=-=-=-
+// irods includes
+#include "rodsDef.h"
+
+// =-=-=-=-=-=-=-
+#include "irods_error.hpp"
+#include "irods_buffer_encryption.hpp"
+
+// =-=-=-=-=-=-=-
+// ssl includes
+#include <openssl/evp.h>
+
+namespace irods {
+
+/// =-=-=-=-=-=-=-
+/// @brief encrypts or decrypts the buffers of one parallel transfer
+///        stream.  the cipher context is keyed once for the stream and
+///        only given a new iv per buffer, and the buffers are processed
+///        in place, so nothing is allocated per buffer.
+///
+///        each buffer goes on the wire as the iv, the cipher text and,
+///        for an AEAD cipher such as aes-256-gcm or chacha20-poly1305,
+///        its tag.  an AEAD iv is a random prefix drawn once per stream
+///        followed by a count of the buffers, any other cipher gets a
+///        random iv of key size bytes per buffer as buffer_crypt does,
+///        which keeps the cbc format unchanged
+    class stream_crypt {
+
+        public:
+            // =-=-=-=-=-=-=-
+            // con/de structors
+            stream_crypt(
+                int,           // key size in bytes
+                const char* ); // algorithm
+            ~stream_crypt();
+
+            /// =-=-=-=-=-=-=-
+            /// @brief key the context for one direction of the stream
+            irods::error init(
+                const buffer_crypt::array_t&, // key
+                bool );                       // true to encrypt
+
+            /// =-=-=-=-=-=-=-
+            /// @brief encrypt the plain text which follows iv_size() bytes
+            ///        of room in the buffer, leaving the iv, cipher text and
+            ///        tag in their place.  the buffer needs overhead() more
+            ///        bytes than the plain text
+            irods::error encrypt(
+                unsigned char*, // buffer
+                int,            // plain text length
+                int& );         // length to send
+
+            /// =-=-=-=-=-=-=-
+            /// @brief decrypt a buffer as it was received, leaving the plain
+            ///        text iv_size() bytes into it
+            irods::error decrypt(
+                unsigned char*, // buffer
+                int,            // length received
+                int& );         // plain text length
+
+            /// =-=-=-=-=-=-=-
+            /// @brief the bytes of the shared secret used as the key
+            int key_size() const {
+                return key_size_;
+            };
+
+            /// =-=-=-=-=-=-=-
+            /// @brief the bytes of iv before the cipher text
+            int iv_size() const {
+                return iv_size_;
+            };
+
+            /// =-=-=-=-=-=-=-
+            /// @brief the most bytes encryption adds to a buffer
+            int overhead() const {
+                return iv_size_ + ( aead_ ? tag_size_ : EVP_MAX_BLOCK_LENGTH );
+            };
+
+            /// =-=-=-=-=-=-=-
+            /// @brief true for a cipher which authenticates the buffers
+            bool aead() const {
+                return aead_;
+            };
+
+            /// =-=-=-=-=-=-=-
+            /// @brief the cipher in use, which may be the aes-256-cbc
+            ///        default if the algorithm is not supported
+            std::string algorithm() const {
+                return algorithm_;
+            };
+
+        private:
+            irods::error next_iv( unsigned char* );
+
+            // =-=-=-=-=-=-=-
+            // attributes
+            int               key_size_;
+            int               iv_size_;
+            int               tag_size_;
+            bool              aead_;
+            bool              encrypt_;
+            std::string       algorithm_;
+            const EVP_CIPHER* cipher_;
+            EVP_CIPHER_CTX*   context_;
+            unsigned char     nonce_prefix_[ 8 ];
+            unsigned int      count_;
+
+    }; // class stream_crypt
+
+}; // namespace irods
+
+#endif // __IRODS_STREAM_ENCRYPTION_HPP__
@@ -0,0 +1,132 @@
+#ifndef IRODS_TRANSFER_SCHEDULER_HPP
+#define IRODS_TRANSFER_SCHEDULER_HPP
+
+// =-=-=-=-=-=-=-
+#include "rodsClient.h"
+#include "parseCommandLine.h"
+
+// =-=-=-=-=-=-=-
+// stl includes
+#include <string>
+#include <deque>
+#include <set>
+#include <vector>
+
+// =-=-=-=-=-=-=-
+// boost includes
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition.hpp>
+
+namespace irods {
+
+/// =-=-=-=-=-=-=-
+/// @brief one file to be moved by a transfer_scheduler worker
+    struct transfer_job {
+        std::string src_;
+        std::string dst_;
+        rodsLong_t  size_;
+        int         mode_;
+        bool        has_spec_coll_;
+        specColl_t  spec_coll_;
+    };
+
+/// =-=-=-=-=-=-=-
+/// @brief moves one job over the worker's connection, given the worker's
+///        own copy of the operation input
+    typedef int ( *transfer_fn_t )(
+        rcComm_t*,
+        rodsArguments_t*,
+        dataObjInp_t*,
+        transfer_job& );
+
+/// =-=-=-=-=-=-=-
+/// @brief runs the file transfers of a recursive iput or iget over a pool
+///        of connections.  the walk of the tree stays on the caller's
+///        connection and submits each file as it is found.  every worker
+///        has its own queue and connection; a new job goes to the queue
+///        holding the fewest bytes, and a worker whose queue runs dry
+///        steals from the far end of another's.  large files still use
+///        the parallel portal streams of their worker's connection.
+///
+///        with --lfrestart each worker records its large file restart
+///        information in a file of its own, the given file name with
+///        the worker number appended
+    class transfer_scheduler {
+        public:
+            transfer_scheduler(
+                int              _workers,
+                rodsEnv*         _env,
+                rodsArguments_t* _args,
+                dataObjInp_t*    _inp,
+                transfer_fn_t    _fn,
+                const char*      _lfrestart_file );
+            ~transfer_scheduler();
+
+            /// =-=-=-=-=-=-=-
+            /// @brief connect the workers and start their threads.  returns
+            ///        the number of workers started, or an error if none
+            ///        could connect
+            int start( char* _ticket );
+
+            /// =-=-=-=-=-=-=-
+            /// @brief queue a job, waiting while the queues are full
+            void submit( const transfer_job& _job );
+
+            /// =-=-=-=-=-=-=-
+            /// @brief do not run a job for this path, e.g. one already
+            ///        completed by a large file restart
+            void skip( const std::string& _path );
+
+            /// =-=-=-=-=-=-=-
+            /// @brief wait for the queued jobs and stop the workers.
+            ///        returns the status of the last failed job, if any
+            int finish();
+
+            /// =-=-=-=-=-=-=-
+            /// @brief the large file restart file of worker _idx
+            std::string lfrestart_file( int _idx ) const;
+
+            int workers() const {
+                return workers_.size();
+            }
+
+        private:
+            struct worker {
+                int                        idx_;
+                rcComm_t*                  conn_;
+                dataObjInp_t               inp_;
+                boost::mutex               mutex_;
+                std::deque< transfer_job > jobs_;
+                rodsLong_t                 queued_bytes_;
+                boost::thread*             thread_;
+            };
+
+            void run( worker* _w );
+            bool take( worker* _w, transfer_job& _job );
+            bool steal( worker* _w, transfer_job& _job );
+
+            int                     requested_;
+            rodsEnv*                env_;
+            rodsArguments_t*        args_;
+            dataObjInp_t*           inp_;
+            transfer_fn_t           fn_;
+            std::string             lfrestart_file_;
+            std::vector< worker* >  workers_;
+
+            // =-=-=-=-=-=-=-
+            // guards the counts below and the skip set, never held while
+            // a queue mutex is taken
+            boost::mutex            mutex_;
+            boost::condition        work_;
+            boost::condition        room_;
+            int                     pending_;
+            bool                    done_;
+            int                     status_;
+            std::set< std::string > skip_;
+
+    }; // class transfer_scheduler
+
+}; // namespace irods
+
+#endif // IRODS_TRANSFER_SCHEDULER_HPP
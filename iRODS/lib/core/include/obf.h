@@ -9,6 +9,9 @@
 #define HASH_TYPE_DEFAULT 3
 #define SHA1_FLAG_STRING ":::sha1"
 
+/* the session token saved by clientLogin, next to the auth file */
+#define AUTH_SESSION_FILE_SUFFIX ".session"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -19,6 +22,7 @@ int obfGetPw( char *pw );
 int obfSavePw( int promptOpt, int fileOpt, int printOpt, const char *pwArg );
 int obfTempOps( int tmpOpt );
 int obfiGetEnvKey();
+int obfiGetFilename( char *fileName );
 int obfiGetTv( char *fileName );
 int obfiDecode( const char *in, char *out, int extra );
 int obfiGetPw( const char *fileName, char *pw );
@@ -73,6 +73,9 @@ typedef enum {          /* specColl operation type */
 
 #define UNMOUNT_STR               "unmount"
 
+/* the member index the tar structFile resource keeps beside a structFile */
+#define STRUCT_FILE_INDEX_EXT     ".structFileIndex"
+
 typedef struct SpecColl {
     specCollClass_t collClass;
     structFileType_t type;
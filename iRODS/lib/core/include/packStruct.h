@@ -122,6 +122,14 @@ unpackStruct( void *inPackStr, void **outStruct, const char *packInstName,
 int
 parsePackInstruct( const char *packInstruct, packItem_t **packItemHead );
 int
+getCompiledPackInstruct( const char *packInstruct, packItem_t **packItemHead );
+int
+copyPackedItem( const packItem_t *srcItemHead, packItem_t **packItemHead );
+const void *
+lookupPackInstruct( char *name, const packInstructArray_t *myPackTable );
+int
+setPackInstructCache( int flag );
+int
 copyStrFromPiBuf( const char **inBuf, char *outBuf, int dependentFlag );
 int
 packTypeLookup( char *typeName );
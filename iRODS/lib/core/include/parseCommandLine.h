@@ -115,6 +115,10 @@ typedef struct {
     char *restartFileString;
     int lfrestart;
     char *lfrestartFileString;
+    int manifest;
+    char *manifestFileString;
+    int transfers;
+    int transfersValue;
     int version;
     int retries;
     int retriesValue;
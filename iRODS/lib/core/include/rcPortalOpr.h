@@ -26,8 +26,18 @@ typedef struct RcPortalTransferInp {
     int status;
     rodsLong_t	bytesWritten;
     unsigned char shared_secret[ NAME_LEN ];
+    int zeroCopy;       /* data moved with sendfile or splice */
+    float timeInSec;    /* wall time of the stream */
 } rcPortalTransferInp_t;
 
+/* throughput of one stream of the last parallel transfer, printed
+ * with the timing line of -v */
+typedef struct {
+    rodsLong_t bytesWritten;
+    float      timeInSec;
+    int        zeroCopy;        /* moved with sendfile or splice */
+} portalStreamStat_t;
+
 typedef enum {
     RBUDP_CLIENT,
     RBUDP_SERVER
@@ -37,6 +47,11 @@ typedef enum {
 extern "C" {
 #endif
 
+int
+getPortalStreamStat( rcComm_t *conn, portalStreamStat_t *streamStat,
+                     int maxStreams );
+void
+clearPortalStreamStat( rcComm_t *conn );
 int
 fillRcPortalTransferInp( rcComm_t *conn, rcPortalTransferInp_t *myInput,
                          int destFd, int srcFd, int threadNum );
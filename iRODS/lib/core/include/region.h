@@ -74,6 +74,8 @@ void *region_alloc( Region *r, size_t s );
 /* free region r */
 void region_free( Region *r );
 size_t region_size( Region *r );
+/* total bytes allocated in all regions by this process */
+size_t region_allocated_bytes();
 
 #ifdef __cplusplus
 }
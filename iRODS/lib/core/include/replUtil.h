@@ -22,6 +22,9 @@ int
 initCondForRepl( rodsEnv *myRodsEnv, rodsArguments_t *rodsArgs,
                  dataObjInp_t *dataObjInp, rodsRestart_t *rodsRestart );
 int
+replCollParallel( rcComm_t *conn, char *srcColl, rodsArguments_t *rodsArgs,
+                  dataObjInp_t *dataObjInp );
+int
 replCollUtil( rcComm_t *conn, char *srcColl, rodsEnv *myRodsEnv,
               rodsArguments_t *rodsArgs, dataObjInp_t *dataObjInp,
               rodsRestart_t *rodsRestart );
@@ -113,6 +113,8 @@
 #define SYS_SVR_TO_CLI_PUT_ACTION 99999990
 #define SYS_SVR_TO_CLI_GET_ACTION 99999991
 #define SYS_RSYNC_TARGET_MODIFIED 99999992	/* target modified */
+/* returned with each page of a STREAM_QUERY general query but the last */
+#define SYS_SVR_TO_CLI_GEN_QUERY_PAGE 99999993
 
 /* definition for iRODS server to client action request from a microservice.
  * these definitions are put in the "label" field of MsParam */
@@ -265,6 +267,7 @@ typedef struct startupPack {
 #define SP_LOG_LEVEL	"spLogLevel"
 #define SP_RE_CACHE_SALT "reCacheSalt"
 #define SERVER_BOOT_TIME "serverBootTime"
+#define SP_AGENT_POOL_SOCK "spAgentPoolSock"
 
 // =-=-=-=-=-=-=-
 // magic token to assign to startup pack option variable
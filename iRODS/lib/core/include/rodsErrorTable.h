@@ -188,6 +188,7 @@
 #define SYS_THREAD_ENCOUNTERED_INTERRUPT            -156000
 #define SYS_THREAD_RESOURCE_ERR                     -157000
 #define SYS_BAD_INPUT                               -158000
+#define SYS_NO_AGENT_POOL_SLOT_ERR                  -159000
 /** @} */
 
 /* 300,000 - 499,000 - user input type error */
@@ -48,6 +48,10 @@ typedef struct GenQueryInp {
                                 (possibly) additional rows available.
                                 If UPPER_CASE_WHERE is set, make the 'where'
                                 columns upper case.
+                                If STREAM_QUERY is set, the server sends
+                                all the pages without waiting for the
+                                continuation calls.  See
+                                rcGenQueryStream.
                              */
     keyValPair_t condInput;
     inxIvalPair_t selectInp; /* 1st int array is columns to return (select),
@@ -88,6 +92,7 @@ primary ordering column.
 #define QUOTA_QUERY 0x80
 #define AUTO_CLOSE  0x100
 #define UPPER_CASE_WHERE  0x200
+#define STREAM_QUERY  0x1000
 
 
 /*
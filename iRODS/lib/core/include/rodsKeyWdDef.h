@@ -121,6 +121,8 @@
 #define MAX_SUB_FILE_KW "maxSubFile" /* max number of files for tar file bundles */
 #define MAX_BUNDLE_SIZE_KW "maxBunSize" /* max size of a tar bundle in Gbs */
 #define NO_STAGING_KW                  "noStaging"
+#define REPL_WORKERS_KW                "replWorkers" /* objects replicated at
+* once by a collection replication */
 
 // =-=-=-=-=-=-=-
 #define MAX_SUB_FILE_KW "maxSubFile" /* max number of files for tar file bundles */ // JMC - backport 4771
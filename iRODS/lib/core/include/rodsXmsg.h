@@ -82,6 +82,7 @@ typedef struct TicketHashQue {
 
 typedef struct XmsgReq {
     int sock;
+    struct XmsgConn *conn;       // server side state of the connection once started
     struct XmsgReq *next;
 } xmsgReq_t;
 
@@ -22,6 +22,7 @@
 #include "authPluginRequest.h"
 #include "irods_configuration_parser.hpp"
 #include "irods_configuration_keywords.hpp"
+#include "irods_kvp_string_parser.hpp"
 #include "checksum.hpp"
 
 #include <openssl/md5.h>
@@ -211,6 +212,127 @@ int clientLoginTTL( rcComm_t *Conn, int ttl ) {
     return 0;
 }
 
+/* getSessionFileName - the session token of the auth file is kept beside
+ * it, and removed with it by iexit */
+static int
+getSessionFileName( char *fileName ) {
+    char authFileName[MAX_NAME_LEN + 10];
+    int status = obfiGetFilename( authFileName );
+    if ( status < 0 ) {
+        return status;
+    }
+    snprintf( fileName, MAX_NAME_LEN, "%s%s", authFileName, AUTH_SESSION_FILE_SUFFIX );
+    return 0;
+}
+
+/* sessionRequest - send a session key to the native plugin of the agent,
+ * returning the token it hands back if any */
+static int
+sessionRequest( rcComm_t *Conn, const std::string& session,
+                std::string& token ) {
+    authPluginReqInp_t reqInp;
+    authPluginReqOut_t *reqOut = NULL;
+
+    irods::kvp_map_t kvp;
+    kvp[ irods::AUTH_SESSION_KEY ] = session;
+    std::string context = irods::kvp_string( kvp );
+    if ( context.size() >= sizeof( reqInp.context_ ) ) {
+        return SYS_INVALID_INPUT_PARAM;
+    }
+
+    memset( &reqInp, 0, sizeof( reqInp ) );
+    snprintf( reqInp.auth_scheme_, sizeof( reqInp.auth_scheme_ ), "%s",
+              irods::AUTH_NATIVE_SCHEME.c_str() );
+    snprintf( reqInp.context_, sizeof( reqInp.context_ ), "%s", context.c_str() );
+
+    int status = rcAuthPluginRequest( Conn, &reqInp, &reqOut );
+    if ( status >= 0 && reqOut != NULL ) {
+        token = reqOut->result_;
+    }
+    free( reqOut );
+    return status;
+}
+
+/* clientLoginSessionResume - log in with the session token saved by an
+ * earlier login of the same user to the same server.  the agent accepts
+ * it without checking the password against the catalog */
+static int
+clientLoginSessionResume( rcComm_t *Conn ) {
+    char fileName[MAX_NAME_LEN + 10];
+    char host[NAME_LEN + 1], user[NAME_LEN + 1], zone[NAME_LEN + 1];
+    char token[MAX_NAME_LEN + 1];
+    int port = 0;
+
+    if ( strcmp( Conn->proxyUser.userName, Conn->clientUser.userName ) != 0 ) {
+        return SYS_NOT_SUPPORTED;
+    }
+
+    int status = getSessionFileName( fileName );
+    if ( status < 0 ) {
+        return status;
+    }
+
+    FILE *fp = fopen( fileName, "r" );
+    if ( fp == NULL ) {
+        return AUTH_FILE_DOES_NOT_EXIST;
+    }
+    status = fscanf( fp, "%64s %d %64s %64s %64s", host, &port, user, zone, token );
+    fclose( fp );
+    if ( status != 5 ||
+            strcmp( host, Conn->host ) != 0 ||
+            port != Conn->portNum ||
+            strcmp( user, Conn->proxyUser.userName ) != 0 ||
+            strcmp( zone, Conn->proxyUser.rodsZone ) != 0 ) {
+        return SYS_NOT_SUPPORTED;
+    }
+
+    std::string unused;
+    status = sessionRequest( Conn, token, unused );
+    if ( status < 0 ) {
+        rodsLog( LOG_DEBUG, "clientLoginSessionResume - session not resumed, status = %d",
+                 status );
+    }
+    return status;
+}
+
+/* clientLoginSessionSave - ask the agent for a token for the session just
+ * started and save it for the next login.  the agent refuses if it does
+ * not keep sessions, which only costs the round trip */
+static void
+clientLoginSessionSave( rcComm_t *Conn ) {
+    char fileName[MAX_NAME_LEN + 10];
+    char tmpName[MAX_NAME_LEN + 40];
+
+    if ( strcmp( Conn->proxyUser.userName, Conn->clientUser.userName ) != 0 ||
+            getSessionFileName( fileName ) < 0 ) {
+        return;
+    }
+
+    std::string token;
+    int status = sessionRequest( Conn, irods::AUTH_SESSION_NEW, token );
+    if ( status < 0 || token.empty() ) {
+        rodsLog( LOG_DEBUG, "clientLoginSessionSave - no session token, status = %d",
+                 status );
+        return;
+    }
+
+    /* written aside and renamed, so a concurrent login reads a whole one */
+    snprintf( tmpName, sizeof( tmpName ), "%s.%d", fileName, getpid() );
+    int fd = open( tmpName, O_CREAT | O_WRONLY | O_TRUNC, 0600 );
+    if ( fd < 0 ) {
+        return;
+    }
+    char line[MAX_NAME_LEN * 4];
+    int len = snprintf( line, sizeof( line ), "%s %d %s %s %s\n",
+                        Conn->host, Conn->portNum, Conn->proxyUser.userName,
+                        Conn->proxyUser.rodsZone, token.c_str() );
+    bool written = write( fd, line, len ) == len;
+    close( fd );
+    if ( !written || rename( tmpName, fileName ) != 0 ) {
+        unlink( tmpName );
+    }
+}
+
 /// =-=-=-=-=-=-=-
 /// @brief clientLogin provides the interface for authentication
 ///        plugins as well as defining the protocol or template
@@ -275,6 +397,20 @@ int clientLogin(
 
     } // if client side auth
 
+    // =-=-=-=-=-=-=-
+    // resume a session saved by an earlier login if the user asked for
+    // sessions to be kept
+    bool use_session = false;
+    if ( ProcessType == CLIENT_PT && irods::AUTH_NATIVE_SCHEME == auth_scheme ) {
+        rodsEnv rods_env;
+        if ( getRodsEnv( &rods_env ) >= 0 && rods_env.irodsAuthSessionCache > 0 ) {
+            use_session = true;
+            if ( clientLoginSessionResume( _comm ) >= 0 ) {
+                _comm->loggedIn = 1;
+                return 0;
+            }
+        }
+    }
 
     // =-=-=-=-=-=-=-
     // construct an auth object given the scheme
@@ -337,6 +473,10 @@ int clientLogin(
     // set the flag stating we are logged in
     _comm->loggedIn = 1;
 
+    if ( use_session ) {
+        clientLoginSessionSave( _comm );
+    }
+
     // =-=-=-=-=-=-=-
     // win!
     return 0;
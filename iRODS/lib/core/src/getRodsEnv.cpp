@@ -204,6 +204,8 @@ extern "C" {
         _env->irodsMaxSizeForSingleBuffer       = 32;
         _env->irodsDefaultNumberTransferThreads = 4;
         _env->irodsTransBufferSizeForParaTrans  = 4;
+        _env->irodsTransPipelineDepth           = 2;
+        _env->irodsAuthSessionCache             = 0;
 
         irods::environment_properties& props =
             irods::environment_properties::getInstance();
@@ -457,6 +459,18 @@ extern "C" {
             irods::CFG_IRODS_TRANS_BUFFER_SIZE_FOR_PARA_TRANS,
             _env->irodsTransBufferSizeForParaTrans );
 
+        capture_integer_property(
+            msg_lvl,
+            props,
+            irods::CFG_IRODS_TRANS_PIPELINE_DEPTH,
+            _env->irodsTransPipelineDepth );
+
+        capture_integer_property(
+            msg_lvl,
+            props,
+            irods::CFG_IRODS_AUTH_SESSION_CACHE,
+            _env->irodsAuthSessionCache );
+
         capture_string_property(
             msg_lvl,
             props,
@@ -746,6 +760,16 @@ extern "C" {
             env_var,
             _env->irodsTransBufferSizeForParaTrans );
 
+        env_var = irods::CFG_IRODS_TRANS_PIPELINE_DEPTH;
+        capture_integer_env_var(
+            env_var,
+            _env->irodsTransPipelineDepth );
+
+        env_var = irods::CFG_IRODS_AUTH_SESSION_CACHE;
+        capture_integer_env_var(
+            env_var,
+            _env->irodsAuthSessionCache );
+
         env_var = irods::CFG_IRODS_PLUGINS_HOME_KW;
         capture_string_env_var(
             env_var,
@@ -12,6 +12,10 @@
 #include "rcPortalOpr.h"
 #include "sockComm.h"
 #include "rcGlobalExtern.h"
+#include "irods_transfer_scheduler.hpp"
+
+/* the workers of a recursive get run with --transfers */
+static irods::transfer_scheduler *ParallelGet = NULL;
 
 int
 setSessionTicket( rcComm_t *myConn, char *ticket ) {
@@ -31,6 +35,77 @@ setSessionTicket( rcComm_t *myConn, char *ticket ) {
     return status;
 }
 
+static int
+getJobUtil( rcComm_t *conn, rodsArguments_t *rodsArgs,
+            dataObjInp_t *dataObjOprInp, irods::transfer_job& job ) {
+    return getDataObjUtil( conn, ( char * )job.src_.c_str(),
+                           ( char * )job.dst_.c_str(), job.size_, job.mode_,
+                           rodsArgs, dataObjOprInp );
+}
+
+/* startParallelGet - connect the --transfers workers for the collections
+ * of a get. Options which need the files fetched in order over the one
+ * connection keep the serial get. Large files left behind by a worker
+ * of an earlier run with --lfrestart are restarted first. */
+static int
+startParallelGet( rcComm_t *conn, rodsEnv *myRodsEnv,
+                  rodsArguments_t *rodsArgs, dataObjInp_t *dataObjOprInp,
+                  rodsPathInp_t *rodsPathInp ) {
+    int i, status;
+
+    if ( rodsArgs->transfers != True || rodsArgs->transfersValue <= 1 ||
+            rodsArgs->recursive != True ) {
+        return 0;
+    }
+    for ( i = 0; i < rodsPathInp->numSrc; i++ ) {
+        if ( rodsPathInp->targPath[i].objType == LOCAL_DIR_T ) {
+            break;
+        }
+    }
+    if ( i >= rodsPathInp->numSrc ) {
+        return 0;
+    }
+    if ( rodsArgs->restart == True || gGuiProgressCB != NULL ) {
+        rodsLog( LOG_NOTICE,
+                 "getUtil: --transfers cannot be used with -X or -P, using one connection" );
+        return 0;
+    }
+
+    ParallelGet = new irods::transfer_scheduler( rodsArgs->transfersValue,
+            myRodsEnv, rodsArgs, dataObjOprInp, getJobUtil,
+            conn->fileRestart.flags == FILE_RESTART_ON ?
+            rodsArgs->lfrestartFileString : NULL );
+    status = ParallelGet->start( rodsArgs->ticket == True ?
+                                 rodsArgs->ticketString : NULL );
+    if ( status < 0 ) {
+        rodsLogError( LOG_ERROR, status,
+                      "getUtil: cannot start the --transfers workers, using one connection" );
+        delete ParallelGet;
+        ParallelGet = NULL;
+        return 0;
+    }
+
+    if ( conn->fileRestart.flags == FILE_RESTART_ON ) {
+        for ( i = 0; i < ParallelGet->workers(); i++ ) {
+            std::string infoFile = ParallelGet->lfrestart_file( i );
+            fileRestartInfo_t *info;
+            status = readLfRestartFile( ( char * )infoFile.c_str(), &info );
+            if ( status < 0 ) {
+                continue;
+            }
+            status = lfRestartGetWithInfo( conn, info );
+            if ( status >= 0 ) {
+                ParallelGet->skip( info->objPath );
+                printf( "%s was restarted successfully\n", info->objPath );
+                unlink( infoFile.c_str() );
+            }
+            free( info );
+        }
+    }
+
+    return 0;
+}
+
 int
 getUtil( rcComm_t **myConn, rodsEnv *myRodsEnv, rodsArguments_t *myRodsArgs,
          rodsPathInp_t *rodsPathInp ) {
@@ -109,6 +184,8 @@ getUtil( rcComm_t **myConn, rodsEnv *myRodsEnv, rodsArguments_t *myRodsArgs,
         }
     }
 
+    startParallelGet( conn, myRodsEnv, myRodsArgs, &dataObjOprInp, rodsPathInp );
+
     for ( i = 0; i < rodsPathInp->numSrc; i++ ) {
         targPath = &rodsPathInp->targPath[i];
 
@@ -151,6 +228,15 @@ getUtil( rcComm_t **myConn, rodsEnv *myRodsEnv, rodsArguments_t *myRodsArgs,
         }
     }
 
+    if ( ParallelGet != NULL ) {
+        int parallelStatus = ParallelGet->finish();
+        delete ParallelGet;
+        ParallelGet = NULL;
+        if ( parallelStatus < 0 ) {
+            savedStatus = parallelStatus;
+        }
+    }
+
     if ( rodsRestart.fd > 0 ) {
         close( rodsRestart.fd );
     }
@@ -478,6 +564,20 @@ getCollUtil( rcComm_t **myConn, char *srcColl, char *targDir,
                 continue;
             }
 
+            if ( ParallelGet != NULL ) {
+                irods::transfer_job job;
+                job.src_ = srcChildPath;
+                job.dst_ = targChildPath;
+                job.size_ = mySize;
+                job.mode_ = collEnt.dataMode;
+                job.has_spec_coll_ = dataObjOprInp->specColl != NULL;
+                if ( job.has_spec_coll_ ) {
+                    job.spec_coll_ = *dataObjOprInp->specColl;
+                }
+                ParallelGet->submit( job );
+                continue;
+            }
+
             status = getDataObjUtil( conn, srcChildPath, targChildPath, mySize,
                                      collEnt.dataMode, rodsArgs, dataObjOprInp );
             if ( status < 0 ) {
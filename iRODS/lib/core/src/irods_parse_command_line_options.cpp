@@ -46,6 +46,7 @@ static int parse_program_options(
     ( "restart_file,X", po::value<std::string>(), "restartFile - specifies that the restart option is on and the restartFile input specifies a local file that contains the restart information." )
     ( "link", "ignore symlink." )
     ( "lfrestart", po::value<std::string>(), "lfRestartFile - specifies that the large file restart option is on and the lfRestartFile input specifies a local file that contains the restart information." )
+    ( "transfers", po::value<int>(), "count - the number of files to transfer at once, each over its own connection, for a recursive put or get" )
     ( "retries", po::value<int>(), "count - Retry the iput in case of error. The 'count' input specifies the number of times to retry. It must be used with the -X option" )
     ( "wlock", "use advisory write (exclusive) lock for the upload" )
     ( "rlock", "use advisory read lock for the download" )
@@ -219,6 +220,15 @@ static int parse_program_options(
             return INVALID_ANY_CAST;
         }
     }
+    if ( global_prog_ops_var_map.count( "transfers" ) ) {
+        _rods_args.transfers = 1;
+        try {
+            _rods_args.transfersValue = global_prog_ops_var_map[ "transfers" ].as< int >();
+        }
+        catch ( const boost::bad_any_cast& ) {
+            return INVALID_ANY_CAST;
+        }
+    }
     if ( global_prog_ops_var_map.count( "wlock" ) ) {
         _rods_args.wlock = 1;
     }
@@ -0,0 +1,260 @@
+// =-=-=-=-=-=-=-
+#include "irods_stream_encryption.hpp"
+#include "irods_log.hpp"
+#include "rodsErrorTable.h"
+
+// =-=-=-=-=-=-=-
+// ssl includes
+#include <openssl/rand.h>
+#include <openssl/err.h>
+
+#include <algorithm>
+#include <sstream>
+#include <string.h>
+
+
+namespace irods {
+
+    /// =-=-=-=-=-=-=-
+    /// @brief the iv and tag of the AEAD ciphers, 96 bits is the iv
+    ///        length gcm handles without hashing it first
+    static const int AEAD_IV_SIZE  = 12;
+    static const int AEAD_TAG_SIZE = 16;
+
+    static irods::error ssl_error( const std::string& _fcn ) {
+        char err[ 256 ];
+        ERR_error_string_n( ERR_get_error(), err, sizeof( err ) );
+        std::string msg( "failed in " );
+        msg += _fcn;
+        msg += " - ";
+        msg += err;
+        return ERROR( SYS_INTERNAL_ERR, msg );
+
+    } // ssl_error
+
+// =-=-=-=-=-=-=-
+// public - constructor
+    stream_crypt::stream_crypt(
+        int         _key_sz,
+        const char* _algo ) :
+        key_size_( _key_sz ),
+        iv_size_( 0 ),
+        tag_size_( 0 ),
+        aead_( false ),
+        encrypt_( true ),
+        algorithm_( _algo ? _algo : "" ),
+        cipher_( 0 ),
+        context_( EVP_CIPHER_CTX_new() ),
+        count_( 0 ) {
+
+        std::transform(
+            algorithm_.begin(),
+            algorithm_.end(),
+            algorithm_.begin(),
+            ::tolower );
+
+        // =-=-=-=-=-=-=-
+        // select the same defaults as buffer_crypt
+        if ( 0 == key_size_ ) {
+            key_size_ = 32;
+        }
+
+        if ( !algorithm_.empty() ) {
+            cipher_ = EVP_get_cipherbyname( algorithm_.c_str() );
+        }
+
+        if ( !cipher_ ) {
+            rodsLog(
+                LOG_NOTICE,
+                "stream_crypt - algorithm not supported [%s]",
+                algorithm_.c_str() );
+            // default to aes 256 cbc
+            cipher_    = EVP_aes_256_cbc();
+            algorithm_ = "aes-256-cbc";
+        }
+
+        aead_ = 0 != ( EVP_CIPHER_flags( cipher_ ) & EVP_CIPH_FLAG_AEAD_CIPHER );
+        if ( aead_ ) {
+            iv_size_  = AEAD_IV_SIZE;
+            tag_size_ = AEAD_TAG_SIZE;
+        }
+        else {
+            iv_size_ = key_size_;
+        }
+
+        memset( nonce_prefix_, 0, sizeof( nonce_prefix_ ) );
+
+    } // ctor
+
+// =-=-=-=-=-=-=-
+// public - destructor
+    stream_crypt::~stream_crypt() {
+        if ( context_ ) {
+            EVP_CIPHER_CTX_free( context_ );
+        }
+
+    } // dtor
+
+// =-=-=-=-=-=-=-
+// public - key the context
+    irods::error stream_crypt::init(
+        const buffer_crypt::array_t& _key,
+        bool                         _encrypt ) {
+        if ( !context_ ) {
+            return ERROR( SYS_INTERNAL_ERR, "no cipher context" );
+        }
+
+        if ( ( int )_key.size() < EVP_CIPHER_key_length( cipher_ ) ||
+                iv_size_ < EVP_CIPHER_iv_length( cipher_ ) ) {
+            std::stringstream msg;
+            msg << "key size [" << _key.size() << "] too small for [" << algorithm_ << "]";
+            return ERROR( SYS_INVALID_INPUT_PARAM, msg.str() );
+        }
+
+        encrypt_ = _encrypt;
+        if ( 0 == EVP_CipherInit_ex( context_, cipher_, NULL, NULL, NULL, encrypt_ ? 1 : 0 ) ) {
+            return ssl_error( "EVP_CipherInit_ex" );
+        }
+
+        if ( aead_ &&
+                0 == EVP_CIPHER_CTX_ctrl( context_, EVP_CTRL_GCM_SET_IVLEN, iv_size_, NULL ) ) {
+            return ssl_error( "EVP_CIPHER_CTX_ctrl" );
+        }
+
+        // =-=-=-=-=-=-=-
+        // the key schedule is computed here once, each buffer only sets
+        // its iv
+        if ( 0 == EVP_CipherInit_ex( context_, NULL, NULL, &_key[0], NULL, encrypt_ ? 1 : 0 ) ) {
+            return ssl_error( "EVP_CipherInit_ex" );
+        }
+
+        // =-=-=-=-=-=-=-
+        // the other streams of the transfer share the key, so the prefix
+        // is random to keep their nonces apart
+        count_ = 0;
+        if ( aead_ && encrypt_ &&
+                1 != RAND_bytes( nonce_prefix_, sizeof( nonce_prefix_ ) ) ) {
+            return ssl_error( "RAND_bytes" );
+        }
+
+        return SUCCESS();
+
+    } // init
+
+// =-=-=-=-=-=-=-
+// private - write the iv of the next buffer
+    irods::error stream_crypt::next_iv(
+        unsigned char* _iv ) {
+        if ( !aead_ ) {
+            if ( 1 != RAND_bytes( _iv, iv_size_ ) ) {
+                return ssl_error( "RAND_bytes" );
+            }
+            return SUCCESS();
+        }
+
+        // =-=-=-=-=-=-=-
+        // a nonce must never repeat under one key
+        if ( 0xffffffff == count_ ) {
+            return ERROR( SYS_INTERNAL_ERR, "nonce space of the stream is exhausted" );
+        }
+
+        memcpy( _iv, nonce_prefix_, sizeof( nonce_prefix_ ) );
+        _iv[  8 ] = ( unsigned char )( count_ >> 24 );
+        _iv[  9 ] = ( unsigned char )( count_ >> 16 );
+        _iv[ 10 ] = ( unsigned char )( count_ >> 8 );
+        _iv[ 11 ] = ( unsigned char )( count_ );
+        count_++;
+
+        return SUCCESS();
+
+    } // next_iv
+
+// =-=-=-=-=-=-=-
+// public - encryptor
+    irods::error stream_crypt::encrypt(
+        unsigned char* _buf,
+        int            _plain_len,
+        int&           _out_len ) {
+        if ( !encrypt_ ) {
+            return ERROR( SYS_INTERNAL_ERR, "context was keyed for decryption" );
+        }
+
+        irods::error ret = next_iv( _buf );
+        if ( !ret.ok() ) {
+            return PASS( ret );
+        }
+
+        if ( 0 == EVP_CipherInit_ex( context_, NULL, NULL, NULL, _buf, -1 ) ) {
+            return ssl_error( "EVP_CipherInit_ex" );
+        }
+
+        // =-=-=-=-=-=-=-
+        // the whole buffer is given in one update, so the output never
+        // runs ahead of the input and may overwrite it
+        unsigned char* text = _buf + iv_size_;
+        int cipher_len = 0;
+        if ( 0 == EVP_CipherUpdate( context_, text, &cipher_len, text, _plain_len ) ) {
+            return ssl_error( "EVP_CipherUpdate" );
+        }
+
+        int final_len = 0;
+        if ( 0 == EVP_CipherFinal_ex( context_, text + cipher_len, &final_len ) ) {
+            return ssl_error( "EVP_CipherFinal_ex" );
+        }
+        cipher_len += final_len;
+
+        if ( aead_ &&
+                0 == EVP_CIPHER_CTX_ctrl( context_, EVP_CTRL_GCM_GET_TAG, tag_size_, text + cipher_len ) ) {
+            return ssl_error( "EVP_CIPHER_CTX_ctrl" );
+        }
+
+        _out_len = iv_size_ + cipher_len + tag_size_;
+        return SUCCESS();
+
+    } // encrypt
+
+// =-=-=-=-=-=-=-
+// public - decryptor
+    irods::error stream_crypt::decrypt(
+        unsigned char* _buf,
+        int            _in_len,
+        int&           _plain_len ) {
+        if ( encrypt_ ) {
+            return ERROR( SYS_INTERNAL_ERR, "context was keyed for encryption" );
+        }
+
+        int cipher_len = _in_len - iv_size_ - tag_size_;
+        if ( cipher_len < 0 ) {
+            std::stringstream msg;
+            msg << "buffer of [" << _in_len << "] bytes is too short";
+            return ERROR( SYS_COPY_LEN_ERR, msg.str() );
+        }
+
+        if ( 0 == EVP_CipherInit_ex( context_, NULL, NULL, NULL, _buf, -1 ) ) {
+            return ssl_error( "EVP_CipherInit_ex" );
+        }
+
+        unsigned char* text = _buf + iv_size_;
+        if ( aead_ &&
+                0 == EVP_CIPHER_CTX_ctrl( context_, EVP_CTRL_GCM_SET_TAG, tag_size_, text + cipher_len ) ) {
+            return ssl_error( "EVP_CIPHER_CTX_ctrl" );
+        }
+
+        int plain_len = 0;
+        if ( 0 == EVP_CipherUpdate( context_, text, &plain_len, text, cipher_len ) ) {
+            return ssl_error( "EVP_CipherUpdate" );
+        }
+
+        // =-=-=-=-=-=-=-
+        // for an AEAD cipher this is where a tampered buffer is caught
+        int final_len = 0;
+        if ( 0 == EVP_CipherFinal_ex( context_, text + plain_len, &final_len ) ) {
+            return ssl_error( "EVP_CipherFinal_ex" );
+        }
+
+        _plain_len = plain_len + final_len;
+        return SUCCESS();
+
+    } // decrypt
+
+}; // namespace irods
@@ -0,0 +1,265 @@
+// =-=-=-=-=-=-=-
+#include "rodsErrorTable.h"
+#include "rodsLog.h"
+#include "irods_transfer_scheduler.hpp"
+
+#include <sstream>
+
+namespace irods {
+
+/// =-=-=-=-=-=-=-
+/// @brief jobs queued per worker before submit waits, which bounds the
+///        memory held for a very large tree
+    static const int MAX_PENDING_PER_WORKER = 64;
+
+    transfer_scheduler::transfer_scheduler(
+        int              _workers,
+        rodsEnv*         _env,
+        rodsArguments_t* _args,
+        dataObjInp_t*    _inp,
+        transfer_fn_t    _fn,
+        const char*      _lfrestart_file ) :
+        requested_( _workers ),
+        env_( _env ),
+        args_( _args ),
+        inp_( _inp ),
+        fn_( _fn ),
+        lfrestart_file_( _lfrestart_file ? _lfrestart_file : "" ),
+        pending_( 0 ),
+        done_( false ),
+        status_( 0 ) {
+    } // ctor
+
+    transfer_scheduler::~transfer_scheduler() {
+        finish();
+
+    } // dtor
+
+    std::string transfer_scheduler::lfrestart_file( int _idx ) const {
+        std::stringstream file;
+        file << lfrestart_file_ << "." << _idx;
+        return file.str();
+
+    } // lfrestart_file
+
+    int transfer_scheduler::start( char* _ticket ) {
+        int reconn_flag = args_->reconnect == True ? RECONN_TIMEOUT : NO_RECONN;
+        int status = 0;
+        for ( int i = 0; i < requested_; ++i ) {
+            rErrMsg_t err_msg;
+            rcComm_t* conn = rcConnect(
+                                 env_->rodsHost,
+                                 env_->rodsPort,
+                                 env_->rodsUserName,
+                                 env_->rodsZone,
+                                 reconn_flag,
+                                 &err_msg );
+            if ( conn == NULL ) {
+                status = err_msg.status < 0 ? err_msg.status : USER_SOCK_CONNECT_ERR;
+                rodsLogError( LOG_ERROR, status,
+                              "transfer_scheduler::start: rcConnect failed for worker %d", i );
+                break;
+            }
+
+            status = clientLogin( conn );
+            if ( status != 0 ) {
+                rodsLogError( LOG_ERROR, status,
+                              "transfer_scheduler::start: clientLogin failed for worker %d", i );
+                rcDisconnect( conn );
+                break;
+            }
+
+            if ( _ticket != NULL ) {
+                ticketAdminInp_t ticket_inp;
+                ticket_inp.arg1 = "session";
+                ticket_inp.arg2 = _ticket;
+                ticket_inp.arg3 = "";
+                ticket_inp.arg4 = "";
+                ticket_inp.arg5 = "";
+                ticket_inp.arg6 = "";
+                rcTicketAdmin( conn, &ticket_inp );
+            }
+
+            if ( !lfrestart_file_.empty() ) {
+                conn->fileRestart.flags = FILE_RESTART_ON;
+                rstrcpy( conn->fileRestart.infoFile, lfrestart_file( i ).c_str(), MAX_NAME_LEN );
+            }
+
+            worker* w = new worker;
+            w->idx_          = i;
+            w->conn_         = conn;
+            w->inp_          = *inp_;
+            w->queued_bytes_ = 0;
+            w->thread_       = NULL;
+            memset( &w->inp_.condInput, 0, sizeof( keyValPair_t ) );
+            replKeyVal( &inp_->condInput, &w->inp_.condInput );
+            workers_.push_back( w );
+        }
+
+        if ( workers_.empty() ) {
+            return status < 0 ? status : SYS_INVALID_INPUT_PARAM;
+        }
+
+        for ( size_t i = 0; i < workers_.size(); ++i ) {
+            workers_[ i ]->thread_ = new boost::thread(
+                &transfer_scheduler::run, this, workers_[ i ] );
+        }
+
+        if ( args_->verbose == True ) {
+            printf( "Transferring files over %d connections\n", ( int )workers_.size() );
+        }
+
+        return workers_.size();
+
+    } // start
+
+    void transfer_scheduler::submit( const transfer_job& _job ) {
+        // =-=-=-=-=-=-=-
+        // wait for room, then hand the job to the least loaded queue
+        {
+            boost::mutex::scoped_lock lock( mutex_ );
+            while ( pending_ >= MAX_PENDING_PER_WORKER * ( int )workers_.size() ) {
+                room_.wait( lock );
+            }
+            if ( skip_.count( _job.src_ ) || skip_.count( _job.dst_ ) ) {
+                return;
+            }
+        }
+
+        worker* target = NULL;
+        rodsLong_t least = 0;
+        for ( size_t i = 0; i < workers_.size(); ++i ) {
+            boost::mutex::scoped_lock lock( workers_[ i ]->mutex_ );
+            if ( target == NULL || workers_[ i ]->queued_bytes_ < least ) {
+                target = workers_[ i ];
+                least  = workers_[ i ]->queued_bytes_;
+            }
+        }
+
+        {
+            boost::mutex::scoped_lock lock( target->mutex_ );
+            target->jobs_.push_back( _job );
+            target->queued_bytes_ += _job.size_;
+        }
+
+        boost::mutex::scoped_lock lock( mutex_ );
+        pending_++;
+        work_.notify_all();
+
+    } // submit
+
+    void transfer_scheduler::skip( const std::string& _path ) {
+        boost::mutex::scoped_lock lock( mutex_ );
+        skip_.insert( _path );
+
+    } // skip
+
+    bool transfer_scheduler::take( worker* _w, transfer_job& _job ) {
+        boost::mutex::scoped_lock lock( _w->mutex_ );
+        if ( _w->jobs_.empty() ) {
+            return false;
+        }
+        _job = _w->jobs_.front();
+        _w->jobs_.pop_front();
+        _w->queued_bytes_ -= _job.size_;
+        return true;
+
+    } // take
+
+    bool transfer_scheduler::steal( worker* _w, transfer_job& _job ) {
+        // =-=-=-=-=-=-=-
+        // take from the back of the fullest other queue, leaving the front
+        // to its owner
+        worker* victim = NULL;
+        rodsLong_t most = 0;
+        for ( size_t i = 0; i < workers_.size(); ++i ) {
+            if ( workers_[ i ] == _w ) {
+                continue;
+            }
+            boost::mutex::scoped_lock lock( workers_[ i ]->mutex_ );
+            if ( !workers_[ i ]->jobs_.empty() &&
+                    ( victim == NULL || workers_[ i ]->queued_bytes_ > most ) ) {
+                victim = workers_[ i ];
+                most   = workers_[ i ]->queued_bytes_;
+            }
+        }
+
+        if ( victim == NULL ) {
+            return false;
+        }
+
+        boost::mutex::scoped_lock lock( victim->mutex_ );
+        if ( victim->jobs_.empty() ) {
+            return false;
+        }
+        _job = victim->jobs_.back();
+        victim->jobs_.pop_back();
+        victim->queued_bytes_ -= _job.size_;
+        return true;
+
+    } // steal
+
+    void transfer_scheduler::run( worker* _w ) {
+        while ( true ) {
+            {
+                boost::mutex::scoped_lock lock( mutex_ );
+                while ( pending_ == 0 && !done_ ) {
+                    work_.wait( lock );
+                }
+                if ( pending_ == 0 && done_ ) {
+                    break;
+                }
+            }
+
+            transfer_job job;
+            if ( !take( _w, job ) && !steal( _w, job ) ) {
+                // =-=-=-=-=-=-=-
+                // another worker got there first
+                boost::this_thread::yield();
+                continue;
+            }
+
+            {
+                boost::mutex::scoped_lock lock( mutex_ );
+                pending_--;
+                room_.notify_one();
+            }
+
+            _w->inp_.specColl = job.has_spec_coll_ ? &job.spec_coll_ : NULL;
+            int status = fn_( _w->conn_, args_, &_w->inp_, job );
+            if ( status < 0 ) {
+                rodsLogError( LOG_ERROR, status,
+                              "transfer_scheduler: transfer of %s failed on connection %d",
+                              job.src_.c_str(), _w->idx_ );
+                boost::mutex::scoped_lock lock( mutex_ );
+                status_ = status;
+            }
+        }
+
+    } // run
+
+    int transfer_scheduler::finish() {
+        {
+            boost::mutex::scoped_lock lock( mutex_ );
+            done_ = true;
+            work_.notify_all();
+        }
+
+        for ( size_t i = 0; i < workers_.size(); ++i ) {
+            worker* w = workers_[ i ];
+            if ( w->thread_ ) {
+                w->thread_->join();
+                delete w->thread_;
+            }
+            printErrorStack( w->conn_->rError );
+            rcDisconnect( w->conn_ );
+            clearKeyVal( &w->inp_.condInput );
+            delete w;
+        }
+        workers_.clear();
+
+        return status_;
+
+    } // finish
+
+}; // namespace irods
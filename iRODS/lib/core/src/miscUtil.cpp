@@ -8,6 +8,7 @@
 #include "rodsClient.h"
 #include "rodsLog.h"
 #include "miscUtil.h"
+#include "rcPortalOpr.h"
 #include "rcGlobalExtern.h"
 
 #include "irods_stacktrace.hpp"
@@ -448,6 +449,26 @@ printTiming( rcComm_t *conn, char *objPath, rodsLong_t fileSize,
                  myFile, sizeInMb, timeInSec, conn->transStat.numThreads, transRate );
     }
 
+    /* per stream throughput of a parallel transfer */
+    portalStreamStat_t streamStat[MAX_NUM_CONFIG_TRAN_THR];
+    int numStreamStat = getPortalStreamStat( conn, streamStat,
+                        MAX_NUM_CONFIG_TRAN_THR );
+    if ( numStreamStat > MAX_NUM_CONFIG_TRAN_THR ) {
+        numStreamStat = MAX_NUM_CONFIG_TRAN_THR;
+    }
+    if ( numStreamStat > 1 ) {
+        for ( int i = 0; i < numStreamStat; i++ ) {
+            portalStreamStat_t *myStat = &streamStat[i];
+            float streamMb = ( float ) myStat->bytesWritten / 1048600.0;
+            fprintf( stdout,
+                     "      stream %-2d %10.3f MB | %.3f sec | %6.3f MB/s%s\n",
+                     i, streamMb, myStat->timeInSec,
+                     myStat->timeInSec > 0.0 ? streamMb / myStat->timeInSec : 0.0,
+                     myStat->zeroCopy ? " | zero-copy" : "" );
+        }
+    }
+    clearPortalStreamStat( conn );
+
     return 0;
 }
 
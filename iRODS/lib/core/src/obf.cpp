@@ -213,6 +213,13 @@ obfRmPw( int opt ) {
     if ( int status = obfiGetFilename( fileName ) ) {
         return status;
     }
+
+    /* a session token is no use without the password it was started with */
+    boost::system::error_code sessionError;
+    boost::filesystem::remove(
+        boost::filesystem::path( std::string( fileName ) + AUTH_SESSION_FILE_SUFFIX ),
+        sessionError );
+
     boost::filesystem::path filePath( fileName );
     if ( !boost::filesystem::exists( filePath ) ) {
         if ( opt == 0 ) {
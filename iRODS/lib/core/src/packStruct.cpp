@@ -14,6 +14,22 @@
 #include "irods_pack_table.hpp"
 #include <iostream>
 #include <string>
+#include <map>
+#include <boost/thread/mutex.hpp>
+
+/* Compiled pack instructions. A pack instruction is parsed into its
+ * packItem_t list once and every later use gets a copy of that list,
+ * since resolving dependent items rewrites the copy in place. The
+ * instruction looked up for a struct name is cached as well.
+ */
+typedef std::map< std::string, packItem_t * > compiledPackInstruct_t;
+typedef std::map< std::pair< const packInstructArray_t *, std::string >,
+        const void * > packInstructLookup_t;
+
+static boost::mutex PackInstructCacheMutex;
+static compiledPackInstruct_t CompiledPackInstruct;
+static packInstructLookup_t PackInstructLookup;
+static int PackInstructCacheFlag = 1;
 
 int
 packStruct( void *inStruct, bytesBuf_t **packedResult, const char *packInstName,
@@ -256,6 +272,137 @@ parsePackInstruct( const char *packInstruct, packItem_t **packItemHead ) {
     return 0;
 }
 
+/* getCompiledPackInstruct - same as parsePackInstruct, but the parsing is
+ * done only the first time an instruction is seen. The returned list is
+ * a private copy to be freed with freePackedItem.
+ */
+int
+getCompiledPackInstruct( const char *packInstruct, packItem_t **packItemHead ) {
+    packItem_t *compiledHead = NULL;
+    int status;
+
+    if ( PackInstructCacheFlag == 0 ) {
+        return parsePackInstruct( packInstruct, packItemHead );
+    }
+
+    {
+        boost::mutex::scoped_lock lock( PackInstructCacheMutex );
+        compiledPackInstruct_t::iterator itr =
+            CompiledPackInstruct.find( packInstruct );
+        if ( itr != CompiledPackInstruct.end() ) {
+            compiledHead = itr->second;
+        }
+    }
+
+    if ( compiledHead == NULL ) {
+        status = parsePackInstruct( packInstruct, &compiledHead );
+        if ( status < 0 ) {
+            freePackedItem( compiledHead );
+            return status;
+        }
+        if ( compiledHead == NULL ) {
+            /* an empty instruction */
+            return 0;
+        }
+        boost::mutex::scoped_lock lock( PackInstructCacheMutex );
+        std::pair< compiledPackInstruct_t::iterator, bool > ret =
+            CompiledPackInstruct.insert( std::make_pair(
+                                             std::string( packInstruct ), compiledHead ) );
+        if ( !ret.second ) {
+            /* another thread got there first */
+            freePackedItem( compiledHead );
+            compiledHead = ret.first->second;
+        }
+    }
+
+    return copyPackedItem( compiledHead, packItemHead );
+}
+
+/* copyPackedItem - make a deep copy of a packItem_t list. Only the
+ * name is owned by an item, the rest is copied as is.
+ */
+int
+copyPackedItem( const packItem_t *srcItemHead, packItem_t **packItemHead ) {
+    const packItem_t *srcItem;
+    packItem_t *myPackItem;
+    packItem_t *prevPackItem = NULL;
+
+    *packItemHead = NULL;
+    for ( srcItem = srcItemHead; srcItem != NULL; srcItem = srcItem->next ) {
+        myPackItem = ( packItem_t* )malloc( sizeof( packItem_t ) );
+        memcpy( myPackItem, srcItem, sizeof( packItem_t ) );
+        if ( srcItem->name != NULL ) {
+            myPackItem->name = strdup( srcItem->name );
+        }
+        myPackItem->parent = NULL;
+        myPackItem->next = NULL;
+        myPackItem->prev = prevPackItem;
+        if ( prevPackItem != NULL ) {
+            prevPackItem->next = myPackItem;
+        }
+        else {
+            *packItemHead = myPackItem;
+        }
+        prevPackItem = myPackItem;
+    }
+
+    return 0;
+}
+
+/* lookupPackInstruct - matchPackInstruct with the result kept per pack
+ * table and name. Failed lookups are not kept since the API pack table
+ * may grow as plugins are loaded.
+ */
+const void *
+lookupPackInstruct( char *name, const packInstructArray_t *myPackTable ) {
+    const void *packInstruct;
+
+    if ( PackInstructCacheFlag == 0 ) {
+        return matchPackInstruct( name, myPackTable );
+    }
+
+    std::pair< const packInstructArray_t *, std::string > key( myPackTable, name );
+    {
+        boost::mutex::scoped_lock lock( PackInstructCacheMutex );
+        packInstructLookup_t::iterator itr = PackInstructLookup.find( key );
+        if ( itr != PackInstructLookup.end() ) {
+            return itr->second;
+        }
+    }
+
+    packInstruct = matchPackInstruct( name, myPackTable );
+    if ( packInstruct != NULL ) {
+        boost::mutex::scoped_lock lock( PackInstructCacheMutex );
+        PackInstructLookup[ key ] = packInstruct;
+    }
+
+    return packInstruct;
+}
+
+/* setPackInstructCache - turn the compiled pack instruction cache on (1)
+ * or off (0). Returns the previous setting. Turning it off drops the
+ * cached entries, so it must not be done while other threads are
+ * packing.
+ */
+int
+setPackInstructCache( int flag ) {
+    boost::mutex::scoped_lock lock( PackInstructCacheMutex );
+    int prevFlag = PackInstructCacheFlag;
+
+    PackInstructCacheFlag = flag;
+    if ( flag == 0 ) {
+        compiledPackInstruct_t::iterator itr;
+        for ( itr = CompiledPackInstruct.begin();
+                itr != CompiledPackInstruct.end(); ++itr ) {
+            freePackedItem( itr->second );
+        }
+        CompiledPackInstruct.clear();
+        PackInstructLookup.clear();
+    }
+
+    return prevFlag;
+}
+
 /* copy the next string from the inBuf to putBuf and advance the inBuf pointer.
  * special char '*', ';' and '?' will be returned as a string.
  */
@@ -608,7 +755,7 @@ resolveIntDepItem( packItem_t *myPackedItem ) {
     }
 
     newPackedItem = NULL;
-    status = parsePackInstruct( myPI, &newPackedItem );
+    status = getCompiledPackInstruct( myPI, &newPackedItem );
 
     if ( status < 0 ) {
         freePackedItem( newPackedItem );
@@ -1793,7 +1940,7 @@ packChildStruct( void **inPtr, packedOutput_t *packedOutput,
     }
 
     if ( packInstructInp == NULL ) {
-        packInstruct = matchPackInstruct( myPackedItem->name, myPackTable );
+        packInstruct = lookupPackInstruct( myPackedItem->name, myPackTable );
     }
     else {
         packInstruct = packInstructInp;
@@ -1809,7 +1956,7 @@ packChildStruct( void **inPtr, packedOutput_t *packedOutput,
     for ( i = 0; i < numElement; i++ ) {
         packItemHead = NULL;
 
-        status = parsePackInstruct( ( const char* )packInstruct, &packItemHead );
+        status = getCompiledPackInstruct( ( const char* )packInstruct, &packItemHead );
         if ( status < 0 ) {
             freePackedItem( packItemHead );
             return status;
@@ -2702,7 +2849,7 @@ unpackChildStruct( void **inPtr, packedOutput_t *unpackedOutput,
     }
 
     if ( packInstructInp == NULL ) {
-        packInstruct = matchPackInstruct( myPackedItem->name, myPackTable );
+        packInstruct = lookupPackInstruct( myPackedItem->name, myPackTable );
     }
     else {
         packInstruct = packInstructInp;
@@ -2718,7 +2865,7 @@ unpackChildStruct( void **inPtr, packedOutput_t *unpackedOutput,
     for ( i = 0; i < numElement; i++ ) {
         unpackItemHead = NULL;
 
-        status = parsePackInstruct( static_cast<const char*>( packInstruct ), &unpackItemHead );
+        status = getCompiledPackInstruct( static_cast<const char*>( packInstruct ), &unpackItemHead );
         if ( status < 0 ) {
             freePackedItem( unpackItemHead );
             return status;
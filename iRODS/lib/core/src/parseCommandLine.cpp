@@ -147,6 +147,17 @@ parseCmdLineOpt( int argc, char **argv, const char *optString, int includeLong,
                     argv[i + 1] = "-Z";
                 }
             }
+            if ( strcmp( "--manifest", argv[i] ) == 0 ) {
+                argv[i] = "-Z";
+                if ( i + 2 > argc || *argv[i + 1] == '-' ) {
+                    rodsLog( LOG_ERROR,
+                             "--manifest option needs a manifest file" );
+                    return USER_INPUT_OPTION_ERR;
+                }
+                rodsArgs->manifestFileString = strdup( argv[i + 1] );
+                argv[i + 1] = "-Z";
+                rodsArgs->manifest = True;
+            }
             if ( strcmp( "--orphan", argv[i] ) == 0 ) {
                 rodsArgs->orphan = True;
                 argv[i] = "-Z";
@@ -304,6 +315,19 @@ parseCmdLineOpt( int argc, char **argv, const char *optString, int includeLong,
                     argv[i + 1] = "-Z";
                 }
             }
+            if ( strcmp( "--transfers", argv[i] ) == 0 ) {
+                rodsArgs->transfers = True;
+                argv[i] = "-Z";
+                if ( i + 2 <= argc ) {
+                    if ( *argv[i + 1] == '-' ) {
+                        rodsLog( LOG_ERROR,
+                                 "--transfers option needs a number of transfers" );
+                        return USER_INPUT_OPTION_ERR;
+                    }
+                    rodsArgs->transfersValue = atoi( argv[i + 1] );
+                    argv[i + 1] = "-Z";
+                }
+            }
         }
     }
 
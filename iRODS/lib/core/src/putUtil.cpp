@@ -19,6 +19,83 @@
 #include "sockComm.h"
 #include <boost/filesystem/operations.hpp>
 #include <boost/filesystem/convenience.hpp>
+#include "irods_transfer_scheduler.hpp"
+
+/* the workers of a recursive put run with --transfers */
+static irods::transfer_scheduler *ParallelPut = NULL;
+
+static int
+putJobUtil( rcComm_t *conn, rodsArguments_t *rodsArgs,
+            dataObjInp_t *dataObjOprInp, irods::transfer_job& job ) {
+    dataObjOprInp->createMode = job.mode_;
+    return putFileUtil( conn, ( char * )job.src_.c_str(),
+                        ( char * )job.dst_.c_str(), job.size_, rodsArgs,
+                        dataObjOprInp );
+}
+
+/* startParallelPut - connect the --transfers workers for the directories
+ * of a put. Options which need the files sent in order over the one
+ * connection keep the serial put. Large files left behind by a worker
+ * of an earlier run with --lfrestart are restarted first. */
+static int
+startParallelPut( rcComm_t *conn, rodsEnv *myRodsEnv,
+                  rodsArguments_t *rodsArgs, dataObjInp_t *dataObjOprInp,
+                  rodsPathInp_t *rodsPathInp ) {
+    int i, status;
+
+    if ( rodsArgs->transfers != True || rodsArgs->transfersValue <= 1 ||
+            rodsArgs->recursive != True ) {
+        return 0;
+    }
+    for ( i = 0; i < rodsPathInp->numSrc; i++ ) {
+        if ( rodsPathInp->targPath[i].objType == COLL_OBJ_T ) {
+            break;
+        }
+    }
+    if ( i >= rodsPathInp->numSrc ) {
+        return 0;
+    }
+    if ( rodsArgs->bulk == True || rodsArgs->restart == True ||
+            gGuiProgressCB != NULL ) {
+        rodsLog( LOG_NOTICE,
+                 "putUtil: --transfers cannot be used with -b, -X or -P, using one connection" );
+        return 0;
+    }
+
+    ParallelPut = new irods::transfer_scheduler( rodsArgs->transfersValue,
+            myRodsEnv, rodsArgs, dataObjOprInp, putJobUtil,
+            conn->fileRestart.flags == FILE_RESTART_ON ?
+            rodsArgs->lfrestartFileString : NULL );
+    status = ParallelPut->start( rodsArgs->ticket == True ?
+                                 rodsArgs->ticketString : NULL );
+    if ( status < 0 ) {
+        rodsLogError( LOG_ERROR, status,
+                      "putUtil: cannot start the --transfers workers, using one connection" );
+        delete ParallelPut;
+        ParallelPut = NULL;
+        return 0;
+    }
+
+    if ( conn->fileRestart.flags == FILE_RESTART_ON ) {
+        for ( i = 0; i < ParallelPut->workers(); i++ ) {
+            std::string infoFile = ParallelPut->lfrestart_file( i );
+            fileRestartInfo_t *info;
+            status = readLfRestartFile( ( char * )infoFile.c_str(), &info );
+            if ( status < 0 ) {
+                continue;
+            }
+            status = lfRestartPutWithInfo( conn, info );
+            if ( status >= 0 ) {
+                ParallelPut->skip( info->objPath );
+                printf( "%s was restarted successfully\n", info->objPath );
+                unlink( infoFile.c_str() );
+            }
+            free( info );
+        }
+    }
+
+    return 0;
+}
 
 int
 setSessionTicket( rcComm_t *myConn, char *ticket ) {
@@ -118,6 +195,8 @@ putUtil( rcComm_t **myConn, rodsEnv *myRodsEnv,
             free( info );
         }
     }
+    startParallelPut( conn, myRodsEnv, myRodsArgs, &dataObjOprInp, rodsPathInp );
+
     for ( i = 0; i < rodsPathInp->numSrc; i++ ) {
         targPath = &rodsPathInp->targPath[i];
 
@@ -161,6 +240,15 @@ putUtil( rcComm_t **myConn, rodsEnv *myRodsEnv,
         }
     }
 
+    if ( ParallelPut != NULL ) {
+        int parallelStatus = ParallelPut->finish();
+        delete ParallelPut;
+        ParallelPut = NULL;
+        if ( parallelStatus < 0 ) {
+            savedStatus = parallelStatus;
+        }
+    }
+
     if ( rodsRestart.fd > 0 ) {
         close( rodsRestart.fd );
     }
@@ -670,6 +758,16 @@ putDirUtil( rcComm_t **myConn, char *srcDir, char *targColl,
                                           dataSize,  dataObjOprInp->createMode, rodsArgs,
                                           bulkOprInp, bulkOprInfo );
             }
+            else if ( ParallelPut != NULL ) {
+                irods::transfer_job job;
+                job.src_ = srcChildPath;
+                job.dst_ = targChildPath;
+                job.size_ = dataSize;
+                job.mode_ = dataObjOprInp->createMode;
+                job.has_spec_coll_ = false;
+                ParallelPut->submit( job );
+                status = 0;
+            }
             else {
                 /* normal put */
                 status = putFileUtil( conn, srcChildPath, targChildPath,
@@ -8,6 +8,7 @@
 #include "rcConnect.h"
 #include "rcGlobal.h"
 #include "rcMisc.h"
+#include "rcPortalOpr.h"
 
 #ifdef windows_platform
 #include "startsock.hpp"
@@ -327,6 +328,7 @@ freeRcComm( rcComm_t *conn ) {
     }
 
     status = cleanRcComm( conn );
+    clearPortalStreamStat( conn );
     free( conn );
 
     return status;
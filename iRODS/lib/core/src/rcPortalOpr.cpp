@@ -14,6 +14,7 @@
 // =-=-=-=-=-=-=-
 #include "irods_stacktrace.hpp"
 #include "irods_buffer_encryption.hpp"
+#include "irods_stream_encryption.hpp"
 #include "irods_client_server_negotiation.hpp"
 
 #include <openssl/md5.h>
@@ -25,8 +26,225 @@
 #include <fstream>
 #include <boost/filesystem/operations.hpp>
 #include <boost/filesystem/convenience.hpp>
+#include <vector>
+#include <map>
+#ifdef linux_platform
+#include <sys/sendfile.h>
+#include <fcntl.h>
+#endif
 using namespace boost::filesystem;
 
+// =-=-=-=-=-=-=-
+// transfer buffers are kept for reuse across streams and files instead
+// of being allocated for every stream of every transfer
+static boost::mutex                  PortalBufMutex;
+static std::vector< unsigned char* > PortalBufFree;
+static rodsLong_t                    PortalBufSize = 0;
+
+// =-=-=-=-=-=-=-
+// per stream counters of the last parallel transfer of each connection,
+// kept out of rcComm_t so that its layout does not change
+static boost::mutex PortalStreamStatMutex;
+static std::map< rcComm_t*, std::vector< portalStreamStat_t > > PortalStreamStats;
+
+static unsigned char*
+getPortalBuf( rodsLong_t size ) {
+    boost::mutex::scoped_lock lock( PortalBufMutex );
+    if ( size != PortalBufSize ) {
+        for ( size_t i = 0; i < PortalBufFree.size(); i++ ) {
+            free( PortalBufFree[i] );
+        }
+        PortalBufFree.clear();
+        PortalBufSize = size;
+    }
+    if ( !PortalBufFree.empty() ) {
+        unsigned char* buf = PortalBufFree.back();
+        PortalBufFree.pop_back();
+        return buf;
+    }
+    return ( unsigned char* )malloc( size );
+}
+
+static void
+putPortalBuf( unsigned char* buf, rodsLong_t size ) {
+    if ( buf == NULL ) {
+        return;
+    }
+    boost::mutex::scoped_lock lock( PortalBufMutex );
+    if ( size != PortalBufSize ||
+            PortalBufFree.size() >= MAX_NUM_CONFIG_TRAN_THR ) {
+        free( buf );
+        return;
+    }
+    PortalBufFree.push_back( buf );
+}
+
+/* updateRestartInfo - account for len bytes moved by a stream and
+ * periodically save the restart file */
+static void
+updateRestartInfo( rcComm_t *conn, int threadNum, rodsLong_t len,
+                   const char *caller ) {
+    fileRestartInfo_t *info = &conn->fileRestart.info;
+
+    if ( info->numSeg <= 0 ) {   /* not a file restart */
+        return;
+    }
+    info->dataSeg[threadNum].len += len;
+    conn->fileRestart.writtenSinceUpdated += len;
+    if ( threadNum == 0 && conn->fileRestart.writtenSinceUpdated >=
+            RESTART_FILE_UPDATE_SIZE ) {
+        int status;
+        /* time to write to the restart file */
+        status = writeLfRestartFile( conn->fileRestart.infoFile,
+                                     &conn->fileRestart.info );
+        if ( status < 0 ) {
+            rodsLog( LOG_ERROR,
+                     "%s: writeLfRestartFile for %s, status = %d",
+                     caller, conn->fileRestart.info.fileName, status );
+        }
+        conn->fileRestart.writtenSinceUpdated = 0;
+    }
+}
+
+/* recordStreamStat - keep the per stream counters of a transfer for the
+ * -v timing output */
+static void
+recordStreamStat( rcComm_t *conn, rcPortalTransferInp_t *myInput,
+                  int numThreads ) {
+    boost::mutex::scoped_lock lock( PortalStreamStatMutex );
+    std::vector< portalStreamStat_t >& stats = PortalStreamStats[ conn ];
+    stats.resize( numThreads );
+    for ( int i = 0; i < numThreads; i++ ) {
+        stats[i].bytesWritten = myInput[i].bytesWritten;
+        stats[i].timeInSec = myInput[i].timeInSec;
+        stats[i].zeroCopy = myInput[i].zeroCopy;
+    }
+}
+
+/* getPortalStreamStat - copy up to maxStreams stream counters of the
+ * last parallel transfer of conn.  Returns the number of streams of that
+ * transfer, 0 if none was recorded */
+int
+getPortalStreamStat( rcComm_t *conn, portalStreamStat_t *streamStat,
+                     int maxStreams ) {
+    boost::mutex::scoped_lock lock( PortalStreamStatMutex );
+    std::map< rcComm_t*, std::vector< portalStreamStat_t > >::iterator itr =
+        PortalStreamStats.find( conn );
+    if ( itr == PortalStreamStats.end() ) {
+        return 0;
+    }
+    int numStreams = itr->second.size();
+    for ( int i = 0; i < numStreams && i < maxStreams; i++ ) {
+        streamStat[i] = itr->second[i];
+    }
+    return numStreams;
+}
+
+/* clearPortalStreamStat - forget the stream counters of conn */
+void
+clearPortalStreamStat( rcComm_t *conn ) {
+    boost::mutex::scoped_lock lock( PortalStreamStatMutex );
+    PortalStreamStats.erase( conn );
+}
+
+static float
+elapsedSec( struct timeval *startTime ) {
+    struct timeval endTime;
+    ( void ) gettimeofday( &endTime, ( struct timezone * )0 );
+    return ( float )( endTime.tv_sec - startTime->tv_sec ) +
+           ( float )( endTime.tv_usec - startTime->tv_usec ) / 1000000.0;
+}
+
+#ifdef linux_platform
+/* sendfileToPortal - send len bytes of the file starting at offset to the
+ * socket without copying them through user space.  Returns the number of
+ * bytes sent, or -errno if nothing could be sent. */
+static rodsLong_t
+sendfileToPortal( int sock, int fd, rodsLong_t offset, rodsLong_t len ) {
+    off_t myOffset = offset;
+    rodsLong_t bytesSent = 0;
+
+    while ( bytesSent < len ) {
+        ssize_t n = sendfile( sock, fd, &myOffset, len - bytesSent );
+        if ( n < 0 ) {
+            if ( errno == EINTR ) {
+                continue;
+            }
+            return bytesSent > 0 ? bytesSent : -errno;
+        }
+        if ( n == 0 ) {     /* the file is shorter than expected */
+            break;
+        }
+        bytesSent += n;
+    }
+    return bytesSent;
+}
+
+/* spliceFromPortal - move up to len bytes from the socket to the current
+ * offset of the file through a pipe.  Returns the number of bytes written
+ * to the file or a negative error.  *unsupported is set if the kernel
+ * cannot splice into this file; whatever was already in the pipe is then
+ * copied through buf and the caller should continue with read and write.
+ */
+static rodsLong_t
+spliceFromPortal( int sock, int fd, int pipeFd[2], rodsLong_t len,
+                  unsigned char *buf, rodsLong_t bufLen, int *unsupported ) {
+    ssize_t bytesIn;
+
+    *unsupported = 0;
+    do {
+        bytesIn = splice( sock, NULL, pipeFd[1], NULL, len,
+                          SPLICE_F_MOVE | SPLICE_F_MORE );
+    }
+    while ( bytesIn < 0 && errno == EINTR );
+
+    if ( bytesIn < 0 ) {
+        if ( errno == EINVAL || errno == ENOSYS ) {
+            *unsupported = 1;
+            return 0;
+        }
+        return SYS_COPY_LEN_ERR - errno;
+    }
+    if ( bytesIn == 0 ) {   /* the peer closed the connection early */
+        return SYS_COPY_LEN_ERR;
+    }
+
+    rodsLong_t toMove = bytesIn;
+    while ( toMove > 0 ) {
+        ssize_t bytesOut = splice( pipeFd[0], NULL, fd, NULL, toMove,
+                                   SPLICE_F_MOVE | SPLICE_F_MORE );
+        if ( bytesOut > 0 ) {
+            toMove -= bytesOut;
+            continue;
+        }
+        if ( bytesOut < 0 && errno == EINTR ) {
+            continue;
+        }
+        if ( bytesOut < 0 && ( errno == EINVAL || errno == ENOSYS ) ) {
+            *unsupported = 1;
+            while ( toMove > 0 ) {
+                int bytesWritten = 0;
+                ssize_t n = read( pipeFd[0], buf, toMove > bufLen ? bufLen : toMove );
+                if ( n < 0 && errno == EINTR ) {
+                    continue;
+                }
+                if ( n <= 0 ) {
+                    return SYS_COPY_LEN_ERR - errno;
+                }
+                bytesWritten = myWrite( fd, buf, n, &bytesWritten );
+                if ( bytesWritten != n ) {
+                    return SYS_COPY_LEN_ERR - errno;
+                }
+                toMove -= n;
+            }
+            break;
+        }
+        return SYS_COPY_LEN_ERR - errno;
+    }
+    return bytesIn;
+}
+#endif
+
 
 
 int
@@ -171,6 +389,7 @@ putFileToPortal( rcComm_t *conn, portalOprOut_t *portalOprOut,
                      portalOprOut->numThreads );
     memset( tid, 0, sizeof( tid ) );
     memset( myInput, 0, sizeof( myInput ) );
+    clearPortalStreamStat( conn );
 
     if ( numThreads == 1 ) {
         sock = connectToRhostPortal( myPortList->hostAddr,
@@ -193,6 +412,7 @@ putFileToPortal( rcComm_t *conn, portalOprOut_t *portalOprOut,
         fillRcPortalTransferInp( conn, &myInput[0], sock, in_fd, 0 );
 
         rcPartialDataPut( &myInput[0] );
+        recordStreamStat( conn, myInput, 1 );
         if ( myInput[0].status < 0 ) {
             return myInput[0].status;
         }
@@ -252,6 +472,7 @@ putFileToPortal( rcComm_t *conn, portalOprOut_t *portalOprOut,
                 retVal = myInput[i].status;
             }
         }
+        recordStreamStat( conn, myInput, numThreads );
         if ( retVal < 0 ) {
             return retVal;
         }
@@ -337,34 +558,51 @@ rcPartialDataPut( rcPortalTransferInp_t *myInput ) {
     }
 
     // =-=-=-=-=-=-=-
-    // create an encryption context
-    int iv_size = 0;
-    irods::buffer_crypt::array_t iv;
-    irods::buffer_crypt::array_t cipher;
-    irods::buffer_crypt::array_t in_buf;
-    irods::buffer_crypt::array_t shared_secret;
-    irods::buffer_crypt crypt(
+    // create the encryption context of this stream, keyed once with
+    // the shared secret
+    irods::stream_crypt crypt(
         rods_env.rodsEncryptionKeySize,
-        rods_env.rodsEncryptionSaltSize,
-        rods_env.rodsEncryptionNumHashRounds,
         rods_env.rodsEncryptionAlgorithm );
-
-    // =-=-=-=-=-=-=-
-    // set iv size
     if ( use_encryption_flg ) {
-        iv_size = crypt.key_size();
-        shared_secret.assign(
+        irods::buffer_crypt::array_t shared_secret(
             &myInput->shared_secret[0],
-            &myInput->shared_secret[iv_size] );
+            &myInput->shared_secret[ crypt.key_size() ] );
+        irods::error ret = crypt.init( shared_secret, true );
+        if ( !ret.ok() ) {
+            irods::log( PASS( ret ) );
+            myInput->status = ret.code();
+            close( srcFd );
+            mySockClose( destFd );
+            return;
+        }
     }
 
     // =-=-=-=-=-=-=-
-    // allocate a buffer for writing
+    // the plain text is read in behind room for the iv, so it can be
+    // encrypted where it lies
+    int plain_offset = use_encryption_flg ? crypt.iv_size() : 0;
+
+    // =-=-=-=-=-=-=-
+    // without encryption the file goes to the socket with sendfile,
+    // otherwise it is read ahead of the encryption by up to
+    // irods_transfer_pipeline_depth buffers
     rodsLong_t trans_buff_sz = ( rodsLong_t )rods_env.irodsTransBufferSizeForParaTrans * 1024 * 1024;
+    rodsLong_t read_ahead_sz = trans_buff_sz * ( rods_env.irodsTransPipelineDepth > 0 ? rods_env.irodsTransPipelineDepth : 0 );
+#ifdef linux_platform
+    int zero_copy = !use_encryption_flg;
+#else
+    int zero_copy = 0;
+#endif
+
+    // =-=-=-=-=-=-=-
+    // get a buffer for writing
     rodsLong_t buf_size = 2 * trans_buff_sz * sizeof( unsigned char );
-    unsigned char* buf = ( unsigned char* )malloc( buf_size );
+    unsigned char* buf = getPortalBuf( buf_size );
     transferHeader_t myHeader;
 
+    struct timeval startTime;
+    ( void ) gettimeofday( &startTime, ( struct timezone * )0 );
+
     while ( myInput->status >= 0 ) {
         rodsLong_t toPut;
 
@@ -392,6 +630,40 @@ rcPartialDataPut( rcPortalTransferInp_t *myInput ) {
         }
 
         toPut = myHeader.length;
+#ifdef linux_platform
+        while ( zero_copy && toPut > 0 ) {
+            rodsLong_t myOffset = curOffset + myHeader.length - toPut;
+            rodsLong_t bytesSent = sendfileToPortal(
+                                       destFd,
+                                       srcFd,
+                                       myOffset,
+                                       toPut > trans_buff_sz ? trans_buff_sz : toPut );
+            if ( bytesSent == -EINVAL || bytesSent == -ENOSYS ) {
+                // =-=-=-=-=-=-=-
+                // not supported for this file, continue with read and write
+                zero_copy = 0;
+                if ( lseek( srcFd, myOffset, SEEK_SET ) < 0 ) {
+                    myInput->status = UNIX_FILE_LSEEK_ERR - errno;
+                }
+                break;
+            }
+            if ( bytesSent <= 0 ) {
+                myInput->status = SYS_COPY_LEN_ERR + ( int ) bytesSent;
+                rodsLogError( LOG_ERROR, myInput->status,
+                              "rcPartialDataPut: sendfile error, toPut %lld",
+                              toPut );
+                break;
+            }
+
+            toPut -= bytesSent;
+            myInput->zeroCopy = 1;
+            updateRestartInfo( conn, threadNum, bytesSent, "rcPartialDataPut" );
+        }
+        if ( myInput->status < 0 ) {
+            break;
+        }
+#endif
+
         while ( toPut > 0 ) {
             rodsLong_t toRead;
             int bytesRead, bytesWritten;
@@ -403,9 +675,21 @@ rcPartialDataPut( rcPortalTransferInp_t *myInput ) {
                 toRead = toPut;
             }
 
+#ifdef linux_platform
+            // =-=-=-=-=-=-=-
+            // keep the next reads of this stream in flight
+            if ( read_ahead_sz > 0 && toPut > toRead ) {
+                posix_fadvise(
+                    srcFd,
+                    curOffset + myHeader.length - toPut + toRead,
+                    toPut - toRead > read_ahead_sz ? read_ahead_sz : toPut - toRead,
+                    POSIX_FADV_WILLNEED );
+            }
+#endif
+
             bytesRead = myRead(
                             srcFd,
-                            buf,
+                            buf + plain_offset,
                             toRead,
                             &bytesRead,
                             NULL );
@@ -418,47 +702,20 @@ rcPartialDataPut( rcPortalTransferInp_t *myInput ) {
             }
 
             // =-=-=-=-=-=-=-
-            // compute an iv for this particular transmission and use
-            // it to encrypt this buffer
+            // encrypt the buffer where it lies, behind the iv of this
+            // particular transmission
             int new_size = bytesRead;
             if ( use_encryption_flg ) {
-                irods::error ret = crypt.initialization_vector( iv );
-                if ( !ret.ok() ) {
-                    ret = PASS( ret );
-                    printf( "%s", ret.result().c_str() );
-                    break;
-                }
-
-                // =-=-=-=-=-=-=-
-                // encrypt
-                in_buf.assign(
-                    &buf[0],
-                    &buf[ bytesRead ] );
-                ret = crypt.encrypt(
-                          shared_secret,
-                          iv,
-                          in_buf,
-                          cipher );
+                irods::error ret = crypt.encrypt(
+                                       buf,
+                                       bytesRead,
+                                       new_size );
                 if ( !ret.ok() ) {
-                    ret = PASS( ret );
-                    printf( "%s", ret.result().c_str() );
+                    irods::log( PASS( ret ) );
+                    myInput->status = ret.code();
                     break;
                 }
 
-                // =-=-=-=-=-=-=-
-                // capture the iv with the cipher text
-                memset( buf, 0,  buf_size );
-                std::copy(
-                    iv.begin(),
-                    iv.end(),
-                    &buf[0] );
-                std::copy(
-                    cipher.begin(),
-                    cipher.end(),
-                    &buf[iv_size] );
-
-                new_size = iv_size + cipher.size();
-
                 // =-=-=-=-=-=-=-
                 // need to send the incoming size as encryption might change
                 // the size of the data from the writen values
@@ -487,23 +744,7 @@ rcPartialDataPut( rcPortalTransferInp_t *myInput ) {
             }
 
             toPut -= bytesRead;
-            if ( info->numSeg > 0 ) {   /* file restart */
-                info->dataSeg[threadNum].len += bytesRead;
-                conn->fileRestart.writtenSinceUpdated += bytesRead;
-                if ( threadNum == 0 && conn->fileRestart.writtenSinceUpdated >=
-                        RESTART_FILE_UPDATE_SIZE ) {
-                    int status;
-                    /* time to write to the restart file */
-                    status = writeLfRestartFile( conn->fileRestart.infoFile,
-                                                 &conn->fileRestart.info );
-                    if ( status < 0 ) {
-                        rodsLog( LOG_ERROR,
-                                 "rcPartialDataPut: writeLfRestartFile for %s, status = %d",
-                                 conn->fileRestart.info.fileName, status );
-                    }
-                    conn->fileRestart.writtenSinceUpdated = 0;
-                }
-            }
+            updateRestartInfo( conn, threadNum, bytesRead, "rcPartialDataPut" );
 
         } // while
 
@@ -520,8 +761,9 @@ rcPartialDataPut( rcPortalTransferInp_t *myInput ) {
         }
     }
 
+    myInput->timeInSec = elapsedSec( &startTime );
 
-    free( buf );
+    putPortalBuf( buf, buf_size );
     close( srcFd );
     mySockClose( destFd );
 }
@@ -863,6 +1105,7 @@ getFileFromPortal( rcComm_t *conn, portalOprOut_t *portalOprOut,
 
     memset( tid, 0, sizeof( tid ) );
     memset( myInput, 0, sizeof( myInput ) );
+    clearPortalStreamStat( conn );
 
     initFileRestart( conn, locFilePath, objPath, dataSize,
                      portalOprOut->numThreads );
@@ -886,6 +1129,7 @@ getFileFromPortal( rcComm_t *conn, portalOprOut_t *portalOprOut,
         }
         fillRcPortalTransferInp( conn, &myInput[0], out_fd, sock, 0640 );
         rcPartialDataGet( &myInput[0] );
+        recordStreamStat( conn, myInput, 1 );
         if ( myInput[0].status < 0 ) {
             return myInput[0].status;
         }
@@ -952,6 +1196,7 @@ getFileFromPortal( rcComm_t *conn, portalOprOut_t *portalOprOut,
                 retVal = myInput[i].status;
             }
         }
+        recordStreamStat( conn, myInput, numThreads );
         if ( retVal < 0 ) {
             return retVal;
         }
@@ -1023,31 +1268,48 @@ rcPartialDataGet( rcPortalTransferInp_t *myInput ) {
     }
 
     // =-=-=-=-=-=-=-
-    // create an encryption context
-    int iv_size = 0;
-    irods::buffer_crypt::array_t iv;
-    irods::buffer_crypt::array_t this_iv;
-    irods::buffer_crypt::array_t cipher;
-    irods::buffer_crypt::array_t plain;
-    irods::buffer_crypt::array_t shared_secret;
-    irods::buffer_crypt crypt(
+    // create the decryption context of this stream, keyed once with
+    // the shared secret
+    irods::stream_crypt crypt(
         rods_env.rodsEncryptionKeySize,
-        rods_env.rodsEncryptionSaltSize,
-        rods_env.rodsEncryptionNumHashRounds,
         rods_env.rodsEncryptionAlgorithm );
-
-    // =-=-=-=-=-=-=-
-    // set iv size
     if ( use_encryption_flg ) {
-        iv_size = crypt.key_size();
-        shared_secret.assign(
+        irods::buffer_crypt::array_t shared_secret(
             &myInput->shared_secret[0],
-            &myInput->shared_secret[iv_size] );
+            &myInput->shared_secret[ crypt.key_size() ] );
+        irods::error ret = crypt.init( shared_secret, false );
+        if ( !ret.ok() ) {
+            irods::log( PASS( ret ) );
+            myInput->status = ret.code();
+            close( destFd );
+            CLOSE_SOCK( srcFd );
+            return;
+        }
     }
 
     rodsLong_t trans_buff_sz = ( rodsLong_t )rods_env.irodsTransBufferSizeForParaTrans * 1024 * 1024;
     rodsLong_t buf_size = ( 2 * trans_buff_sz ) * sizeof( unsigned char );
-    buf = ( unsigned char* )malloc( buf_size );
+    buf = getPortalBuf( buf_size );
+
+    // =-=-=-=-=-=-=-
+    // without encryption the data is spliced from the socket into the
+    // file through a pipe holding up to irods_transfer_pipeline_depth
+    // buffers, otherwise it is read and decrypted in user space
+    int zero_copy = 0;
+#ifdef linux_platform
+    int pipe_fd[2] = { -1, -1 };
+    if ( !use_encryption_flg && pipe( pipe_fd ) == 0 ) {
+        zero_copy = 1;
+        if ( rods_env.irodsTransPipelineDepth > 0 ) {
+            /* best effort, unprivileged users are capped by pipe-max-size */
+            fcntl( pipe_fd[1], F_SETPIPE_SZ,
+                   ( int )( trans_buff_sz * rods_env.irodsTransPipelineDepth ) );
+        }
+    }
+#endif
+
+    struct timeval startTime;
+    ( void ) gettimeofday( &startTime, ( struct timezone * )0 );
 
     while ( myInput->status >= 0 ) {
 
@@ -1075,6 +1337,41 @@ rcPartialDataGet( rcPortalTransferInp_t *myInput ) {
         }
 
         rodsLong_t toGet = myHeader.length;
+#ifdef linux_platform
+        while ( zero_copy && toGet > 0 ) {
+            int unsupported = 0;
+            rodsLong_t bytesMoved = spliceFromPortal(
+                                        srcFd,
+                                        destFd,
+                                        pipe_fd,
+                                        toGet,
+                                        buf,
+                                        buf_size,
+                                        &unsupported );
+            if ( bytesMoved < 0 ) {
+                myInput->status = bytesMoved;
+                rodsLogError( LOG_ERROR, myInput->status,
+                              "rcPartialDataGet: splice error, toGet %lld",
+                              toGet );
+                break;
+            }
+            if ( unsupported ) {
+                // =-=-=-=-=-=-=-
+                // continue with read and write
+                zero_copy = 0;
+            }
+            else {
+                myInput->zeroCopy = 1;
+            }
+
+            toGet -= bytesMoved;
+            updateRestartInfo( conn, threadNum, bytesMoved, "rcPartialDataGet" );
+        }
+        if ( myInput->status < 0 ) {
+            break;
+        }
+#endif
+
         while ( toGet > 0 ) {
             int toRead, bytesRead, bytesWritten;
 
@@ -1121,39 +1418,26 @@ rcPartialDataGet( rcPortalTransferInp_t *myInput ) {
             }
 
             // =-=-=-=-=-=-=-
-            // if using encryption, strip off the iv
-            // and decrypt before writing
+            // if using encryption, decrypt in place, leaving the
+            // plain text after the iv
             int plain_size = bytesRead;
+            unsigned char* plain_buf = buf;
             if ( use_encryption_flg ) {
-                this_iv.assign(
-                    &buf[ 0 ],
-                    &buf[ iv_size ] );
-                cipher.assign(
-                    &buf[ iv_size ],
-                    &buf[ new_size ] );
                 irods::error ret = crypt.decrypt(
-                                       shared_secret,
-                                       this_iv,
-                                       cipher,
-                                       plain );
+                                       buf,
+                                       new_size,
+                                       plain_size );
                 if ( !ret.ok() ) {
                     irods::log( PASS( ret ) );
                     myInput->status = SYS_COPY_LEN_ERR;
                     break;
                 }
-
-                memset( buf, 0, buf_size );
-                std::copy(
-                    plain.begin(),
-                    plain.end(),
-                    &buf[0] );
-                plain_size = plain.size();
-
+                plain_buf = buf + crypt.iv_size();
             }
 
             bytesWritten = myWrite(
                                destFd,
-                               buf,
+                               plain_buf,
                                plain_size,
                                &bytesWritten );
             if ( bytesWritten != plain_size ) {
@@ -1165,24 +1449,7 @@ rcPartialDataGet( rcPortalTransferInp_t *myInput ) {
             }
 
             toGet -= bytesWritten;
-
-            if ( info->numSeg > 0 ) {   /* file restart */
-                info->dataSeg[threadNum].len += bytesWritten;
-                conn->fileRestart.writtenSinceUpdated += bytesWritten;
-                if ( threadNum == 0 && conn->fileRestart.writtenSinceUpdated >=
-                        RESTART_FILE_UPDATE_SIZE ) {
-                    int status;
-                    /* time to write to the restart file */
-                    status = writeLfRestartFile( conn->fileRestart.infoFile,
-                                                 &conn->fileRestart.info );
-                    if ( status < 0 ) {
-                        rodsLog( LOG_ERROR,
-                                 "rcPartialDataGet: writeLfRestartFile for %s, status = %d",
-                                 conn->fileRestart.info.fileName, status );
-                    }
-                    conn->fileRestart.writtenSinceUpdated = 0;
-                }
-            }
+            updateRestartInfo( conn, threadNum, bytesWritten, "rcPartialDataGet" );
         }
         curOffset += myHeader.length;
         myInput->bytesWritten += myHeader.length;
@@ -1197,7 +1464,15 @@ rcPartialDataGet( rcPortalTransferInp_t *myInput ) {
         }
     }
 
-    free( buf );
+    myInput->timeInSec = elapsedSec( &startTime );
+
+#ifdef linux_platform
+    if ( pipe_fd[0] >= 0 ) {
+        close( pipe_fd[0] );
+        close( pipe_fd[1] );
+    }
+#endif
+    putPortalBuf( buf, buf_size );
     close( destFd );
     CLOSE_SOCK( srcFd );
 }
@@ -2,6 +2,14 @@
  */
 #include "region.h"
 #include <string.h>
+
+/* running total of region_alloc, read by the rule engine profiler */
+static size_t allocatedBytes = 0;
+
+size_t region_allocated_bytes() {
+    return allocatedBytes;
+}
+
 #ifdef REGION_MALLOC
 
 Region *make_region( size_t is, jmp_buf *label ) {
@@ -37,6 +45,7 @@ void *region_alloc( Region *r, size_t size ) {
     ( ( RegionDesc * )mem )->region = r;
     ( ( RegionDesc * )mem )->size = allocSize;
     ( ( RegionDesc * )mem )->del = 0;
+    allocatedBytes += allocSize;
     return mem + CACHE_SIZE( RegionDesc, 1 );
 }
 void region_free( Region *r ) {
@@ -140,6 +149,7 @@ void *region_alloc( Region *r, size_t size ) {
     ( ( RegionDesc * )mem )->region = r;
     ( ( RegionDesc * )mem )->size = allocSize;
     ( ( RegionDesc * )mem )->del = 0;
+    allocatedBytes += allocSize;
     return mem + CACHE_SIZE( RegionDesc, 1 );
 }
 void region_free( Region *r ) {
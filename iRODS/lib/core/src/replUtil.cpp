@@ -252,6 +252,39 @@ initCondForRepl( rodsEnv *myRodsEnv, rodsArguments_t *rodsArgs,
     return 0;
 }
 
+int
+replCollParallel( rcComm_t *conn, char *srcColl, rodsArguments_t *rodsArgs,
+                  dataObjInp_t *dataObjInp ) {
+    int status;
+    collInp_t collInp;
+    char workersStr[NAME_LEN];
+
+    bzero( &collInp, sizeof( collInp ) );
+    rstrcpy( collInp.collName, srcColl, MAX_NAME_LEN );
+    replKeyVal( &dataObjInp->condInput, &collInp.condInput );
+    rmKeyVal( &collInp.condInput, TRANSLATED_PATH_KW );
+    snprintf( workersStr, NAME_LEN, "%d", rodsArgs->transfersValue );
+    addKeyVal( &collInp.condInput, REPL_WORKERS_KW, workersStr );
+
+    if ( rodsArgs->verbose == True ) {
+        fprintf( stdout, "C- %s:\n", srcColl );
+    }
+
+    status = rcCollRepl( conn, &collInp, rodsArgs->verbose == True );
+    clearKeyVal( &collInp.condInput );
+
+    if ( status == SYS_COPY_ALREADY_IN_RESC || status == CAT_NO_ROWS_FOUND ) {
+        status = 0;
+    }
+    if ( status < 0 ) {
+        rodsLogError( LOG_ERROR, status,
+                      "replCollParallel: rcCollRepl failed for %s. status = %d",
+                      srcColl, status );
+    }
+
+    return status;
+}
+
 int
 replCollUtil( rcComm_t *conn, char *srcColl, rodsEnv *myRodsEnv,
               rodsArguments_t *rodsArgs, dataObjInp_t *dataObjInp,
@@ -275,6 +308,13 @@ replCollUtil( rcComm_t *conn, char *srcColl, rodsEnv *myRodsEnv,
         return USER_INPUT_OPTION_ERR;
     }
 
+    /* several objects at once are replicated by the server, which
+     * walks the whole collection itself.  a restart needs the walk here */
+    if ( rodsArgs->transfers == True && rodsArgs->transfersValue > 1 &&
+            rodsRestart->fd <= 0 ) {
+        return replCollParallel( conn, srcColl, rodsArgs, dataObjInp );
+    }
+
     if ( rodsArgs->verbose == True ) {
         fprintf( stdout, "C- %s:\n", srcColl );
     }
@@ -7,6 +7,7 @@
 #include "rodsErrorTable.h"
 #include "rodsLog.h"
 #include "rsyncUtil.h"
+#include "putUtil.h"
 #include "miscUtil.h"
 #include "checksum.hpp"
 #include "rcGlobalExtern.h"
@@ -18,6 +19,35 @@ using namespace boost::filesystem;
 
 #include "irods_log.hpp"
 
+#include <map>
+#include <string>
+#include <fstream>
+
+/* a local file as recorded in the --manifest file */
+typedef struct {
+    rodsLong_t inode;
+    rodsLong_t size;
+    rodsLong_t mtime;
+    std::string chksum;
+    bool seen;
+} rsyncManifestEnt_t;
+
+/* a data object as listed by rsyncListColl */
+typedef struct {
+    rodsLong_t size;
+    std::string chksum;
+    int replStatus;
+} rsyncRemoteEnt_t;
+
+/* state shared by the directories of one local to iRODS sync */
+typedef struct {
+    std::map< std::string, rsyncManifestEnt_t > manifest;
+    int manifestChanged;
+    char hashScheme[NAME_LEN];
+    int bulkFlag;
+    bulkOprInp_t bulkOprInp;
+    bulkOprInfo_t bulkOprInfo;
+} rsyncDirToCollState_t;
 
 static int CurrentTime = 0;
 int
@@ -676,10 +706,12 @@ rsyncCollToDirUtil( rcComm_t *conn, rodsPath_t *srcPath,
     }
 }
 
-int
-rsyncDirToCollUtil( rcComm_t *conn, rodsPath_t *srcPath,
-                    rodsPath_t *targPath, rodsEnv *myRodsEnv, rodsArguments_t *rodsArgs,
-                    dataObjInp_t *dataObjOprInp ) {
+/* rsyncDirToSpecCollUtil - sync a local directory to a special collection,
+ * whose objects are not in the catalog, by stat'ing each target object. */
+static int
+rsyncDirToSpecCollUtil( rcComm_t *conn, rodsPath_t *srcPath,
+                        rodsPath_t *targPath, rodsEnv *myRodsEnv, rodsArguments_t *rodsArgs,
+                        dataObjInp_t *dataObjOprInp ) {
     char *srcDir, *targColl;
     rodsPath_t mySrcPath, myTargPath;
 
@@ -790,8 +822,8 @@ rsyncDirToCollUtil( rcComm_t *conn, rodsPath_t *srcPath,
                 mySrcPath.objType = LOCAL_DIR_T;
                 mySrcPath.objState = myTargPath.objState = EXIST_ST;
                 getRodsObjType( conn, &myTargPath );
-                status = rsyncDirToCollUtil( conn, &mySrcPath, &myTargPath,
-                                             myRodsEnv, rodsArgs, dataObjOprInp );
+                status = rsyncDirToSpecCollUtil( conn, &mySrcPath, &myTargPath,
+                                                 myRodsEnv, rodsArgs, dataObjOprInp );
                 /* fix a big mem leak */
                 if ( myTargPath.rodsObjStat != NULL ) {
                     freeRodsObjStat( myTargPath.rodsObjStat );
@@ -820,6 +852,527 @@ rsyncDirToCollUtil( rcComm_t *conn, rodsPath_t *srcPath,
 
 }
 
+/* rsyncListColl - list the data objects and subcollections of collName
+ * with paged GenQuery, one round trip per MAX_SQL_ROWS rows rather than
+ * an rcObjStat per object. A data object with several replicas is
+ * described by a good replica with a checksum where there is one.
+ * Subcollections map to their collection type, empty unless special. */
+static int
+rsyncListColl( rcComm_t *conn, char *collName,
+               std::map< std::string, rsyncRemoteEnt_t >& dataObjs,
+               std::map< std::string, std::string >& subColls ) {
+    genQueryInp_t genQueryInp;
+    genQueryOut_t *genQueryOut = NULL;
+    char condStr[MAX_NAME_LEN];
+    int status;
+
+    memset( &genQueryInp, 0, sizeof( genQueryInp ) );
+    snprintf( condStr, MAX_NAME_LEN, "='%s'", collName );
+    addInxVal( &genQueryInp.sqlCondInp, COL_COLL_NAME, condStr );
+    addInxIval( &genQueryInp.selectInp, COL_DATA_NAME, 1 );
+    addInxIval( &genQueryInp.selectInp, COL_DATA_SIZE, 1 );
+    addInxIval( &genQueryInp.selectInp, COL_D_DATA_CHECKSUM, 1 );
+    addInxIval( &genQueryInp.selectInp, COL_D_REPL_STATUS, 1 );
+    genQueryInp.maxRows = MAX_SQL_ROWS;
+
+    status = rcGenQuery( conn, &genQueryInp, &genQueryOut );
+    while ( status >= 0 ) {
+        sqlResult_t *dataName = getSqlResultByInx( genQueryOut, COL_DATA_NAME );
+        sqlResult_t *dataSize = getSqlResultByInx( genQueryOut, COL_DATA_SIZE );
+        sqlResult_t *chksum = getSqlResultByInx( genQueryOut, COL_D_DATA_CHECKSUM );
+        sqlResult_t *replStatus = getSqlResultByInx( genQueryOut, COL_D_REPL_STATUS );
+        if ( dataName == NULL || dataSize == NULL || chksum == NULL ||
+                replStatus == NULL ) {
+            freeGenQueryOut( &genQueryOut );
+            clearGenQueryInp( &genQueryInp );
+            return UNMATCHED_KEY_OR_INDEX;
+        }
+
+        for ( int i = 0; i < genQueryOut->rowCnt; i++ ) {
+            rsyncRemoteEnt_t ent;
+            ent.size = strtoll( &dataSize->value[dataSize->len * i], 0, 0 );
+            ent.chksum = &chksum->value[chksum->len * i];
+            ent.replStatus = atoi( &replStatus->value[replStatus->len * i] );
+
+            std::string name( &dataName->value[dataName->len * i] );
+            std::map< std::string, rsyncRemoteEnt_t >::iterator itr =
+                dataObjs.find( name );
+            if ( itr == dataObjs.end() ) {
+                dataObjs[name] = ent;
+            }
+            else if ( ( ent.replStatus > 0 ) > ( itr->second.replStatus > 0 ) ||
+                      ( ( ent.replStatus > 0 ) == ( itr->second.replStatus > 0 ) &&
+                        itr->second.chksum.empty() && !ent.chksum.empty() ) ) {
+                itr->second = ent;
+            }
+        }
+
+        genQueryInp.continueInx = genQueryOut->continueInx;
+        freeGenQueryOut( &genQueryOut );
+        if ( genQueryInp.continueInx <= 0 ) {
+            break;
+        }
+        status = rcGenQuery( conn, &genQueryInp, &genQueryOut );
+    }
+    clearGenQueryInp( &genQueryInp );
+    if ( status < 0 && status != CAT_NO_ROWS_FOUND ) {
+        return status;
+    }
+
+    memset( &genQueryInp, 0, sizeof( genQueryInp ) );
+    addInxVal( &genQueryInp.sqlCondInp, COL_COLL_PARENT_NAME, condStr );
+    addInxIval( &genQueryInp.selectInp, COL_COLL_NAME, 1 );
+    addInxIval( &genQueryInp.selectInp, COL_COLL_TYPE, 1 );
+    genQueryInp.maxRows = MAX_SQL_ROWS;
+
+    status = rcGenQuery( conn, &genQueryInp, &genQueryOut );
+    while ( status >= 0 ) {
+        sqlResult_t *collNames = getSqlResultByInx( genQueryOut, COL_COLL_NAME );
+        sqlResult_t *collType = getSqlResultByInx( genQueryOut, COL_COLL_TYPE );
+        if ( collNames == NULL || collType == NULL ) {
+            freeGenQueryOut( &genQueryOut );
+            clearGenQueryInp( &genQueryInp );
+            return UNMATCHED_KEY_OR_INDEX;
+        }
+
+        for ( int i = 0; i < genQueryOut->rowCnt; i++ ) {
+            char *subColl = &collNames->value[collNames->len * i];
+            char *childName = strrchr( subColl, '/' );
+            subColls[childName == NULL ? subColl : childName + 1] =
+                &collType->value[collType->len * i];
+        }
+
+        genQueryInp.continueInx = genQueryOut->continueInx;
+        freeGenQueryOut( &genQueryOut );
+        if ( genQueryInp.continueInx <= 0 ) {
+            break;
+        }
+        status = rcGenQuery( conn, &genQueryInp, &genQueryOut );
+    }
+    clearGenQueryInp( &genQueryInp );
+    if ( status < 0 && status != CAT_NO_ROWS_FOUND ) {
+        return status;
+    }
+
+    return 0;
+}
+
+/* readRsyncManifest - load the --manifest file, one line per local file:
+ * inode size mtime checksum path. A missing file is an empty manifest. */
+static int
+readRsyncManifest( char *manifestFile,
+                   std::map< std::string, rsyncManifestEnt_t >& manifest ) {
+    std::ifstream in( manifestFile );
+    if ( !in.is_open() ) {
+        return 0;
+    }
+
+    std::string line;
+    while ( std::getline( in, line ) ) {
+        std::istringstream fields( line );
+        rsyncManifestEnt_t ent;
+        std::string filePath;
+        if ( !( fields >> ent.inode >> ent.size >> ent.mtime >> ent.chksum ) ) {
+            continue;
+        }
+        fields.get();
+        std::getline( fields, filePath );
+        if ( filePath.empty() ) {
+            continue;
+        }
+        ent.seen = false;
+        manifest[filePath] = ent;
+    }
+
+    return 0;
+}
+
+/* writeRsyncManifest - write the manifest back through a temporary file.
+ * Entries not looked at in this run are kept while their file exists. */
+static int
+writeRsyncManifest( char *manifestFile,
+                    std::map< std::string, rsyncManifestEnt_t >& manifest ) {
+    std::string tmpFile = std::string( manifestFile ) + ".tmp";
+    std::ofstream out( tmpFile.c_str() );
+    if ( !out.is_open() ) {
+        rodsLog( LOG_ERROR,
+                 "writeRsyncManifest: cannot open %s, errno = %d",
+                 tmpFile.c_str(), errno );
+        return USER_INPUT_PATH_ERR - errno;
+    }
+
+    std::map< std::string, rsyncManifestEnt_t >::iterator itr;
+    for ( itr = manifest.begin(); itr != manifest.end(); ++itr ) {
+        struct stat statbuf;
+        if ( !itr->second.seen && stat( itr->first.c_str(), &statbuf ) < 0 ) {
+            continue;
+        }
+        out << itr->second.inode << " " << itr->second.size << " "
+            << itr->second.mtime << " " << itr->second.chksum << " "
+            << itr->first << "\n";
+    }
+    out.close();
+
+    if ( out.fail() || rename( tmpFile.c_str(), manifestFile ) < 0 ) {
+        rodsLog( LOG_ERROR,
+                 "writeRsyncManifest: cannot write %s, errno = %d",
+                 manifestFile, errno );
+        unlink( tmpFile.c_str() );
+        return USER_INPUT_PATH_ERR - errno;
+    }
+
+    return 0;
+}
+
+/* sameChksumScheme - true if both checksums carry the same scheme prefix,
+ * e.g. "sha2:", or neither does */
+static bool
+sameChksumScheme( const std::string& chksum1, const std::string& chksum2 ) {
+    std::string::size_type pos1 = chksum1.find( ':' );
+    std::string::size_type pos2 = chksum2.find( ':' );
+    if ( pos1 == std::string::npos || pos2 == std::string::npos ) {
+        return pos1 == pos2;
+    }
+    return chksum1.compare( 0, pos1, chksum2, 0, pos2 ) == 0;
+}
+
+/* rsyncLocalChksum - the checksum of a local file, taken from the manifest
+ * while the file's inode, size and mtime match the recorded ones */
+static int
+rsyncLocalChksum( char *filePath, struct stat *statbuf,
+                  const std::string& remoteChksum, rodsArguments_t *rodsArgs,
+                  rsyncDirToCollState_t *state, char *chksumStr ) {
+    std::string key;
+    if ( rodsArgs->manifest == True ) {
+        key = system_complete( path( filePath ) ).string();
+        std::map< std::string, rsyncManifestEnt_t >::iterator itr =
+            state->manifest.find( key );
+        if ( itr != state->manifest.end() ) {
+            itr->second.seen = true;
+            if ( itr->second.inode == ( rodsLong_t )statbuf->st_ino &&
+                    itr->second.size == ( rodsLong_t )statbuf->st_size &&
+                    itr->second.mtime == ( rodsLong_t )statbuf->st_mtime &&
+                    sameChksumScheme( itr->second.chksum, remoteChksum ) ) {
+                rstrcpy( chksumStr, itr->second.chksum.c_str(), NAME_LEN );
+                return 0;
+            }
+        }
+    }
+
+    int status = chksumLocFile( filePath, chksumStr, state->hashScheme );
+    if ( status < 0 ) {
+        rodsLogError( LOG_ERROR, status,
+                      "rsyncLocalChksum: chksumLocFile error for %s", filePath );
+        return status;
+    }
+
+    if ( rodsArgs->manifest == True ) {
+        rsyncManifestEnt_t& ent = state->manifest[key];
+        ent.inode = statbuf->st_ino;
+        ent.size = statbuf->st_size;
+        ent.mtime = statbuf->st_mtime;
+        ent.chksum = chksumStr;
+        ent.seen = true;
+        state->manifestChanged = 1;
+    }
+
+    return 0;
+}
+
+/* rsyncDirToCollBulkUtil - sync a local directory to a collection whose
+ * state is listed once per collection and compared locally. Only new and
+ * changed files are sent; with -b those up to MAX_BULK_OPR_FILE_SIZE are
+ * batched through the bulk put. Objects without a registered checksum
+ * still go through rcDataObjRsync one at a time. */
+static int
+rsyncDirToCollBulkUtil( rcComm_t *conn, rodsPath_t *srcPath,
+                        rodsPath_t *targPath, rodsEnv *myRodsEnv, rodsArguments_t *rodsArgs,
+                        dataObjInp_t *dataObjOprInp, rsyncDirToCollState_t *state ) {
+    char *srcDir, *targColl;
+    rodsPath_t mySrcPath, myTargPath;
+    std::map< std::string, rsyncRemoteEnt_t > dataObjs;
+    std::map< std::string, std::string > subColls;
+
+    srcDir = srcPath->outPath;
+    targColl = targPath->outPath;
+
+    if ( isPathSymlink( rodsArgs, srcDir ) > 0 ) {
+        return 0;
+    }
+
+    if ( rodsArgs->recursive != True ) {
+        rodsLog( LOG_ERROR,
+                 "rsyncDirToCollUtil: -r option must be used for putting %s directory",
+                 srcDir );
+        return USER_INPUT_OPTION_ERR;
+    }
+
+    path srcDirPath( srcDir );
+    if ( !exists( srcDirPath ) || !is_directory( srcDirPath ) ) {
+        rodsLog( LOG_ERROR,
+                 "rsyncDirToCollUtil: opendir local dir error for %s, errno = %d\n",
+                 srcDir, errno );
+        return USER_INPUT_PATH_ERR;
+    }
+
+    int status = rsyncListColl( conn, targColl, dataObjs, subColls );
+    if ( status < 0 ) {
+        rodsLogError( LOG_ERROR, status,
+                      "rsyncDirToCollUtil: cannot list %s, comparing per object",
+                      targColl );
+        return rsyncDirToSpecCollUtil( conn, srcPath, targPath, myRodsEnv,
+                                       rodsArgs, dataObjOprInp );
+    }
+
+    if ( rodsArgs->verbose == True ) {
+        fprintf( stdout, "C- %s:\n", targColl );
+    }
+
+    memset( &mySrcPath,  0, sizeof( mySrcPath ) );
+    memset( &myTargPath, 0, sizeof( myTargPath ) );
+
+    directory_iterator end_itr; // default construction yields past-the-end
+    int savedStatus = 0;
+    for ( directory_iterator itr( srcDirPath );
+            itr != end_itr;
+            ++itr ) {
+        path p = itr->path();
+        snprintf( mySrcPath.outPath, MAX_NAME_LEN, "%s", p.c_str() );
+
+        if ( isPathSymlink( rodsArgs, mySrcPath.outPath ) > 0 ) {
+            continue;
+        }
+
+        if ( !exists( p ) ) {
+            rodsLog( LOG_ERROR,
+                     "rsyncDirToCollUtil: stat error for %s, errno = %d\n",
+                     mySrcPath.outPath, errno );
+            return USER_INPUT_PATH_ERR;
+        }
+
+        if ( ( is_regular_file( p ) && rodsArgs->age == True ) &&
+                ageExceeded(
+                    rodsArgs->agevalue,
+                    last_write_time( p ),
+                    mySrcPath.outPath,
+                    file_size( p ) ) ) {
+            continue;
+        }
+
+        bzero( &myTargPath, sizeof( myTargPath ) );
+        path childPath = p.filename();
+        std::string childName = childPath.string();
+        snprintf( myTargPath.outPath, MAX_NAME_LEN, "%s/%s",
+                  targColl, childName.c_str() );
+        if ( is_symlink( p ) ) {
+            path cp = read_symlink( p );
+            snprintf( mySrcPath.outPath, MAX_NAME_LEN, "%s/%s",
+                      srcDir, cp.c_str() );
+            p = path( mySrcPath.outPath );
+        }
+        dataObjOprInp->createMode = getPathStMode( p.c_str() );
+        status = 0;
+        if ( is_regular_file( p ) ) {
+            struct stat statbuf;
+            if ( stat( mySrcPath.outPath, &statbuf ) < 0 ) {
+                rodsLog( LOG_ERROR,
+                         "rsyncDirToCollUtil: stat error for %s, errno = %d\n",
+                         mySrcPath.outPath, errno );
+                return USER_INPUT_PATH_ERR;
+            }
+            myTargPath.objType = DATA_OBJ_T;
+            mySrcPath.objType = LOCAL_FILE_T;
+            mySrcPath.objState = EXIST_ST;
+            mySrcPath.size = statbuf.st_size;
+
+            char chksumStr[NAME_LEN];
+            chksumStr[0] = '\0';
+            int putFlag = 0;
+            int syncFlag = 0;
+            std::map< std::string, rsyncRemoteEnt_t >::iterator obj =
+                dataObjs.find( childName );
+            if ( obj == dataObjs.end() ) {
+                putFlag = 1;
+            }
+            else if ( rodsArgs->sizeFlag == True ) {
+                putFlag = obj->second.size != mySrcPath.size;
+            }
+            else if ( !obj->second.chksum.empty() ) {
+                status = rsyncLocalChksum( mySrcPath.outPath, &statbuf,
+                                           obj->second.chksum, rodsArgs, state, chksumStr );
+                if ( status >= 0 ) {
+                    putFlag = obj->second.chksum != chksumStr;
+                }
+            }
+            else {
+                /* exist but no chksum, let the server compare */
+                syncFlag = 1;
+                myTargPath.objState = EXIST_ST;
+                myTargPath.size = obj->second.size;
+                status = rsyncFileToDataUtil( conn, &mySrcPath, &myTargPath,
+                                              rodsArgs, dataObjOprInp );
+            }
+
+            if ( status < 0 ) {
+                /* reported below */
+            }
+            else if ( putFlag && state->bulkFlag &&
+                      mySrcPath.size <= MAX_BULK_OPR_FILE_SIZE ) {
+                status = bulkPutFileUtil( conn, mySrcPath.outPath,
+                                          myTargPath.outPath, mySrcPath.size,
+                                          dataObjOprInp->createMode, rodsArgs,
+                                          &state->bulkOprInp, &state->bulkOprInfo );
+            }
+            else if ( putFlag ) {
+                myTargPath.objState = NOT_EXIST_ST;
+                if ( strlen( chksumStr ) > 0 && rodsArgs->verifyChecksum == True ) {
+                    addKeyVal( &dataObjOprInp->condInput, VERIFY_CHKSUM_KW,
+                               chksumStr );
+                }
+                status = rsyncFileToDataUtil( conn, &mySrcPath, &myTargPath,
+                                              rodsArgs, dataObjOprInp );
+                rmKeyVal( &dataObjOprInp->condInput, VERIFY_CHKSUM_KW );
+            }
+            else if ( !syncFlag && rodsArgs->verbose == True ) {
+                printNoSync( mySrcPath.outPath, mySrcPath.size, "a match" );
+            }
+        }
+        else if ( is_directory( p ) ) {
+            std::map< std::string, std::string >::iterator coll =
+                subColls.find( childName );
+            myTargPath.objType = COLL_OBJ_T;
+            mySrcPath.objType = LOCAL_DIR_T;
+            mySrcPath.objState = myTargPath.objState = EXIST_ST;
+            if ( coll != subColls.end() && !coll->second.empty() ) {
+                /* a mounted or linked collection, its objects are not
+                 * in the catalog */
+                getRodsObjType( conn, &myTargPath );
+                status = rsyncDirToSpecCollUtil( conn, &mySrcPath, &myTargPath,
+                                                 myRodsEnv, rodsArgs, dataObjOprInp );
+                if ( myTargPath.rodsObjStat != NULL ) {
+                    freeRodsObjStat( myTargPath.rodsObjStat );
+                    myTargPath.rodsObjStat = NULL;
+                }
+            }
+            else {
+                /* only do the sync if no -l option specified */
+                if ( coll == subColls.end() && rodsArgs->longOption != True ) {
+                    status = mkColl( conn, myTargPath.outPath );
+                }
+                if ( status < 0 ) {
+                    rodsLogError( LOG_ERROR, status,
+                                  "rsyncDirToCollUtil: mkColl error for %s",
+                                  myTargPath.outPath );
+                }
+                else {
+                    status = rsyncDirToCollBulkUtil( conn, &mySrcPath, &myTargPath,
+                                                     myRodsEnv, rodsArgs, dataObjOprInp, state );
+                }
+            }
+        }
+        else {
+            rodsLog( LOG_ERROR,
+                     "rsyncDirToCollUtil: unknown local path %s",
+                     mySrcPath.outPath );
+            status = USER_INPUT_PATH_ERR;
+        }
+
+        if ( status < 0 &&
+                status != CAT_NO_ROWS_FOUND &&
+                status != SYS_SPEC_COLL_OBJ_NOT_EXIST ) {
+            savedStatus = status;
+            rodsLogError( LOG_ERROR, status,
+                          "rsyncDirToCollUtil: put %s failed. status = %d",
+                          mySrcPath.outPath, status );
+        }
+    }
+
+    return savedStatus;
+}
+
+int
+rsyncDirToCollUtil( rcComm_t *conn, rodsPath_t *srcPath,
+                    rodsPath_t *targPath, rodsEnv *myRodsEnv, rodsArguments_t *rodsArgs,
+                    dataObjInp_t *dataObjOprInp ) {
+    if ( srcPath == NULL || targPath == NULL ) {
+        rodsLog( LOG_ERROR,
+                 "rsyncDirToCollUtil: NULL srcPath or targPath input" );
+        return USER__NULL_INPUT_ERR;
+    }
+
+    if ( targPath->rodsObjStat != NULL &&
+            targPath->rodsObjStat->specColl != NULL ) {
+        return rsyncDirToSpecCollUtil( conn, srcPath, targPath, myRodsEnv,
+                                       rodsArgs, dataObjOprInp );
+    }
+
+    rodsEnv env;
+    int status = getRodsEnv( &env );
+    if ( status < 0 ) {
+        rodsLogError( LOG_ERROR, status,
+                      "rsyncDirToCollUtil: getRodsEnv failed" );
+        return status;
+    }
+
+    /* the bulk put buffers are too large for the stack */
+    rsyncDirToCollState_t *state = new rsyncDirToCollState_t;
+    state->manifestChanged = 0;
+    state->bulkFlag = 0;
+    rstrcpy( state->hashScheme, env.rodsDefaultHashScheme, NAME_LEN );
+    bzero( &state->bulkOprInp, sizeof( bulkOprInp_t ) );
+    bzero( &state->bulkOprInfo, sizeof( bulkOprInfo_t ) );
+
+    if ( rodsArgs->manifest == True && rodsArgs->manifestFileString != NULL ) {
+        readRsyncManifest( rodsArgs->manifestFileString, state->manifest );
+    }
+
+    if ( rodsArgs->bulk == True && rodsArgs->longOption != True ) {
+        state->bulkFlag = 1;
+        initAttriArrayOfBulkOprInp( &state->bulkOprInp );
+        rstrcpy( state->bulkOprInp.objPath, targPath->outPath, MAX_NAME_LEN );
+        addKeyVal( &state->bulkOprInp.condInput, FORCE_FLAG_KW, "" );
+        /* register the checksums so the next run can compare them */
+        addKeyVal( &state->bulkOprInp.condInput, REG_CHKSUM_KW, "" );
+        if ( rodsArgs->verifyChecksum == True ) {
+            addKeyVal( &state->bulkOprInp.condInput, VERIFY_CHKSUM_KW, "" );
+        }
+        char *rescName = getValByKey( &dataObjOprInp->condInput,
+                                      DEST_RESC_NAME_KW );
+        if ( rescName != NULL ) {
+            addKeyVal( &state->bulkOprInp.condInput, DEST_RESC_NAME_KW,
+                       rescName );
+        }
+        state->bulkOprInfo.flags = BULK_OPR_SMALL_FILES;
+        state->bulkOprInfo.bytesBuf.buf = malloc( BULK_OPR_BUF_SIZE );
+    }
+
+    int savedStatus = rsyncDirToCollBulkUtil( conn, srcPath, targPath,
+                      myRodsEnv, rodsArgs, dataObjOprInp, state );
+
+    if ( state->bulkFlag ) {
+        if ( state->bulkOprInfo.count > 0 ) {
+            status = sendBulkPut( conn, &state->bulkOprInp,
+                                  &state->bulkOprInfo, rodsArgs );
+            if ( status < 0 ) {
+                rodsLogError( LOG_ERROR, status,
+                              "rsyncDirToCollUtil: sendBulkPut error for %s",
+                              targPath->outPath );
+                savedStatus = status;
+            }
+        }
+        clearBulkOprInfo( &state->bulkOprInfo );
+        free( state->bulkOprInfo.bytesBuf.buf );
+        clearBulkOprInp( &state->bulkOprInp );
+    }
+
+    if ( state->manifestChanged ) {
+        writeRsyncManifest( rodsArgs->manifestFileString, state->manifest );
+    }
+
+    delete state;
+    return savedStatus;
+}
+
 int
 rsyncCollToCollUtil( rcComm_t *conn, rodsPath_t *srcPath,
                      rodsPath_t *targPath, rodsEnv *myRodsEnv, rodsArguments_t *rodsArgs,
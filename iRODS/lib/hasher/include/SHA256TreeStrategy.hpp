@@ -0,0 +1,38 @@
+#ifndef _SHA256_TREE_STRATEGY_HPP_
+#define _SHA256_TREE_STRATEGY_HPP_
+
+#include "HashStrategy.hpp"
+#include <string>
+
+namespace irods {
+    const std::string SHA256_TREE_NAME( "sha256tree" );
+
+    /// =-=-=-=-=-=-=-
+    /// @brief size of the blocks hashed independently by the sha256tree
+    ///        scheme.  it is part of the checksum, changing it changes
+    ///        every checksum computed with the scheme
+    const size_t SHA256_TREE_BLOCK_SIZE = 4 * 1024 * 1024;
+
+    /// =-=-=-=-=-=-=-
+    /// @brief sha256 over fixed size blocks of the data, combined into a
+    ///        merkle root.  the blocks do not depend on each other, so
+    ///        they are hashed on a pool of threads while the caller reads
+    ///        the following ones, and a large file is hashed on all of
+    ///        the cores rather than one
+    class SHA256TreeStrategy : public HashStrategy {
+        public:
+            SHA256TreeStrategy() {};
+            virtual ~SHA256TreeStrategy() {};
+
+            virtual std::string name() const {
+                return SHA256_TREE_NAME;
+            }
+            virtual error init( boost::any& context ) const;
+            virtual error update( const std::string& data, boost::any& context ) const;
+            virtual error digest( std::string& messageDigest, boost::any& context ) const;
+            virtual bool isChecksum( const std::string& ) const;
+
+    };
+}; // namespace irods
+
+#endif // _SHA256_TREE_STRATEGY_HPP_
@@ -15,6 +15,7 @@ extern "C" {
 #endif
 
 #define SHA256_CHKSUM_PREFIX "sha2:"
+#define SHA256_TREE_CHKSUM_PREFIX "sha2t:"
 int verifyChksumLocFile( char *fileName, char *myChksum, char *chksumStr );
 
 int
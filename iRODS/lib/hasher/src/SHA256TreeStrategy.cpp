@@ -0,0 +1,193 @@
+#include "SHA256TreeStrategy.hpp"
+#include "checksum.hpp"
+#include "rodsErrorTable.h"
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <string.h>
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <openssl/sha.h>
+
+#include "base64.h"
+
+namespace irods {
+
+    namespace {
+        // =-=-=-=-=-=-=-
+        // upper bound on the hashing threads, and so on the number of
+        // blocks held in memory per batch
+        const unsigned int MAX_TREE_HASH_THREADS = 8;
+
+        // =-=-=-=-=-=-=-
+        // leaves and nodes are hashed behind different first bytes, as
+        // in RFC 6962, so that no pair of digests can pass for a block
+        const unsigned char TREE_LEAF_PREFIX = 0x00;
+        const unsigned char TREE_NODE_PREFIX = 0x01;
+
+        std::string sha256_of( unsigned char _prefix, const char* _data, size_t _len ) {
+            unsigned char md[SHA256_DIGEST_LENGTH];
+            SHA256_CTX ctx;
+            SHA256_Init( &ctx );
+            SHA256_Update( &ctx, &_prefix, 1 );
+            SHA256_Update( &ctx, _data, _len );
+            SHA256_Final( md, &ctx );
+            return std::string( ( char* )md, SHA256_DIGEST_LENGTH );
+        }
+
+        // =-=-=-=-=-=-=-
+        // hash blocks [_first, _last) of _blocks into _leaves, stepping
+        // by _stride so that the threads share the batch evenly
+        void hash_blocks(
+            const std::vector< std::string >* _blocks,
+            std::vector< std::string >*       _leaves,
+            size_t                            _first,
+            size_t                            _stride ) {
+            for ( size_t i = _first; i < _blocks->size(); i += _stride ) {
+                ( *_leaves )[ i ] = sha256_of( TREE_LEAF_PREFIX, ( *_blocks )[ i ].data(), ( *_blocks )[ i ].size() );
+            }
+        }
+
+        class tree_context {
+            public:
+                tree_context() {
+                    threads_ = boost::thread::hardware_concurrency();
+                    threads_ = std::max( 1u, std::min( threads_, MAX_TREE_HASH_THREADS ) );
+                    current_.reserve( SHA256_TREE_BLOCK_SIZE );
+                }
+
+                ~tree_context() {
+                    finish_batch();
+                }
+
+                void update( const char* _data, size_t _len ) {
+                    while ( _len > 0 ) {
+                        size_t n = std::min( _len, SHA256_TREE_BLOCK_SIZE - current_.size() );
+                        current_.append( _data, n );
+                        _data += n;
+                        _len  -= n;
+                        if ( current_.size() == SHA256_TREE_BLOCK_SIZE ) {
+                            filling_.push_back( std::string() );
+                            filling_.back().swap( current_ );
+                            current_.reserve( SHA256_TREE_BLOCK_SIZE );
+                            if ( filling_.size() == threads_ ) {
+                                start_batch();
+                            }
+                        }
+                    }
+                }
+
+                std::string root() {
+                    // =-=-=-=-=-=-=-
+                    // the partial last block is a leaf too, as is the
+                    // empty block of an empty input
+                    if ( !current_.empty() || ( leaves_.empty() && filling_.empty() && hashing_.empty() ) ) {
+                        filling_.push_back( std::string() );
+                        filling_.back().swap( current_ );
+                    }
+                    if ( !filling_.empty() ) {
+                        start_batch();
+                    }
+                    finish_batch();
+
+                    std::vector< std::string > level( leaves_ );
+                    while ( level.size() > 1 ) {
+                        std::vector< std::string > next;
+                        for ( size_t i = 0; i < level.size(); i += 2 ) {
+                            if ( i + 1 < level.size() ) {
+                                std::string pair = level[ i ] + level[ i + 1 ];
+                                next.push_back( sha256_of( TREE_NODE_PREFIX, pair.data(), pair.size() ) );
+                            }
+                            else {
+                                // =-=-=-=-=-=-=-
+                                // an odd node moves up unchanged
+                                next.push_back( level[ i ] );
+                            }
+                        }
+                        level.swap( next );
+                    }
+                    return level[ 0 ];
+                }
+
+            private:
+                // =-=-=-=-=-=-=-
+                // hand the full blocks to the threads and carry on
+                // reading, waiting first on the batch before it
+                void start_batch() {
+                    finish_batch();
+                    hashing_.swap( filling_ );
+                    hashed_.assign( hashing_.size(), std::string() );
+                    size_t stride = std::min( ( size_t )threads_, hashing_.size() );
+                    for ( size_t i = 0; i < stride; ++i ) {
+                        workers_.push_back( boost::shared_ptr< boost::thread >(
+                            new boost::thread( hash_blocks, &hashing_, &hashed_, i, stride ) ) );
+                    }
+                }
+
+                void finish_batch() {
+                    for ( size_t i = 0; i < workers_.size(); ++i ) {
+                        workers_[ i ]->join();
+                    }
+                    workers_.clear();
+                    leaves_.insert( leaves_.end(), hashed_.begin(), hashed_.end() );
+                    hashing_.clear();
+                    hashed_.clear();
+                }
+
+                unsigned int               threads_;
+                std::string                current_;
+                std::vector< std::string > filling_;
+                std::vector< std::string > hashing_;
+                std::vector< std::string > hashed_;
+                std::vector< std::string > leaves_;
+                std::vector< boost::shared_ptr< boost::thread > > workers_;
+
+        }; // class tree_context
+
+        typedef boost::shared_ptr< tree_context > tree_context_ptr;
+
+    }; // namespace
+
+    error
+    SHA256TreeStrategy::init( boost::any& _context ) const {
+        _context = tree_context_ptr( new tree_context() );
+        return SUCCESS();
+    }
+
+    error
+    SHA256TreeStrategy::update( const std::string& data, boost::any& _context ) const {
+        tree_context_ptr* ctx = boost::any_cast< tree_context_ptr >( &_context );
+        if ( !ctx ) {
+            return ERROR( SYS_UNINITIALIZED, "sha256tree context is not initialized" );
+        }
+        ( *ctx )->update( data.data(), data.size() );
+        return SUCCESS();
+    }
+
+    error
+    SHA256TreeStrategy::digest( std::string& _messageDigest, boost::any& _context ) const {
+        tree_context_ptr* ctx = boost::any_cast< tree_context_ptr >( &_context );
+        if ( !ctx ) {
+            return ERROR( SYS_UNINITIALIZED, "sha256tree context is not initialized" );
+        }
+        std::string root = ( *ctx )->root();
+
+        int len = strlen( SHA256_TREE_CHKSUM_PREFIX );
+        unsigned long out_len = CHKSUM_LEN - len;
+
+        unsigned char out_buffer[CHKSUM_LEN];
+        base64_encode( ( const unsigned char* )root.data(), root.size(), out_buffer, &out_len );
+
+        _messageDigest = SHA256_TREE_CHKSUM_PREFIX;
+        _messageDigest += std::string( ( char* )out_buffer, out_len );
+
+        return SUCCESS();
+    }
+
+    bool
+    SHA256TreeStrategy::isChecksum( const std::string& _chksum ) const {
+        return boost::starts_with( _chksum, SHA256_TREE_CHKSUM_PREFIX );
+    }
+}; // namespace irods
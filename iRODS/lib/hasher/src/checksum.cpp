@@ -11,11 +11,14 @@
 #include "rcMisc.h"
 #include "checksum.hpp"
 
-#include <fstream>
-#include "irods_stacktrace.hpp"
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
 
 
-#define HASH_BUF_SZ      (4 * 1024)
+#define HASH_BUF_SZ      (4 * 1024 * 1024)
+#define HASH_BUF_ALIGN   4096
 
 int chksumLocFile(
     char*       _file_name,
@@ -127,10 +130,8 @@ int chksumLocFile(
 
     // =-=-=-=-=-=-=-
     // open the local file
-    std::ifstream in_file(
-        _file_name,
-        std::ios::in | std::ios::binary );
-    if ( !in_file.is_open() ) {
+    int fd = open( _file_name, O_RDONLY );
+    if ( fd < 0 ) {
         status = UNIX_FILE_OPEN_ERR - errno;
         rodsLogError(
             LOG_NOTICE,
@@ -141,20 +142,50 @@ int chksumLocFile(
         return status;
     }
 
-    char buffer_read[ HASH_BUF_SZ ];
-    std::streamsize bytes_read = in_file.readsome(
-                                     buffer_read,
-                                     HASH_BUF_SZ );
-    while ( bytes_read > 0 ) {
+    // =-=-=-=-=-=-=-
+    // read in large page aligned chunks, and ask the kernel for a
+    // bigger readahead window and the next chunk while this one is
+    // being hashed
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise( fd, 0, 0, POSIX_FADV_SEQUENTIAL );
+#endif
+    void* buffer_read = NULL;
+    if ( posix_memalign( &buffer_read, HASH_BUF_ALIGN, HASH_BUF_SZ ) != 0 ) {
+        close( fd );
+        return SYS_MALLOC_ERR;
+    }
+
+    off_t offset = 0;
+    ssize_t bytes_read = 0;
+    while ( ( bytes_read = read( fd, buffer_read, HASH_BUF_SZ ) ) != 0 ) {
+        if ( bytes_read < 0 ) {
+            if ( EINTR == errno ) {
+                continue;
+            }
+            status = UNIX_FILE_READ_ERR - errno;
+            rodsLogError(
+                LOG_NOTICE,
+                status,
+                "chksumLocFile - read failed for %s, status = %d",
+                _file_name,
+                status );
+            free( buffer_read );
+            close( fd );
+            return status;
+        }
+        offset += bytes_read;
+#ifdef POSIX_FADV_WILLNEED
+        posix_fadvise( fd, offset, HASH_BUF_SZ, POSIX_FADV_WILLNEED );
+#endif
         hasher.update(
             std::string(
-                buffer_read,
+                ( char* )buffer_read,
                 bytes_read ) );
-        bytes_read = in_file.readsome(
-                         buffer_read,
-                         HASH_BUF_SZ );
     }
 
+    free( buffer_read );
+    close( fd );
+
     // =-=-=-=-=-=-=-
     // capture the digest
     std::string digest;
@@ -2,6 +2,7 @@
 #include "checksum.hpp"
 #include "MD5Strategy.hpp"
 #include "SHA256Strategy.hpp"
+#include "SHA256TreeStrategy.hpp"
 #include "rodsErrorTable.h"
 #include <sstream>
 #include <boost/unordered_map.hpp>
@@ -10,12 +11,14 @@ namespace irods {
 
     namespace {
         const SHA256Strategy _sha256;
+        const SHA256TreeStrategy _sha256_tree;
         const MD5Strategy _md5;
 
         boost::unordered_map<const std::string, const HashStrategy*>
         make_map() {
             boost::unordered_map<const std::string, const HashStrategy*> map;
             map[ SHA256_NAME ] = &_sha256;
+            map[ SHA256_TREE_NAME ] = &_sha256_tree;
             map[ MD5_NAME ] = &_md5;
             return map;
         }
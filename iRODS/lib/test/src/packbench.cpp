@@ -0,0 +1,191 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+/* packbench.c - compare the packing throughput with and without the
+ * compiled pack instruction cache, and check that both produce the
+ * same bytes.
+ *
+ * usage: packbench [iterations]
+ */
+
+#include "rodsClient.h"
+#include "packStruct.h"
+#include <sys/time.h>
+
+#define DEF_BENCH_ITERATIONS    2000
+#define BENCH_QUERY_ROWS        256
+#define BENCH_QUERY_ATTRS       8
+
+typedef struct {
+    const char *piName;
+    void *inStruct;
+} benchCase_t;
+
+static double
+benchElapsed( struct timeval *startTime ) {
+    struct timeval endTime;
+    gettimeofday( &endTime, NULL );
+    return ( double )( endTime.tv_sec - startTime->tv_sec ) +
+           ( double )( endTime.tv_usec - startTime->tv_usec ) / 1000000.0;
+}
+
+/* benchOne - pack and unpack inStruct iterations times. The first
+ * packed result is returned in firstResult for the comparison. */
+static int
+benchOne( benchCase_t *myCase, irodsProt_t irodsProt, int iterations,
+          bytesBuf_t **firstResult, double *packSec, double *unpackSec ) {
+    bytesBuf_t *packedResult = NULL;
+    struct timeval startTime;
+    void *outStruct;
+    int i, status;
+
+    gettimeofday( &startTime, NULL );
+    for ( i = 0; i < iterations; i++ ) {
+        status = packStruct( myCase->inStruct, &packedResult, myCase->piName,
+                             NULL, 0, irodsProt );
+        if ( status < 0 ) {
+            return status;
+        }
+        if ( i == 0 ) {
+            *firstResult = packedResult;
+        }
+        else {
+            freeBBuf( packedResult );
+        }
+    }
+    *packSec = benchElapsed( &startTime );
+
+    gettimeofday( &startTime, NULL );
+    for ( i = 0; i < iterations; i++ ) {
+        status = unpackStruct( ( *firstResult )->buf, &outStruct,
+                               myCase->piName, NULL, irodsProt );
+        if ( status < 0 ) {
+            return status;
+        }
+        /* the nested pointers are not freed, the bench is short lived */
+        free( outStruct );
+    }
+    *unpackSec = benchElapsed( &startTime );
+
+    return 0;
+}
+
+int
+main( int argc, char **argv ) {
+    genQueryOut_t myQueryOut;
+    dataObjInfo_t myDataObjInfo;
+    genQueryInp_t myQueryInp;
+    startupPack_t myStartupPack;
+    benchCase_t benchCases[4];
+    irodsProt_t protList[2] = {NATIVE_PROT, XML_PROT};
+    int iterations = DEF_BENCH_ITERATIONS;
+    int i, j, p, status;
+    int failed = 0;
+
+    if ( argc > 1 ) {
+        iterations = atoi( argv[1] );
+        if ( iterations <= 0 ) {
+            fprintf( stderr, "usage: %s [iterations]\n", argv[0] );
+            return 1;
+        }
+    }
+
+    memset( &myQueryOut, 0, sizeof( myQueryOut ) );
+    myQueryOut.rowCnt = BENCH_QUERY_ROWS;
+    myQueryOut.attriCnt = BENCH_QUERY_ATTRS;
+    for ( i = 0; i < BENCH_QUERY_ATTRS; i++ ) {
+        myQueryOut.sqlResult[i].attriInx = 401 + i;
+        myQueryOut.sqlResult[i].len = NAME_LEN;
+        myQueryOut.sqlResult[i].value =
+            ( char * ) calloc( BENCH_QUERY_ROWS, NAME_LEN );
+        for ( j = 0; j < BENCH_QUERY_ROWS; j++ ) {
+            snprintf( myQueryOut.sqlResult[i].value + j * NAME_LEN, NAME_LEN,
+                      "value %d,%d", j, i );
+        }
+    }
+
+    memset( &myDataObjInfo, 0, sizeof( myDataObjInfo ) );
+    rstrcpy( myDataObjInfo.objPath, "/tempZone/home/rods/bench/file0",
+             MAX_NAME_LEN );
+    rstrcpy( myDataObjInfo.rescName, "demoResc", NAME_LEN );
+    rstrcpy( myDataObjInfo.rescHier, "demoResc", MAX_NAME_LEN );
+    rstrcpy( myDataObjInfo.dataType, "generic", NAME_LEN );
+    rstrcpy( myDataObjInfo.filePath, "/var/lib/irods/Vault/home/rods/bench/file0",
+             MAX_NAME_LEN );
+    myDataObjInfo.dataSize = 1234567;
+    myDataObjInfo.dataId = 10101;
+    addKeyVal( &myDataObjInfo.condInput, "dataType", "generic" );
+
+    memset( &myQueryInp, 0, sizeof( myQueryInp ) );
+    myQueryInp.maxRows = MAX_SQL_ROWS;
+    addInxIval( &myQueryInp.selectInp, COL_DATA_NAME, 1 );
+    addInxIval( &myQueryInp.selectInp, COL_COLL_NAME, 1 );
+    addInxIval( &myQueryInp.selectInp, COL_DATA_SIZE, 1 );
+    addInxVal( &myQueryInp.sqlCondInp, COL_COLL_NAME, "like '/tempZone/home/%'" );
+
+    memset( &myStartupPack, 0, sizeof( myStartupPack ) );
+    myStartupPack.irodsProt = NATIVE_PROT;
+    myStartupPack.connectCnt = 1;
+    rstrcpy( myStartupPack.proxyUser, "rods", NAME_LEN );
+    rstrcpy( myStartupPack.proxyRodsZone, "tempZone", NAME_LEN );
+    rstrcpy( myStartupPack.clientUser, "rods", NAME_LEN );
+    rstrcpy( myStartupPack.clientRodsZone, "tempZone", NAME_LEN );
+    rstrcpy( myStartupPack.relVersion, RODS_REL_VERSION, NAME_LEN );
+    rstrcpy( myStartupPack.apiVersion, RODS_API_VERSION, NAME_LEN );
+
+    benchCases[0].piName = "GenQueryOut_PI";
+    benchCases[0].inStruct = &myQueryOut;
+    benchCases[1].piName = "DataObjInfo_PI";
+    benchCases[1].inStruct = &myDataObjInfo;
+    benchCases[2].piName = "GenQueryInp_PI";
+    benchCases[2].inStruct = &myQueryInp;
+    benchCases[3].piName = "StartupPack_PI";
+    benchCases[3].inStruct = &myStartupPack;
+
+    printf( "%-16s %-6s %12s %12s %8s %12s %12s %8s %s\n", "struct", "prot",
+            "pack/s old", "pack/s new", "speedup",
+            "unpack/s old", "unpack/s new", "speedup", "output" );
+
+    for ( i = 0; i < 4; i++ ) {
+        for ( p = 0; p < 2; p++ ) {
+            bytesBuf_t *oldResult = NULL, *newResult = NULL;
+            double oldPack, oldUnpack, newPack, newUnpack;
+            int same;
+
+            setPackInstructCache( 0 );
+            status = benchOne( &benchCases[i], protList[p], iterations,
+                               &oldResult, &oldPack, &oldUnpack );
+            if ( status < 0 ) {
+                fprintf( stderr, "%s: uncached run failed, status = %d\n",
+                         benchCases[i].piName, status );
+                return 1;
+            }
+
+            setPackInstructCache( 1 );
+            status = benchOne( &benchCases[i], protList[p], iterations,
+                               &newResult, &newPack, &newUnpack );
+            if ( status < 0 ) {
+                fprintf( stderr, "%s: cached run failed, status = %d\n",
+                         benchCases[i].piName, status );
+                return 1;
+            }
+
+            same = oldResult->len == newResult->len &&
+                   memcmp( oldResult->buf, newResult->buf, oldResult->len ) == 0;
+            if ( !same ) {
+                failed = 1;
+            }
+
+            printf( "%-16s %-6s %12.0f %12.0f %7.2fx %12.0f %12.0f %7.2fx %s\n",
+                    benchCases[i].piName,
+                    protList[p] == XML_PROT ? "XML" : "NATIVE",
+                    iterations / oldPack, iterations / newPack, oldPack / newPack,
+                    iterations / oldUnpack, iterations / newUnpack,
+                    oldUnpack / newUnpack, same ? "identical" : "DIFFERENT" );
+
+            freeBBuf( oldResult );
+            freeBBuf( newResult );
+        }
+    }
+
+    return failed;
+}
@@ -0,0 +1,212 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+/* xmsgbench.c - load generator for the xmsg server. Each connection
+ * gets a ticket of its own and sends and receives messages on it in a
+ * loop. The total messages/s and the percentiles of the send-to-receive
+ * latency are reported.
+ *
+ * usage: xmsgbench [connections] [messages per connection] [message size]
+ */
+
+#include "rodsClient.h"
+#include <sys/time.h>
+#include <pthread.h>
+#include <algorithm>
+
+#define DEF_BENCH_CONNECTIONS   16
+#define DEF_BENCH_MESSAGES      2000
+#define DEF_BENCH_MSG_SIZE      64
+
+typedef struct {
+    rcComm_t *conn;
+    xmsgTicketInfo_t *ticket;
+    char *msg;
+    int messages;
+    double *latency;    /* seconds, one per message */
+    int done;
+    int status;
+} benchConn_t;
+
+static double
+benchNow() {
+    struct timeval tv;
+    gettimeofday( &tv, NULL );
+    return ( double ) tv.tv_sec + ( double ) tv.tv_usec / 1000000.0;
+}
+
+static void *
+benchRoutine( void *arg ) {
+    benchConn_t *myConn = ( benchConn_t * ) arg;
+    sendXmsgInp_t sendXmsgInp;
+    rcvXmsgInp_t rcvXmsgInp;
+    rcvXmsgOut_t *rcvXmsgOut = NULL;
+    int i, status;
+
+    memset( &sendXmsgInp, 0, sizeof( sendXmsgInp ) );
+    sendXmsgInp.ticket = *myConn->ticket;
+    sendXmsgInp.sendXmsgInfo.numRcv = 1;
+    rstrcpy( sendXmsgInp.sendXmsgInfo.msgType, "benchMsg", HEADER_TYPE_LEN );
+    sendXmsgInp.sendXmsgInfo.msg = myConn->msg;
+
+    memset( &rcvXmsgInp, 0, sizeof( rcvXmsgInp ) );
+    rcvXmsgInp.rcvTicket = myConn->ticket->rcvTicket;
+
+    for ( i = 0; i < myConn->messages; i++ ) {
+        double startTime = benchNow();
+
+        sendXmsgInp.sendXmsgInfo.msgNumber = i + 1;
+        status = rcSendXmsg( myConn->conn, &sendXmsgInp );
+        if ( status < 0 ) {
+            myConn->status = status;
+            break;
+        }
+
+        rcvXmsgInp.msgNumber = i + 1;
+        status = rcRcvXmsg( myConn->conn, &rcvXmsgInp, &rcvXmsgOut );
+        if ( status < 0 ) {
+            myConn->status = status;
+            break;
+        }
+        free( rcvXmsgOut->msg );
+        free( rcvXmsgOut );
+        rcvXmsgOut = NULL;
+
+        myConn->latency[i] = benchNow() - startTime;
+        myConn->done++;
+    }
+
+    /* release the ticket */
+    sendXmsgInp.sendXmsgInfo.msgNumber = 0;
+    sendXmsgInp.sendXmsgInfo.msg = "";
+    sendXmsgInp.sendXmsgInfo.miscInfo = "DROP_STREAM";
+    rcSendXmsg( myConn->conn, &sendXmsgInp );
+
+    return NULL;
+}
+
+static double
+benchPercentile( double *latency, int count, double pct ) {
+    int idx = ( int )( pct / 100.0 * ( count - 1 ) + 0.5 );
+    return latency[idx] * 1000.0;
+}
+
+int
+main( int argc, char **argv ) {
+    rodsEnv myRodsEnv;
+    rErrMsg_t errMsg;
+    getXmsgTicketInp_t getXmsgTicketInp;
+    benchConn_t *benchConn;
+    pthread_t *benchThr;
+    double *allLatency;
+    double startTime, elapsed;
+    int connections = DEF_BENCH_CONNECTIONS;
+    int messages = DEF_BENCH_MESSAGES;
+    int msgSize = DEF_BENCH_MSG_SIZE;
+    int i, j, total, status;
+
+    if ( argc > 1 ) {
+        connections = atoi( argv[1] );
+    }
+    if ( argc > 2 ) {
+        messages = atoi( argv[2] );
+    }
+    if ( argc > 3 ) {
+        msgSize = atoi( argv[3] );
+    }
+    if ( connections <= 0 || messages <= 0 || msgSize <= 0 ) {
+        fprintf( stderr,
+                 "usage: %s [connections] [messages per connection] [message size]\n",
+                 argv[0] );
+        exit( 1 );
+    }
+
+    status = getRodsEnv( &myRodsEnv );
+    if ( status < 0 ) {
+        fprintf( stderr, "getRodsEnv error, status = %d\n", status );
+        exit( 1 );
+    }
+
+    benchConn = ( benchConn_t * ) calloc( connections, sizeof( benchConn_t ) );
+    benchThr = ( pthread_t * ) calloc( connections, sizeof( pthread_t ) );
+
+    /* connect and get the tickets up front, so only the messages are
+     * timed */
+    for ( i = 0; i < connections; i++ ) {
+        benchConn[i].conn = rcConnectXmsg( &myRodsEnv, &errMsg );
+        if ( benchConn[i].conn == NULL ) {
+            fprintf( stderr, "rcConnect error\n" );
+            exit( 1 );
+        }
+
+        status = clientLogin( benchConn[i].conn );
+        if ( status != 0 ) {
+            fprintf( stderr, "clientLogin error\n" );
+            exit( 7 );
+        }
+
+        memset( &getXmsgTicketInp, 0, sizeof( getXmsgTicketInp ) );
+        status = rcGetXmsgTicket( benchConn[i].conn, &getXmsgTicketInp,
+                                  &benchConn[i].ticket );
+        if ( status != 0 ) {
+            fprintf( stderr, "rcGetXmsgTicket error. status = %d\n", status );
+            exit( 8 );
+        }
+
+        benchConn[i].msg = ( char * ) malloc( msgSize + 1 );
+        memset( benchConn[i].msg, 'x', msgSize );
+        benchConn[i].msg[msgSize] = '\0';
+        benchConn[i].messages = messages;
+        benchConn[i].latency = ( double * ) calloc( messages, sizeof( double ) );
+    }
+
+    startTime = benchNow();
+    for ( i = 0; i < connections; i++ ) {
+        pthread_create( &benchThr[i], NULL, benchRoutine, &benchConn[i] );
+    }
+    for ( i = 0; i < connections; i++ ) {
+        pthread_join( benchThr[i], NULL );
+    }
+    elapsed = benchNow() - startTime;
+
+    total = 0;
+    for ( i = 0; i < connections; i++ ) {
+        if ( benchConn[i].status < 0 ) {
+            fprintf( stderr, "connection %d failed after %d messages, status = %d\n",
+                     i, benchConn[i].done, benchConn[i].status );
+        }
+        total += benchConn[i].done;
+    }
+    if ( total == 0 ) {
+        exit( 9 );
+    }
+
+    allLatency = ( double * ) malloc( total * sizeof( double ) );
+    for ( i = 0, j = 0; i < connections; i++ ) {
+        memcpy( &allLatency[j], benchConn[i].latency,
+                benchConn[i].done * sizeof( double ) );
+        j += benchConn[i].done;
+    }
+    std::sort( allLatency, allLatency + total );
+
+    printf( "%d connections, %d messages of %d bytes in %.3f sec\n",
+            connections, total, msgSize, elapsed );
+    printf( "throughput: %.0f messages/s\n", total / elapsed );
+    printf( "latency ms: p50 %.3f  p90 %.3f  p99 %.3f  p99.9 %.3f  max %.3f\n",
+            benchPercentile( allLatency, total, 50.0 ),
+            benchPercentile( allLatency, total, 90.0 ),
+            benchPercentile( allLatency, total, 99.0 ),
+            benchPercentile( allLatency, total, 99.9 ),
+            allLatency[total - 1] * 1000.0 );
+
+    for ( i = 0; i < connections; i++ ) {
+        rcDisconnect( benchConn[i].conn );
+        free( benchConn[i].ticket );
+        free( benchConn[i].msg );
+        free( benchConn[i].latency );
+    }
+    free( benchConn );
+    free( benchThr );
+    free( allLatency );
+
+    exit( 0 );
+}
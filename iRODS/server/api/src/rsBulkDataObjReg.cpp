@@ -10,6 +10,9 @@
 
 #include "irods_stacktrace.hpp"
 #include "irods_file_object.hpp"
+#include "irods_server_properties.hpp"
+
+#include <algorithm>
 
 int
 rsBulkDataObjReg( rsComm_t *rsComm, genQueryOut_t *bulkDataObjRegInp,
@@ -51,6 +54,117 @@ rsBulkDataObjReg( rsComm_t *rsComm, genQueryOut_t *bulkDataObjRegInp,
     return status;
 }
 
+#ifdef RODS_CAT
+/* getBulkDataObjRegBatchSize - the number of objects registered in each
+ * catalog transaction, from the bulk_registration_batch_size advanced
+ * setting.
+ */
+static int
+getBulkDataObjRegBatchSize() {
+    int batchSize = DEFAULT_BULK_REG_BATCH_SIZE;
+    irods::error ret = irods::get_advanced_setting<int>(
+                           irods::CFG_BULK_REGISTRATION_BATCH_SIZE,
+                           batchSize );
+    if ( !ret.ok() ) {
+        if ( KEY_NOT_FOUND != ret.code() ) {
+            irods::log( PASS( ret ) );
+        }
+        batchSize = DEFAULT_BULK_REG_BATCH_SIZE;
+    }
+    if ( batchSize < 1 ) {
+        batchSize = 1;
+    }
+    return batchSize;
+}
+
+/* _rsBulkDataObjRegBatch - register or update one batch of objects without
+ * committing.  New objects go to the catalog together through
+ * chlRegDataObjBatch, overwritten objects are updated one at a time.
+ * Everything is rolled back on failure.
+ */
+static int
+_rsBulkDataObjRegBatch( rsComm_t *rsComm, dataObjInfo_t *dataObjInfoArray,
+                        char *oprTypes, int oprTypeLen,
+                        char *dataSizes, int dataSizeLen, int count ) {
+    dataObjInfo_t *regHead = NULL, *regTail = NULL;
+    int status = 0;
+    int i;
+
+    for ( i = 0; i < count; i++ ) {
+        dataObjInfoArray[i].next = NULL;
+        if ( strcmp( &oprTypes[oprTypeLen * i], REGISTER_OPR ) == 0 ) {
+            if ( regTail == NULL ) {
+                regHead = &dataObjInfoArray[i];
+            }
+            else {
+                regTail->next = &dataObjInfoArray[i];
+            }
+            regTail = &dataObjInfoArray[i];
+        }
+    }
+
+    if ( regHead != NULL ) {
+        status = chlRegDataObjBatch( rsComm, regHead );
+    }
+    /* unlink before anything below looks at a single dataObjInfo */
+    for ( i = 0; i < count; i++ ) {
+        dataObjInfoArray[i].next = NULL;
+    }
+    if ( status < 0 ) {
+        rodsLog( LOG_ERROR,
+                 "rsBulkDataObjReg: chlRegDataObjBatch failed for %s, stat=%d",
+                 regHead->objPath, status );
+        chlRollback( rsComm );
+        return status;
+    }
+
+    for ( i = 0; i < count; i++ ) {
+        dataObjInfo_t *dataObjInfo = &dataObjInfoArray[i];
+        int isReg = strcmp( &oprTypes[oprTypeLen * i], REGISTER_OPR ) == 0;
+        if ( !isReg ) {
+            status = modDataObjSizeMeta( rsComm, dataObjInfo,
+                                         &dataSizes[dataSizeLen * i] );
+            if ( status < 0 ) {
+                rodsLog( LOG_ERROR,
+                         "rsBulkDataObjReg: ModDataObj failed for %s,stat=%d",
+                         dataObjInfo->objPath, status );
+                chlRollback( rsComm );
+                return status;
+            }
+        }
+
+        // =-=-=-=-=-=-=-
+        // added due to lack of notificaiton of new data object
+        // to resource hiers during operation.  ticket 1753
+        irods::file_object_ptr file_obj(
+            new irods::file_object(
+                rsComm,
+                dataObjInfo ) );
+
+        irods::error ret = SUCCESS();
+        if ( isReg ) {
+            ret = fileRegistered( rsComm, file_obj );
+        }
+        if ( ret.ok() ) {
+            ret = fileModified( rsComm, file_obj );
+        }
+        if ( !ret.ok() ) {
+            std::stringstream msg;
+            msg << __FUNCTION__;
+            msg << " - Failed to signal resource that the data object \"";
+            msg << dataObjInfo->objPath;
+            msg << "\" was registered";
+            ret = PASSMSG( msg.str(), ret );
+            irods::log( ret );
+            chlRollback( rsComm );
+            return ret.code();
+        }
+    }
+
+    return 0;
+}
+#endif
+
 int
 _rsBulkDataObjReg( rsComm_t *rsComm, genQueryOut_t *bulkDataObjRegInp,
                    genQueryOut_t **bulkDataObjRegOut ) {
@@ -58,10 +172,8 @@ _rsBulkDataObjReg( rsComm_t *rsComm, genQueryOut_t *bulkDataObjRegInp,
     dataObjInfo_t dataObjInfo;
     sqlResult_t *objPath, *dataType, *dataSize, *rescName, *rescHier, *filePath,
                 *dataMode, *oprType, *replNum, *chksum;
-    char *tmpObjPath, *tmpDataType, *tmpDataSize, *tmpRescName, *tmpRescHier, *tmpFilePath,
-         *tmpDataMode, *tmpOprType, *tmpReplNum, *tmpChksum;
+    char *tmpChksum;
     sqlResult_t *objId;
-    char *tmpObjId;
     int status, i;
 
     if ( ( rescHier =
@@ -137,85 +249,82 @@ _rsBulkDataObjReg( rsComm_t *rsComm, genQueryOut_t *bulkDataObjRegInp,
         return UNMATCHED_KEY_OR_INDEX;
     }
 
-    ( *bulkDataObjRegOut )->rowCnt = bulkDataObjRegInp->rowCnt;
+    /* the output is sized for MAX_NUM_BULK_OPR_FILES rows */
+    if ( bulkDataObjRegInp->rowCnt > MAX_NUM_BULK_OPR_FILES ) {
+        free( objId->value );
+        objId->value = ( char * ) calloc( bulkDataObjRegInp->rowCnt, objId->len );
+    }
+
+    dataObjInfo_t *dataObjInfoArray = ( dataObjInfo_t * )
+                                      calloc( bulkDataObjRegInp->rowCnt, sizeof( dataObjInfo_t ) );
+    if ( dataObjInfoArray == NULL || objId->value == NULL ) {
+        free( dataObjInfoArray );
+        freeGenQueryOut( bulkDataObjRegOut );
+        *bulkDataObjRegOut = NULL;
+        return SYS_MALLOC_ERR;
+    }
+
     for ( i = 0; i < bulkDataObjRegInp->rowCnt; i++ ) {
-        tmpObjPath = &objPath->value[objPath->len * i];
-        tmpDataType = &dataType->value[dataType->len * i];
-        tmpDataSize = &dataSize->value[dataSize->len * i];
-        tmpRescName = &rescName->value[rescName->len * i];
-        tmpRescHier = &rescHier->value[rescHier->len * i];
-        tmpFilePath = &filePath->value[filePath->len * i];
-        tmpDataMode = &dataMode->value[dataMode->len * i];
-        tmpOprType = &oprType->value[oprType->len * i];
-        tmpReplNum =  &replNum->value[replNum->len * i];
-        tmpObjId = &objId->value[objId->len * i];
-
-        bzero( &dataObjInfo, sizeof( dataObjInfo_t ) );
-        dataObjInfo.flags = NO_COMMIT_FLAG;
-        rstrcpy( dataObjInfo.objPath, tmpObjPath, MAX_NAME_LEN );
-        rstrcpy( dataObjInfo.dataType, tmpDataType, NAME_LEN );
-        dataObjInfo.dataSize = strtoll( tmpDataSize, 0, 0 );
-        rstrcpy( dataObjInfo.rescName, tmpRescName, NAME_LEN );
-        rstrcpy( dataObjInfo.rescHier, tmpRescHier, MAX_NAME_LEN );
-        rstrcpy( dataObjInfo.filePath, tmpFilePath, MAX_NAME_LEN );
-        rstrcpy( dataObjInfo.dataMode, tmpDataMode, SHORT_STR_LEN );
-        dataObjInfo.replNum = atoi( tmpReplNum );
+        dataObjInfo_t *dataObjInfo = &dataObjInfoArray[i];
+        dataObjInfo->flags = NO_COMMIT_FLAG;
+        rstrcpy( dataObjInfo->objPath, &objPath->value[objPath->len * i], MAX_NAME_LEN );
+        rstrcpy( dataObjInfo->dataType, &dataType->value[dataType->len * i], NAME_LEN );
+        dataObjInfo->dataSize = strtoll( &dataSize->value[dataSize->len * i], 0, 0 );
+        rstrcpy( dataObjInfo->rescName, &rescName->value[rescName->len * i], NAME_LEN );
+        rstrcpy( dataObjInfo->rescHier, &rescHier->value[rescHier->len * i], MAX_NAME_LEN );
+        rstrcpy( dataObjInfo->filePath, &filePath->value[filePath->len * i], MAX_NAME_LEN );
+        rstrcpy( dataObjInfo->dataMode, &dataMode->value[dataMode->len * i], SHORT_STR_LEN );
+        dataObjInfo->replNum = atoi( &replNum->value[replNum->len * i] );
         if ( chksum != NULL ) {
             tmpChksum = &chksum->value[chksum->len * i];
             if ( strlen( tmpChksum ) > 0 ) {
-                rstrcpy( dataObjInfo.chksum, tmpChksum, NAME_LEN );
+                rstrcpy( dataObjInfo->chksum, tmpChksum, NAME_LEN );
             }
         }
+        dataObjInfo->replStatus = NEWLY_CREATED_COPY;
+    }
 
-        dataObjInfo.replStatus = NEWLY_CREATED_COPY;
-        if ( strcmp( tmpOprType, REGISTER_OPR ) == 0 ) {
-            status = svrRegDataObj( rsComm, &dataObjInfo );
-        }
-        else {
-            status = modDataObjSizeMeta( rsComm, &dataObjInfo, tmpDataSize );
+    /* register in batches, each batch is committed on its own */
+    int batchSize = getBulkDataObjRegBatchSize();
+    int committed = 0;
+    status = 0;
+    for ( int first = 0; first < bulkDataObjRegInp->rowCnt; first += batchSize ) {
+        int last = std::min( bulkDataObjRegInp->rowCnt, first + batchSize );
+        status = _rsBulkDataObjRegBatch( rsComm, &dataObjInfoArray[first],
+                                         &oprType->value[oprType->len * first], oprType->len,
+                                         &dataSize->value[dataSize->len * first], dataSize->len,
+                                         last - first );
+        if ( status < 0 ) {
+            break;
         }
-        if ( status >= 0 ) {
-            snprintf( tmpObjId, NAME_LEN, "%lld", dataObjInfo.dataId );
-
-            // =-=-=-=-=-=-=-
-            // added due to lack of notificaiton of new data object
-            // to resource hiers during operation.  ticket 1753
-            irods::file_object_ptr file_obj(
-                new irods::file_object(
-                    rsComm,
-                    &dataObjInfo ) );
-
-            irods::error ret = fileModified( rsComm, file_obj );
-            if ( !ret.ok() ) {
-                std::stringstream msg;
-                msg << __FUNCTION__;
-                msg << " - Failed to signal resource that the data object \"";
-                msg << dataObjInfo.objPath;
-                msg << "\" was registered";
-                ret = PASSMSG( msg.str(), ret );
-                irods::log( ret );
-                return ret.code();
-            }
 
-        }
-        else {
+        status = chlCommit( rsComm );
+        if ( status < 0 ) {
             rodsLog( LOG_ERROR,
-                     "rsBulkDataObjReg: RegDataObj or ModDataObj failed for %s,stat=%d",
-                     tmpObjPath, status );
-            chlRollback( rsComm );
-            freeGenQueryOut( bulkDataObjRegOut );
-            *bulkDataObjRegOut = NULL;
-            return status;
+                     "rsBulkDataObjReg: chlCommit failed, status = %d", status );
+            break;
         }
+
+        for ( i = first; i < last; i++ ) {
+            snprintf( &objId->value[objId->len * i], NAME_LEN, "%lld",
+                      dataObjInfoArray[i].dataId );
+        }
+        committed = last;
     }
-    status = chlCommit( rsComm );
 
     if ( status < 0 ) {
-        rodsLog( LOG_ERROR,
-                 "rsBulkDataObjReg: chlCommit failed, status = %d", status );
+        if ( committed > 0 ) {
+            rodsLog( LOG_NOTICE,
+                     "rsBulkDataObjReg: %d of %d objects were registered before the failure",
+                     committed, bulkDataObjRegInp->rowCnt );
+        }
         freeGenQueryOut( bulkDataObjRegOut );
         *bulkDataObjRegOut = NULL;
     }
+    else {
+        ( *bulkDataObjRegOut )->rowCnt = bulkDataObjRegInp->rowCnt;
+    }
+    free( dataObjInfoArray );
     return status;
 #else
     return SYS_NO_RCAT_SERVER_ERR;
@@ -15,6 +15,88 @@
 #include "dataObjRepl.h"
 #include "rsApiHandler.hpp"
 #include "getRemoteZoneResc.h"
+#include "irods_coll_repl_scheduler.hpp"
+
+/* _rsCollReplParallel - replicate the data objects of an open collection
+ * with a coll_repl_scheduler.  The collection is read here while the
+ * workers replicate, and progress is sent to the client as the objects
+ * complete, FILE_CNT_PER_STAT_OUT at a time, as in the serial loop.
+ */
+static int
+_rsCollReplParallel( rsComm_t *rsComm, collInp_t *collReplInp,
+                     int handleInx, irods::coll_repl_scheduler &scheduler,
+                     collOprStat_t **collOprStat ) {
+    int status;
+    int savedStatus = 0;
+    int totalFileCnt = 0;
+    bool reading = true;
+    collEnt_t *collEnt = NULL;
+    char *srcResc = getValByKey( &collReplInp->condInput, RESC_NAME_KW );
+
+    while ( reading || scheduler.busy() ) {
+        if ( reading ) {
+            status = rsReadCollection( rsComm, &handleInx, &collEnt );
+            if ( status < 0 ) {
+                reading = false;
+            }
+            else {
+                if ( collEnt->objType == DATA_OBJ_T ) {
+                    if ( totalFileCnt == 0 ) totalFileCnt =
+                            CollHandle[handleInx].dataObjSqlResult.totalRowCount;
+
+                    irods::coll_repl_job job;
+                    job.path_ = std::string( collEnt->collName ) + "/" +
+                                collEnt->dataName;
+                    /* without -S, the resource of the replica the read
+                     * picked, a good one where there is one */
+                    job.src_resc_ = srcResc != NULL ? srcResc :
+                                    ( collEnt->resource != NULL ? collEnt->resource : "" );
+                    if ( !scheduler.submit( job ) ) {
+                        reading = false;
+                    }
+                }
+                free( collEnt );	   /* just free collEnt but not content */
+                collEnt = NULL;
+            }
+        }
+
+        /* only wait for a completion once the whole collection is queued */
+        rodsLong_t bytes = 0;
+        std::string lastObjPath;
+        int cnt = scheduler.completed( reading ? 0 : 1000, bytes, lastObjPath );
+        if ( collOprStat == NULL || cnt == 0 ) {
+            continue;
+        }
+
+        ( *collOprStat )->bytesWritten += bytes;
+        ( *collOprStat )->filesCnt += cnt;
+        rstrcpy( ( *collOprStat )->lastObjPath, lastObjPath.c_str(),
+                 MAX_NAME_LEN );
+        if ( ( *collOprStat )->filesCnt >= FILE_CNT_PER_STAT_OUT ) {
+            ( *collOprStat )->totalFileCnt = totalFileCnt;
+            status = svrSendCollOprStat( rsComm, *collOprStat );
+            if ( status < 0 ) {
+                rodsLogError( LOG_ERROR, status,
+                              "_rsCollReplParallel: svrSendCollOprStat failed for %s. status = %d",
+                              lastObjPath.c_str(), status );
+                *collOprStat = NULL;
+                savedStatus = status;
+                scheduler.cancel();
+                reading = false;
+                continue;
+            }
+            *collOprStat = ( collOprStat_t* )malloc( sizeof( collOprStat_t ) );
+            memset( *collOprStat, 0, sizeof( collOprStat_t ) );
+        }
+    }
+
+    status = scheduler.finish();
+    if ( savedStatus == 0 ) {
+        savedStatus = status;
+    }
+
+    return savedStatus;
+}
 
 /* rsCollRepl - The Api handler of the rcCollRepl call - Replicate
  * a data object.
@@ -62,7 +144,18 @@ rsCollRepl( rsComm_t *rsComm, collInp_t *collReplInp,
     if ( collOprStat != NULL ) {
         *collOprStat = NULL;
     }
+    /* replicate several objects at once if the client asked for it */
+    char *workersStr = getValByKey( &collReplInp->condInput, REPL_WORKERS_KW );
+    int workers = workersStr != NULL ?
+                  irods::coll_repl_scheduler::workers_for( atoi( workersStr ) ) : 0;
+
+    /* the scheduler limits the jobs per source resource, which needs the
+     * resource of each object.  only asked for when it is used, since it
+     * costs a row per replica in the query */
     collReplInp->flags = RECUR_QUERY_FG;
+    if ( workers > 1 ) {
+        collReplInp->flags |= LONG_METADATA_FG;
+    }
     handleInx = rsOpenCollection( rsComm, collReplInp );
     if ( handleInx < 0 ) {
         rodsLog( LOG_ERROR,
@@ -84,6 +177,20 @@ rsCollRepl( rsComm_t *rsComm, collInp_t *collReplInp,
         return 0;
     }
 
+    if ( workers > 1 ) {
+        irods::coll_repl_scheduler scheduler( rsComm, &collReplInp->condInput,
+                                              workers );
+        if ( scheduler.start() > 0 ) {
+            savedStatus = _rsCollReplParallel( rsComm, collReplInp, handleInx,
+                                               scheduler, collOprStat );
+            rsCloseCollection( rsComm, &handleInx );
+            return savedStatus;
+        }
+        rodsLog( LOG_NOTICE,
+                 "rsCollRepl: no replication workers for %s, replicating serially",
+                 collReplInp->collName );
+    }
+
     collEnt_t *collEnt = NULL;
     while ( ( status = rsReadCollection( rsComm, &handleInx, &collEnt ) ) >= 0 ) {
         if ( collEnt->objType == DATA_OBJ_T ) {
@@ -60,7 +60,7 @@ irsDataObjClose(
     int l1descInx;
     ruleExecInfo_t rei;
     l1descInx = dataObjCloseInp->l1descInx;
-    if ( l1descInx <= 2 || l1descInx >= NUM_L1_DESC ) {
+    if ( l1descInx <= 2 || l1descInx >= L1desc.size() ) {
         rodsLog( LOG_NOTICE,
                  "rsDataObjClose: l1descInx %d out of range",
                  l1descInx );
@@ -64,7 +64,7 @@ rsDataObjRead( rsComm_t *rsComm, openedDataObjInp_t *dataObjReadInp,
     int bytesRead;
     int l1descInx = dataObjReadInp->l1descInx;
 
-    if ( l1descInx < 2 || l1descInx >= NUM_L1_DESC ) {
+    if ( l1descInx < 2 || l1descInx >= L1desc.size() ) {
         rodsLog( LOG_NOTICE,
                  "rsDataObjRead: l1descInx %d out of range",
                  l1descInx );
@@ -8,6 +8,7 @@
 #include "rodsConnect.h"
 #include "icatDefines.h"
 #include "fileUnlink.h"
+#include "fileStat.h"
 #include "reFuncDefs.hpp"
 #include "unregDataObj.h"
 #include "objMetaOpr.hpp"
@@ -357,6 +358,13 @@ dataObjUnlinkS( rsComm_t *rsComm, dataObjInp_t *dataObjUnlinkInp,
                      dataObjUnlinkInp->objPath, status );
             return status;
         }
+
+        /* the file stays, but nothing is left to keep its index current */
+        std::string location;
+        if ( dataObjUnlinkInp->oprType == UNREG_OPR &&
+                irods::get_loc_for_hier_string( dataObjInfo->rescHier, location ).ok() ) {
+            l3UnlinkStructFileIndex( rsComm, dataObjInfo, location.c_str() );
+        }
     }
 
     if ( dataObjUnlinkInp->oprType != UNREG_OPR ) {
@@ -477,10 +485,69 @@ l3Unlink( rsComm_t *rsComm, dataObjInfo_t *dataObjInfo ) {
         rstrcpy( fileUnlinkInp.objPath, dataObjInfo->objPath, MAX_NAME_LEN );
         rstrcpy( fileUnlinkInp.in_pdmo, dataObjInfo->in_pdmo, MAX_NAME_LEN );
         status = rsFileUnlink( rsComm, &fileUnlinkInp );
+        if ( status >= 0 ) {
+            l3UnlinkStructFileIndex( rsComm, dataObjInfo, location.c_str() );
+        }
     }
     return status;
 }
 
+/* whether an object of this data type can have a member index beside
+ * it. a tar mount records TAR_DT_STR on an object of any other type */
+int
+isStructFileDataType( const char *dataType ) {
+    if ( dataType == NULL ) {
+        return False;
+    }
+    if ( strcmp( dataType, TAR_DT_STR ) == 0 ||
+            strcmp( dataType, GZIP_TAR_DT_STR ) == 0 ||
+            strcmp( dataType, BZIP2_TAR_DT_STR ) == 0 ||
+            strcmp( dataType, ZIP_DT_STR ) == 0 ||
+            strcmp( dataType, TAR_BUNDLE_DT_STR ) == 0 ||
+            strcmp( dataType, GZIP_TAR_BUNDLE_DT_STR ) == 0 ||
+            strcmp( dataType, BZIP2_TAR_BUNDLE_DT_STR ) == 0 ||
+            strcmp( dataType, ZIP_BUNDLE_DT_STR ) == 0 ) {
+        return True;
+    }
+    return False;
+}
+
+/* remove the member index the tar structFile resource keeps beside a
+ * file it has served members of. only a struct file data type can have
+ * one; the index may still be missing, and a stat of a missing file is
+ * not logged */
+int
+l3UnlinkStructFileIndex( rsComm_t *rsComm, dataObjInfo_t *dataObjInfo,
+                         const char *location ) {
+    fileStatInp_t fileStatInp;
+    rodsStat_t *fileStatOut = NULL;
+    fileUnlinkInp_t fileUnlinkInp;
+    int status;
+
+    if ( !isStructFileDataType( dataObjInfo->dataType ) ) {
+        return 0;
+    }
+
+    memset( &fileStatInp, 0, sizeof( fileStatInp ) );
+    snprintf( fileStatInp.fileName, MAX_NAME_LEN, "%s%s",
+              dataObjInfo->filePath, STRUCT_FILE_INDEX_EXT );
+    rstrcpy( fileStatInp.rescHier, dataObjInfo->rescHier, MAX_NAME_LEN );
+    rstrcpy( fileStatInp.addr.hostAddr, location, NAME_LEN );
+    rstrcpy( fileStatInp.objPath, dataObjInfo->objPath, MAX_NAME_LEN );
+    status = rsFileStat( rsComm, &fileStatInp, &fileStatOut );
+    free( fileStatOut );
+    if ( status < 0 ) {
+        return 0;
+    }
+
+    memset( &fileUnlinkInp, 0, sizeof( fileUnlinkInp ) );
+    rstrcpy( fileUnlinkInp.fileName, fileStatInp.fileName, MAX_NAME_LEN );
+    rstrcpy( fileUnlinkInp.rescHier, dataObjInfo->rescHier, MAX_NAME_LEN );
+    rstrcpy( fileUnlinkInp.addr.hostAddr, location, NAME_LEN );
+    rstrcpy( fileUnlinkInp.objPath, dataObjInfo->objPath, MAX_NAME_LEN );
+    return rsFileUnlink( rsComm, &fileUnlinkInp );
+}
+
 int
 rsMvDataObjToTrash( rsComm_t *rsComm, dataObjInp_t *dataObjInp,
                     dataObjInfo_t **dataObjInfoHead ) {
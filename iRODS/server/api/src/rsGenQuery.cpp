@@ -9,7 +9,11 @@
 #include "miscUtil.h"
 #include "cache.hpp"
 #include "rsGlobalExtern.hpp"
+#include "rsApiHandler.hpp"
+#include "apiNumber.h"
 #include "irods_server_properties.hpp"
+#include "irods_configuration_keywords.hpp"
+#include "irods_server_api_table.hpp"
 
 #include "boost/format.hpp"
 #include <string>
@@ -166,6 +170,109 @@ irods::error proc_query_terms_for_community_server(
 
 } // proc_query_terms_for_community_server
 
+#ifdef RODS_CAT
+static int
+getGenQueryStreamPageSize() {
+    int pageSize = DEFAULT_GEN_QUERY_STREAM_PAGE_SIZE;
+    irods::error ret = irods::get_advanced_setting<int>(
+                           irods::CFG_GEN_QUERY_STREAM_PAGE_SIZE,
+                           pageSize );
+    if ( !ret.ok() ) {
+        if ( KEY_NOT_FOUND != ret.code() ) {
+            irods::log( PASS( ret ) );
+        }
+        pageSize = DEFAULT_GEN_QUERY_STREAM_PAGE_SIZE;
+    }
+    if ( pageSize < 1 ) {
+        pageSize = 1;
+    }
+    return pageSize;
+}
+
+/* isClientGenQuery - true if this is the GenQuery API call of the client,
+ * as opposed to a query made by the server while handling another call.
+ * Only the former can be answered with a stream of pages.
+ */
+static bool
+isClientGenQuery( rsComm_t *rsComm ) {
+    if ( rsComm->apiInx < 0 ) {
+        return false;
+    }
+    irods::api_entry_table& RsApiTable = irods::get_server_api_table();
+    return RsApiTable[rsComm->apiInx]->apiNumber == GEN_QUERY_AN;
+}
+
+/* _rsGenQueryStream - run a STREAM_QUERY to the end. Each page but the
+ * last is sent to the client as soon as it is read from the catalog, with
+ * a SYS_SVR_TO_CLI_GEN_QUERY_PAGE status. The last page is returned as
+ * the normal reply. There is no handshake between pages; a client which
+ * does not keep up blocks the agent in the socket write. The first page
+ * has genQueryInp->maxRows rows, the later ones as many rows as fit in
+ * gen_query_stream_page_size_in_bytes, judged by the previous page.
+ */
+static int
+_rsGenQueryStream( rsComm_t *rsComm, genQueryInp_t *genQueryInp,
+                   genQueryOut_t **genQueryOut ) {
+    int pageSize = getGenQueryStreamPageSize();
+    int pageCnt = 0;
+    int status;
+
+    if ( genQueryInp->maxRows > MAX_SQL_STREAM_ROWS ) {
+        genQueryInp->maxRows = MAX_SQL_STREAM_ROWS;
+    }
+
+    while ( 1 ) {
+        status = _rsGenQuery( rsComm, genQueryInp, genQueryOut );
+        if ( status < 0 ) {
+            if ( status == CAT_NO_ROWS_FOUND && pageCnt > 0 ) {
+                /* the last page sent happened to end at the last row */
+                *genQueryOut = ( genQueryOut_t* )malloc( sizeof( genQueryOut_t ) );
+                memset( *genQueryOut, 0, sizeof( genQueryOut_t ) );
+                return 0;
+            }
+            return status;
+        }
+        if ( ( *genQueryOut )->continueInx <= 0 ) {
+            return status;
+        }
+
+        int rowLen = 0;
+        for ( int i = 0; i < ( *genQueryOut )->attriCnt; i++ ) {
+            rowLen += ( *genQueryOut )->sqlResult[i].len;
+        }
+        int nextRows = rowLen > 0 ? pageSize / rowLen : MAX_SQL_STREAM_ROWS;
+        if ( nextRows < 1 ) {
+            nextRows = 1;
+        }
+        else if ( nextRows > MAX_SQL_STREAM_ROWS ) {
+            nextRows = MAX_SQL_STREAM_ROWS;
+        }
+        genQueryInp->continueInx = ( *genQueryOut )->continueInx;
+        genQueryInp->maxRows = nextRows;
+
+        /* sendAndProcApiReply frees the page */
+        status = sendAndProcApiReply( rsComm, rsComm->apiInx,
+                                      SYS_SVR_TO_CLI_GEN_QUERY_PAGE, *genQueryOut, NULL );
+        *genQueryOut = NULL;
+        if ( status < 0 ) {
+            rodsLog( LOG_ERROR,
+                     "_rsGenQueryStream: sendAndProcApiReply of page %d failed, status = %d",
+                     pageCnt, status );
+            /* close out the statement */
+            genQueryOut_t *closeOut = NULL;
+            genQueryInp->maxRows = 0;
+            _rsGenQuery( rsComm, genQueryInp, &closeOut );
+            if ( closeOut != NULL ) {
+                clearGenQueryOut( closeOut );
+                free( closeOut );
+            }
+            return status;
+        }
+        pageCnt++;
+    }
+}
+#endif
+
 /* can be used for debug: */
 /* extern int printGenQI( genQueryInp_t *genQueryInp); */
 ;
@@ -200,7 +307,13 @@ rsGenQuery( rsComm_t *rsComm, genQueryInp_t *genQueryInp,
 
     if ( rodsServerHost->localFlag == LOCAL_HOST ) {
 #ifdef RODS_CAT
-        status = _rsGenQuery( rsComm, genQueryInp, genQueryOut );
+        if ( ( genQueryInp->options & STREAM_QUERY ) &&
+                genQueryInp->continueInx == 0 && isClientGenQuery( rsComm ) ) {
+            status = _rsGenQueryStream( rsComm, genQueryInp, genQueryOut );
+        }
+        else {
+            status = _rsGenQuery( rsComm, genQueryInp, genQueryOut );
+        }
 #else
         rodsLog( LOG_NOTICE,
                  "rsGenQuery error. RCAT is not configured on this host" );
@@ -224,6 +337,11 @@ rsGenQuery( rsComm_t *rsComm, genQueryInp_t *genQueryInp,
 
         } // if dis_kw
 
+        // =-=-=-=-=-=-=-
+        // the server to server connection is not read as a stream, the
+        // remote zone answers with ordinary pages
+        genQueryInp->options &= ~STREAM_QUERY;
+
         status = rcGenQuery( rodsServerHost->conn,
                              genQueryInp, genQueryOut );
     }
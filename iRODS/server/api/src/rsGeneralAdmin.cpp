@@ -21,6 +21,8 @@
 #include "irods_string_tokenize.hpp"
 #include "irods_plugin_name_generator.hpp"
 #include "irods_resource_manager.hpp"
+#include "irods_resource_cache.hpp"
+#include "irods_auth_session_cache.hpp"
 #include "irods_file_object.hpp"
 #include "irods_resource_constants.hpp"
 #include "irods_load_plugin.hpp"
@@ -98,6 +100,9 @@ _addChildToResource(
     if ( ( result = chlAddChildResc( _rsComm, resc_input ) ) != 0 ) {
         chlRollback( _rsComm );
     }
+    else {
+        irods::resource_cache::invalidate();
+    }
 
     return result;
 }
@@ -126,6 +131,9 @@ _removeChildFromResource(
     if ( ( result = chlDelChildResc( _rsComm, resc_input ) ) != 0 ) {
         chlRollback( _rsComm );
     }
+    else {
+        irods::resource_cache::invalidate();
+    }
 
     return result;
 }
@@ -257,6 +265,11 @@ _addResource(
                  resc_input[irods::RESOURCE_NAME].c_str(), result );
     }
 
+    // =-=-=-=-=-=-=-
+    // the resource may have been committed even if a policy failed after
+    // it, and a needless invalidation only costs agents one catalog read
+    irods::resource_cache::invalidate();
+
     return result;
 }
 
@@ -464,6 +477,12 @@ _rsGeneralAdmin( rsComm_t *rsComm, generalAdminInp_t *generalAdminInp ) {
                                  generalAdminInp->arg3, generalAdminInp->arg4 );
 
             if ( status == 0 ) {
+                char userName[NAME_LEN];
+                char zoneName[NAME_LEN];
+                if ( parseUserName( generalAdminInp->arg2, userName, zoneName ) == 0 ) {
+                    irods::auth_session_cache::revoke( userName, zoneName );
+                }
+
                 i =  applyRuleArg( "acPostProcForModifyUser", args, argc, &rei2, NO_SAVE_REI );
                 if ( i < 0 ) {
                     if ( rei2.status < 0 ) {
@@ -618,6 +637,9 @@ _rsGeneralAdmin( rsComm_t *rsComm, generalAdminInp_t *generalAdminInp ) {
                              generalAdminInp->arg2,
                              generalAdminInp->arg3,
                              generalAdminInp->arg4 );
+                if ( status == 0 ) {
+                    irods::resource_cache::invalidate();
+                }
 
             }
 
@@ -673,6 +695,9 @@ _rsGeneralAdmin( rsComm_t *rsComm, generalAdminInp_t *generalAdminInp ) {
             if ( status != 0 ) {
                 chlRollback( rsComm );
             }
+            else {
+                irods::auth_session_cache::revoke( userName, strlen( zoneName ) > 0 ? zoneName : generalAdminInp->arg3 );
+            }
             return status;
         }
         if ( strcmp( generalAdminInp->arg1, "dir" ) == 0 ) {
@@ -737,6 +762,7 @@ _rsGeneralAdmin( rsComm_t *rsComm, generalAdminInp_t *generalAdminInp ) {
 
             status = chlDelResc( rsComm, resc_name );
             if ( status == 0 ) {
+                irods::resource_cache::invalidate();
                 i =  applyRuleArg( "acPostProcForDeleteResource", args, argc, &rei2, NO_SAVE_REI );
                 if ( i < 0 ) {
                     if ( rei2.status < 0 ) {
@@ -819,6 +845,11 @@ _rsGeneralAdmin( rsComm_t *rsComm, generalAdminInp_t *generalAdminInp ) {
         }
     }
     if ( strcmp( generalAdminInp->arg0, "calculate-usage" ) == 0 ) {
+        if ( strcmp( generalAdminInp->arg1, "reconcile" ) == 0 ) {
+            status = chlReconcileQuotaUsage( rsComm,
+                                             atoi( generalAdminInp->arg2 ) );
+            return status;
+        }
         status = chlCalcUsageAndQuota( rsComm );
         return status;
     }
@@ -40,6 +40,8 @@ rsGetXmsgTicket( rsComm_t*, getXmsgTicketInp_t *getXmsgTicketInp,
         ( *outXmsgTicketInfo )->rcvTicket = random();
         ( *outXmsgTicketInfo )->sendTicket = ( *outXmsgTicketInfo )->rcvTicket;
         hashSlotNum = ticketHashFunc( ( *outXmsgTicketInfo )->rcvTicket );
+        boost::mutex::scoped_lock lock(
+            ticketHashSlotMutex( ( *outXmsgTicketInfo )->rcvTicket ) );
         status = addTicketToHQue(
                      *outXmsgTicketInfo, &XmsgHashQue[hashSlotNum] );
         if ( status != SYS_DUPLICATE_XMSG_TICKET ) {
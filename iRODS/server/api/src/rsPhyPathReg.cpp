@@ -987,6 +987,31 @@ int structFileReg(
             rsDataObjClose( rsComm, &dataObjCloseInp );
         }
     }
+    else {
+        /* a tar gets a member index beside it while mounted. record a
+         * struct file data type so its delete knows to look for one */
+        if ( strcmp( collType, TAR_STRUCT_FILE_STR ) == 0 &&
+                !isStructFileDataType( dataObjInfo->dataType ) ) {
+            modDataObjMeta_t modDataObjMetaInp;
+            keyValPair_t regParam;
+            memset( &modDataObjMetaInp, 0, sizeof( modDataObjMetaInp ) );
+            memset( &regParam, 0, sizeof( regParam ) );
+            addKeyVal( &regParam, DATA_TYPE_KW, TAR_DT_STR );
+            addKeyVal( &regParam, ALL_KW, "" );
+            modDataObjMetaInp.dataObjInfo = dataObjInfo;
+            modDataObjMetaInp.regParam = &regParam;
+            status = rsModDataObjMeta( rsComm, &modDataObjMetaInp );
+            clearKeyVal( &regParam );
+            if ( status < 0 ) {
+                rodsLog( LOG_ERROR,
+                         "structFileReg: rsModDataObjMeta of data type for %s failed, status = %d",
+                         dataObjInp.objPath, status );
+                freeAllDataObjInfo( dataObjInfo );
+                return status;
+            }
+        }
+        freeAllDataObjInfo( dataObjInfo );
+    }
 
     char* tmp_hier = getValByKey( &phyPathRegInp->condInput, RESC_HIER_STR_KW );
     if ( !tmp_hier ) {
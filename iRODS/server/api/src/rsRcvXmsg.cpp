@@ -7,7 +7,6 @@
 #include "xmsgLib.hpp"
 
 extern ticketHashQue_t XmsgHashQue[];
-extern xmsgQue_t XmsgQue;
 
 int
 rsRcvXmsg( rsComm_t*, rcvXmsgInp_t *rcvXmsgInp,
@@ -18,6 +17,8 @@ rsRcvXmsg( rsComm_t*, rcvXmsgInp_t *rcvXmsgInp,
     status = getIrodsXmsgByMsgNum (rcvXmsgInp->rcvTicket,
       rcvXmsgInp->msgNumber, &irodsXmsg);
     */
+    boost::mutex::scoped_lock lock(
+        ticketHashSlotMutex( rcvXmsgInp->rcvTicket ) );
     status = getIrodsXmsg( rcvXmsgInp, &irodsXmsg );
 
     if ( status < 0 ) {
@@ -18,8 +18,32 @@
 #include "subStructFileRmdir.h"
 #include "dataObjRename.h"
 #include "genQuery.h"
+#include "regDataObj.h"
+#include "physPath.hpp"
 
 #include "irods_resource_backport.hpp"
+#include "irods_coll_unlink_scheduler.hpp"
+#include "irods_configuration_keywords.hpp"
+#include "irods_server_properties.hpp"
+
+#include <set>
+
+/* the collection_delete_batch_size setting. zero removes a collection
+ * one data object at a time */
+static int
+getCollDeleteBatchSize() {
+    int batchSize = 0;
+    irods::error ret = irods::get_advanced_setting<int>(
+                           irods::CFG_COLLECTION_DELETE_BATCH_SIZE,
+                           batchSize );
+    if ( !ret.ok() ) {
+        if ( KEY_NOT_FOUND != ret.code() ) {
+            irods::log( PASS( ret ) );
+        }
+        batchSize = irods::DEFAULT_COLLECTION_DELETE_BATCH_SIZE;
+    }
+    return batchSize;
+}
 
 int
 rsRmColl( rsComm_t *rsComm, collInp_t *rmCollInp,
@@ -185,6 +209,243 @@ _rsRmCollRecur( rsComm_t *rsComm, collInp_t *rmCollInp,
     return status;
 }
 
+/* register a file which could not be unlinked as an orphan, as
+ * dataObjUnlinkS does */
+static void
+_rsRmCollRegOrphan( rsComm_t *rsComm, dataObjInfo_t *dataObjInfo ) {
+    char orphanPath[MAX_NAME_LEN];
+    int status;
+
+    rodsLog( LOG_NOTICE,
+             "_rsRmCollRegOrphan: orphan file %s", dataObjInfo->filePath );
+    while ( 1 ) {
+        if ( isOrphanPath( dataObjInfo->objPath ) == NOT_ORPHAN_PATH ) {
+            /* don't rename orphan path */
+            status = rsMkOrphanPath( rsComm, dataObjInfo->objPath,
+                                     orphanPath );
+            if ( status < 0 ) {
+                break;
+            }
+            rstrcpy( dataObjInfo->objPath, orphanPath, MAX_NAME_LEN );
+        }
+        status = svrRegDataObj( rsComm, dataObjInfo );
+        if ( status == CAT_NAME_EXISTS_AS_DATAOBJ ||
+                status == CATALOG_ALREADY_HAS_ITEM_BY_THAT_NAME ) {
+            continue;
+        }
+        else if ( status < 0 ) {
+            rodsLogError( LOG_ERROR, status,
+                          "_rsRmCollRegOrphan: svrRegDataObj of orphan %s error",
+                          dataObjInfo->objPath );
+        }
+        break;
+    }
+}
+
+/* register the files the delete workers could not unlink as orphans */
+static void
+_rsRmCollRegOrphanJobs( rsComm_t *rsComm,
+                        std::vector< irods::coll_unlink_job > &failed ) {
+    for ( size_t i = 0; i < failed.size(); ++i ) {
+        dataObjInfo_t orphanInfo;
+        memset( &orphanInfo, 0, sizeof( orphanInfo ) );
+        rstrcpy( orphanInfo.objPath, failed[i].obj_path_.c_str(), MAX_NAME_LEN );
+        rstrcpy( orphanInfo.filePath, failed[i].file_path_.c_str(), MAX_NAME_LEN );
+        rstrcpy( orphanInfo.rescName, failed[i].resc_name_.c_str(), NAME_LEN );
+        rstrcpy( orphanInfo.rescHier, failed[i].resc_hier_.c_str(), MAX_NAME_LEN );
+        rstrcpy( orphanInfo.dataType, failed[i].data_type_.c_str(), NAME_LEN );
+        orphanInfo.dataSize = failed[i].data_size_;
+        _rsRmCollRegOrphan( rsComm, &orphanInfo );
+    }
+    failed.clear();
+}
+
+/* unlink the file of a replica whose catalog row is being removed, on
+ * the delete workers if there are any. the checks of l3Unlink are made
+ * here so that the workers only unlink. returns the error of a file
+ * which is left and should be kept as an orphan, once the removal of
+ * the batch is committed */
+static int
+_rsRmCollUnlinkReplica( rsComm_t *rsComm,
+                        irods::coll_unlink_scheduler *unlinker,
+                        dataObjInfo_t *dataObjInfo ) {
+    int status;
+
+    if ( unlinker != NULL ) {
+        std::string resc_class;
+        std::string location;
+        irods::error ret = irods::get_resource_property<std::string>(
+                               dataObjInfo->rescName,
+                               irods::RESOURCE_CLASS,
+                               resc_class );
+        if ( ret.ok() && resc_class == irods::RESOURCE_CLASS_BUNDLE ) {
+            return 0;
+        }
+        if ( ret.ok() ) {
+            ret = irods::get_loc_for_hier_string( dataObjInfo->rescHier, location );
+        }
+        if ( ret.ok() ) {
+            ret = irods::is_hier_live( dataObjInfo->rescHier );
+        }
+        if ( ret.ok() ) {
+            irods::coll_unlink_job job;
+            job.obj_path_  = dataObjInfo->objPath;
+            job.file_path_ = dataObjInfo->filePath;
+            job.resc_name_ = dataObjInfo->rescName;
+            job.resc_hier_ = dataObjInfo->rescHier;
+            job.location_  = location;
+            job.data_type_ = dataObjInfo->dataType;
+            job.data_size_ = dataObjInfo->dataSize;
+            job.status_    = 0;
+            unlinker->submit( job );
+            return 0;
+        }
+        irods::log( PASSMSG( "_rsRmCollUnlinkReplica - cannot unlink file", ret ) );
+        status = ret.code();
+    }
+    else {
+        status = l3Unlink( rsComm, dataObjInfo );
+    }
+
+    if ( status < 0 ) {
+        int myError = getErrno( status );
+        rodsLog( LOG_NOTICE,
+                 "_rsRmCollUnlinkReplica: unlink error for %s. status = %d",
+                 dataObjInfo->objPath, status );
+        if ( myError != ENOENT && myError != EACCES ) {
+            return status;
+        }
+    }
+
+    return 0;
+}
+
+/* remove the data objects and collections below rmCollInp from the
+ * catalog in batches of batchSize objects. the files of a batch are
+ * unlinked on the delete workers before its removal is committed, so an
+ * agent which dies part way leaves catalog rows, which the next delete
+ * removes, rather than files no row points to. whatever the catalog
+ * leaves, e.g. bundles, mount points or objects the client may not
+ * delete, is left to the walk in _rsPhyRmColl, as is everything if the
+ * catalog is remote */
+static int
+_rsPhyRmCollBulk( rsComm_t *rsComm, collInp_t *rmCollInp, int batchSize,
+                  collOprStat_t **collOprStat ) {
+#ifdef RODS_CAT
+    rodsServerHost_t *rodsServerHost = NULL;
+    collInfo_t collInfo;
+    dataObjInfo_t *removed;
+    dataObjInfo_t *tmpDataObjInfo;
+    int status;
+
+    status = getAndConnRcatHost(
+                 rsComm,
+                 MASTER_RCAT,
+                 ( const char* )rmCollInp->collName,
+                 &rodsServerHost );
+    if ( status < 0 || NULL == rodsServerHost ||
+            rodsServerHost->localFlag != LOCAL_HOST ) {
+        return 0;
+    }
+
+    memset( &collInfo, 0, sizeof( collInfo ) );
+    rstrcpy( collInfo.collName, rmCollInp->collName, MAX_NAME_LEN );
+    if ( getValByKey( &rmCollInp->condInput, ADMIN_RMTRASH_KW ) != NULL ) {
+        addKeyVal( &collInfo.condInput, ADMIN_RMTRASH_KW, "" );
+    }
+
+    irods::coll_unlink_scheduler scheduler( rsComm );
+    irods::coll_unlink_scheduler *unlinker = &scheduler;
+    status = scheduler.start();
+    if ( status < 0 ) {
+        rodsLogError( LOG_NOTICE, status,
+                      "_rsPhyRmCollBulk: no delete workers for %s, unlinking inline",
+                      rmCollInp->collName );
+        unlinker = NULL;
+    }
+
+    int savedStatus = 0;
+    while ( 1 ) {
+        removed = NULL;
+        status = chlDelCollTreeBatch( rsComm, &collInfo, batchSize, &removed );
+        if ( status < 0 ) {
+            /* what is left is removed one object at a time */
+            if ( status != CAT_COLLECTION_NOT_EMPTY ) {
+                rodsLogError( LOG_NOTICE, status,
+                              "_rsPhyRmCollBulk: chlDelCollTreeBatch failed for %s",
+                              rmCollInp->collName );
+            }
+            break;
+        }
+        if ( removed == NULL ) {
+            break;
+        }
+
+        std::set< rodsLong_t > dataIds;
+        std::vector< dataObjInfo_t* > orphans;
+        for ( tmpDataObjInfo = removed; tmpDataObjInfo != NULL;
+                tmpDataObjInfo = tmpDataObjInfo->next ) {
+            if ( _rsRmCollUnlinkReplica( rsComm, unlinker, tmpDataObjInfo ) < 0 ) {
+                orphans.push_back( tmpDataObjInfo );
+            }
+            dataIds.insert( tmpDataObjInfo->dataId );
+        }
+
+        std::vector< irods::coll_unlink_job > failed;
+        if ( unlinker != NULL ) {
+            unlinker->drain( failed );
+        }
+
+        status = chlCommit( rsComm );
+        if ( status < 0 ) {
+            rodsLogError( LOG_ERROR, status,
+                          "_rsPhyRmCollBulk: commit failed for %s, the files of %d replicas are unlinked but their rows are left",
+                          rmCollInp->collName, ( int )( dataIds.size() ) );
+            chlRollback( rsComm );
+            savedStatus = status;
+            freeAllDataObjInfo( removed );
+            break;
+        }
+
+        /* registering an orphan commits, so only now */
+        for ( size_t i = 0; i < orphans.size(); ++i ) {
+            _rsRmCollRegOrphan( rsComm, orphans[i] );
+        }
+        _rsRmCollRegOrphanJobs( rsComm, failed );
+
+        if ( collOprStat != NULL ) {
+            ( *collOprStat )->filesCnt += dataIds.size();
+            if ( ( *collOprStat )->filesCnt >= FILE_CNT_PER_STAT_OUT ) {
+                rstrcpy( ( *collOprStat )->lastObjPath, removed->objPath,
+                         MAX_NAME_LEN );
+                status = svrSendCollOprStat( rsComm, *collOprStat );
+                if ( status < 0 ) {
+                    rodsLogError( LOG_ERROR, status,
+                                  "_rsPhyRmCollBulk: svrSendCollOprStat failed for %s. status = %d",
+                                  rmCollInp->collName, status );
+                    *collOprStat = NULL;
+                    savedStatus = status;
+                    freeAllDataObjInfo( removed );
+                    break;
+                }
+                *collOprStat = ( collOprStat_t* )malloc( sizeof( collOprStat_t ) );
+                memset( *collOprStat, 0, sizeof( collOprStat_t ) );
+            }
+        }
+        freeAllDataObjInfo( removed );
+    }
+
+    std::vector< irods::coll_unlink_job > failed;
+    scheduler.finish( failed );
+    _rsRmCollRegOrphanJobs( rsComm, failed );
+    clearKeyVal( &collInfo.condInput );
+
+    return savedStatus;
+#else
+    return 0;
+#endif
+}
+
 int
 _rsPhyRmColl( rsComm_t *rsComm, collInp_t *rmCollInp,
               dataObjInfo_t *dataObjInfo, collOprStat_t **collOprStat ) {
@@ -275,6 +536,24 @@ _rsPhyRmColl( rsComm_t *rsComm, collInp_t *rmCollInp,
         addKeyVal( &tmpCollInp.condInput, EMPTY_BUNDLE_ONLY_KW, "" );
         addKeyVal( &dataObjInp.condInput, EMPTY_BUNDLE_ONLY_KW, "" );
     }
+    // =-=-=-=-=-=-=-
+    // remove what the catalog can in batches first. the walk below sees
+    // only what is left, as the collection is not read until then
+    int batchSize = getCollDeleteBatchSize();
+    if ( batchSize > 0 && rmCollInp->oprType != UNREG_OPR &&
+            getValByKey( &rmCollInp->condInput, AGE_KW ) == NULL &&
+            getValByKey( &rmCollInp->condInput, EMPTY_BUNDLE_ONLY_KW ) == NULL &&
+            ( dataObjInfo == NULL || dataObjInfo->specColl == NULL ) &&
+            !isHomeColl( rmCollInp->collName ) ) {
+        status = _rsPhyRmCollBulk( rsComm, rmCollInp, batchSize, collOprStat );
+        if ( status < 0 ) {
+            rsCloseCollection( rsComm, &handleInx );
+            clearKeyVal( &tmpCollInp.condInput );
+            clearKeyVal( &dataObjInp.condInput );
+            return status;
+        }
+    }
+
     // =-=-=-=-=-=-=-
     collEnt_t *collEnt = NULL;
     while ( ( status = rsReadCollection( rsComm, &handleInx, &collEnt ) ) >= 0 ) {
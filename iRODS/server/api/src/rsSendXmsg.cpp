@@ -8,7 +8,6 @@
 
 
 extern ticketHashQue_t XmsgHashQue[];
-extern xmsgQue_t XmsgQue;
 
 int
 rsSendXmsg( rsComm_t *rsComm, sendXmsgInp_t *sendXmsgInp ) {
@@ -17,6 +16,10 @@ rsSendXmsg( rsComm_t *rsComm, sendXmsgInp_t *sendXmsgInp ) {
     irodsXmsg_t *irodsXmsg;
     char *miscInfo;
 
+    /* held until the message is queued or the stream is changed */
+    boost::mutex::scoped_lock lock(
+        ticketHashSlotMutex( sendXmsgInp->ticket.rcvTicket ) );
+
     status = getTicketMsgStructByTicket( sendXmsgInp->ticket.rcvTicket,
                                          &ticketMsgStruct );
 
@@ -998,6 +998,24 @@ irods::error load_version_file(
 } // load_version_file
 
 
+irods::error get_l1desc_table_stats(
+    json_t*& _l1desc ) {
+    _l1desc = json_object();
+    if ( !_l1desc ) {
+        return ERROR(
+                   SYS_MALLOC_ERR,
+                   "allocation of json_object failed" );
+    }
+
+    irods::l1desc_table::stats stats = L1desc.get_stats();
+    json_object_set( _l1desc, "size",            json_integer( stats.size ) );
+    json_object_set( _l1desc, "in_use",          json_integer( stats.in_use ) );
+    json_object_set( _l1desc, "high_water_mark", json_integer( stats.high_water_mark ) );
+
+    return SUCCESS();
+
+} // get_l1desc_table_stats
+
 #ifdef RODS_CAT
 irods::error get_database_config(
     json_t*& _db_cfg ) {
@@ -1160,6 +1178,13 @@ int _rsServerReport(
     }
     json_object_set( resc_svr, "configuration_directory", cfg_dir );
 
+    json_t* l1desc = 0;
+    ret = get_l1desc_table_stats( l1desc );
+    if ( !ret.ok() ) {
+        irods::log( PASS( ret ) );
+    }
+    json_object_set( resc_svr, "l1desc_table", l1desc );
+
 #ifdef RODS_CAT
 
     json_t* db_cfg = 0;
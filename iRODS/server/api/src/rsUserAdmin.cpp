@@ -7,6 +7,8 @@
 #include "userAdmin.h"
 #include "reGlobalsExtern.hpp"
 #include "icatHighLevelRoutines.hpp"
+#include "rcMisc.h"
+#include "irods_auth_session_cache.hpp"
 
 int
 rsUserAdmin( rsComm_t *rsComm, userAdminInp_t *userAdminInp ) {
@@ -88,6 +90,13 @@ _rsUserAdmin( rsComm_t *rsComm, userAdminInp_t *userAdminInp ) {
         if ( status != 0 ) {
             chlRollback( rsComm );
         }
+        else {
+            char userName[NAME_LEN];
+            char zoneName[NAME_LEN];
+            if ( parseUserName( userAdminInp->arg1, userName, zoneName ) == 0 ) {
+                irods::auth_session_cache::revoke( userName, zoneName );
+            }
+        }
 
         status2 = applyRuleArg( "acPostProcForModifyUser", args, argc,
                                 &rei2, NO_SAVE_REI );
@@ -40,6 +40,8 @@ logFileOpen( int runMode, const char *logDir, const char *logFileName );
 int
 initRsCommWithStartupPack( rsComm_t *rsComm, startupPack_t *startupPack );
 int
+setStartupPackEnv( int newSock, startupPack_t *startupPack );
+int
 initConnectControl();
 int
 chkAllowedUser( const char *userName, const char *rodsZone );
@@ -19,6 +19,7 @@
 
 #define RE_SERVER_SLEEP_TIME    30
 #define RE_SERVER_EXEC_TIME     120
+#define RE_SERVER_POLL_TIME     1	/* sec between queue passes while busy */
 
 uint CoreIrbTimeStamp = 0;
 
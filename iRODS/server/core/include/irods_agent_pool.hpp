@@ -0,0 +1,123 @@
+#ifndef IRODS_AGENT_POOL_HPP
+#define IRODS_AGENT_POOL_HPP
+
+#include "rodsDef.h"
+#include "irods_error.hpp"
+
+#include <sys/time.h>
+#include <list>
+#include <vector>
+#include <boost/thread/mutex.hpp>
+
+namespace irods {
+
+    /// =-=-=-=-=-=-=-
+    /// @brief default values for the agent pool advanced settings.  a
+    ///        pool size of zero disables the pool and the server falls
+    ///        back to a fork and exec of a new agent per connection
+    static const int DEFAULT_AGENT_POOL_SIZE = 0;
+    static const int DEFAULT_AGENT_POOL_MAX_REQUESTS = 1;
+
+    /// =-=-=-=-=-=-=-
+    /// @brief a warm pool of pre-initialized irodsAgent processes.  the
+    ///        server forks and execs the agents ahead of time, and each
+    ///        agent loads its configuration and plugins before reporting
+    ///        ready over a unix domain socket.  accepted client sockets
+    ///        are then handed to an idle agent via SCM_RIGHTS.
+    class agent_pool {
+        public:
+            /// =-=-=-=-=-=-=-
+            /// @brief counters reported by the server control plane
+            struct statistics {
+                int    pool_size;
+                int    max_requests_per_agent;
+                int    idle;
+                int    busy;
+                size_t spawned;
+                size_t dispatched;
+                size_t recycled;
+                size_t fallbacks;
+                double mean_startup_ms;
+                double max_startup_ms;
+            };
+
+            static agent_pool& instance();
+
+            /// =-=-=-=-=-=-=-
+            /// @brief read the pool size and recycling limit from the
+            ///        advanced settings of server_config.json
+            error configure();
+            bool enabled();
+
+            /// =-=-=-=-=-=-=-
+            /// @brief fork and exec agents until the pool is full
+            error replenish();
+
+            /// =-=-=-=-=-=-=-
+            /// @brief collect ready notifications from the agents. pids
+            ///        of agents which finished a connection and returned
+            ///        to the pool are appended to _recycled
+            error poll( std::vector<int>& _recycled );
+
+            /// =-=-=-=-=-=-=-
+            /// @brief hand an accepted socket and its startup pack to an
+            ///        idle agent. fails with SYS_NO_AGENT_POOL_SLOT_ERR if
+            ///        no agent is ready so the caller may spawn one instead
+            error dispatch( int _sock, startupPack_t* _pack, int& _pid );
+
+            /// =-=-=-=-=-=-=-
+            /// @brief forget an agent which has exited.  returns true if
+            ///        the pid belonged to the pool
+            bool reap( int _pid );
+
+            /// =-=-=-=-=-=-=-
+            /// @brief close all control sockets, idle agents exit on eof
+            void shutdown();
+
+            statistics stats();
+
+            /// =-=-=-=-=-=-=-
+            /// @brief agent side of the protocol
+            static error get_settings( int& _size, int& _max_requests );
+            static error signal_ready( int _ctrl_sock, int _served );
+            static error wait_for_connection(
+                int            _ctrl_sock,
+                int&           _sock,
+                startupPack_t& _pack );
+
+        private:
+            struct pooled_agent {
+                int            pid;
+                int            ctrl_sock;
+                struct timeval spawn_time;
+                bool           started;
+                bool           ready;
+            };
+
+            agent_pool();
+            agent_pool( const agent_pool& );
+            agent_pool& operator=( const agent_pool& );
+
+            error spawn( pooled_agent& _agent );
+            void  drain();
+
+            boost::mutex            mutex_;
+            bool                    configured_;
+            int                     pool_size_;
+            int                     max_requests_;
+            std::list<pooled_agent> agents_;
+            std::vector<int>        recycled_;
+
+            size_t spawned_;
+            size_t dispatched_;
+            size_t recycled_cnt_;
+            size_t fallbacks_;
+            size_t startup_cnt_;
+            double startup_total_ms_;
+            double startup_max_ms_;
+
+    }; // class agent_pool
+
+}; // namespace irods
+
+#endif // IRODS_AGENT_POOL_HPP
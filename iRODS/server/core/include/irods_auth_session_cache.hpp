@@ -0,0 +1,74 @@
+#ifndef IRODS_AUTH_SESSION_CACHE_HPP
+#define IRODS_AUTH_SESSION_CACHE_HPP
+
+#include "irods_error.hpp"
+
+#include <string>
+
+namespace irods {
+
+    /// =-=-=-=-=-=-=-
+    /// @brief default for authentication_session_lifetime_in_seconds.
+    ///        zero disables the cache
+    static const int DEFAULT_AUTH_SESSION_LIFETIME = 300;
+
+    /// =-=-=-=-=-=-=-
+    /// @brief the sessions of users who logged in to this catalog server,
+    ///        kept in a shared memory segment so that a client may resume
+    ///        one on a new connection, to any agent, without the password
+    ///        check against the catalog.
+    ///
+    ///        a session is handed to the client as a token naming its slot
+    ///        in the table and when it expires, signed with a secret drawn
+    ///        when the segment is created.  a token is only good until its
+    ///        session is revoked, which a change to or removal of the user
+    ///        does, or is pushed out of the table by newer sessions
+    class auth_session_cache {
+        public:
+            /// =-=-=-=-=-=-=-
+            /// @brief true if authentication_session_lifetime_in_seconds is
+            ///        above zero
+            static bool enabled();
+
+            /// =-=-=-=-=-=-=-
+            /// @brief the number of revocations so far, to be read before
+            ///        the credentials of a user are checked
+            static unsigned int generation();
+
+            /// =-=-=-=-=-=-=-
+            /// @brief start a session for a user who has authenticated.
+            ///        _generation is what generation returned before the
+            ///        check, and the session is refused if a user has been
+            ///        revoked since
+            static error issue(
+                const std::string& _user,
+                const std::string& _zone,
+                int                _priv_level,
+                unsigned int       _generation,
+                std::string&       _token );
+
+            /// =-=-=-=-=-=-=-
+            /// @brief check a token presented for the user, and get the
+            ///        privilege level the user logged in with
+            static error resume(
+                const std::string& _token,
+                const std::string& _user,
+                const std::string& _zone,
+                int&               _priv_level );
+
+            /// =-=-=-=-=-=-=-
+            /// @brief end the sessions of a user, of any zone if _zone is
+            ///        empty.  called once a change to the user is committed
+            static void revoke(
+                const std::string& _user,
+                const std::string& _zone );
+
+            /// =-=-=-=-=-=-=-
+            /// @brief remove the segment, when the server exits
+            static void remove();
+
+    }; // class auth_session_cache
+
+}; // namespace irods
+
+#endif // IRODS_AUTH_SESSION_CACHE_HPP
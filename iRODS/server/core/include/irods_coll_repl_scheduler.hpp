@@ -0,0 +1,135 @@
+#ifndef IRODS_COLL_REPL_SCHEDULER_HPP
+#define IRODS_COLL_REPL_SCHEDULER_HPP
+
+#include "rodsDef.h"
+#include "rcConnect.h"
+#include "objInfo.h"
+
+#include <string>
+#include <deque>
+#include <map>
+#include <vector>
+
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition.hpp>
+
+namespace irods {
+
+    /// =-=-=-=-=-=-=-
+    /// @brief default for maximum_number_of_collection_replication_workers
+    static const int DEFAULT_MAX_COLL_REPL_WORKERS = 8;
+
+    /// =-=-=-=-=-=-=-
+    /// @brief default for
+    ///        maximum_number_of_concurrent_replications_per_resource
+    static const int DEFAULT_MAX_REPLS_PER_RESC = 4;
+
+    /// =-=-=-=-=-=-=-
+    /// @brief one data object to be replicated
+    struct coll_repl_job {
+        std::string path_;
+        std::string src_resc_;
+    };
+
+    /// =-=-=-=-=-=-=-
+    /// @brief replicates the data objects of a collection over a pool of
+    ///        connections from the agent to its own server, one object per
+    ///        connection at a time.  each object is replicated by the
+    ///        agent at the other end of its connection, so a large object
+    ///        still gets its own multi-stream copy.
+    ///
+    ///        a job runs only while fewer than
+    ///        maximum_number_of_concurrent_replications_per_resource jobs
+    ///        of this scheduler read from its source resource or write to
+    ///        its destination, so a slow vault does not get every worker.
+    ///        the counts are per request, not per server: two recursive
+    ///        replications at once may each reach the limit.  the walk of the
+    ///        collection and the progress reports stay with the caller,
+    ///        which owns the client connection
+    class coll_repl_scheduler {
+        public:
+            coll_repl_scheduler(
+                rsComm_t*     _comm,
+                keyValPair_t* _cond_input,
+                int           _workers );
+            ~coll_repl_scheduler();
+
+            /// =-=-=-=-=-=-=-
+            /// @brief the number of workers a request for _requested gets,
+            ///        within maximum_number_of_collection_replication_workers
+            static int workers_for( int _requested );
+
+            /// =-=-=-=-=-=-=-
+            /// @brief connect the workers and start their threads.  returns
+            ///        the number started, or an error if none could connect
+            int start();
+
+            /// =-=-=-=-=-=-=-
+            /// @brief queue a job, waiting while the queue is full.  false
+            ///        once a job has failed and no more should be queued.
+            ///        a replica which already existed is not a failure
+            bool submit( const coll_repl_job& _job );
+
+            /// =-=-=-=-=-=-=-
+            /// @brief take the count and bytes of the jobs completed since
+            ///        the last call, waiting up to _wait_ms for one if none
+            ///        has.  _last is the path of the latest
+            int completed(
+                int          _wait_ms,
+                rodsLong_t&  _bytes,
+                std::string& _last );
+
+            /// =-=-=-=-=-=-=-
+            /// @brief drop the queued jobs, e.g. once the client has gone.
+            ///        the running ones are left to finish
+            void cancel();
+
+            /// =-=-=-=-=-=-=-
+            /// @brief true while jobs are queued or running
+            bool busy();
+
+            /// =-=-=-=-=-=-=-
+            /// @brief stop the workers once the queue is empty.  returns
+            ///        the first error, or SYS_COPY_ALREADY_IN_RESC if a
+            ///        replica already existed
+            int finish();
+
+        private:
+            struct worker {
+                int            idx_;
+                rcComm_t*      conn_;
+                boost::thread* thread_;
+            };
+
+            void run( worker* _w );
+            bool take( coll_repl_job& _job );
+            void release( const coll_repl_job& _job );
+
+            rsComm_t*              comm_;
+            keyValPair_t           cond_input_;
+            int                    requested_;
+            int                    per_resc_;
+            std::string            dest_resc_;
+            std::vector< worker* > workers_;
+
+            boost::mutex                 mutex_;
+            boost::condition             work_;
+            boost::condition             room_;
+            boost::condition             done_cond_;
+            std::deque< coll_repl_job >  jobs_;
+            std::map< std::string, int > src_running_;
+            int                          dest_running_;
+            int                          running_;
+            bool                         done_;
+            int                          status_;
+            bool                         already_in_resc_;
+            int                          completed_;
+            rodsLong_t                   bytes_;
+            std::string                  last_;
+
+    }; // class coll_repl_scheduler
+
+}; // namespace irods
+
+#endif // IRODS_COLL_REPL_SCHEDULER_HPP
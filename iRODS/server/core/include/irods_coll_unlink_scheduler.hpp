@@ -0,0 +1,107 @@
+#ifndef IRODS_COLL_UNLINK_SCHEDULER_HPP
+#define IRODS_COLL_UNLINK_SCHEDULER_HPP
+
+#include "rodsDef.h"
+#include "rcConnect.h"
+#include "objInfo.h"
+
+#include <string>
+#include <deque>
+#include <map>
+#include <vector>
+
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition.hpp>
+
+namespace irods {
+
+    /// =-=-=-=-=-=-=-
+    /// @brief default for collection_delete_batch_size, zero removes a
+    ///        collection one data object at a time
+    static const int DEFAULT_COLLECTION_DELETE_BATCH_SIZE = 0;
+
+    /// =-=-=-=-=-=-=-
+    /// @brief default for maximum_number_of_collection_delete_workers
+    static const int DEFAULT_MAX_COLL_DELETE_WORKERS = 4;
+
+    /// =-=-=-=-=-=-=-
+    /// @brief the file of one replica whose catalog row is gone
+    struct coll_unlink_job {
+        std::string obj_path_;
+        std::string file_path_;
+        std::string resc_name_;
+        std::string resc_hier_;
+        std::string location_;
+        std::string data_type_;
+        rodsLong_t  data_size_;
+        int         status_;
+    };
+
+    /// =-=-=-=-=-=-=-
+    /// @brief unlinks the files of a collection removed from the catalog
+    ///        in batches, over a pool of connections from the agent to its
+    ///        own server.  the files of each resource hierarchy are queued
+    ///        apart and a free worker takes from the one with the fewest
+    ///        unlinks running, so the workers spread over the vaults.
+    ///
+    ///        the caller waits for the files of a batch with drain before
+    ///        it commits the removal of their rows.  the files which could
+    ///        not be unlinked are returned by drain and finish, to be
+    ///        registered as orphans once the batch is committed
+    class coll_unlink_scheduler {
+        public:
+            coll_unlink_scheduler( rsComm_t* _comm );
+            ~coll_unlink_scheduler();
+
+            /// =-=-=-=-=-=-=-
+            /// @brief connect the workers and start their threads.  returns
+            ///        the number started, or an error if none could connect
+            int start();
+
+            /// =-=-=-=-=-=-=-
+            /// @brief queue a file, waiting while the queue is full
+            void submit( const coll_unlink_job& _job );
+
+            /// =-=-=-=-=-=-=-
+            /// @brief wait for the queued files, leaving the workers for
+            ///        the next batch.  _failed gets the jobs whose files
+            ///        are left, with their status
+            void drain( std::vector< coll_unlink_job >& _failed );
+
+            /// =-=-=-=-=-=-=-
+            /// @brief wait for the queued files.  _failed gets the jobs
+            ///        whose files are left, with their status
+            void finish( std::vector< coll_unlink_job >& _failed );
+
+        private:
+            struct worker {
+                int            idx_;
+                rcComm_t*      conn_;
+                boost::thread* thread_;
+            };
+
+            typedef std::map< std::string, std::deque< coll_unlink_job > > queue_map_t;
+
+            void run( worker* _w );
+            bool take( coll_unlink_job& _job );
+
+            rsComm_t*              comm_;
+            std::vector< worker* > workers_;
+
+            boost::mutex                         mutex_;
+            boost::condition                     work_;
+            boost::condition                     room_;
+            boost::condition                     idle_;
+            queue_map_t                          queues_;
+            std::map< std::string, int >         running_;
+            size_t                               queued_;
+            size_t                               active_;
+            bool                                 done_;
+            std::vector< coll_unlink_job >       failed_;
+
+    }; // class coll_unlink_scheduler
+
+}; // namespace irods
+
+#endif // IRODS_COLL_UNLINK_SCHEDULER_HPP
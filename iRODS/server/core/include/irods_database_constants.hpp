@@ -18,6 +18,7 @@ namespace irods {
     const std::string DATABASE_OP_UPDATE_RESC_OBJ_COUNT( "database_update_resc_obj_count" );
     const std::string DATABASE_OP_MOD_DATA_OBJ_META( "database_mod_data_obj_meta" );
     const std::string DATABASE_OP_REG_DATA_OBJ( "database_reg_data_obj" );
+    const std::string DATABASE_OP_REG_DATA_OBJ_BATCH( "database_reg_data_obj_batch" );
     const std::string DATABASE_OP_REG_REPLICA( "database_reg_replica" );
     const std::string DATABASE_OP_UNREG_REPLICA( "database_unreg_replica" );
     const std::string DATABASE_OP_REG_RULE_EXEC( "database_reg_rule_exec" );
@@ -42,6 +43,7 @@ namespace irods {
     const std::string DATABASE_OP_GENERAL_UPDATE( "database_general_update" );
     const std::string DATABASE_OP_DEL_COLL_BY_ADMIN( "database_del_coll_by_admin" );
     const std::string DATABASE_OP_DEL_COLL( "database_del_coll" );
+    const std::string DATABASE_OP_DEL_COLL_TREE_BATCH( "database_del_coll_tree_batch" );
     const std::string DATABASE_OP_CHECK_AUTH( "database_check_auth" );
     const std::string DATABASE_OP_MAKE_TEMP_PW( "database_make_tmp_pw" );
     const std::string DATABASE_OP_MAKE_LIMITED_PW( "database_make_limited_pw" );
@@ -80,6 +82,7 @@ namespace irods {
     const std::string DATABASE_OP_PURGE_SERVER_LOAD_DIGEST( "database_purge_server_load_digest" );
 
     const std::string DATABASE_OP_CALC_USAGE_AND_QUOTA( "database_calc_usage_and_quota" );
+    const std::string DATABASE_OP_RECONCILE_QUOTA_USAGE( "database_reconcile_quota_usage" );
     const std::string DATABASE_OP_SET_QUOTA( "database_set_quota" );
     const std::string DATABASE_OP_CHECK_QUOTA( "database_check_quota" );
 
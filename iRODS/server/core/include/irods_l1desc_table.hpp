@@ -0,0 +1,80 @@
+#ifndef IRODS_L1DESC_TABLE_HPP
+#define IRODS_L1DESC_TABLE_HPP
+
+#include "objDesc.hpp"
+
+#include <vector>
+
+namespace irods {
+
+    /// =-=-=-=-=-=-=-
+    /// @brief number of descriptors added each time the table grows
+    static const int L1DESC_TABLE_CHUNK_SIZE = 1024;
+
+    /// =-=-=-=-=-=-=-
+    /// @brief first descriptor handed out, 0 - 2 are never used
+    static const int L1DESC_TABLE_FIRST_INDEX = 3;
+
+    /// =-=-=-=-=-=-=-
+    /// @brief the L1 descriptor table of an agent.  descriptors are kept
+    ///        in fixed size chunks which are added as needed and never
+    ///        moved, so an index and a reference to its l1desc_t stay
+    ///        valid while the table grows.  freed indices go on a free
+    ///        list and are handed out again first.
+    class l1desc_table {
+        public:
+            /// =-=-=-=-=-=-=-
+            /// @brief counters reported by rsServerReport
+            struct stats {
+                int size;
+                int in_use;
+                int high_water_mark;
+            };
+
+            l1desc_table();
+            ~l1desc_table();
+
+            /// =-=-=-=-=-=-=-
+            /// @brief the descriptor at _idx, which must be below size()
+            l1desc_t& operator[]( int _idx ) {
+                return chunks_[ _idx / L1DESC_TABLE_CHUNK_SIZE ][ _idx % L1DESC_TABLE_CHUNK_SIZE ];
+            }
+
+            /// =-=-=-=-=-=-=-
+            /// @brief one past the highest index handed out so far, the
+            ///        bound for range checks and scans of the table
+            int size() const {
+                return next_;
+            }
+
+            /// =-=-=-=-=-=-=-
+            /// @brief mark a free descriptor in use and return its index,
+            ///        growing the table if none is free
+            int alloc();
+
+            /// =-=-=-=-=-=-=-
+            /// @brief return _idx to the free list.  the caller has
+            ///        already cleared the descriptor
+            void release( int _idx );
+
+            /// =-=-=-=-=-=-=-
+            /// @brief drop all descriptors, the high water mark is kept
+            void clear();
+
+            stats get_stats() const;
+
+        private:
+            l1desc_table( const l1desc_table& );
+            l1desc_table& operator=( const l1desc_table& );
+
+            std::vector< l1desc_t* > chunks_;
+            std::vector< int >       free_;
+            int                      next_;
+            int                      in_use_;
+            int                      high_water_mark_;
+
+    }; // class l1desc_table
+
+}; // namespace irods
+
+#endif // IRODS_L1DESC_TABLE_HPP
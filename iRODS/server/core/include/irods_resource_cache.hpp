@@ -0,0 +1,70 @@
+#ifndef IRODS_RESOURCE_CACHE_HPP
+#define IRODS_RESOURCE_CACHE_HPP
+
+#include "rodsType.h"
+#include "rodsGenQuery.h"
+#include "irods_error.hpp"
+
+#include <vector>
+
+namespace irods {
+
+    /// =-=-=-=-=-=-=-
+    /// @brief default for resource_cache_lifetime_in_seconds.  zero
+    ///        disables the cache
+    static const int DEFAULT_RESOURCE_CACHE_LIFETIME = 60;
+
+    /// =-=-=-=-=-=-=-
+    /// @brief the R_RESC_MAIN rows the resource manager builds its table
+    ///        from, kept in a shared memory segment so that agents do not
+    ///        each run the query.  the first process on a host to read the
+    ///        rows from the catalog publishes them, packed as GenQueryOut_PI
+    ///        pages, and later processes map the segment read only.
+    ///
+    ///        every publication carries a generation, so a process whose
+    ///        table was built from the current generation may keep it.  a
+    ///        change to a resource made through this host bumps a shared
+    ///        invalidation count, and a publication older than the count or
+    ///        than resource_cache_lifetime_in_seconds is replaced by the next
+    ///        reader.  the lifetime bounds how long other servers in the
+    ///        zone, whose segments are not told of the change, keep old rows
+    class resource_cache {
+        public:
+            /// =-=-=-=-=-=-=-
+            /// @brief true if resource_cache_lifetime_in_seconds is above zero
+            static bool enabled();
+
+            /// =-=-=-=-=-=-=-
+            /// @brief the current invalidation count, to be taken before
+            ///        the catalog is queried and handed to publish
+            static unsigned int invalidation_count();
+
+            /// =-=-=-=-=-=-=-
+            /// @brief unpack the published pages.  fails if there is no
+            ///        usable publication.  the caller frees the pages
+            static error fetch(
+                std::vector< genQueryOut_t* >& _pages,
+                rodsULong_t&                   _generation );
+
+            /// =-=-=-=-=-=-=-
+            /// @brief publish packed pages read from the catalog while the
+            ///        invalidation count was _count, unless a current
+            ///        publication already exists
+            static error publish(
+                unsigned int                       _count,
+                const std::vector< bytesBuf_t* >& _pages,
+                rodsULong_t&                       _generation );
+
+            /// =-=-=-=-=-=-=-
+            /// @brief called once a change to a resource is committed
+            static void invalidate();
+
+            /// =-=-=-=-=-=-=-
+            /// @brief remove the segments, when the server exits
+            static void remove();
+
+    }; // class resource_cache
+
+}; // namespace irods
+
+#endif // IRODS_RESOURCE_CACHE_HPP
@@ -151,10 +151,19 @@ namespace irods {
             iterator end()   { return resources_.end();   }
 
         private:
+            // =-=-=-=-=-=-=-
+            /// @brief query the catalog for the resources and publish the
+            //         rows to the other agents
+            error init_from_query( rsComm_t* );
+
             // =-=-=-=-=-=-=-
             /// @brief take results from genQuery, extract values and create resources
             error process_init_results( genQueryOut_t* );
 
+            // =-=-=-=-=-=-=-
+            /// @brief set the server host of each resource from the current host list
+            error resolve_resource_hosts( void );
+
             // =-=-=-=-=-=-=-
             /// @brief Initialize the child map from the resources lookup table
             error init_child_map( void );
@@ -183,6 +192,7 @@ namespace irods {
             // Attributes
             lookup_table< resource_ptr >            resources_;
             std::vector< std::vector< pdmo_type > > maintenance_operations_;
+            rodsULong_t                             generation_; // of the resource cache the table was built from
 
     }; // class resource_manager
 
@@ -0,0 +1,50 @@
+#ifndef IRODS_ROUND_ROBIN_CURSOR_HPP
+#define IRODS_ROUND_ROBIN_CURSOR_HPP
+
+#include "rodsType.h"
+#include "irods_error.hpp"
+
+#include <string>
+
+namespace irods {
+
+    /// =-=-=-=-=-=-=-
+    /// @brief default for round_robin_context_update_interval.  zero
+    ///        never writes the next child to the catalog
+    static const int DEFAULT_ROUND_ROBIN_CONTEXT_UPDATE_INTERVAL = 1000;
+
+    /// =-=-=-=-=-=-=-
+    /// @brief the positions of the round robin resources, kept in a shared
+    ///        memory segment so that the agents on a server take turns
+    ///        without writing the next child to the catalog on every
+    ///        create.  a position is a counter taken with an atomic add,
+    ///        started from the next child in the catalog the first time a
+    ///        resource is seen on this server.
+    ///
+    ///        positions are kept by name and are not freed when a resource
+    ///        is removed or renamed, so the table can fill up on a server
+    ///        which runs long enough.  next then fails and the resource
+    ///        falls back to the position held by each agent
+    class round_robin_cursor {
+        public:
+            /// =-=-=-=-=-=-=-
+            /// @brief take the next position of a resource
+            static error next(
+                const std::string& _resc_name,
+                rodsULong_t        _seed,
+                rodsULong_t&       _position );
+
+            /// =-=-=-=-=-=-=-
+            /// @brief the number of creates between writes of the next
+            ///        child to the catalog
+            static int context_update_interval();
+
+            /// =-=-=-=-=-=-=-
+            /// @brief remove the segment, when the server exits
+            static void remove();
+
+    }; // class round_robin_cursor
+
+}; // namespace irods
+
+#endif // IRODS_ROUND_ROBIN_CURSOR_HPP
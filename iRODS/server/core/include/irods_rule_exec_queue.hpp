@@ -0,0 +1,145 @@
+#ifndef IRODS_RULE_EXEC_QUEUE_HPP
+#define IRODS_RULE_EXEC_QUEUE_HPP
+
+#include "rodsDef.h"
+#include "rcConnect.h"
+#include "irods_error.hpp"
+
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+
+namespace irods {
+
+    /// =-=-=-=-=-=-=-
+    /// @brief default for rule_engine_server_queue_resync_in_seconds
+    static const int DEFAULT_RULE_EXEC_QUEUE_RESYNC = 60;
+
+    /// =-=-=-=-=-=-=-
+    /// @brief seconds within which a rule exec row is expected to be
+    ///        committed once its id is taken
+    static const int RULE_EXEC_ID_SETTLE = 10;
+
+    /// =-=-=-=-=-=-=-
+    /// @brief the priority of a delayed rule with no numeric PRI hint
+    static const int DEFAULT_RULE_EXEC_PRIORITY = 5;
+
+    /// =-=-=-=-=-=-=-
+    /// @brief one R_RULE_EXEC row
+    struct rule_exec_entry {
+        rodsLong_t  id_;
+        std::string id_str_;
+        std::string name_;
+        std::string rei_file_path_;
+        std::string user_name_;
+        std::string address_;
+        std::string exe_time_;
+        std::string frequency_;
+        std::string priority_str_;
+        std::string estimated_exe_time_;
+        std::string notification_addr_;
+        std::string status_;
+        time_t      due_;
+        int         priority_;
+        bool        running_;
+    };
+
+    /// =-=-=-=-=-=-=-
+    /// @brief the delayed rule queue of the rule engine server, held in
+    ///        memory.  entries whose exec time has not come are ordered by
+    ///        that time; entries which are due are ordered by priority,
+    ///        a smaller PRI first, then by exec time.  jobs which failed
+    ///        once come after all others, as they did when the server ran
+    ///        them in a second pass.
+    ///
+    ///        rule exec ids only grow, but a row may be committed after
+    ///        one with a higher id was read.  so a refresh reads the rows
+    ///        above the highest id seen RULE_EXEC_ID_SETTLE seconds
+    ///        before, skipping those it has already seen.  the row of a
+    ///        job is read again when the job finishes, and the whole
+    ///        table is read every rule_engine_server_queue_resync_in_seconds
+    ///        to pick up the changes of iqmod and iqdel
+    class rule_exec_queue {
+        public:
+            /// =-=-=-=-=-=-=-
+            /// @brief reported by the rule engine server log
+            struct metrics {
+                int    total;
+                int    ready;
+                int    running;
+                int    failed;
+                time_t max_lag;     // seconds the oldest ready job is overdue
+            };
+
+            rule_exec_queue();
+
+            /// =-=-=-=-=-=-=-
+            /// @brief read new rows, or all of them when a resync is due.
+            ///        reads at most once a second unless _force is set
+            error refresh( rsComm_t* _comm, bool _force );
+
+            /// =-=-=-=-=-=-=-
+            /// @brief read the row of a job again once it has run, which
+            ///        clears its running state
+            error refresh_entry( rsComm_t* _comm, const std::string& _id );
+
+            /// =-=-=-=-=-=-=-
+            /// @brief take the best job which is due, marking it running
+            bool next( time_t _now, rule_exec_entry& _entry );
+
+            /// =-=-=-=-=-=-=-
+            /// @brief forget a job, e.g. one whose row or rei file is gone
+            void drop( const std::string& _id );
+
+            /// =-=-=-=-=-=-=-
+            /// @brief clear the running state of every job, once no child
+            ///        process is left
+            void clear_running();
+
+            /// =-=-=-=-=-=-=-
+            /// @brief the exec time of the next job to become due, or 0
+            time_t next_due() const;
+
+            /// =-=-=-=-=-=-=-
+            /// @brief true if a job is due and not running
+            bool has_ready( time_t _now ) const;
+
+            metrics get_metrics( time_t _now ) const;
+
+        private:
+            struct ready_key {
+                bool       failed_;
+                int        priority_;
+                time_t     due_;
+                rodsLong_t id_;
+                bool operator<( const ready_key& _rhs ) const;
+            };
+            typedef std::pair< time_t, rodsLong_t > waiting_key;
+
+            error read_rows(
+                rsComm_t*   _comm,
+                const char* _cond,
+                bool        _full,
+                bool        _new_only );
+            void insert( const rule_exec_entry& _entry );
+            void unlink( const rule_exec_entry& _entry );
+            void promote( time_t _now );
+            static ready_key make_ready_key( const rule_exec_entry& _entry );
+
+            int                                  resync_;
+            time_t                               last_refresh_;
+            time_t                               last_resync_;
+            rodsLong_t                           max_id_;
+            rodsLong_t                           floor_id_;   // rows above are read again
+            std::set< rodsLong_t >               seen_ids_;   // ids above floor_id_ seen
+            std::deque< std::pair< time_t, rodsLong_t > > max_id_history_;
+            std::map< rodsLong_t, rule_exec_entry > entries_;
+            std::set< ready_key >                ready_;
+            std::set< waiting_key >              waiting_;
+
+    }; // class rule_exec_queue
+
+}; // namespace irods
+
+#endif // IRODS_RULE_EXEC_QUEUE_HPP
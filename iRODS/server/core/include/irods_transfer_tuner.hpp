@@ -0,0 +1,83 @@
+#ifndef IRODS_TRANSFER_TUNER_HPP
+#define IRODS_TRANSFER_TUNER_HPP
+
+#include "rodsType.h"
+#include "irods_error.hpp"
+
+#include <map>
+#include <string>
+
+namespace irods {
+
+    /// =-=-=-=-=-=-=-
+    /// @brief default for adaptive_number_of_transfer_threads, the number
+    ///        of streams an adaptive transfer starts with.  zero disables
+    ///        the tuner
+    static const int DEFAULT_ADAPTIVE_TRANSFER_THREADS = 0;
+
+    /// =-=-=-=-=-=-=-
+    /// @brief chooses the number of portal streams for a parallel transfer
+    ///        from the throughput observed on earlier transfers with the
+    ///        same client, rather than from the acSetNumThreads rule alone.
+    ///        the count starts small and is doubled while the aggregate
+    ///        throughput keeps improving.  once it stops improving the
+    ///        extra streams are retired, and the best count is probed now
+    ///        and then by one stream in either direction.  the value from
+    ///        the rule is the upper bound.  the state lives in the agent,
+    ///        so it follows a client connection across the objects of a
+    ///        recursive or bulk transfer.
+    class transfer_tuner {
+        public:
+            static transfer_tuner& instance();
+
+            /// =-=-=-=-=-=-=-
+            /// @brief true if adaptive_number_of_transfer_threads is set
+            ///        above zero in the advanced settings
+            bool enabled();
+
+            /// =-=-=-=-=-=-=-
+            /// @brief the number of streams to use for the next transfer of
+            ///        type _opr_type with _peer, never more than _max
+            int num_threads(
+                const std::string& _peer,
+                int                _opr_type,
+                int                _max );
+
+            /// =-=-=-=-=-=-=-
+            /// @brief feed back the outcome of a transfer.  the stream
+            ///        rates are only logged
+            void record(
+                const std::string& _peer,
+                int                _opr_type,
+                int                _num_threads,
+                rodsLong_t         _bytes,
+                double             _seconds,
+                double             _min_stream_rate,
+                double             _max_stream_rate );
+
+        private:
+            struct peer_state {
+                int    current;
+                int    limit;
+                int    best;
+                double best_rate;
+                int    transfers;
+                int    probes;
+                bool   settled;
+            };
+
+            transfer_tuner();
+            transfer_tuner( const transfer_tuner& );
+            transfer_tuner& operator=( const transfer_tuner& );
+
+            std::string key( const std::string& _peer, int _opr_type );
+
+            bool                                configured_;
+            int                                 initial_;
+            std::map< std::string, peer_state > peers_;
+
+    }; // class transfer_tuner
+
+}; // namespace irods
+
+#endif // IRODS_TRANSFER_TUNER_HPP
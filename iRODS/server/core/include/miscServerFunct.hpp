@@ -47,6 +47,8 @@ typedef struct PortalTransferInp {
     char encryption_algorithm[ NAME_LEN ];
     char shared_secret[ NAME_LEN ]; // JMC - shared secret for each portal thread
 
+    double timeInSec;   /* wall time of the stream */
+
 } portalTransferInp_t;
 
 int
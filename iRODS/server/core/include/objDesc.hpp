@@ -20,8 +20,6 @@
 
 #include "boost/any.hpp"
 
-#define NUM_L1_DESC     1026    /* number of L1Desc */
-
 #define CHK_ORPHAN_CNT_LIMIT  20  /* number of failed check before stopping */
 /* definition for getNumThreads */
 
@@ -16,6 +16,7 @@
 #include "rcGlobalExtern.h"
 #include "rsGlobalExtern.hpp"
 #include "reIn2p3SysRule.hpp"
+#include "irods_rule_exec_queue.hpp"
 
 #define DEF_NUM_RE_PROCS	1
 #define RESC_UPDATE_TIME        60
@@ -47,14 +48,10 @@ getReInfo( rsComm_t *rsComm, genQueryOut_t **genQueryOut );
 int
 getReInfoById( rsComm_t *rsComm, char *ruleExecId, genQueryOut_t **genQueryOut );
 int
-getNextQueuedRuleExec( genQueryOut_t **inGenQueryOut,
-                       int startInx, ruleExecSubmitInp_t *queuedRuleExec,
-                       reExec_t *reExec, int jobType );
-int
 regExeStatus( rsComm_t *rsComm, char *ruleExecId, char *exeStatus );
 int
 runQueuedRuleExec( rsComm_t *rsComm, reExec_t *reExec,
-                   genQueryOut_t **genQueryOut, time_t endTime, int statusFlag );
+                   irods::rule_exec_queue& ruleExecQueue );
 int
 initReExec( rsComm_t *rsComm, reExec_t *reExec );
 int
@@ -71,7 +68,8 @@ matchRuleExecId( reExec_t *eeExec, char *ruleExecIdStr,
 int
 matchPidInReExec( reExec_t *reExec, pid_t pid );
 int
-waitAndFreeReThr( rsComm_t *rsComm, reExec_t *reExec ); // JMC - backport 4695
+waitAndFreeReThr( rsComm_t *rsComm, reExec_t *reExec, int waitOpt,
+                  irods::rule_exec_queue& ruleExecQueue ); // JMC - backport 4695
 int
 chkAndUpdateResc( rsComm_t *rsComm );
 int
@@ -54,6 +54,8 @@ int serverize( char *logDir );
 int serverMain( char *logDir );
 int
 procChildren( agentProc_t **agentProcHead );
+int
+procAgentPool( agentProc_t **agentProcHead );
 agentProc_t *
 getAgentProcByPid( int childPid, agentProc_t **agentProcHead );
 
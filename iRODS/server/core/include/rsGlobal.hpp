@@ -15,6 +15,7 @@
 
 // =-=-=-=-=-=-=-
 #include "irods_resource_manager.hpp"
+#include "irods_l1desc_table.hpp"
 
 // =-=-=-=-=-=-=-
 // externs to singleton plugin managers
@@ -35,7 +36,7 @@ int RescGrpInit = 0;    /* whether initRescGrp has been called */
 /* global fileDesc */
 
 fileDesc_t FileDesc[NUM_FILE_DESC];
-l1desc_t L1desc[NUM_L1_DESC];
+irods::l1desc_table L1desc;
 specCollDesc_t SpecCollDesc[NUM_SPEC_COLL_DESC];
 collHandle_t CollHandle[NUM_COLL_HANDLE];
 
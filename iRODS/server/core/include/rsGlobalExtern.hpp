@@ -18,6 +18,7 @@
 
 // =-=-=-=-=-=-=-
 #include "irods_resource_manager.hpp"
+#include "irods_l1desc_table.hpp"
 
 // =-=-=-=-=-=-=-
 // externs to singleton plugin managers
@@ -33,7 +34,7 @@ extern rodsServerHost_t *HostConfigHead;
 extern zoneInfo_t *ZoneInfoHead;
 extern int RescGrpInit;
 extern fileDesc_t FileDesc[NUM_FILE_DESC];
-extern l1desc_t L1desc[NUM_L1_DESC];
+extern irods::l1desc_table L1desc;
 extern specCollDesc_t SpecCollDesc[NUM_SPEC_COLL_DESC];
 extern collHandle_t CollHandle[NUM_COLL_HANDLE];
 
@@ -29,6 +29,8 @@ extern "C" {
     queueSpecCollCacheWithObjStat( rodsObjStat_t *rodsObjStatOut );
     specCollCache_t *
     matchSpecCollCache( char *objPath );
+    void
+    freeSpecCollCache();
     int
     getSpecCollCache( rsComm_t *rsComm, char *objPath, int inCachOnly,
                       specCollCache_t **specCollCache );
@@ -19,12 +19,24 @@
 #include "rcConnect.h"
 #include "rodsXmsg.h"
 
+#include <boost/thread/mutex.hpp>
+
 #define REQ_MSG_TIMEOUT_TIME	5	/* 5 sec timeout for req msg */
 
-#define NUM_HASH_SLOT		47	/* number of slots for the ticket
-* hash key */
+#define NUM_HASH_SLOT		251	/* number of slots for the ticket
+* hash key. each slot has its own lock */
 #define NUM_XMSG_THR		40       /* used to be 10 */
 
+#define XMSG_POLL_EVENTS	64	/* events taken per epoll_wait */
+
+/* an accepted connection. between requests it is parked in the poll set
+ * rather than holding a worker thread. like a connection held by a worker
+ * in select(), it stays open until the client closes it */
+typedef struct XmsgConn {
+    rsComm_t rsComm;
+    int polled;                 /* registered with the poll set */
+} xmsgConn_t;
+
 int
 initThreadEnv();
 int
@@ -41,13 +53,25 @@ rmTicketMsgStructFromHQue( ticketMsgStruct_t *ticketMsgStruct,
                            ticketHashQue_t *ticketHQue );
 int
 addReqToQue( int sock );
+int
+addXmsgReqToQue( xmsgReq_t *xmsgReq );
 xmsgReq_t *getReqFromQue();
+void
+closeXmsgReq( xmsgReq_t *xmsgReq );
+#ifdef linux_platform
+int
+initXmsgPoll( int listenSock );
+int
+parkXmsgReq( xmsgReq_t *xmsgReq );
+#endif
 int
 startXmsgThreads();
 void
 procReqRoutine();
 int
 ticketHashFunc( uint rcvTicket );
+boost::mutex&
+ticketHashSlotMutex( uint rcvTicket );
 int
 initXmsgHashQue();
 int
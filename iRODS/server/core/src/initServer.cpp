@@ -28,6 +28,7 @@
 #include "irods_log.hpp"
 #include "irods_threads.hpp"
 #include "irods_server_properties.hpp"
+#include "irods_client_server_negotiation.hpp"
 
 #include <vector>
 #include <set>
@@ -1310,6 +1311,47 @@ initRsCommWithStartupPack( rsComm_t *rsComm, startupPack_t *startupPack ) {
     return 0;
 }
 
+/* setStartupPackEnv - export the startup pack of a newly accepted
+ * connection as the env variables read by initRsCommWithStartupPack.
+ * Used by the server before exec'ing an agent and by a pooled agent
+ * which has just been handed a connection. */
+int
+setStartupPackEnv( int newSock, startupPack_t *startupPack ) {
+    if ( startupPack == NULL ) {
+        return USER__NULL_INPUT_ERR;
+    }
+
+    mySetenvInt( SP_NEW_SOCK, newSock );
+    mySetenvInt( SP_PROTOCOL, startupPack->irodsProt );
+    mySetenvInt( SP_RECONN_FLAG, startupPack->reconnFlag );
+    mySetenvInt( SP_CONNECT_CNT, startupPack->connectCnt );
+    mySetenvStr( SP_PROXY_USER, startupPack->proxyUser );
+    mySetenvStr( SP_PROXY_RODS_ZONE, startupPack->proxyRodsZone );
+    mySetenvStr( SP_CLIENT_USER, startupPack->clientUser );
+    mySetenvStr( SP_CLIENT_RODS_ZONE, startupPack->clientRodsZone );
+    mySetenvStr( SP_REL_VERSION, startupPack->relVersion );
+    mySetenvStr( SP_API_VERSION, startupPack->apiVersion );
+
+    // =-=-=-=-=-=-=-
+    // if the client-server negotiation request is in the
+    // option variable, set that env var and strip it out
+    std::string opt_str( startupPack->option );
+    size_t pos = opt_str.find( REQ_SVR_NEG );
+    if ( std::string::npos != pos ) {
+        std::string trunc_str = opt_str.substr( 0, pos );
+        mySetenvStr( SP_OPTION,           trunc_str.c_str() );
+        mySetenvStr( irods::RODS_CS_NEG, REQ_SVR_NEG );
+
+    }
+    else {
+        mySetenvStr( SP_OPTION, startupPack->option );
+        mySetenvStr( irods::RODS_CS_NEG, "" );
+
+    }
+
+    return 0;
+}
+
 int
 initConnectControl() {
     char buf[LONG_NAME_LEN * 5];
@@ -179,16 +179,14 @@ int usage( char *prog ) {
 
 void
 reServerMain( rsComm_t *rsComm, char* logDir ) {
-    int status = 0;
-    genQueryOut_t *genQueryOut = NULL;
-    time_t endTime;
-    int runCnt;
     reExec_t reExec;
-    int repeatedQueryErrorCount = 0; // JMC - backport 4520
+    time_t lastReport = 0;
 
     initReExec( rsComm, &reExec );
     LastRescUpdateTime = time( NULL );
 
+    irods::rule_exec_queue ruleExecQueue;
+
     try {
         while ( true ) {
 
@@ -197,54 +195,57 @@ reServerMain( rsComm_t *rsComm, char* logDir ) {
             chkLogfileName( logDir, RULE_EXEC_LOGFILE );
 #endif
 #endif
-            rodsLog(
-                LOG_NOTICE,
-                "reServerMain: checking the queue for jobs" );
             chkAndResetRule();
-            status = getReInfo( rsComm, &genQueryOut );
-            if ( status < 0 ) {
-                if ( status != CAT_NO_ROWS_FOUND ) {
-                    rodsLog( LOG_ERROR,
-                             "reServerMain: getReInfo error. status = %d", status );
+
+            /* pick up the finished jobs, then the new ones */
+            if ( reExec.doFork == 1 ) {
+                while ( reExec.runCnt > 0 &&
+                        waitAndFreeReThr( rsComm, &reExec, WNOHANG, ruleExecQueue ) >= 0 ) {
+                    ;
+                }
+            }
+
+            irods::error ret = ruleExecQueue.refresh( rsComm, false );
+            if ( !ret.ok() ) {
+                irods::log( PASS( ret ) );
+                if ( reExec.runCnt == 0 ) {
+                    reSvrSleep( rsComm );
                 }
-                else {   // JMC - backport 4520
-                    repeatedQueryErrorCount++;
+                else {
+                    rodsSleep( RE_SERVER_POLL_TIME, 0 );
                 }
-                reSvrSleep( rsComm );
                 continue;
             }
-            else {   // JMC - backport 4520
-                repeatedQueryErrorCount = 0;
+
+            runQueuedRuleExec( rsComm, &reExec, ruleExecQueue );
+
+            time_t now = time( NULL );
+            if ( now - lastReport >= RE_SERVER_SLEEP_TIME ) {
+                irods::rule_exec_queue::metrics m = ruleExecQueue.get_metrics( now );
+                rodsLog( LOG_NOTICE,
+                         "reServerMain: %d jobs queued, %d due, %d running, %d failed, oldest due for %d sec",
+                         m.total, m.ready, m.running, m.failed, ( int ) m.max_lag );
+                lastReport = now;
             }
-            endTime = time( NULL ) + RE_SERVER_EXEC_TIME;
-            runCnt = runQueuedRuleExec( rsComm, &reExec, &genQueryOut, endTime, 0 );
-            if ( runCnt > 0 ||
-                    ( genQueryOut != NULL && genQueryOut->continueInx > 0 ) ) {
-                /* need to refresh */
-                svrCloseQueryOut( rsComm, genQueryOut );
-                freeGenQueryOut( &genQueryOut );
-                status = getReInfo( rsComm, &genQueryOut );
-                if ( status < 0 ) {
+
+            if ( reExec.runCnt == 0 && !ruleExecQueue.has_ready( now ) ) {
+                /* nothing running or due. let go of the catalog while
+                 * waiting, unless a job is due before long */
+                time_t nextDue = ruleExecQueue.next_due();
+                if ( nextDue == 0 || nextDue - now >= RE_SERVER_SLEEP_TIME ) {
                     reSvrSleep( rsComm );
+                    ruleExecQueue.refresh( rsComm, true );
                     continue;
                 }
             }
 
-            /* run the failed job */
-
-            runCnt =
-                runQueuedRuleExec( rsComm, &reExec, &genQueryOut, endTime,
-                                   RE_FAILED_STATUS );
-            svrCloseQueryOut( rsComm, genQueryOut );
-            freeGenQueryOut( &genQueryOut );
-            if ( runCnt > 0 ||
-                    ( genQueryOut != NULL && genQueryOut->continueInx > 0 ) ) {
+            if ( reExec.doFork == 1 && reExec.runCnt >= reExec.maxRunCnt ) {
+                /* every process is busy. wait for one to finish */
+                waitAndFreeReThr( rsComm, &reExec, 0, ruleExecQueue );
                 continue;
             }
-            else {
-                /* nothing got run */
-                reSvrSleep( rsComm );
-            }
+
+            rodsSleep( RE_SERVER_POLL_TIME, 0 );
         }
 
         rodsLog(
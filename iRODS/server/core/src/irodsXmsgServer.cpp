@@ -16,6 +16,10 @@
 #include "irods_signal.hpp"
 #include "sockCommNetworkInterface.hpp"
 
+#ifdef linux_platform
+#include <sys/epoll.h>
+#endif
+
 int loopCnt = -1; /* make it -1 to run infinitely */
 
 
@@ -122,8 +126,6 @@ xmsgServerMain() {
     rsComm_t rsComm;
     rsComm_t svrComm;	/* rsComm is connection to icat, svrComm is the
                          * server's listening socket */
-    fd_set sockMask;
-    int numSock;
 
     initThreadEnv();
     initXmsgHashQue();
@@ -227,10 +229,59 @@ xmsgServerMain() {
 
     listen( svrComm.sock, MAX_LISTEN_QUE );
 
-    FD_ZERO( &sockMask );
-
     rodsLog( LOG_NOTICE, "xmsgServer version %s is up", RODS_REL_VERSION );
 
+#ifdef linux_platform
+    /* the listening socket and the idle connections share one poll set.
+     * a connection with a request waiting is handed to a worker thread,
+     * which parks it again when the request is done */
+    const int pollFd = initXmsgPoll( svrComm.sock );
+    if ( pollFd < 0 ) {
+        return pollFd;
+    }
+
+    while ( 1 ) {       /* infinite loop */
+        struct epoll_event events[XMSG_POLL_EVENTS];
+        const int numEvents = epoll_wait( pollFd, events, XMSG_POLL_EVENTS, -1 );
+        if ( numEvents < 0 ) {
+            if ( errno == EINTR ) {
+                continue;
+            }
+            rodsLog( LOG_NOTICE, "xmsgServerMain: epoll_wait() error, errno = %d", errno );
+            return -1;
+        }
+
+        for ( int i = 0; i < numEvents; i++ ) {
+            xmsgReq_t *myXmsgReq = ( xmsgReq_t * ) events[i].data.ptr;
+            if ( myXmsgReq != NULL ) {
+                addXmsgReqToQue( myXmsgReq );
+                continue;
+            }
+
+            const int newSock = rsAcceptConn( &svrComm );
+
+            if ( newSock < 0 ) {
+                rodsLog( LOG_NOTICE,
+                         "xmsgServerMain: acceptConn () error, errno = %d", errno );
+                continue;
+            }
+
+            addReqToQue( newSock );
+
+            if ( loopCnt > 0 ) {
+                loopCnt--;
+                if ( loopCnt == 0 ) {
+                    return 0;
+                }
+            }
+        }
+    }
+#else
+    fd_set sockMask;
+    int numSock;
+
+    FD_ZERO( &sockMask );
+
     while ( 1 ) {       /* infinite loop */
         FD_SET( svrComm.sock, &sockMask );
         while ( ( numSock = select( svrComm.sock + 1, &sockMask,
@@ -266,6 +317,7 @@ xmsgServerMain() {
 
 
     }
+#endif
     return 0;
 }
 
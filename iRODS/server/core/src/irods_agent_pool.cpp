@@ -0,0 +1,458 @@
+
+
+
+#include "rodsErrorTable.h"
+#include "rodsLog.h"
+#include "rcMisc.h"
+#include "irods_log.hpp"
+#include "irods_agent_pool.hpp"
+#include "irods_configuration_keywords.hpp"
+#include "irods_server_properties.hpp"
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+
+#ifndef windows_platform
+
+namespace irods {
+
+    /// =-=-=-=-=-=-=-
+    /// @brief message sent by an agent when it is ready for a connection
+    struct agent_ready_msg {
+        int pid;
+        int served;
+    };
+
+    static double elapsed_ms(
+        const struct timeval& _start,
+        const struct timeval& _end ) {
+        return ( _end.tv_sec - _start.tv_sec ) * 1000.0 +
+               ( _end.tv_usec - _start.tv_usec ) / 1000.0;
+
+    } // elapsed_ms
+
+    agent_pool::agent_pool() :
+        configured_( false ),
+        pool_size_( DEFAULT_AGENT_POOL_SIZE ),
+        max_requests_( DEFAULT_AGENT_POOL_MAX_REQUESTS ),
+        spawned_( 0 ),
+        dispatched_( 0 ),
+        recycled_cnt_( 0 ),
+        fallbacks_( 0 ),
+        startup_cnt_( 0 ),
+        startup_total_ms_( 0.0 ),
+        startup_max_ms_( 0.0 ) {
+    }
+
+    agent_pool& agent_pool::instance() {
+        static agent_pool instance_;
+        return instance_;
+    }
+
+    error agent_pool::get_settings(
+        int& _size,
+        int& _max_requests ) {
+        _size = DEFAULT_AGENT_POOL_SIZE;
+        _max_requests = DEFAULT_AGENT_POOL_MAX_REQUESTS;
+
+        // =-=-=-=-=-=-=-
+        // both settings are optional, a missing entry keeps the default
+        error ret = get_advanced_setting<int>(
+                        CFG_AGENT_POOL_SIZE,
+                        _size );
+        if ( !ret.ok() && KEY_NOT_FOUND != ret.code() ) {
+            return PASS( ret );
+        }
+
+        ret = get_advanced_setting<int>(
+                  CFG_AGENT_POOL_MAX_REQUESTS_PER_AGENT,
+                  _max_requests );
+        if ( !ret.ok() && KEY_NOT_FOUND != ret.code() ) {
+            return PASS( ret );
+        }
+
+        if ( _size < 0 ) {
+            _size = 0;
+        }
+
+        if ( _max_requests < 1 ) {
+            _max_requests = 1;
+        }
+
+        return SUCCESS();
+
+    } // get_settings
+
+    error agent_pool::configure() {
+        int size = 0, max_requests = 0;
+        error ret = get_settings( size, max_requests );
+        if ( !ret.ok() ) {
+            return PASS( ret );
+        }
+
+        boost::mutex::scoped_lock lock( mutex_ );
+        pool_size_    = size;
+        max_requests_ = max_requests;
+        configured_   = true;
+
+        if ( pool_size_ > 0 ) {
+            rodsLog(
+                LOG_NOTICE,
+                "agent pool enabled with [%d] agents, [%d] requests per agent",
+                pool_size_,
+                max_requests_ );
+        }
+
+        return SUCCESS();
+
+    } // configure
+
+    bool agent_pool::enabled() {
+        boost::mutex::scoped_lock lock( mutex_ );
+        return configured_ && pool_size_ > 0;
+    }
+
+    error agent_pool::spawn( pooled_agent& _agent ) {
+        int fds[2];
+        if ( socketpair( AF_UNIX, SOCK_STREAM, 0, fds ) < 0 ) {
+            return ERROR(
+                       SYS_SOCK_OPEN_ERR - errno,
+                       "socketpair failed" );
+        }
+
+        gettimeofday( &_agent.spawn_time, NULL );
+        int pid = fork();
+        if ( pid < 0 ) {
+            close( fds[0] );
+            close( fds[1] );
+            return ERROR(
+                       SYS_FORK_ERROR - errno,
+                       "fork failed" );
+        }
+        else if ( 0 == pid ) {
+            // =-=-=-=-=-=-=-
+            // child - close every inherited descriptor other than stdio
+            // and our end of the control socket, notably the listening
+            // socket and any client sockets still queued in the parent
+            int max_fd = getdtablesize();
+            for ( int fd = 3; fd < max_fd; ++fd ) {
+                if ( fd != fds[1] ) {
+                    close( fd );
+                }
+            }
+
+            mySetenvInt( SP_AGENT_POOL_SOCK, fds[1] );
+
+            char agent_exe[] = "irodsAgent";
+            char* av[] = { agent_exe, NULL };
+            execv( av[0], av );
+            rodsLog( LOG_ERROR, "agent_pool::spawn: execv error errno=%d", errno );
+            exit( 1 );
+        }
+
+        close( fds[1] );
+        fcntl( fds[0], F_SETFD, FD_CLOEXEC );
+
+        _agent.pid       = pid;
+        _agent.ctrl_sock = fds[0];
+        _agent.started   = false;
+        _agent.ready     = false;
+
+        return SUCCESS();
+
+    } // spawn
+
+    error agent_pool::replenish() {
+        boost::mutex::scoped_lock lock( mutex_ );
+        if ( !configured_ || pool_size_ <= 0 ) {
+            return SUCCESS();
+        }
+
+        while ( agents_.size() < static_cast<size_t>( pool_size_ ) ) {
+            pooled_agent agent;
+            error ret = spawn( agent );
+            if ( !ret.ok() ) {
+                return PASS( ret );
+            }
+
+            agents_.push_back( agent );
+            ++spawned_;
+        }
+
+        return SUCCESS();
+
+    } // replenish
+
+    void agent_pool::drain() {
+        if ( agents_.empty() ) {
+            return;
+        }
+
+        std::vector<struct pollfd> fds;
+        std::list<pooled_agent>::iterator itr;
+        for ( itr = agents_.begin(); itr != agents_.end(); ++itr ) {
+            struct pollfd pfd;
+            pfd.fd      = itr->ctrl_sock;
+            pfd.events  = POLLIN;
+            pfd.revents = 0;
+            fds.push_back( pfd );
+        }
+
+        if ( ::poll( &fds[0], fds.size(), 0 ) <= 0 ) {
+            return;
+        }
+
+        size_t idx = 0;
+        for ( itr = agents_.begin(); itr != agents_.end(); ++itr, ++idx ) {
+            if ( 0 == fds[ idx ].revents || itr->ctrl_sock < 0 ) {
+                continue;
+            }
+
+            agent_ready_msg msg;
+            ssize_t len = recv( itr->ctrl_sock, &msg, sizeof( msg ), MSG_WAITALL );
+            if ( len != sizeof( msg ) ) {
+                // =-=-=-=-=-=-=-
+                // the agent exited or broke protocol, it is no longer
+                // eligible for dispatch.  reap() will remove it
+                close( itr->ctrl_sock );
+                itr->ctrl_sock = -1;
+                itr->ready     = false;
+                continue;
+            }
+
+            itr->ready = true;
+            if ( !itr->started ) {
+                struct timeval now;
+                gettimeofday( &now, NULL );
+                double ms = elapsed_ms( itr->spawn_time, now );
+                itr->started = true;
+                ++startup_cnt_;
+                startup_total_ms_ += ms;
+                if ( ms > startup_max_ms_ ) {
+                    startup_max_ms_ = ms;
+                }
+                rodsLog(
+                    LOG_DEBUG,
+                    "agent_pool: agent [%d] ready after [%.3f] ms",
+                    itr->pid,
+                    ms );
+            }
+
+            if ( msg.served > 0 ) {
+                ++recycled_cnt_;
+                recycled_.push_back( itr->pid );
+            }
+        }
+
+    } // drain
+
+    error agent_pool::poll( std::vector<int>& _recycled ) {
+        boost::mutex::scoped_lock lock( mutex_ );
+        drain();
+        _recycled.insert( _recycled.end(), recycled_.begin(), recycled_.end() );
+        recycled_.clear();
+        return SUCCESS();
+
+    } // poll
+
+    error agent_pool::dispatch(
+        int            _sock,
+        startupPack_t* _pack,
+        int&           _pid ) {
+        if ( !_pack ) {
+            return ERROR(
+                       SYS_INTERNAL_NULL_INPUT_ERR,
+                       "null startup pack" );
+        }
+
+        boost::mutex::scoped_lock lock( mutex_ );
+        drain();
+
+        std::list<pooled_agent>::iterator itr;
+        for ( itr = agents_.begin(); itr != agents_.end(); ++itr ) {
+            if ( !itr->ready || itr->ctrl_sock < 0 ) {
+                continue;
+            }
+
+            struct msghdr msg;
+            struct iovec  iov;
+            char          ctrl_buf[ CMSG_SPACE( sizeof( int ) ) ];
+            memset( &msg, 0, sizeof( msg ) );
+            memset( ctrl_buf, 0, sizeof( ctrl_buf ) );
+
+            iov.iov_base       = _pack;
+            iov.iov_len        = sizeof( startupPack_t );
+            msg.msg_iov        = &iov;
+            msg.msg_iovlen     = 1;
+            msg.msg_control    = ctrl_buf;
+            msg.msg_controllen = sizeof( ctrl_buf );
+
+            struct cmsghdr* cmsg = CMSG_FIRSTHDR( &msg );
+            cmsg->cmsg_level = SOL_SOCKET;
+            cmsg->cmsg_type  = SCM_RIGHTS;
+            cmsg->cmsg_len   = CMSG_LEN( sizeof( int ) );
+            memcpy( CMSG_DATA( cmsg ), &_sock, sizeof( int ) );
+
+            ssize_t len = sendmsg( itr->ctrl_sock, &msg, MSG_NOSIGNAL );
+            itr->ready = false;
+            if ( len != static_cast<ssize_t>( sizeof( startupPack_t ) ) ) {
+                rodsLog(
+                    LOG_NOTICE,
+                    "agent_pool::dispatch: sendmsg to agent [%d] failed, errno = %d",
+                    itr->pid,
+                    errno );
+                close( itr->ctrl_sock );
+                itr->ctrl_sock = -1;
+                continue;
+            }
+
+            ++dispatched_;
+            _pid = itr->pid;
+            return SUCCESS();
+        }
+
+        ++fallbacks_;
+        return ERROR(
+                   SYS_NO_AGENT_POOL_SLOT_ERR,
+                   "no idle agent in the pool" );
+
+    } // dispatch
+
+    bool agent_pool::reap( int _pid ) {
+        boost::mutex::scoped_lock lock( mutex_ );
+        std::list<pooled_agent>::iterator itr;
+        for ( itr = agents_.begin(); itr != agents_.end(); ++itr ) {
+            if ( itr->pid == _pid ) {
+                if ( itr->ctrl_sock >= 0 ) {
+                    close( itr->ctrl_sock );
+                }
+                agents_.erase( itr );
+                return true;
+            }
+        }
+
+        return false;
+
+    } // reap
+
+    void agent_pool::shutdown() {
+        boost::mutex::scoped_lock lock( mutex_ );
+        std::list<pooled_agent>::iterator itr;
+        for ( itr = agents_.begin(); itr != agents_.end(); ++itr ) {
+            if ( itr->ctrl_sock >= 0 ) {
+                close( itr->ctrl_sock );
+                itr->ctrl_sock = -1;
+            }
+        }
+        pool_size_ = 0;
+
+    } // shutdown
+
+    agent_pool::statistics agent_pool::stats() {
+        boost::mutex::scoped_lock lock( mutex_ );
+        drain();
+
+        statistics s;
+        s.pool_size              = pool_size_;
+        s.max_requests_per_agent = max_requests_;
+        s.idle                   = 0;
+        s.busy                   = 0;
+        s.spawned                = spawned_;
+        s.dispatched             = dispatched_;
+        s.recycled               = recycled_cnt_;
+        s.fallbacks              = fallbacks_;
+        s.mean_startup_ms        = startup_cnt_ > 0 ?
+                                   startup_total_ms_ / startup_cnt_ : 0.0;
+        s.max_startup_ms         = startup_max_ms_;
+
+        std::list<pooled_agent>::iterator itr;
+        for ( itr = agents_.begin(); itr != agents_.end(); ++itr ) {
+            if ( itr->ready ) {
+                ++s.idle;
+            }
+            else if ( itr->started ) {
+                ++s.busy;
+            }
+        }
+
+        return s;
+
+    } // stats
+
+    error agent_pool::signal_ready(
+        int _ctrl_sock,
+        int _served ) {
+        agent_ready_msg msg;
+        msg.pid    = getpid();
+        msg.served = _served;
+
+        ssize_t len = send( _ctrl_sock, &msg, sizeof( msg ), MSG_NOSIGNAL );
+        if ( len != sizeof( msg ) ) {
+            return ERROR(
+                       SYS_HEADER_WRITE_LEN_ERR - errno,
+                       "failed to signal the server" );
+        }
+
+        return SUCCESS();
+
+    } // signal_ready
+
+    error agent_pool::wait_for_connection(
+        int            _ctrl_sock,
+        int&           _sock,
+        startupPack_t& _pack ) {
+        struct msghdr msg;
+        struct iovec  iov;
+        char          ctrl_buf[ CMSG_SPACE( sizeof( int ) ) ];
+        memset( &msg, 0, sizeof( msg ) );
+        memset( ctrl_buf, 0, sizeof( ctrl_buf ) );
+
+        iov.iov_base       = &_pack;
+        iov.iov_len        = sizeof( startupPack_t );
+        msg.msg_iov        = &iov;
+        msg.msg_iovlen     = 1;
+        msg.msg_control    = ctrl_buf;
+        msg.msg_controllen = sizeof( ctrl_buf );
+
+        ssize_t len = 0;
+        while ( ( len = recvmsg( _ctrl_sock, &msg, MSG_WAITALL ) ) < 0 &&
+                EINTR == errno ) {
+        }
+
+        if ( 0 == len ) {
+            return ERROR(
+                       SYS_SOCK_READ_ERR,
+                       "server closed the agent pool control socket" );
+        }
+        else if ( len != static_cast<ssize_t>( sizeof( startupPack_t ) ) ) {
+            return ERROR(
+                       SYS_SOCK_READ_ERR - errno,
+                       "short read of startup pack from server" );
+        }
+
+        struct cmsghdr* cmsg = CMSG_FIRSTHDR( &msg );
+        if ( !cmsg ||
+                SOL_SOCKET != cmsg->cmsg_level ||
+                SCM_RIGHTS != cmsg->cmsg_type ) {
+            return ERROR(
+                       SYS_SOCK_READ_ERR,
+                       "no socket descriptor received from server" );
+        }
+
+        memcpy( &_sock, CMSG_DATA( cmsg ), sizeof( int ) );
+
+        return SUCCESS();
+
+    } // wait_for_connection
+
+}; // namespace irods
+
+#endif // windows_platform
+
+
+
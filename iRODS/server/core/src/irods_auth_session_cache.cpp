@@ -0,0 +1,446 @@
+#include "rodsDef.h"
+#include "rodsErrorTable.h"
+#include "rodsLog.h"
+#include "rodsConnect.h"
+#include "base64.h"
+#include "irods_log.hpp"
+#include "irods_auth_session_cache.hpp"
+#include "irods_configuration_keywords.hpp"
+#include "irods_server_properties.hpp"
+
+#include <sys/types.h>
+#include <signal.h>
+#include <sched.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/rand.h>
+
+#include <boost/interprocess/creation_tags.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+namespace bi = boost::interprocess;
+
+namespace irods {
+
+    /// =-=-=-=-=-=-=-
+    /// @brief the size of the table.  a new session takes the slot after
+    ///        the last one taken, so the oldest sessions are pushed out
+    static const unsigned int AUTH_SESSION_SLOTS = 4096;
+
+    /// =-=-=-=-=-=-=-
+    /// @brief a lock held for longer than this many yields is checked for
+    ///        a holder which died while holding it
+    static const int AUTH_SESSION_LOCK_SPINS = 1000;
+
+    /// =-=-=-=-=-=-=-
+    /// @brief the token is the slot, its serial, the expiry and the first
+    ///        bytes of the HMAC-SHA256 of those and the user, which fits in
+    ///        the context and result of an auth plugin request
+    static const int AUTH_SESSION_MAC_SIZE   = 12;
+    static const int AUTH_SESSION_TOKEN_SIZE = 12 + AUTH_SESSION_MAC_SIZE;
+    static const int AUTH_SESSION_SECRET_SIZE = 32;
+
+    enum {
+        AUTH_SESSION_EMPTY = 0,
+        AUTH_SESSION_CLAIMED,
+        AUTH_SESSION_READY
+    };
+
+    /// =-=-=-=-=-=-=-
+    /// @brief revocations counts the calls to revoke, so that a session
+    ///        is not issued to a user changed after the password check
+    struct auth_session_header {
+        volatile unsigned int state;
+        volatile unsigned int next;
+        volatile unsigned int revocations;
+        unsigned char         secret[ AUTH_SESSION_SECRET_SIZE ];
+    };
+
+    struct auth_session_slot {
+        volatile pid_t lock;
+        unsigned int   serial;
+        unsigned int   expires;
+        int            priv_level;
+        char           user[ NAME_LEN ];
+        char           zone[ NAME_LEN ];
+    };
+
+    static const bi::offset_t AUTH_SESSION_SIZE =
+        sizeof( auth_session_header ) + sizeof( auth_session_slot ) * AUTH_SESSION_SLOTS;
+
+    static bi::shared_memory_object* table_obj    = NULL;
+    static bi::mapped_region*        table_region = NULL;
+    static int                       lifetime     = -1;
+
+    /// =-=-=-=-=-=-=-
+    /// @brief salted like the rule engine cache, so each server run has
+    ///        its own table and secret
+    static error segment_name( std::string& _name ) {
+        std::string salt;
+        error ret = server_properties::getInstance().get_property< std::string >( RE_CACHE_SALT_KW, salt );
+        if ( !ret.ok() ) {
+            return PASS( ret );
+        }
+
+        _name = "irods_auth_session_shared_memory_" + salt;
+        return SUCCESS();
+
+    } // segment_name
+
+    /// =-=-=-=-=-=-=-
+    /// @brief map the segment, drawing the secret if this process is the
+    ///        first to map it
+    static auth_session_header* header_ptr() {
+        if ( !table_region ) {
+            std::string name;
+            error ret = segment_name( name );
+            if ( !ret.ok() ) {
+                irods::log( PASS( ret ) );
+                return NULL;
+            }
+
+            try {
+                table_obj = new bi::shared_memory_object( bi::open_or_create, name.c_str(), bi::read_write, 0600 );
+                bi::offset_t size = 0;
+                if ( table_obj->get_size( size ) && size == 0 ) {
+                    table_obj->truncate( AUTH_SESSION_SIZE );
+                }
+                table_region = new bi::mapped_region( *table_obj, bi::read_write );
+            }
+            catch ( const bi::interprocess_exception& e ) {
+                rodsLog( LOG_ERROR, "auth_session_cache - failed to map [%s]. Exception caught [%s]",
+                         name.c_str(), e.what() );
+                delete table_obj;
+                table_obj = NULL;
+                return NULL;
+            }
+        }
+
+        auth_session_header* header = static_cast< auth_session_header* >( table_region->get_address() );
+        if ( AUTH_SESSION_READY == header->state ) {
+            return header;
+        }
+
+        if ( __sync_bool_compare_and_swap( &header->state, AUTH_SESSION_EMPTY, AUTH_SESSION_CLAIMED ) ) {
+            if ( 1 != RAND_bytes( header->secret, sizeof( header->secret ) ) ) {
+                rodsLog( LOG_ERROR, "auth_session_cache - failed to draw the secret" );
+                header->state = AUTH_SESSION_EMPTY;
+                return NULL;
+            }
+            __sync_synchronize();
+            header->state = AUTH_SESSION_READY;
+            return header;
+        }
+
+        for ( int i = 0; i < AUTH_SESSION_LOCK_SPINS; ++i ) {
+            if ( AUTH_SESSION_READY == header->state ) {
+                return header;
+            }
+            sched_yield();
+        }
+
+        return NULL;
+
+    } // header_ptr
+
+    static auth_session_slot* slot_ptr(
+        auth_session_header* _header,
+        unsigned int         _index ) {
+        return reinterpret_cast< auth_session_slot* >( _header + 1 ) + _index;
+
+    } // slot_ptr
+
+    static bool lock_slot( auth_session_slot* _slot ) {
+        pid_t pid = getpid();
+        for ( int i = 0; i < AUTH_SESSION_LOCK_SPINS; ++i ) {
+            if ( __sync_bool_compare_and_swap( &_slot->lock, 0, pid ) ) {
+                return true;
+            }
+            sched_yield();
+        }
+
+        // =-=-=-=-=-=-=-
+        // take over a lock left by a process which died holding it
+        pid_t holder = _slot->lock;
+        if ( holder != 0 && -1 == kill( holder, 0 ) && ESRCH == errno ) {
+            return __sync_bool_compare_and_swap( &_slot->lock, holder, pid );
+        }
+
+        return false;
+
+    } // lock_slot
+
+    static void unlock_slot( auth_session_slot* _slot ) {
+        __sync_synchronize();
+        _slot->lock = 0;
+
+    } // unlock_slot
+
+    static void put_uint( unsigned char* _buf, unsigned int _val ) {
+        _buf[ 0 ] = ( unsigned char )( _val >> 24 );
+        _buf[ 1 ] = ( unsigned char )( _val >> 16 );
+        _buf[ 2 ] = ( unsigned char )( _val >> 8 );
+        _buf[ 3 ] = ( unsigned char )( _val );
+
+    } // put_uint
+
+    static unsigned int get_uint( const unsigned char* _buf ) {
+        return ( ( unsigned int )_buf[ 0 ] << 24 ) |
+               ( ( unsigned int )_buf[ 1 ] << 16 ) |
+               ( ( unsigned int )_buf[ 2 ] << 8 ) |
+               ( unsigned int )_buf[ 3 ];
+
+    } // get_uint
+
+    /// =-=-=-=-=-=-=-
+    /// @brief sign the first 12 bytes of the token for the user
+    static error sign_token(
+        const auth_session_header* _header,
+        const unsigned char*       _token,
+        const std::string&         _user,
+        const std::string&         _zone,
+        unsigned char*             _mac ) {
+        std::string msg( reinterpret_cast< const char* >( _token ), 12 );
+        msg += _user;
+        msg += "#";
+        msg += _zone;
+
+        unsigned char digest[ EVP_MAX_MD_SIZE ];
+        unsigned int  digest_len = 0;
+        if ( !HMAC( EVP_sha256(), _header->secret, sizeof( _header->secret ),
+                    reinterpret_cast< const unsigned char* >( msg.c_str() ), msg.size(),
+                    digest, &digest_len ) ||
+                digest_len < ( unsigned int )AUTH_SESSION_MAC_SIZE ) {
+            return ERROR( SYS_INTERNAL_ERR, "failed to sign the session token" );
+        }
+
+        memcpy( _mac, digest, AUTH_SESSION_MAC_SIZE );
+        return SUCCESS();
+
+    } // sign_token
+
+    bool auth_session_cache::enabled() {
+        if ( lifetime < 0 ) {
+            error ret = get_advanced_setting<int>(
+                            CFG_AUTH_SESSION_LIFETIME,
+                            lifetime );
+            if ( !ret.ok() ) {
+                if ( KEY_NOT_FOUND != ret.code() ) {
+                    irods::log( PASS( ret ) );
+                }
+                lifetime = DEFAULT_AUTH_SESSION_LIFETIME;
+            }
+        }
+
+        return lifetime > 0;
+
+    } // enabled
+
+    unsigned int auth_session_cache::generation() {
+        if ( !enabled() ) {
+            return 0;
+        }
+
+        auth_session_header* header = header_ptr();
+        if ( !header ) {
+            return 0;
+        }
+
+        __sync_synchronize();
+        return header->revocations;
+
+    } // generation
+
+    error auth_session_cache::issue(
+        const std::string& _user,
+        const std::string& _zone,
+        int                _priv_level,
+        unsigned int       _generation,
+        std::string&       _token ) {
+        if ( !enabled() ) {
+            return ERROR( SYS_NOT_SUPPORTED, "authentication session cache is disabled" );
+        }
+
+        if ( _user.empty() || _user.size() >= NAME_LEN || _zone.size() >= NAME_LEN ) {
+            return ERROR( SYS_INVALID_INPUT_PARAM, "invalid user for a session" );
+        }
+
+        auth_session_header* header = header_ptr();
+        if ( !header ) {
+            return ERROR( SYS_INTERNAL_ERR, "authentication session cache is not available" );
+        }
+
+        unsigned int index   = __sync_fetch_and_add( &header->next, 1 ) % AUTH_SESSION_SLOTS;
+        unsigned int expires = ( unsigned int )time( NULL ) + lifetime;
+
+        auth_session_slot* slot = slot_ptr( header, index );
+        if ( !lock_slot( slot ) ) {
+            return ERROR( SYS_INTERNAL_ERR, "authentication session slot is busy" );
+        }
+
+        slot->serial++;
+        slot->expires    = expires;
+        slot->priv_level = _priv_level;
+        snprintf( slot->user, sizeof( slot->user ), "%s", _user.c_str() );
+        snprintf( slot->zone, sizeof( slot->zone ), "%s", _zone.c_str() );
+        unsigned int serial = slot->serial;
+
+        unlock_slot( slot );
+
+        // =-=-=-=-=-=-=-
+        // revoke counts before it looks at the slots, so either it saw
+        // this one or the count has moved since the user was checked
+        __sync_synchronize();
+        if ( header->revocations != _generation ) {
+            if ( lock_slot( slot ) ) {
+                if ( slot->serial == serial ) {
+                    slot->serial++;
+                    slot->expires = 0;
+                    slot->user[ 0 ] = '\0';
+                    slot->zone[ 0 ] = '\0';
+                }
+                unlock_slot( slot );
+            }
+            return ERROR( CAT_INVALID_AUTHENTICATION, "a user was changed since the session was authenticated" );
+        }
+
+        unsigned char token[ AUTH_SESSION_TOKEN_SIZE ];
+        put_uint( token,     index );
+        put_uint( token + 4, serial );
+        put_uint( token + 8, expires );
+        error ret = sign_token( header, token, _user, _zone, token + 12 );
+        if ( !ret.ok() ) {
+            return PASS( ret );
+        }
+
+        unsigned char encoded[ 2 * AUTH_SESSION_TOKEN_SIZE ];
+        unsigned long encoded_len = sizeof( encoded );
+        if ( base64_encode( token, sizeof( token ), encoded, &encoded_len ) != 0 ) {
+            return ERROR( SYS_INTERNAL_ERR, "failed to encode the session token" );
+        }
+
+        _token.assign( reinterpret_cast< char* >( encoded ), encoded_len );
+        return SUCCESS();
+
+    } // issue
+
+    error auth_session_cache::resume(
+        const std::string& _token,
+        const std::string& _user,
+        const std::string& _zone,
+        int&               _priv_level ) {
+        if ( !enabled() ) {
+            return ERROR( SYS_NOT_SUPPORTED, "authentication session cache is disabled" );
+        }
+
+        unsigned char token[ 2 * AUTH_SESSION_TOKEN_SIZE ];
+        unsigned long token_len = sizeof( token );
+        if ( base64_decode( reinterpret_cast< const unsigned char* >( _token.c_str() ), _token.size(),
+                            token, &token_len ) != 0 ||
+                token_len != ( unsigned long )AUTH_SESSION_TOKEN_SIZE ) {
+            return ERROR( CAT_INVALID_AUTHENTICATION, "malformed session token" );
+        }
+
+        unsigned int index   = get_uint( token );
+        unsigned int serial  = get_uint( token + 4 );
+        unsigned int expires = get_uint( token + 8 );
+        if ( index >= AUTH_SESSION_SLOTS ) {
+            return ERROR( CAT_INVALID_AUTHENTICATION, "malformed session token" );
+        }
+        if ( ( unsigned int )time( NULL ) > expires ) {
+            return ERROR( CAT_INVALID_AUTHENTICATION, "session token has expired" );
+        }
+
+        auth_session_header* header = header_ptr();
+        if ( !header ) {
+            return ERROR( SYS_INTERNAL_ERR, "authentication session cache is not available" );
+        }
+
+        // =-=-=-=-=-=-=-
+        // a forged token is turned away before its slot is touched
+        unsigned char mac[ AUTH_SESSION_MAC_SIZE ];
+        error ret = sign_token( header, token, _user, _zone, mac );
+        if ( !ret.ok() ) {
+            return PASS( ret );
+        }
+        if ( CRYPTO_memcmp( mac, token + 12, AUTH_SESSION_MAC_SIZE ) != 0 ) {
+            return ERROR( CAT_INVALID_AUTHENTICATION, "session token signature mismatch" );
+        }
+
+        auth_session_slot* slot = slot_ptr( header, index );
+        if ( !lock_slot( slot ) ) {
+            return ERROR( SYS_INTERNAL_ERR, "authentication session slot is busy" );
+        }
+
+        bool current = slot->serial  == serial  &&
+                       slot->expires == expires &&
+                       _user == slot->user      &&
+                       _zone == slot->zone;
+        int priv_level = slot->priv_level;
+
+        unlock_slot( slot );
+
+        if ( !current ) {
+            return ERROR( CAT_INVALID_AUTHENTICATION, "session was revoked or replaced" );
+        }
+
+        _priv_level = priv_level;
+        return SUCCESS();
+
+    } // resume
+
+    void auth_session_cache::revoke(
+        const std::string& _user,
+        const std::string& _zone ) {
+        if ( !enabled() ) {
+            return;
+        }
+
+        auth_session_header* header = header_ptr();
+        if ( !header ) {
+            return;
+        }
+
+        __sync_fetch_and_add( &header->revocations, 1 );
+
+        int revoked = 0;
+        for ( unsigned int i = 0; i < AUTH_SESSION_SLOTS; ++i ) {
+            auth_session_slot* slot = slot_ptr( header, i );
+            if ( !lock_slot( slot ) ) {
+                rodsLog( LOG_ERROR, "auth_session_cache - failed to lock slot %d to revoke [%s]",
+                         i, _user.c_str() );
+                continue;
+            }
+
+            if ( _user == slot->user && ( _zone.empty() || _zone == slot->zone ) ) {
+                slot->serial++;
+                slot->expires = 0;
+                slot->user[ 0 ] = '\0';
+                slot->zone[ 0 ] = '\0';
+                revoked++;
+            }
+
+            unlock_slot( slot );
+        }
+
+        rodsLog( LOG_DEBUG, "auth_session_cache - revoked %d sessions of [%s#%s]",
+                 revoked, _user.c_str(), _zone.c_str() );
+
+    } // revoke
+
+    void auth_session_cache::remove() {
+        std::string name;
+        if ( segment_name( name ).ok() ) {
+            bi::shared_memory_object::remove( name.c_str() );
+        }
+
+    } // remove
+
+}; // namespace irods
@@ -0,0 +1,306 @@
+#include "irods_coll_repl_scheduler.hpp"
+#include "rodsErrorTable.h"
+#include "rodsLog.h"
+#include "rcMisc.h"
+#include "dataObjRepl.h"
+#include "irods_log.hpp"
+#include "irods_configuration_keywords.hpp"
+#include "irods_server_properties.hpp"
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+namespace irods {
+
+    /// =-=-=-=-=-=-=-
+    /// @brief jobs queued per worker before submit waits, which bounds the
+    ///        memory held for a very large collection
+    static const int MAX_PENDING_PER_WORKER = 64;
+
+    static int get_setting(
+        const std::string& _key,
+        int                _default ) {
+        int val = 0;
+        error ret = get_advanced_setting<int>( _key, val );
+        if ( !ret.ok() ) {
+            if ( KEY_NOT_FOUND != ret.code() ) {
+                irods::log( PASS( ret ) );
+            }
+            return _default;
+        }
+
+        return val;
+
+    } // get_setting
+
+    coll_repl_scheduler::coll_repl_scheduler(
+        rsComm_t*     _comm,
+        keyValPair_t* _cond_input,
+        int           _workers ) :
+        comm_( _comm ),
+        requested_( _workers ),
+        per_resc_( get_setting( CFG_MAX_NUMBER_OF_REPLS_PER_RESC, DEFAULT_MAX_REPLS_PER_RESC ) ),
+        dest_running_( 0 ),
+        running_( 0 ),
+        done_( false ),
+        status_( 0 ),
+        already_in_resc_( false ),
+        completed_( 0 ),
+        bytes_( 0 ) {
+        if ( per_resc_ <= 0 ) {
+            per_resc_ = DEFAULT_MAX_REPLS_PER_RESC;
+        }
+
+        // =-=-=-=-=-=-=-
+        // the workers replicate single objects, so the keyword which asked
+        // for them is not passed on
+        memset( &cond_input_, 0, sizeof( cond_input_ ) );
+        replKeyVal( _cond_input, &cond_input_ );
+        rmKeyVal( &cond_input_, REPL_WORKERS_KW );
+
+        const char* dest = getValByKey( &cond_input_, DEST_RESC_NAME_KW );
+        if ( dest == NULL ) {
+            dest = getValByKey( &cond_input_, BACKUP_RESC_NAME_KW );
+        }
+        if ( dest == NULL ) {
+            dest = getValByKey( &cond_input_, DEF_RESC_NAME_KW );
+        }
+        dest_resc_ = dest ? dest : "";
+
+    } // ctor
+
+    coll_repl_scheduler::~coll_repl_scheduler() {
+        finish();
+        clearKeyVal( &cond_input_ );
+
+    } // dtor
+
+    int coll_repl_scheduler::workers_for( int _requested ) {
+        int max_workers = get_setting(
+                              CFG_MAX_NUMBER_OF_COLL_REPL_WORKERS,
+                              DEFAULT_MAX_COLL_REPL_WORKERS );
+        if ( _requested > max_workers ) {
+            return max_workers;
+        }
+
+        return _requested;
+
+    } // workers_for
+
+    int coll_repl_scheduler::start() {
+        int status = 0;
+        for ( int i = 0; i < requested_; ++i ) {
+            rErrMsg_t err_msg;
+            memset( &err_msg, 0, sizeof( err_msg ) );
+            rcComm_t* conn = _rcConnect(
+                                 comm_->myEnv.rodsHost,
+                                 comm_->myEnv.rodsPort,
+                                 comm_->myEnv.rodsUserName,
+                                 comm_->myEnv.rodsZone,
+                                 comm_->clientUser.userName,
+                                 comm_->clientUser.rodsZone,
+                                 &err_msg,
+                                 0,
+                                 NO_RECONN );
+            if ( conn == NULL ) {
+                status = err_msg.status < 0 ? err_msg.status : SYS_SVR_TO_SVR_CONNECT_FAILED;
+                rodsLogError( LOG_ERROR, status,
+                              "coll_repl_scheduler::start: connect failed for worker %d", i );
+                break;
+            }
+
+            status = clientLogin( conn );
+            if ( status != 0 ) {
+                rodsLogError( LOG_ERROR, status,
+                              "coll_repl_scheduler::start: clientLogin failed for worker %d", i );
+                rcDisconnect( conn );
+                break;
+            }
+
+            worker* w = new worker;
+            w->idx_    = i;
+            w->conn_   = conn;
+            w->thread_ = NULL;
+            workers_.push_back( w );
+        }
+
+        if ( workers_.empty() ) {
+            return status < 0 ? status : SYS_INVALID_INPUT_PARAM;
+        }
+
+        for ( size_t i = 0; i < workers_.size(); ++i ) {
+            workers_[ i ]->thread_ = new boost::thread(
+                &coll_repl_scheduler::run, this, workers_[ i ] );
+        }
+
+        return workers_.size();
+
+    } // start
+
+    bool coll_repl_scheduler::submit( const coll_repl_job& _job ) {
+        boost::mutex::scoped_lock lock( mutex_ );
+        while ( status_ >= 0 &&
+                ( int )jobs_.size() >= MAX_PENDING_PER_WORKER * ( int )workers_.size() ) {
+            room_.wait( lock );
+        }
+        if ( status_ < 0 ) {
+            return false;
+        }
+
+        jobs_.push_back( _job );
+        work_.notify_all();
+        return true;
+
+    } // submit
+
+    bool coll_repl_scheduler::take( coll_repl_job& _job ) {
+        // =-=-=-=-=-=-=-
+        // the first queued job whose resources both have room, which
+        // lets jobs from an idle source pass those from a busy one
+        if ( dest_running_ >= per_resc_ ) {
+            return false;
+        }
+
+        std::deque< coll_repl_job >::iterator itr;
+        for ( itr = jobs_.begin(); itr != jobs_.end(); ++itr ) {
+            if ( src_running_[ itr->src_resc_ ] < per_resc_ ) {
+                _job = *itr;
+                jobs_.erase( itr );
+                src_running_[ _job.src_resc_ ]++;
+                dest_running_++;
+                running_++;
+                return true;
+            }
+        }
+
+        return false;
+
+    } // take
+
+    void coll_repl_scheduler::release( const coll_repl_job& _job ) {
+        src_running_[ _job.src_resc_ ]--;
+        dest_running_--;
+        running_--;
+
+    } // release
+
+    void coll_repl_scheduler::run( worker* _w ) {
+        while ( true ) {
+            coll_repl_job job;
+            {
+                boost::mutex::scoped_lock lock( mutex_ );
+                while ( !take( job ) ) {
+                    if ( done_ && jobs_.empty() ) {
+                        return;
+                    }
+                    work_.wait( lock );
+                }
+                room_.notify_one();
+            }
+
+            dataObjInp_t inp;
+            memset( &inp, 0, sizeof( inp ) );
+            rstrcpy( inp.objPath, job.path_.c_str(), MAX_NAME_LEN );
+            replKeyVal( &cond_input_, &inp.condInput );
+            // replicate from the resource the job was scheduled against
+            // rather than letting each agent pick its own source
+            if ( !job.src_resc_.empty() ) {
+                addKeyVal( &inp.condInput, RESC_NAME_KW, job.src_resc_.c_str() );
+            }
+
+            transferStat_t* stat = NULL;
+            int status = _rcDataObjRepl( _w->conn_, &inp, &stat );
+            rodsLong_t bytes = stat ? stat->bytesWritten : 0;
+            free( stat );
+            clearKeyVal( &inp.condInput );
+            freeRErrorContent( _w->conn_->rError );
+
+            boost::mutex::scoped_lock lock( mutex_ );
+            release( job );
+            if ( status == SYS_COPY_ALREADY_IN_RESC ) {
+                already_in_resc_ = true;
+                status = 0;
+            }
+
+            if ( status < 0 ) {
+                rodsLogError( LOG_ERROR, status,
+                              "coll_repl_scheduler: replication of %s to [%s] failed on connection %d",
+                              job.path_.c_str(), dest_resc_.c_str(), _w->idx_ );
+                // =-=-=-=-=-=-=-
+                // stop at the first failure, as the serial replication does
+                if ( status_ >= 0 ) {
+                    status_ = status;
+                }
+                jobs_.clear();
+                room_.notify_all();
+            }
+            else {
+                completed_++;
+                bytes_ += bytes;
+                last_ = job.path_;
+            }
+
+            work_.notify_all();
+            done_cond_.notify_all();
+        }
+
+    } // run
+
+    int coll_repl_scheduler::completed(
+        int          _wait_ms,
+        rodsLong_t&  _bytes,
+        std::string& _last ) {
+        boost::mutex::scoped_lock lock( mutex_ );
+        if ( completed_ == 0 && _wait_ms > 0 &&
+                ( !jobs_.empty() || running_ > 0 ) ) {
+            done_cond_.timed_wait( lock, boost::posix_time::milliseconds( _wait_ms ) );
+        }
+
+        int count = completed_;
+        _bytes = bytes_;
+        _last  = last_;
+        completed_ = 0;
+        bytes_     = 0;
+        return count;
+
+    } // completed
+
+    void coll_repl_scheduler::cancel() {
+        boost::mutex::scoped_lock lock( mutex_ );
+        jobs_.clear();
+        room_.notify_all();
+
+    } // cancel
+
+    bool coll_repl_scheduler::busy() {
+        boost::mutex::scoped_lock lock( mutex_ );
+        return !jobs_.empty() || running_ > 0;
+
+    } // busy
+
+    int coll_repl_scheduler::finish() {
+        {
+            boost::mutex::scoped_lock lock( mutex_ );
+            done_ = true;
+            work_.notify_all();
+        }
+
+        for ( size_t i = 0; i < workers_.size(); ++i ) {
+            worker* w = workers_[ i ];
+            if ( w->thread_ ) {
+                w->thread_->join();
+                delete w->thread_;
+            }
+            rcDisconnect( w->conn_ );
+            delete w;
+        }
+        workers_.clear();
+
+        if ( status_ < 0 ) {
+            return status_;
+        }
+
+        return already_in_resc_ ? SYS_COPY_ALREADY_IN_RESC : 0;
+
+    } // finish
+
+}; // namespace irods
@@ -0,0 +1,247 @@
+#include "irods_coll_unlink_scheduler.hpp"
+#include "rodsErrorTable.h"
+#include "rodsLog.h"
+#include "rcMisc.h"
+#include "fileUnlink.h"
+#include "fileStat.h"
+#include "dataObjUnlink.h"
+#include "irods_log.hpp"
+#include "irods_configuration_keywords.hpp"
+#include "irods_server_properties.hpp"
+
+namespace irods {
+
+    /// =-=-=-=-=-=-=-
+    /// @brief files queued per worker before submit waits
+    static const size_t MAX_UNLINKS_PER_WORKER = 256;
+
+    static void unlink_struct_file_index(
+        rcComm_t*              _conn,
+        const fileUnlinkInp_t& _inp ) {
+        // =-=-=-=-=-=-=-
+        // as l3UnlinkStructFileIndex, look for the index of a tar file
+        // first, as the stat of a missing file is not logged
+        fileStatInp_t stat_inp;
+        memset( &stat_inp, 0, sizeof( stat_inp ) );
+        snprintf( stat_inp.fileName, MAX_NAME_LEN, "%s%s", _inp.fileName, STRUCT_FILE_INDEX_EXT );
+        rstrcpy( stat_inp.rescHier, _inp.rescHier, MAX_NAME_LEN );
+        rstrcpy( stat_inp.addr.hostAddr, _inp.addr.hostAddr, NAME_LEN );
+        rstrcpy( stat_inp.objPath, _inp.objPath, MAX_NAME_LEN );
+        rodsStat_t* stat_out = 0;
+        int status = rcFileStat( _conn, &stat_inp, &stat_out );
+        free( stat_out );
+        freeRErrorContent( _conn->rError );
+        if ( status < 0 ) {
+            return;
+        }
+
+        fileUnlinkInp_t inp = _inp;
+        rstrcpy( inp.fileName, stat_inp.fileName, MAX_NAME_LEN );
+        rcFileUnlink( _conn, &inp );
+        freeRErrorContent( _conn->rError );
+
+    } // unlink_struct_file_index
+
+    coll_unlink_scheduler::coll_unlink_scheduler(
+        rsComm_t* _comm ) :
+        comm_( _comm ),
+        queued_( 0 ),
+        active_( 0 ),
+        done_( false ) {
+
+    } // ctor
+
+    coll_unlink_scheduler::~coll_unlink_scheduler() {
+        std::vector< coll_unlink_job > failed;
+        finish( failed );
+
+    } // dtor
+
+    int coll_unlink_scheduler::start() {
+        int workers = 0;
+        error ret = get_advanced_setting<int>( CFG_MAX_NUMBER_OF_COLL_DELETE_WORKERS, workers );
+        if ( !ret.ok() ) {
+            if ( KEY_NOT_FOUND != ret.code() ) {
+                irods::log( PASS( ret ) );
+            }
+            workers = DEFAULT_MAX_COLL_DELETE_WORKERS;
+        }
+        if ( workers <= 0 ) {
+            return SYS_INVALID_INPUT_PARAM;
+        }
+
+        int status = 0;
+        for ( int i = 0; i < workers; ++i ) {
+            rErrMsg_t err_msg;
+            memset( &err_msg, 0, sizeof( err_msg ) );
+            rcComm_t* conn = _rcConnect(
+                                 comm_->myEnv.rodsHost,
+                                 comm_->myEnv.rodsPort,
+                                 comm_->myEnv.rodsUserName,
+                                 comm_->myEnv.rodsZone,
+                                 comm_->clientUser.userName,
+                                 comm_->clientUser.rodsZone,
+                                 &err_msg,
+                                 0,
+                                 NO_RECONN );
+            if ( conn == NULL ) {
+                status = err_msg.status < 0 ? err_msg.status : SYS_SVR_TO_SVR_CONNECT_FAILED;
+                rodsLogError( LOG_ERROR, status,
+                              "coll_unlink_scheduler::start: connect failed for worker %d", i );
+                break;
+            }
+
+            status = clientLogin( conn );
+            if ( status != 0 ) {
+                rodsLogError( LOG_ERROR, status,
+                              "coll_unlink_scheduler::start: clientLogin failed for worker %d", i );
+                rcDisconnect( conn );
+                break;
+            }
+
+            worker* w = new worker;
+            w->idx_    = i;
+            w->conn_   = conn;
+            w->thread_ = NULL;
+            workers_.push_back( w );
+        }
+
+        if ( workers_.empty() ) {
+            return status < 0 ? status : SYS_INVALID_INPUT_PARAM;
+        }
+
+        for ( size_t i = 0; i < workers_.size(); ++i ) {
+            workers_[ i ]->thread_ = new boost::thread(
+                &coll_unlink_scheduler::run, this, workers_[ i ] );
+        }
+
+        return workers_.size();
+
+    } // start
+
+    void coll_unlink_scheduler::submit( const coll_unlink_job& _job ) {
+        boost::mutex::scoped_lock lock( mutex_ );
+        while ( queued_ >= MAX_UNLINKS_PER_WORKER * workers_.size() ) {
+            room_.wait( lock );
+        }
+
+        queues_[ _job.resc_hier_ ].push_back( _job );
+        queued_++;
+        work_.notify_one();
+
+    } // submit
+
+    bool coll_unlink_scheduler::take( coll_unlink_job& _job ) {
+        queue_map_t::iterator best = queues_.end();
+        int best_running = 0;
+        queue_map_t::iterator itr;
+        for ( itr = queues_.begin(); itr != queues_.end(); ++itr ) {
+            int running = running_[ itr->first ];
+            if ( best == queues_.end() || running < best_running ) {
+                best = itr;
+                best_running = running;
+            }
+        }
+
+        if ( best == queues_.end() ) {
+            return false;
+        }
+
+        _job = best->second.front();
+        best->second.pop_front();
+        if ( best->second.empty() ) {
+            queues_.erase( best );
+        }
+        running_[ _job.resc_hier_ ]++;
+        queued_--;
+        active_++;
+        return true;
+
+    } // take
+
+    void coll_unlink_scheduler::run( worker* _w ) {
+        while ( true ) {
+            coll_unlink_job job;
+            {
+                boost::mutex::scoped_lock lock( mutex_ );
+                while ( !take( job ) ) {
+                    if ( done_ ) {
+                        return;
+                    }
+                    work_.wait( lock );
+                }
+                room_.notify_one();
+            }
+
+            fileUnlinkInp_t inp;
+            memset( &inp, 0, sizeof( inp ) );
+            rstrcpy( inp.fileName, job.file_path_.c_str(), MAX_NAME_LEN );
+            rstrcpy( inp.rescHier, job.resc_hier_.c_str(), MAX_NAME_LEN );
+            rstrcpy( inp.addr.hostAddr, job.location_.c_str(), NAME_LEN );
+            rstrcpy( inp.objPath, job.obj_path_.c_str(), MAX_NAME_LEN );
+            int status = rcFileUnlink( _w->conn_, &inp );
+            freeRErrorContent( _w->conn_->rError );
+            if ( status >= 0 && isStructFileDataType( job.data_type_.c_str() ) ) {
+                unlink_struct_file_index( _w->conn_, inp );
+            }
+
+            boost::mutex::scoped_lock lock( mutex_ );
+            running_[ job.resc_hier_ ]--;
+            active_--;
+
+            // =-=-=-=-=-=-=-
+            // as for a single object, a file which is already gone or may
+            // not be removed is not kept as an orphan
+            if ( status < 0 ) {
+                int err = getErrno( status );
+                if ( err != ENOENT && err != EACCES ) {
+                    rodsLogError( LOG_NOTICE, status,
+                                  "coll_unlink_scheduler: unlink of %s failed on connection %d",
+                                  job.file_path_.c_str(), _w->idx_ );
+                    job.status_ = status;
+                    failed_.push_back( job );
+                }
+            }
+
+            if ( 0 == queued_ && 0 == active_ ) {
+                idle_.notify_all();
+            }
+        }
+
+    } // run
+
+    void coll_unlink_scheduler::drain( std::vector< coll_unlink_job >& _failed ) {
+        boost::mutex::scoped_lock lock( mutex_ );
+        while ( !workers_.empty() && ( queued_ > 0 || active_ > 0 ) ) {
+            idle_.wait( lock );
+        }
+
+        _failed.swap( failed_ );
+        failed_.clear();
+
+    } // drain
+
+    void coll_unlink_scheduler::finish( std::vector< coll_unlink_job >& _failed ) {
+        {
+            boost::mutex::scoped_lock lock( mutex_ );
+            done_ = true;
+            work_.notify_all();
+        }
+
+        for ( size_t i = 0; i < workers_.size(); ++i ) {
+            worker* w = workers_[ i ];
+            if ( w->thread_ ) {
+                w->thread_->join();
+                delete w->thread_;
+            }
+            rcDisconnect( w->conn_ );
+            delete w;
+        }
+        workers_.clear();
+
+        _failed.swap( failed_ );
+        failed_.clear();
+
+    } // finish
+
+}; // namespace irods
@@ -0,0 +1,78 @@
+#include "fileOpr.hpp"
+#include "irods_l1desc_table.hpp"
+
+namespace irods {
+
+    l1desc_table::l1desc_table() :
+        next_( L1DESC_TABLE_FIRST_INDEX ),
+        in_use_( 0 ),
+        high_water_mark_( 0 ) {
+    }
+
+    l1desc_table::~l1desc_table() {
+        clear();
+    }
+
+    int l1desc_table::alloc() {
+        int idx = -1;
+        while ( !free_.empty() ) {
+            int candidate = free_.back();
+            free_.pop_back();
+            if ( ( *this )[ candidate ].inuseFlag <= FD_FREE ) {
+                idx = candidate;
+                break;
+            }
+        }
+
+        if ( idx < 0 ) {
+            if ( next_ >= ( int )chunks_.size() * L1DESC_TABLE_CHUNK_SIZE ) {
+                // =-=-=-=-=-=-=-
+                // value-initialized, so the descriptors start out zeroed
+                // as the static array did
+                chunks_.push_back( new l1desc_t[ L1DESC_TABLE_CHUNK_SIZE ]() );
+            }
+            idx = next_++;
+        }
+
+        ( *this )[ idx ].inuseFlag = FD_INUSE;
+        in_use_++;
+        if ( in_use_ > high_water_mark_ ) {
+            high_water_mark_ = in_use_;
+        }
+
+        return idx;
+
+    } // alloc
+
+    void l1desc_table::release( int _idx ) {
+        if ( _idx < L1DESC_TABLE_FIRST_INDEX || _idx >= next_ ) {
+            return;
+        }
+        free_.push_back( _idx );
+        if ( in_use_ > 0 ) {
+            in_use_--;
+        }
+
+    } // release
+
+    void l1desc_table::clear() {
+        for ( size_t i = 0; i < chunks_.size(); ++i ) {
+            delete [] chunks_[ i ];
+        }
+        chunks_.clear();
+        free_.clear();
+        next_   = L1DESC_TABLE_FIRST_INDEX;
+        in_use_ = 0;
+
+    } // clear
+
+    l1desc_table::stats l1desc_table::get_stats() const {
+        stats s;
+        s.size            = next_;
+        s.in_use          = in_use_;
+        s.high_water_mark = high_water_mark_;
+        return s;
+
+    } // get_stats
+
+}; // namespace irods
@@ -0,0 +1,314 @@
+#include "rodsErrorTable.h"
+#include "rodsLog.h"
+#include "rodsConnect.h"
+#include "rcGlobalExtern.h"
+#include "packStruct.h"
+#include "rcMisc.h"
+#include "irods_log.hpp"
+#include "irods_resource_cache.hpp"
+#include "irods_configuration_keywords.hpp"
+#include "irods_server_properties.hpp"
+
+#include <sys/time.h>
+#include <string.h>
+#include <string>
+
+#include <boost/interprocess/creation_tags.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+namespace bi = boost::interprocess;
+
+namespace irods {
+
+    /// =-=-=-=-=-=-=-
+    /// @brief written last, once the rest of a publication is in place
+    static const unsigned int RESOURCE_CACHE_MAGIC = 0x52455343;
+
+    /// =-=-=-=-=-=-=-
+    /// @brief a publication still incomplete after this long was left by
+    ///        a process which died while writing it
+    static const int RESOURCE_CACHE_ABANDONED = 10;
+
+    /// =-=-=-=-=-=-=-
+    /// @brief the invalidation count lives in a segment of its own, the
+    ///        only one written by more than one process
+    static const bi::offset_t RESOURCE_CACHE_COUNT_SIZE = 4096;
+
+    struct resource_cache_header {
+        unsigned int magic;
+        unsigned int count;
+        rodsULong_t  generation;
+        rodsULong_t  published;
+        unsigned int pages;
+        unsigned int reserved;
+    };
+
+    static bi::shared_memory_object* count_obj    = NULL;
+    static bi::mapped_region*        count_region = NULL;
+    static int                       lifetime     = -1;
+
+    static size_t page_span( size_t _len ) {
+        return sizeof( unsigned int ) + ( ( _len + 7 ) & ~( size_t )7 );
+    }
+
+    /// =-=-=-=-=-=-=-
+    /// @brief the segments are salted like the rule engine cache, so each
+    ///        server run has its own
+    static error segment_name(
+        const std::string& _kind,
+        std::string&       _name ) {
+        std::string salt;
+        error ret = server_properties::getInstance().get_property< std::string >( RE_CACHE_SALT_KW, salt );
+        if ( !ret.ok() ) {
+            return PASS( ret );
+        }
+
+        _name = "irods_resc_cache_" + _kind + "_shared_memory_" + salt;
+        return SUCCESS();
+
+    } // segment_name
+
+    static volatile unsigned int* count_ptr() {
+        if ( !count_region ) {
+            std::string name;
+            error ret = segment_name( "count", name );
+            if ( !ret.ok() ) {
+                irods::log( PASS( ret ) );
+                return NULL;
+            }
+
+            try {
+                count_obj = new bi::shared_memory_object( bi::open_or_create, name.c_str(), bi::read_write, 0600 );
+                bi::offset_t size = 0;
+                if ( count_obj->get_size( size ) && size == 0 ) {
+                    count_obj->truncate( RESOURCE_CACHE_COUNT_SIZE );
+                }
+                count_region = new bi::mapped_region( *count_obj, bi::read_write );
+            }
+            catch ( const bi::interprocess_exception& e ) {
+                rodsLog( LOG_ERROR, "resource_cache - failed to map [%s]. Exception caught [%s]",
+                         name.c_str(), e.what() );
+                delete count_obj;
+                count_obj = NULL;
+                return NULL;
+            }
+        }
+
+        return static_cast< volatile unsigned int* >( count_region->get_address() );
+
+    } // count_ptr
+
+    bool resource_cache::enabled() {
+        if ( lifetime < 0 ) {
+            error ret = get_advanced_setting<int>(
+                            CFG_RESOURCE_CACHE_LIFETIME,
+                            lifetime );
+            if ( !ret.ok() ) {
+                if ( KEY_NOT_FOUND != ret.code() ) {
+                    irods::log( PASS( ret ) );
+                }
+                lifetime = DEFAULT_RESOURCE_CACHE_LIFETIME;
+            }
+        }
+
+        return lifetime > 0;
+
+    } // enabled
+
+    unsigned int resource_cache::invalidation_count() {
+        volatile unsigned int* count = count_ptr();
+        return count ? *count : 0;
+
+    } // invalidation_count
+
+    error resource_cache::fetch(
+        std::vector< genQueryOut_t* >& _pages,
+        rodsULong_t&                   _generation ) {
+        if ( !enabled() ) {
+            return ERROR( SYS_NOT_SUPPORTED, "resource cache is disabled" );
+        }
+
+        std::string name;
+        error ret = segment_name( "rows", name );
+        if ( !ret.ok() ) {
+            return PASS( ret );
+        }
+
+        try {
+            bi::shared_memory_object shm( bi::open_only, name.c_str(), bi::read_only );
+            bi::mapped_region region( shm, bi::read_only );
+
+            const char* base = static_cast< const char* >( region.get_address() );
+            size_t      size = region.get_size();
+            if ( size < sizeof( resource_cache_header ) ) {
+                return ERROR( KEY_NOT_FOUND, "resource cache is empty" );
+            }
+
+            resource_cache_header header;
+            memcpy( &header, base, sizeof( header ) );
+            if ( header.magic != RESOURCE_CACHE_MAGIC ) {
+                return ERROR( KEY_NOT_FOUND, "resource cache is being published" );
+            }
+            if ( header.count != invalidation_count() ||
+                    ( rodsULong_t )time( NULL ) > header.published + lifetime ) {
+                return ERROR( KEY_NOT_FOUND, "resource cache is stale" );
+            }
+
+            size_t offset = sizeof( header );
+            for ( unsigned int i = 0; i < header.pages; ++i ) {
+                unsigned int len = 0;
+                if ( offset + sizeof( len ) > size ) {
+                    break;
+                }
+                memcpy( &len, base + offset, sizeof( len ) );
+                if ( offset + page_span( len ) > size ) {
+                    break;
+                }
+
+                genQueryOut_t* page = NULL;
+                int status = unpackStruct(
+                                 const_cast< char* >( base + offset + sizeof( len ) ),
+                                 ( void** )&page, "GenQueryOut_PI", RodsPackTable, NATIVE_PROT );
+                if ( status < 0 ) {
+                    for ( size_t p = 0; p < _pages.size(); ++p ) {
+                        freeGenQueryOut( &_pages[ p ] );
+                    }
+                    _pages.clear();
+                    return ERROR( status, "failed to unpack resource cache page" );
+                }
+                _pages.push_back( page );
+                offset += page_span( len );
+            }
+
+            if ( _pages.size() != header.pages ) {
+                for ( size_t p = 0; p < _pages.size(); ++p ) {
+                    freeGenQueryOut( &_pages[ p ] );
+                }
+                _pages.clear();
+                return ERROR( SYS_INTERNAL_ERR, "resource cache is truncated" );
+            }
+
+            _generation = header.generation;
+        }
+        catch ( const bi::interprocess_exception& ) {
+            return ERROR( KEY_NOT_FOUND, "resource cache is not published" );
+        }
+
+        return SUCCESS();
+
+    } // fetch
+
+    error resource_cache::publish(
+        unsigned int                       _count,
+        const std::vector< bytesBuf_t* >& _pages,
+        rodsULong_t&                       _generation ) {
+        if ( !enabled() ) {
+            return ERROR( SYS_NOT_SUPPORTED, "resource cache is disabled" );
+        }
+
+        // =-=-=-=-=-=-=-
+        // a resource changed while the rows were read, they may predate it
+        if ( _count != invalidation_count() ) {
+            return ERROR( KEY_NOT_FOUND, "resources changed during the catalog read" );
+        }
+
+        std::string name;
+        error ret = segment_name( "rows", name );
+        if ( !ret.ok() ) {
+            return PASS( ret );
+        }
+
+        // =-=-=-=-=-=-=-
+        // leave a current or recently started publication alone, replace
+        // a stale or abandoned one
+        try {
+            bi::shared_memory_object shm( bi::open_only, name.c_str(), bi::read_only );
+            bi::mapped_region region( shm, bi::read_only );
+            if ( region.get_size() >= sizeof( resource_cache_header ) ) {
+                resource_cache_header header;
+                memcpy( &header, region.get_address(), sizeof( header ) );
+                rodsULong_t now = time( NULL );
+                if ( header.magic == RESOURCE_CACHE_MAGIC ) {
+                    if ( header.count == _count && now <= header.published + lifetime ) {
+                        return ERROR( KEY_NOT_FOUND, "resource cache is already published" );
+                    }
+                }
+                else if ( now <= header.published + RESOURCE_CACHE_ABANDONED ) {
+                    return ERROR( KEY_NOT_FOUND, "resource cache is being published" );
+                }
+            }
+            bi::shared_memory_object::remove( name.c_str() );
+        }
+        catch ( const bi::interprocess_exception& ) {
+            // =-=-=-=-=-=-=-
+            // nothing published yet
+        }
+
+        size_t size = sizeof( resource_cache_header );
+        for ( size_t i = 0; i < _pages.size(); ++i ) {
+            size += page_span( _pages[ i ]->len );
+        }
+
+        struct timeval tv;
+        gettimeofday( &tv, NULL );
+
+        try {
+            bi::shared_memory_object shm( bi::create_only, name.c_str(), bi::read_write, 0600 );
+            shm.truncate( size );
+            bi::mapped_region region( shm, bi::read_write );
+            char* base = static_cast< char* >( region.get_address() );
+
+            resource_cache_header header;
+            memset( &header, 0, sizeof( header ) );
+            header.count      = _count;
+            header.generation = ( rodsULong_t )tv.tv_sec * 1000000 + tv.tv_usec;
+            header.published  = tv.tv_sec;
+            header.pages      = _pages.size();
+            memcpy( base, &header, sizeof( header ) );
+
+            size_t offset = sizeof( header );
+            for ( size_t i = 0; i < _pages.size(); ++i ) {
+                unsigned int len = _pages[ i ]->len;
+                memcpy( base + offset, &len, sizeof( len ) );
+                memcpy( base + offset + sizeof( len ), _pages[ i ]->buf, len );
+                offset += page_span( len );
+            }
+
+            __sync_synchronize();
+            reinterpret_cast< resource_cache_header* >( base )->magic = RESOURCE_CACHE_MAGIC;
+
+            _generation = header.generation;
+        }
+        catch ( const bi::interprocess_exception& e ) {
+            // =-=-=-=-=-=-=-
+            // most likely another process won the race to publish
+            return ERROR( KEY_NOT_FOUND, e.what() );
+        }
+
+        rodsLog( LOG_DEBUG, "resource_cache - published %d pages in %d bytes",
+                 ( int )_pages.size(), ( int )size );
+        return SUCCESS();
+
+    } // publish
+
+    void resource_cache::invalidate() {
+        volatile unsigned int* count = count_ptr();
+        if ( count ) {
+            __sync_fetch_and_add( count, 1 );
+        }
+
+    } // invalidate
+
+    void resource_cache::remove() {
+        std::string name;
+        if ( segment_name( "rows", name ).ok() ) {
+            bi::shared_memory_object::remove( name.c_str() );
+        }
+        if ( segment_name( "count", name ).ok() ) {
+            bi::shared_memory_object::remove( name.c_str() );
+        }
+
+    } // remove
+
+}; // namespace irods
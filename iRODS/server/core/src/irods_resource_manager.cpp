@@ -3,6 +3,7 @@
 #include "irods_log.hpp"
 #include "irods_string_tokenize.hpp"
 #include "irods_stacktrace.hpp"
+#include "irods_resource_cache.hpp"
 
 // =-=-=-=-=-=-=-
 // irods includes
@@ -27,12 +28,14 @@ irods::resource_manager resc_mgr;
 namespace irods {
 // =-=-=-=-=-=-=-
 // public - Constructor
-    resource_manager::resource_manager() {
+    resource_manager::resource_manager() :
+        generation_( 0 ) {
     } // ctor
 
 // =-=-=-=-=-=-=-
 // public - Copy Constructor
-    resource_manager::resource_manager( const resource_manager& ) {
+    resource_manager::resource_manager( const resource_manager& ) :
+        generation_( 0 ) {
     } // cctor
 
 // =-=-=-=-=-=-=-
@@ -154,8 +157,93 @@ namespace irods {
 //          attached resources and instantiate them
     error resource_manager::init_from_catalog( rsComm_t* _comm ) {
         // =-=-=-=-=-=-=-
-        // clear existing resource map and initialize
+        // use the rows published in shared memory, if any.  a table built
+        // from the same publication is kept, only the hosts are resolved
+        // again as the server host list is rebuilt for each connection
+        std::vector< genQueryOut_t* > cached_pages;
+        rodsULong_t generation = 0;
+        error cache_ret = resource_cache::fetch( cached_pages, generation );
+        if ( cache_ret.ok() && generation == generation_ && !resources_.empty() ) {
+            for ( size_t i = 0; i < cached_pages.size(); ++i ) {
+                freeGenQueryOut( &cached_pages[ i ] );
+            }
+            return resolve_resource_hosts();
+        }
+
+        // =-=-=-=-=-=-=-
+        // clear existing resource map and the maintenance operations
+        // gathered from it, and initialize
         resources_.clear();
+        maintenance_operations_.clear();
+        generation_ = 0;
+
+        error proc_ret;
+
+        if ( cache_ret.ok() ) {
+            for ( size_t i = 0; i < cached_pages.size(); ++i ) {
+                if ( proc_ret.ok() ) {
+                    proc_ret = process_init_results( cached_pages[ i ] );
+                }
+                freeGenQueryOut( &cached_pages[ i ] );
+            }
+
+            if ( !proc_ret.ok() ) {
+                return PASSMSG( "process_init_results failed.", proc_ret );
+            }
+            generation_ = generation;
+        }
+        else {
+            proc_ret = init_from_query( _comm );
+            if ( !proc_ret.ok() ) {
+                return PASS( proc_ret );
+            }
+        }
+
+        // =-=-=-=-=-=-=-
+        // Update child resource maps
+        proc_ret = init_child_map();
+        if ( !proc_ret.ok() ) {
+            return PASSMSG( "init_child_map failed.", proc_ret );
+        }
+
+        // =-=-=-=-=-=-=-
+        // gather the post disconnect maintenance operations
+        error op_ret = gather_operations();
+        if ( !op_ret.ok() ) {
+            return PASSMSG( "gather_operations failed.", op_ret );
+        }
+
+        // =-=-=-=-=-=-=-
+        // initialize the special local file system resource
+        // JMC :: no longer needed
+        //error spec_ret = init_local_file_system_resource();
+        //if ( !spec_ret.ok() ) {
+        //    return PASSMSG( "init_local_file_system_resource failed.", op_ret );
+        //}
+
+        // =-=-=-=-=-=-=-
+        // call start for plugins
+        error start_err = start_resource_plugins();
+        if ( !start_err.ok() ) {
+            return PASSMSG( "start_resource_plugins failed.", start_err );
+        }
+
+        // =-=-=-=-=-=-=-
+        // win!
+        return SUCCESS();
+
+    } // init_from_catalog
+
+// =-=-=-=-=-=-=-
+// private - query the catalog for the resources, publishing the
+//           rows in the resource cache
+    error resource_manager::init_from_query( rsComm_t* _comm ) {
+        // =-=-=-=-=-=-=-
+        // the invalidation count is read before the rows, so a change
+        // committed during the query keeps them from being published
+        unsigned int count = resource_cache::invalidation_count();
+        bool publishing = resource_cache::enabled();
+        std::vector< bytesBuf_t* > packed_pages;
 
         // =-=-=-=-=-=-=-
         // set up data structures for a gen query
@@ -207,6 +295,9 @@ namespace irods {
                 }
 
                 clearGenQueryInp( &genQueryInp );
+                for ( size_t i = 0; i < packed_pages.size(); ++i ) {
+                    freeBBuf( packed_pages[ i ] );
+                }
                 return ERROR( status, "genQuery failed." );
 
             } // if
@@ -215,6 +306,19 @@ namespace irods {
             // given a series of rows, each being a resource, create a resource and add it to the table
             proc_ret = process_init_results( genQueryOut );
 
+            // =-=-=-=-=-=-=-
+            // keep the page to publish for the other agents
+            if ( proc_ret.ok() && publishing && genQueryOut != NULL ) {
+                bytesBuf_t* packed = NULL;
+                if ( packStruct( genQueryOut, &packed, "GenQueryOut_PI",
+                                 RodsPackTable, 0, NATIVE_PROT ) >= 0 ) {
+                    packed_pages.push_back( packed );
+                }
+                else {
+                    publishing = false;
+                }
+            }
+
             // =-=-=-=-=-=-=-
             // if error is not valid, clear query and bail
             if ( !proc_ret.ok() ) {
@@ -239,45 +343,71 @@ namespace irods {
         clearGenQueryInp( &genQueryInp );
 
         // =-=-=-=-=-=-=-
-        // pass along the error if we are in an error state
-        if ( !proc_ret.ok() ) {
-            return PASSMSG( "process_init_results failed.", proc_ret );
+        // publish the rows, a failure only means the next agent queries
+        if ( proc_ret.ok() && publishing ) {
+            rodsULong_t generation = 0;
+            error pub_ret = resource_cache::publish( count, packed_pages, generation );
+            if ( pub_ret.ok() ) {
+                generation_ = generation;
+            }
+            else {
+                rodsLog( LOG_DEBUG, "init_from_query - resource cache not published: %s",
+                         pub_ret.result().c_str() );
+            }
         }
 
-        // =-=-=-=-=-=-=-
-        // Update child resource maps
-        proc_ret = init_child_map();
-        if ( !proc_ret.ok() ) {
-            return PASSMSG( "init_child_map failed.", proc_ret );
+        for ( size_t i = 0; i < packed_pages.size(); ++i ) {
+            freeBBuf( packed_pages[ i ] );
         }
 
         // =-=-=-=-=-=-=-
-        // gather the post disconnect maintenance operations
-        error op_ret = gather_operations();
-        if ( !op_ret.ok() ) {
-            return PASSMSG( "gather_operations failed.", op_ret );
+        // pass along the error if we are in an error state
+        if ( !proc_ret.ok() ) {
+            return PASSMSG( "process_init_results failed.", proc_ret );
         }
 
-        // =-=-=-=-=-=-=-
-        // initialize the special local file system resource
-        // JMC :: no longer needed
-        //error spec_ret = init_local_file_system_resource();
-        //if ( !spec_ret.ok() ) {
-        //    return PASSMSG( "init_local_file_system_resource failed.", op_ret );
-        //}
+        return SUCCESS();
 
-        // =-=-=-=-=-=-=-
-        // call start for plugins
-        error start_err = start_resource_plugins();
-        if ( !start_err.ok() ) {
-            return PASSMSG( "start_resource_plugins failed.", start_err );
-        }
+    } // init_from_query
+
+// =-=-=-=-=-=-=-
+// private - resolve the host of each resource against the current
+//           server host list, for a table kept from an earlier connection
+    error resource_manager::resolve_resource_hosts( void ) {
+        lookup_table< resource_ptr >::iterator itr;
+        for ( itr = resources_.begin(); itr != resources_.end(); ++itr ) {
+            std::string location, zone;
+            error ret = itr->second->get_property< std::string >( RESOURCE_LOCATION, location );
+            if ( !ret.ok() ) {
+                return PASS( ret );
+            }
+            ret = itr->second->get_property< std::string >( RESOURCE_ZONE, zone );
+            if ( !ret.ok() ) {
+                return PASS( ret );
+            }
+
+            rodsServerHost_t* tmpRodsServerHost = 0;
+            if ( location != irods::EMPTY_RESC_HOST ) {
+                rodsHostAddr_t addr;
+                rstrcpy( addr.hostAddr, const_cast<char*>( location.c_str() ), LONG_NAME_LEN );
+                rstrcpy( addr.zoneName, const_cast<char*>( zone.c_str() ), NAME_LEN );
+                if ( resolveHost( &addr, &tmpRodsServerHost ) < 0 ) {
+                    rodsLog( LOG_NOTICE, "resolve_resource_hosts: resolveHost error for %s",
+                             addr.hostAddr );
+                }
+            }
+
+            itr->second->set_property< rodsServerHost_t* >( RESOURCE_HOST, tmpRodsServerHost );
+
+            // =-=-=-=-=-=-=-
+            // quotas are read again, as for a new table
+            itr->second->set_property<long>( RESOURCE_QUOTA, RESC_QUOTA_UNINIT );
+
+        } // for itr
 
-        // =-=-=-=-=-=-=-
-        // win!
         return SUCCESS();
 
-    } // init_from_catalog
+    } // resolve_resource_hosts
 
 // =-=-=-=-=-=-=-
 /// @brief call shutdown on resources before destruction
@@ -0,0 +1,190 @@
+#include "rodsDef.h"
+#include "rodsErrorTable.h"
+#include "rodsLog.h"
+#include "rodsConnect.h"
+#include "irods_log.hpp"
+#include "irods_round_robin_cursor.hpp"
+#include "irods_configuration_keywords.hpp"
+#include "irods_server_properties.hpp"
+
+#include <sched.h>
+#include <string.h>
+
+#include <boost/interprocess/creation_tags.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+namespace bi = boost::interprocess;
+
+namespace irods {
+
+    /// =-=-=-=-=-=-=-
+    /// @brief the size of the table.  a slot is kept until the server
+    ///        exits, also once its resource is removed or renamed, so a
+    ///        round robin resource not in a full table keeps its position
+    ///        in the agent instead
+    static const unsigned int ROUND_ROBIN_SLOTS = 1024;
+
+    /// =-=-=-=-=-=-=-
+    /// @brief a slot claimed for longer than this many yields was left by
+    ///        a process which died while naming it, and is skipped
+    static const int ROUND_ROBIN_CLAIM_SPINS = 1000;
+
+    /// =-=-=-=-=-=-=-
+    /// @brief a slot is claimed by the first process to take a position
+    ///        of its resource, and is ready once the name and the seed are
+    ///        written.  the position is only ever added to
+    enum {
+        ROUND_ROBIN_SLOT_EMPTY = 0,
+        ROUND_ROBIN_SLOT_CLAIMED,
+        ROUND_ROBIN_SLOT_READY
+    };
+
+    struct round_robin_slot {
+        volatile unsigned int state;
+        char                  name[ NAME_LEN ];
+        volatile rodsULong_t  position;
+    };
+
+    static const bi::offset_t ROUND_ROBIN_SIZE =
+        sizeof( round_robin_slot ) * ROUND_ROBIN_SLOTS;
+
+    static bi::shared_memory_object* table_obj       = NULL;
+    static bi::mapped_region*        table_region    = NULL;
+    static int                       update_interval = -1;
+
+    /// =-=-=-=-=-=-=-
+    /// @brief salted like the rule engine cache, so each server run has
+    ///        its own table
+    static error segment_name( std::string& _name ) {
+        std::string salt;
+        error ret = server_properties::getInstance().get_property< std::string >( RE_CACHE_SALT_KW, salt );
+        if ( !ret.ok() ) {
+            return PASS( ret );
+        }
+
+        _name = "irods_round_robin_shared_memory_" + salt;
+        return SUCCESS();
+
+    } // segment_name
+
+    static round_robin_slot* table_ptr() {
+        if ( !table_region ) {
+            std::string name;
+            error ret = segment_name( name );
+            if ( !ret.ok() ) {
+                irods::log( PASS( ret ) );
+                return NULL;
+            }
+
+            try {
+                table_obj = new bi::shared_memory_object( bi::open_or_create, name.c_str(), bi::read_write, 0600 );
+                bi::offset_t size = 0;
+                if ( table_obj->get_size( size ) && size == 0 ) {
+                    table_obj->truncate( ROUND_ROBIN_SIZE );
+                }
+                table_region = new bi::mapped_region( *table_obj, bi::read_write );
+            }
+            catch ( const bi::interprocess_exception& e ) {
+                rodsLog( LOG_ERROR, "round_robin_cursor - failed to map [%s]. Exception caught [%s]",
+                         name.c_str(), e.what() );
+                delete table_obj;
+                table_obj = NULL;
+                return NULL;
+            }
+        }
+
+        return static_cast< round_robin_slot* >( table_region->get_address() );
+
+    } // table_ptr
+
+    error round_robin_cursor::next(
+        const std::string& _resc_name,
+        rodsULong_t        _seed,
+        rodsULong_t&       _position ) {
+        if ( _resc_name.empty() || _resc_name.size() >= NAME_LEN ) {
+            return ERROR( SYS_INVALID_INPUT_PARAM, "invalid resource name" );
+        }
+
+        round_robin_slot* table = table_ptr();
+        if ( !table ) {
+            return ERROR( SYS_INTERNAL_ERR, "round robin table is not available" );
+        }
+
+        unsigned int hash = 2166136261u;
+        for ( size_t i = 0; i < _resc_name.size(); ++i ) {
+            hash = ( hash ^ ( unsigned char )_resc_name[ i ] ) * 16777619u;
+        }
+
+        unsigned int idx = hash % ROUND_ROBIN_SLOTS;
+        int spins = 0;
+        for ( unsigned int probe = 0; probe < ROUND_ROBIN_SLOTS; ) {
+            round_robin_slot* slot = &table[ idx ];
+            unsigned int state = slot->state;
+            if ( ROUND_ROBIN_SLOT_EMPTY == state ) {
+                if ( __sync_bool_compare_and_swap(
+                            &slot->state,
+                            ROUND_ROBIN_SLOT_EMPTY,
+                            ROUND_ROBIN_SLOT_CLAIMED ) ) {
+                    snprintf( slot->name, sizeof( slot->name ), "%s", _resc_name.c_str() );
+                    slot->position = _seed + 1;
+                    __sync_synchronize();
+                    slot->state = ROUND_ROBIN_SLOT_READY;
+                    _position = _seed;
+                    return SUCCESS();
+                }
+                // =-=-=-=-=-=-=-
+                // another process claimed it first, look again
+                continue;
+            }
+
+            if ( ROUND_ROBIN_SLOT_CLAIMED == state &&
+                    spins++ < ROUND_ROBIN_CLAIM_SPINS ) {
+                sched_yield();
+                continue;
+            }
+
+            if ( ROUND_ROBIN_SLOT_READY == state &&
+                    _resc_name == slot->name ) {
+                _position = __sync_fetch_and_add( &slot->position, 1 );
+                return SUCCESS();
+            }
+
+            spins = 0;
+            idx = ( idx + 1 ) % ROUND_ROBIN_SLOTS;
+            ++probe;
+        }
+
+        return ERROR( SYS_INTERNAL_ERR, "round robin table is full" );
+
+    } // next
+
+    int round_robin_cursor::context_update_interval() {
+        if ( update_interval < 0 ) {
+            error ret = get_advanced_setting<int>(
+                            CFG_ROUND_ROBIN_CONTEXT_UPDATE_INTERVAL,
+                            update_interval );
+            if ( !ret.ok() ) {
+                if ( KEY_NOT_FOUND != ret.code() ) {
+                    irods::log( PASS( ret ) );
+                }
+                update_interval = DEFAULT_ROUND_ROBIN_CONTEXT_UPDATE_INTERVAL;
+            }
+            else if ( update_interval < 0 ) {
+                update_interval = 0;
+            }
+        }
+
+        return update_interval;
+
+    } // context_update_interval
+
+    void round_robin_cursor::remove() {
+        std::string name;
+        if ( segment_name( name ).ok() ) {
+            bi::shared_memory_object::remove( name.c_str() );
+        }
+
+    } // remove
+
+}; // namespace irods
@@ -0,0 +1,382 @@
+#include "rodsErrorTable.h"
+#include "rodsLog.h"
+#include "rodsGenQuery.h"
+#include "rcMisc.h"
+#include "genQuery.h"
+#include "ruleExecSubmit.h"
+#include "irods_log.hpp"
+#include "irods_rule_exec_queue.hpp"
+#include "irods_configuration_keywords.hpp"
+#include "irods_server_properties.hpp"
+
+#include <stdlib.h>
+#include <string.h>
+#include <sstream>
+
+namespace irods {
+
+    /// =-=-=-=-=-=-=-
+    /// @brief the columns read for each row, in the order of the fields
+    ///        of rule_exec_entry
+    static const int RULE_EXEC_COLUMNS[] = {
+        COL_RULE_EXEC_ID,
+        COL_RULE_EXEC_NAME,
+        COL_RULE_EXEC_REI_FILE_PATH,
+        COL_RULE_EXEC_USER_NAME,
+        COL_RULE_EXEC_ADDRESS,
+        COL_RULE_EXEC_TIME,
+        COL_RULE_EXEC_FREQUENCY,
+        COL_RULE_EXEC_PRIORITY,
+        COL_RULE_EXEC_ESTIMATED_EXE_TIME,
+        COL_RULE_EXEC_NOTIFICATION_ADDR,
+        COL_RULE_EXEC_STATUS
+    };
+    static const int NUM_RULE_EXEC_COLUMNS =
+        sizeof( RULE_EXEC_COLUMNS ) / sizeof( RULE_EXEC_COLUMNS[0] );
+
+    bool rule_exec_queue::ready_key::operator<( const ready_key& _rhs ) const {
+        if ( failed_ != _rhs.failed_ ) {
+            return !failed_;
+        }
+        if ( priority_ != _rhs.priority_ ) {
+            return priority_ < _rhs.priority_;
+        }
+        if ( due_ != _rhs.due_ ) {
+            return due_ < _rhs.due_;
+        }
+        return id_ < _rhs.id_;
+
+    } // operator<
+
+    rule_exec_queue::rule_exec_queue() :
+        resync_( DEFAULT_RULE_EXEC_QUEUE_RESYNC ),
+        last_refresh_( 0 ),
+        last_resync_( 0 ),
+        max_id_( 0 ),
+        floor_id_( 0 ) {
+        error ret = get_advanced_setting<int>(
+                        CFG_RULE_ENGINE_SERVER_QUEUE_RESYNC,
+                        resync_ );
+        if ( !ret.ok() ) {
+            if ( KEY_NOT_FOUND != ret.code() ) {
+                irods::log( PASS( ret ) );
+            }
+            resync_ = DEFAULT_RULE_EXEC_QUEUE_RESYNC;
+        }
+
+    } // ctor
+
+    rule_exec_queue::ready_key rule_exec_queue::make_ready_key(
+        const rule_exec_entry& _entry ) {
+        ready_key key;
+        key.failed_   = _entry.status_ == RE_FAILED;
+        key.priority_ = _entry.priority_;
+        key.due_      = _entry.due_;
+        key.id_       = _entry.id_;
+        return key;
+
+    } // make_ready_key
+
+    void rule_exec_queue::insert( const rule_exec_entry& _entry ) {
+        entries_[ _entry.id_ ] = _entry;
+        if ( !_entry.running_ ) {
+            waiting_.insert( waiting_key( _entry.due_, _entry.id_ ) );
+        }
+
+    } // insert
+
+    void rule_exec_queue::unlink( const rule_exec_entry& _entry ) {
+        waiting_.erase( waiting_key( _entry.due_, _entry.id_ ) );
+        ready_.erase( make_ready_key( _entry ) );
+
+    } // unlink
+
+    void rule_exec_queue::promote( time_t _now ) {
+        while ( !waiting_.empty() && waiting_.begin()->first <= _now ) {
+            std::map< rodsLong_t, rule_exec_entry >::iterator itr =
+                entries_.find( waiting_.begin()->second );
+            waiting_.erase( waiting_.begin() );
+            if ( itr != entries_.end() ) {
+                ready_.insert( make_ready_key( itr->second ) );
+            }
+        }
+
+    } // promote
+
+    error rule_exec_queue::read_rows(
+        rsComm_t*   _comm,
+        const char* _cond,
+        bool        _full,
+        bool        _new_only ) {
+        genQueryInp_t gen_inp;
+        memset( &gen_inp, 0, sizeof( gen_inp ) );
+        for ( int i = 0; i < NUM_RULE_EXEC_COLUMNS; ++i ) {
+            addInxIval( &gen_inp.selectInp, RULE_EXEC_COLUMNS[ i ],
+                        i == 0 ? ORDER_BY : 1 );
+        }
+        if ( _cond ) {
+            addInxVal( &gen_inp.sqlCondInp, COL_RULE_EXEC_ID, _cond );
+        }
+        gen_inp.maxRows = MAX_SQL_ROWS;
+
+        // =-=-=-=-=-=-=-
+        // a resync replaces the table, keeping the jobs still running
+        std::map< rodsLong_t, rule_exec_entry > running;
+        if ( _full ) {
+            std::map< rodsLong_t, rule_exec_entry >::iterator itr;
+            for ( itr = entries_.begin(); itr != entries_.end(); ++itr ) {
+                if ( itr->second.running_ ) {
+                    running[ itr->first ] = itr->second;
+                }
+            }
+            entries_.clear();
+            ready_.clear();
+            waiting_.clear();
+        }
+
+        int status = 0;
+        genQueryOut_t* gen_out = NULL;
+        while ( true ) {
+            status = rsGenQuery( _comm, &gen_inp, &gen_out );
+            if ( status < 0 ) {
+                break;
+            }
+
+            sqlResult_t* cols[ NUM_RULE_EXEC_COLUMNS ];
+            for ( int i = 0; i < NUM_RULE_EXEC_COLUMNS; ++i ) {
+                cols[ i ] = getSqlResultByInx( gen_out, RULE_EXEC_COLUMNS[ i ] );
+                if ( cols[ i ] == NULL ) {
+                    status = UNMATCHED_KEY_OR_INDEX;
+                }
+            }
+            if ( status < 0 ) {
+                break;
+            }
+
+            for ( int row = 0; row < gen_out->rowCnt; ++row ) {
+                std::string val[ NUM_RULE_EXEC_COLUMNS ];
+                for ( int i = 0; i < NUM_RULE_EXEC_COLUMNS; ++i ) {
+                    val[ i ] = &cols[ i ]->value[ cols[ i ]->len * row ];
+                }
+
+                rule_exec_entry entry;
+                entry.id_str_             = val[ 0 ];
+                entry.id_                 = strtoll( val[ 0 ].c_str(), 0, 0 );
+                if ( _new_only && seen_ids_.count( entry.id_ ) ) {
+                    continue;
+                }
+                entry.name_               = val[ 1 ];
+                entry.rei_file_path_      = val[ 2 ];
+                entry.user_name_          = val[ 3 ];
+                entry.address_            = val[ 4 ];
+                entry.exe_time_           = val[ 5 ];
+                entry.frequency_          = val[ 6 ];
+                entry.priority_str_       = val[ 7 ];
+                entry.estimated_exe_time_ = val[ 8 ];
+                entry.notification_addr_  = val[ 9 ];
+                entry.status_             = val[ 10 ];
+                entry.due_                = atol( entry.exe_time_.c_str() );
+                entry.running_            = false;
+
+                char* end = NULL;
+                entry.priority_ = strtol( entry.priority_str_.c_str(), &end, 10 );
+                if ( entry.priority_str_.empty() || *end != '\0' ) {
+                    entry.priority_ = DEFAULT_RULE_EXEC_PRIORITY;
+                }
+
+                std::map< rodsLong_t, rule_exec_entry >::iterator itr =
+                    entries_.find( entry.id_ );
+                if ( itr != entries_.end() ) {
+                    entry.running_ = itr->second.running_;
+                    unlink( itr->second );
+                }
+                else if ( running.count( entry.id_ ) ) {
+                    entry.running_ = true;
+                    running.erase( entry.id_ );
+                }
+                insert( entry );
+
+                if ( entry.id_ > floor_id_ ) {
+                    seen_ids_.insert( entry.id_ );
+                }
+                if ( entry.id_ > max_id_ ) {
+                    max_id_ = entry.id_;
+                }
+            }
+
+            if ( gen_out->continueInx <= 0 ) {
+                break;
+            }
+            gen_inp.continueInx = gen_out->continueInx;
+            freeGenQueryOut( &gen_out );
+        }
+
+        freeGenQueryOut( &gen_out );
+        clearGenQueryInp( &gen_inp );
+
+        // =-=-=-=-=-=-=-
+        // a running job whose row is gone is kept until it is reaped
+        std::map< rodsLong_t, rule_exec_entry >::iterator itr;
+        for ( itr = running.begin(); itr != running.end(); ++itr ) {
+            entries_[ itr->first ] = itr->second;
+        }
+
+        if ( status < 0 && CAT_NO_ROWS_FOUND != status ) {
+            return ERROR( status, "failed to read R_RULE_EXEC" );
+        }
+
+        return SUCCESS();
+
+    } // read_rows
+
+    error rule_exec_queue::refresh(
+        rsComm_t* _comm,
+        bool      _force ) {
+        time_t now = time( NULL );
+        if ( !_force && now == last_refresh_ ) {
+            return SUCCESS();
+        }
+        last_refresh_ = now;
+
+        // =-=-=-=-=-=-=-
+        // a row with an id below the highest one read may still be
+        // committed, so read again above the highest id seen before
+        // RULE_EXEC_ID_SETTLE, or above none until one is that old
+        while ( max_id_history_.size() > 1 &&
+                max_id_history_[ 1 ].first <= now - RULE_EXEC_ID_SETTLE ) {
+            max_id_history_.pop_front();
+        }
+        if ( !max_id_history_.empty() &&
+                max_id_history_.front().first <= now - RULE_EXEC_ID_SETTLE &&
+                max_id_history_.front().second > floor_id_ ) {
+            floor_id_ = max_id_history_.front().second;
+            seen_ids_.erase( seen_ids_.begin(), seen_ids_.upper_bound( floor_id_ ) );
+        }
+
+        if ( last_resync_ == 0 || now - last_resync_ >= resync_ ) {
+            seen_ids_.clear();
+            error ret = read_rows( _comm, NULL, true, false );
+            if ( !ret.ok() ) {
+                return PASS( ret );
+            }
+            last_resync_ = now;
+        }
+        else {
+            std::stringstream cond;
+            cond << "> " << floor_id_;
+            error ret = read_rows( _comm, cond.str().c_str(), false, true );
+            if ( !ret.ok() ) {
+                return PASS( ret );
+            }
+        }
+
+        max_id_history_.push_back( std::make_pair( now, max_id_ ) );
+        return SUCCESS();
+
+    } // refresh
+
+    error rule_exec_queue::refresh_entry(
+        rsComm_t*          _comm,
+        const std::string& _id ) {
+        rodsLong_t id = strtoll( _id.c_str(), 0, 0 );
+        std::map< rodsLong_t, rule_exec_entry >::iterator itr = entries_.find( id );
+        if ( itr != entries_.end() ) {
+            unlink( itr->second );
+            entries_.erase( itr );
+        }
+
+        // =-=-=-=-=-=-=-
+        // a finished job which is not repeated no longer has a row
+        std::string cond = "= " + _id;
+        error ret = read_rows( _comm, cond.c_str(), false, false );
+        if ( !ret.ok() ) {
+            return PASS( ret );
+        }
+
+        return SUCCESS();
+
+    } // refresh_entry
+
+    bool rule_exec_queue::next(
+        time_t           _now,
+        rule_exec_entry& _entry ) {
+        promote( _now );
+        if ( ready_.empty() ) {
+            return false;
+        }
+
+        rodsLong_t id = ready_.begin()->id_;
+        ready_.erase( ready_.begin() );
+
+        std::map< rodsLong_t, rule_exec_entry >::iterator itr = entries_.find( id );
+        if ( itr == entries_.end() ) {
+            return false;
+        }
+        itr->second.running_ = true;
+        _entry = itr->second;
+        return true;
+
+    } // next
+
+    void rule_exec_queue::drop( const std::string& _id ) {
+        rodsLong_t id = strtoll( _id.c_str(), 0, 0 );
+        std::map< rodsLong_t, rule_exec_entry >::iterator itr = entries_.find( id );
+        if ( itr != entries_.end() ) {
+            unlink( itr->second );
+            entries_.erase( itr );
+        }
+
+    } // drop
+
+    void rule_exec_queue::clear_running() {
+        std::map< rodsLong_t, rule_exec_entry >::iterator itr;
+        for ( itr = entries_.begin(); itr != entries_.end(); ++itr ) {
+            if ( itr->second.running_ ) {
+                itr->second.running_ = false;
+                waiting_.insert( waiting_key( itr->second.due_, itr->first ) );
+            }
+        }
+
+    } // clear_running
+
+    time_t rule_exec_queue::next_due() const {
+        if ( waiting_.empty() ) {
+            return 0;
+        }
+        return waiting_.begin()->first;
+
+    } // next_due
+
+    bool rule_exec_queue::has_ready( time_t _now ) const {
+        return !ready_.empty() ||
+               ( !waiting_.empty() && waiting_.begin()->first <= _now );
+
+    } // has_ready
+
+    rule_exec_queue::metrics rule_exec_queue::get_metrics( time_t _now ) const {
+        metrics m;
+        memset( &m, 0, sizeof( m ) );
+        m.total = entries_.size();
+
+        std::map< rodsLong_t, rule_exec_entry >::const_iterator itr;
+        for ( itr = entries_.begin(); itr != entries_.end(); ++itr ) {
+            const rule_exec_entry& entry = itr->second;
+            if ( entry.status_ == RE_FAILED ) {
+                m.failed++;
+            }
+            if ( entry.running_ ) {
+                m.running++;
+            }
+            else if ( entry.due_ <= _now ) {
+                m.ready++;
+                if ( _now - entry.due_ > m.max_lag ) {
+                    m.max_lag = _now - entry.due_;
+                }
+            }
+        }
+
+        return m;
+
+    } // get_metrics
+
+}; // namespace irods
@@ -18,8 +18,10 @@
 #include "irods_buffer_encryption.hpp"
 #include "irods_resource_manager.hpp"
 #include "irods_server_state.hpp"
+#include "irods_agent_pool.hpp"
 #include "irods_exception.hpp"
 #include "irods_stacktrace.hpp"
+#include "irods_rule_profiler.hpp"
 
 #include "boost/lexical_cast.hpp"
 
@@ -506,6 +508,27 @@ namespace irods {
 
         json_object_set( obj, "agents", arr );
 
+        agent_pool::statistics pool_stats = agent_pool::instance().stats();
+        json_t* pool_obj = json_object();
+        if ( !pool_obj ) {
+            return ERROR(
+                       SYS_MALLOC_ERR,
+                       "allocation of json object failed" );
+        }
+
+        json_object_set( pool_obj, "pool_size", json_integer( pool_stats.pool_size ) );
+        json_object_set( pool_obj, "maximum_requests_per_agent", json_integer( pool_stats.max_requests_per_agent ) );
+        json_object_set( pool_obj, "idle", json_integer( pool_stats.idle ) );
+        json_object_set( pool_obj, "busy", json_integer( pool_stats.busy ) );
+        json_object_set( pool_obj, "spawned", json_integer( pool_stats.spawned ) );
+        json_object_set( pool_obj, "dispatched", json_integer( pool_stats.dispatched ) );
+        json_object_set( pool_obj, "recycled", json_integer( pool_stats.recycled ) );
+        json_object_set( pool_obj, "fallbacks", json_integer( pool_stats.fallbacks ) );
+        json_object_set( pool_obj, "mean_startup_milliseconds", json_real( pool_stats.mean_startup_ms ) );
+        json_object_set( pool_obj, "maximum_startup_milliseconds", json_real( pool_stats.max_startup_ms ) );
+        json_object_set( obj, "agent_pool", pool_obj );
+        json_decref( pool_obj );
+
         char* tmp_buf = json_dumps( obj, JSON_INDENT( 4 ) );
 
         json_decref( obj );
@@ -517,6 +540,76 @@ namespace irods {
 
     } // operation_status
 
+    static error operation_rule_profile(
+        const std::string&, // _wait_option,
+        const size_t, //       _wait_seconds,
+        std::string& _output ) {
+        rodsEnv my_env;
+        _reloadRodsEnv( my_env );
+
+        std::vector< rule_profile_entry > entries;
+        error ret = rule_profiler::report( entries );
+        if ( !ret.ok() ) {
+            return PASS( ret );
+        }
+
+        json_t* obj = json_object();
+        if ( !obj ) {
+            return ERROR(
+                       SYS_MALLOC_ERR,
+                       "allocation of json object failed" );
+        }
+
+        json_object_set( obj, "hostname", json_string( my_env.rodsHost ) );
+        json_object_set( obj, "enabled", rule_profiler::enabled() ? json_true() : json_false() );
+
+        json_t* arr = json_array();
+        if ( !arr ) {
+            json_decref( obj );
+            return ERROR(
+                       SYS_MALLOC_ERR,
+                       "allocation of json array failed" );
+        }
+
+        for ( size_t i = 0; i < entries.size(); ++i ) {
+            const rule_profile_entry& entry = entries[ i ];
+            json_t* entry_obj = json_object();
+            if ( !entry_obj ) {
+                json_decref( arr );
+                json_decref( obj );
+                return ERROR(
+                           SYS_MALLOC_ERR,
+                           "allocation of json object failed" );
+            }
+
+            json_object_set( entry_obj, "name", json_string( entry.name_.c_str() ) );
+            json_object_set( entry_obj, "type", json_string(
+                                 rule_profiler::MICROSERVICE == entry.kind_ ? "microservice" : "rule" ) );
+            json_object_set( entry_obj, "calls", json_integer( entry.calls_ ) );
+            json_object_set( entry_obj, "inclusive_milliseconds", json_real( entry.inclusive_usec_ / 1000.0 ) );
+            json_object_set( entry_obj, "exclusive_milliseconds", json_real( entry.exclusive_usec_ / 1000.0 ) );
+            json_object_set( entry_obj, "region_bytes", json_integer( entry.region_bytes_ ) );
+            json_array_append( arr, entry_obj );
+
+            json_decref( entry_obj );
+
+        }
+
+        json_object_set( obj, "rules", arr );
+        json_decref( arr );
+
+        char* tmp_buf = json_dumps( obj, JSON_INDENT( 4 ) );
+
+        json_decref( obj );
+
+        _output += tmp_buf;
+        _output += ",";
+        free( tmp_buf );
+
+        return SUCCESS();
+
+    } // operation_rule_profile
+
     bool server_control_executor::compare_host_names(
         const std::string& _hn1,
         const std::string& _hn2 ) {
@@ -590,6 +683,7 @@ namespace irods {
         op_map_[ SERVER_CONTROL_PAUSE ]    = operation_pause;
         op_map_[ SERVER_CONTROL_RESUME ]   = operation_resume;
         op_map_[ SERVER_CONTROL_STATUS ]   = operation_status;
+        op_map_[ SERVER_CONTROL_RULE_PROFILE ] = operation_rule_profile;
         if ( _prop == CFG_RULE_ENGINE_CONTROL_PLANE_PORT ) {
             op_map_[ SERVER_CONTROL_SHUTDOWN ] = rule_engine_operation_shutdown;
         }
@@ -1015,7 +1109,8 @@ namespace irods {
         if ( SERVER_CONTROL_SHUTDOWN != _name &&
                 SERVER_CONTROL_PAUSE    != _name &&
                 SERVER_CONTROL_RESUME   != _name &&
-                SERVER_CONTROL_STATUS   != _name ) {
+                SERVER_CONTROL_STATUS   != _name &&
+                SERVER_CONTROL_RULE_PROFILE != _name ) {
             std::string msg( "invalid command [" );
             msg += _name;
             msg += "]";
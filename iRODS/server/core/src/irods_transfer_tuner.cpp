@@ -0,0 +1,178 @@
+#include "rodsErrorTable.h"
+#include "rodsLog.h"
+#include "dataObjInpOut.h"
+#include "irods_log.hpp"
+#include "irods_transfer_tuner.hpp"
+#include "irods_configuration_keywords.hpp"
+#include "irods_server_properties.hpp"
+
+#include <algorithm>
+
+namespace irods {
+
+    /// =-=-=-=-=-=-=-
+    /// @brief a new stream count must beat the best one by this fraction
+    ///        of its throughput to be kept
+    static const double ADAPTIVE_MIN_IMPROVEMENT = 0.05;
+
+    /// =-=-=-=-=-=-=-
+    /// @brief number of transfers at the best count between probes
+    static const int ADAPTIVE_PROBE_INTERVAL = 16;
+
+    static const char* opr_name( int _opr_type ) {
+        return PUT_OPR == _opr_type ? "put" : "get";
+    }
+
+    transfer_tuner::transfer_tuner() :
+        configured_( false ),
+        initial_( DEFAULT_ADAPTIVE_TRANSFER_THREADS ) {
+    }
+
+    transfer_tuner& transfer_tuner::instance() {
+        static transfer_tuner instance_;
+        return instance_;
+    }
+
+    bool transfer_tuner::enabled() {
+        if ( !configured_ ) {
+            configured_ = true;
+            error ret = get_advanced_setting<int>(
+                            CFG_ADAPTIVE_NUMBER_OF_TRANSFER_THREADS,
+                            initial_ );
+            if ( !ret.ok() ) {
+                if ( KEY_NOT_FOUND != ret.code() ) {
+                    irods::log( PASS( ret ) );
+                }
+                initial_ = DEFAULT_ADAPTIVE_TRANSFER_THREADS;
+            }
+        }
+
+        return initial_ > 0;
+
+    } // enabled
+
+    std::string transfer_tuner::key(
+        const std::string& _peer,
+        int                _opr_type ) {
+        return _peer + ":" + opr_name( _opr_type );
+
+    } // key
+
+    int transfer_tuner::num_threads(
+        const std::string& _peer,
+        int                _opr_type,
+        int                _max ) {
+        std::map< std::string, peer_state >::iterator itr =
+            peers_.find( key( _peer, _opr_type ) );
+        if ( itr == peers_.end() ) {
+            peer_state state;
+            state.current   = initial_;
+            state.limit     = _max;
+            state.best      = initial_;
+            state.best_rate = 0.0;
+            state.transfers = 0;
+            state.probes    = 0;
+            state.settled   = false;
+            itr = peers_.insert( std::make_pair( key( _peer, _opr_type ), state ) ).first;
+
+            rodsLog(
+                LOG_NOTICE,
+                "transfer_tuner - %s with [%s] starts with [%d] streams, rule allows [%d]",
+                opr_name( _opr_type ),
+                _peer.c_str(),
+                std::min( initial_, _max ),
+                _max );
+        }
+
+        itr->second.limit = _max;
+        return std::max( 1, std::min( itr->second.current, _max ) );
+
+    } // num_threads
+
+    void transfer_tuner::record(
+        const std::string& _peer,
+        int                _opr_type,
+        int                _num_threads,
+        rodsLong_t         _bytes,
+        double             _seconds,
+        double             _min_stream_rate,
+        double             _max_stream_rate ) {
+        std::map< std::string, peer_state >::iterator itr =
+            peers_.find( key( _peer, _opr_type ) );
+        if ( itr == peers_.end() || _seconds <= 0.0 ) {
+            return;
+        }
+
+        // =-=-=-=-=-=-=-
+        // ignore transfers which did not use the count chosen here, such
+        // as those where the client asked for a number of streams
+        peer_state& state = itr->second;
+        if ( _num_threads != std::max( 1, std::min( state.current, state.limit ) ) ) {
+            return;
+        }
+
+        double rate = ( double )_bytes / 1048576.0 / _seconds;
+        state.transfers++;
+
+        rodsLog(
+            LOG_DEBUG,
+            "transfer_tuner - %s with [%s] of [%lld] bytes over [%d] streams: %.3f MB/s, streams %.3f - %.3f MB/s",
+            opr_name( _opr_type ),
+            _peer.c_str(),
+            _bytes,
+            _num_threads,
+            rate,
+            _min_stream_rate,
+            _max_stream_rate );
+
+        int next = state.best;
+        if ( rate > state.best_rate * ( 1.0 + ADAPTIVE_MIN_IMPROVEMENT ) ) {
+            // =-=-=-=-=-=-=-
+            // better than anything seen so far, keep growing until it
+            // stops paying off
+            bool grew = _num_threads >= state.best;
+            state.best      = _num_threads;
+            state.best_rate = rate;
+            next = ( grew && !state.settled ) ? _num_threads * 2 : _num_threads;
+        }
+        else if ( _num_threads != state.best ) {
+            // =-=-=-=-=-=-=-
+            // the change did not help, go back to the best count
+            state.settled = true;
+            next = state.best;
+        }
+        else {
+            // =-=-=-=-=-=-=-
+            // follow drift in the link and probe one stream either side
+            // of the best count now and then
+            state.best_rate = ( state.best_rate + rate ) / 2.0;
+            if ( state.settled && 0 == state.transfers % ADAPTIVE_PROBE_INTERVAL ) {
+                state.probes++;
+                next = ( state.probes % 2 || state.best <= 1 ) ?
+                       state.best + 1 : state.best - 1;
+            }
+        }
+
+        next = std::max( 1, std::min( next, state.limit ) );
+        if ( !state.settled && next == _num_threads ) {
+            state.settled = true;
+        }
+
+        if ( next != _num_threads ) {
+            rodsLog(
+                LOG_NOTICE,
+                "transfer_tuner - %s with [%s] moves from [%d] to [%d] streams, %.3f MB/s at [%d], best %.3f MB/s at [%d]",
+                opr_name( _opr_type ),
+                _peer.c_str(),
+                _num_threads,
+                next,
+                rate,
+                _num_threads,
+                state.best_rate,
+                state.best );
+        }
+        state.current = next;
+
+    } // record
+
+}; // namespace irods
@@ -11,6 +11,7 @@
 
 
 #include "miscServerFunct.hpp"
+#include "irods_transfer_tuner.hpp"
 #include "QUANTAnet_rbudpBase_c.h"
 #include "QUANTAnet_rbudpSender_c.h"
 #include "QUANTAnet_rbudpReceiver_c.h"
@@ -39,6 +40,7 @@ char *__loc1;
 #include "irods_stacktrace.hpp"
 #include "irods_network_factory.hpp"
 #include "irods_buffer_encryption.hpp"
+#include "irods_stream_encryption.hpp"
 #include "irods_client_server_negotiation.hpp"
 #include "irods_hierarchy_parser.hpp"
 #include "irods_threads.hpp"
@@ -346,6 +348,56 @@ int applyRuleForSvrPortal( int sockFd, int oprType, int preOrPost, int load, rsC
 }
 
 
+static double
+portalElapsedSec( struct timeval *startTime ) {
+    struct timeval endTime;
+    ( void ) gettimeofday( &endTime, ( struct timezone * )0 );
+    return ( double )( endTime.tv_sec - startTime->tv_sec ) +
+           ( double )( endTime.tv_usec - startTime->tv_usec ) / 1000000.0;
+}
+
+/* timedPartialData - run one portal stream and keep its wall time */
+static void
+timedPartialData( void ( *transfer )( portalTransferInp_t * ),
+                  portalTransferInp_t *myInput ) {
+    struct timeval startTime;
+
+    ( void ) gettimeofday( &startTime, ( struct timezone * )0 );
+    transfer( myInput );
+    myInput->timeInSec = portalElapsedSec( &startTime );
+}
+
+/* recordPortalRate - report the throughput of a finished parallel
+ * transfer to the adaptive transfer tuner */
+static void
+recordPortalRate( rsComm_t *rsComm, int oprType, int numThreads,
+                  portalTransferInp_t *myInput, struct timeval *startTime ) {
+    irods::transfer_tuner& tuner = irods::transfer_tuner::instance();
+    if ( !tuner.enabled() ) {
+        return;
+    }
+
+    rodsLong_t totalSize = 0;
+    double minRate = 0.0, maxRate = 0.0;
+    for ( int i = 0; i < numThreads; i++ ) {
+        if ( myInput[i].status < 0 ) {
+            return;
+        }
+        double rate = myInput[i].timeInSec > 0.0 ?
+                      ( double ) myInput[i].size / 1048576.0 / myInput[i].timeInSec : 0.0;
+        if ( i == 0 || rate < minRate ) {
+            minRate = rate;
+        }
+        if ( i == 0 || rate > maxRate ) {
+            maxRate = rate;
+        }
+        totalSize += myInput[i].size;
+    }
+
+    tuner.record( rsComm->clientAddr, oprType, numThreads, totalSize,
+                  portalElapsedSec( startTime ), minRate, maxRate );
+}
+
 int
 svrPortalPutGet( rsComm_t *rsComm ) {
     portalOpr_t *myPortalOpr;
@@ -360,6 +412,7 @@ svrPortalPutGet( rsComm_t *rsComm ) {
     int oprType;
     int flags = 0;
     int retVal = 0;
+    struct timeval startTime;
 
     myPortalOpr = rsComm->portalOpr;
 
@@ -416,6 +469,7 @@ svrPortalPutGet( rsComm_t *rsComm ) {
 
         return portalFd;
     }
+    ( void ) gettimeofday( &startTime, ( struct timezone * )0 );
     applyRuleForSvrPortal( portalFd, oprType, 0, size0, rsComm );
 
     if ( oprType == PUT_OPR ) {
@@ -431,14 +485,15 @@ svrPortalPutGet( rsComm_t *rsComm ) {
 
     if ( numThreads == 1 ) {
         if ( oprType == PUT_OPR ) {
-            partialDataPut( &myInput[0] );
+            timedPartialData( partialDataPut, &myInput[0] );
         }
         else {
-            partialDataGet( &myInput[0] );
+            timedPartialData( partialDataGet, &myInput[0] );
         }
 
         CLOSE_SOCK( lsock );
 
+        recordPortalRate( rsComm, oprType, numThreads, myInput, &startTime );
         return myInput[0].status;
     }
     else {
@@ -477,7 +532,7 @@ svrPortalPutGet( rsComm_t *rsComm ) {
                                        portalFd, l3descInx, 0,
                                        dataOprInp->destRescTypeInx,
                                        i, mySize, myOffset, flags );
-                tid[i] = new boost::thread( partialDataPut, &myInput[i] );
+                tid[i] = new boost::thread( timedPartialData, partialDataPut, &myInput[i] );
 
             }
             else {	/* a get */
@@ -485,17 +540,17 @@ svrPortalPutGet( rsComm_t *rsComm ) {
                 fillPortalTransferInp( &myInput[i], rsComm,
                                        l3descInx, portalFd, dataOprInp->srcRescTypeInx, 0,
                                        i, mySize, myOffset, flags );
-                tid[i] = new boost::thread( partialDataGet, &myInput[i] );
+                tid[i] = new boost::thread( timedPartialData, partialDataGet, &myInput[i] );
             }
         } // for i
 
         /* spawn the first thread. do this last so the file will not be
         * closed */
         if ( oprType == PUT_OPR ) {
-            tid[0] = new boost::thread( partialDataPut, &myInput[0] );
+            tid[0] = new boost::thread( timedPartialData, partialDataPut, &myInput[0] );
         }
         else {
-            tid[0] = new boost::thread( partialDataGet, &myInput[0] );
+            tid[0] = new boost::thread( timedPartialData, partialDataGet, &myInput[0] );
         }
 
         for ( i = 0; i < numThreads; i++ ) {
@@ -507,6 +562,9 @@ svrPortalPutGet( rsComm_t *rsComm ) {
             }
         } // for i
         CLOSE_SOCK( lsock );
+        if ( retVal >= 0 ) {
+            recordPortalRate( rsComm, oprType, numThreads, myInput, &startTime );
+        }
         return retVal;
 
     } // else
@@ -600,27 +658,25 @@ partialDataPut( portalTransferInp_t *myInput ) {
     bytesToGet = myInput->size;
 
     // =-=-=-=-=-=-=-
-    // create an encryption context, initialization vector
-    int iv_size = 0;
-    irods::buffer_crypt::array_t iv;
-    irods::buffer_crypt::array_t this_iv;
-    irods::buffer_crypt::array_t cipher;
-    irods::buffer_crypt::array_t plain;
-    irods::buffer_crypt::array_t shared_secret;
-    irods::buffer_crypt crypt(
+    // create the decryption context of this stream, keyed once with
+    // the shared secret
+    irods::stream_crypt crypt(
         myInput->key_size,
-        myInput->salt_size,
-        myInput->num_hash_rounds,
         myInput->encryption_algorithm );
-
-    // =-=-=-=-=-=-=-
-    // compute an iv to determine how large it
-    // is for this implementation
     if ( use_encryption_flg ) {
-        iv_size = crypt.key_size();
-        shared_secret.assign(
+        irods::buffer_crypt::array_t shared_secret(
             &myInput->shared_secret[0],
-            &myInput->shared_secret[iv_size] );
+            &myInput->shared_secret[ crypt.key_size() ] );
+        irods::error ret = crypt.init( shared_secret, false );
+        if ( !ret.ok() ) {
+            irods::log( PASS( ret ) );
+            myInput->status = ret.code();
+            if ( myInput->threadNum > 0 ) {
+                _l3Close( myInput->rsComm, destL3descInx );
+            }
+            CLOSE_SOCK( srcFd );
+            return;
+        }
     }
 
     int chunk_size = 0;
@@ -709,39 +765,27 @@ partialDataPut( portalTransferInp_t *myInput ) {
 
             if ( bytesRead == new_size ) {
                 // =-=-=-=-=-=-=-
-                // if using encryption, strip off the iv
-                // and decrypt before writing
+                // if using encryption, decrypt in place, leaving the
+                // plain text after the iv
                 int plain_size = bytesRead;
+                unsigned char* plain_buf = buf;
                 if ( use_encryption_flg ) {
-                    this_iv.assign(
-                        &buf[0],
-                        &buf[ iv_size ] );
-                    cipher.assign(
-                        &buf[ iv_size ],
-                        &buf[ new_size ] );
                     irods::error ret = crypt.decrypt(
-                                           shared_secret,
-                                           this_iv,
-                                           cipher,
-                                           plain );
+                                           buf,
+                                           new_size,
+                                           plain_size );
                     if ( !ret.ok() ) {
                         irods::log( PASS( ret ) );
                         myInput->status = SYS_COPY_LEN_ERR;
                         break;
                     }
-
-                    std::copy(
-                        plain.begin(),
-                        plain.end(),
-                        &buf[0] );
-                    plain_size = plain.size();
-
+                    plain_buf = buf + crypt.iv_size();
                 }
 
                 if ( ( bytesWritten = _l3Write(
                                           myInput->rsComm,
                                           destL3descInx,
-                                          buf,
+                                          plain_buf,
                                           plain_size ) ) != ( plain_size ) ) {
                     rodsLog( LOG_NOTICE,
                              "_partialDataPut:Bytes written %d don't match read %d",
@@ -832,27 +876,32 @@ void partialDataGet(
           irods::CS_NEG_USE_SSL );
 
     // =-=-=-=-=-=-=-
-    // create an encryption context
-    int iv_size = 0;
-    irods::buffer_crypt::array_t iv;
-    irods::buffer_crypt::array_t cipher;
-    irods::buffer_crypt::array_t in_buf;
-    irods::buffer_crypt::array_t shared_secret;
-    irods::buffer_crypt crypt(
+    // create the encryption context of this stream, keyed once with
+    // the shared secret
+    irods::stream_crypt crypt(
         myInput->key_size,
-        myInput->salt_size,
-        myInput->num_hash_rounds,
         myInput->encryption_algorithm );
-
-    // =-=-=-=-=-=-=-
-    // set iv size
     if ( use_encryption_flg ) {
-        iv_size = crypt.key_size();
-        shared_secret.assign(
+        irods::buffer_crypt::array_t shared_secret(
             &myInput->shared_secret[0],
-            &myInput->shared_secret[iv_size] );
+            &myInput->shared_secret[ crypt.key_size() ] );
+        irods::error ret = crypt.init( shared_secret, true );
+        if ( !ret.ok() ) {
+            irods::log( PASS( ret ) );
+            myInput->status = ret.code();
+            if ( myInput->threadNum > 0 ) {
+                _l3Close( myInput->rsComm, srcL3descInx );
+            }
+            CLOSE_SOCK( destFd );
+            return;
+        }
     }
 
+    // =-=-=-=-=-=-=-
+    // the plain text is read in behind room for the iv, so it can be
+    // encrypted where it lies
+    int plain_offset = use_encryption_flg ? crypt.iv_size() : 0;
+
     int trans_buff_size = 0;
     irods::error ret = irods::get_advanced_setting<int>(
                            irods::CFG_TRANS_BUFFER_SIZE_FOR_PARA_TRANS,
@@ -918,53 +967,25 @@ void partialDataGet(
                 toread1 = toread0;
             }
 
-            bytesRead = _l3Read( myInput->rsComm, srcL3descInx, buf, toread1 );
+            bytesRead = _l3Read( myInput->rsComm, srcL3descInx, buf + plain_offset, toread1 );
 
 
             if ( bytesRead == toread1 ) {
                 // =-=-=-=-=-=-=-
-                // compute an iv for this particular transmission and use
-                // it to encrypt this buffer
+                // encrypt the buffer where it lies, behind the iv of this
+                // particular transmission
                 int new_size = bytesRead;
                 if ( use_encryption_flg ) {
-                    irods::error ret = crypt.initialization_vector( iv );
-                    if ( !ret.ok() ) {
-                        ret = PASS( ret );
-                        printf( "%s", ret.result().c_str() );
-                        break;
-                    }
-
-                    // =-=-=-=-=-=-=-
-                    // encrypt
-                    in_buf.assign(
-                        &buf[0],
-                        &buf[ bytesRead ] );
-
-                    ret = crypt.encrypt(
-                              shared_secret,
-                              iv,
-                              in_buf,
-                              cipher );
+                    irods::error ret = crypt.encrypt(
+                                           buf,
+                                           bytesRead,
+                                           new_size );
                     if ( !ret.ok() ) {
-                        ret = PASS( ret );
-                        printf( "%s", ret.result().c_str() );
+                        irods::log( PASS( ret ) );
+                        myInput->status = ret.code();
                         break;
                     }
 
-                    // =-=-=-=-=-=-=-
-                    // capture the iv with the cipher text
-                    memset( buf, 0,  buf_size );
-                    std::copy(
-                        iv.begin(),
-                        iv.end(),
-                        &buf[0] );
-                    std::copy(
-                        cipher.begin(),
-                        cipher.end(),
-                        &buf[iv_size] );
-
-                    new_size = iv_size + cipher.size();
-
                     // =-=-=-=-=-=-=-
                     // need to send the incoming size as encryption might change
                     // the size of the data from the written values
@@ -1063,27 +1084,25 @@ remToLocPartialCopy( portalTransferInp_t *myInput ) {
           irods::CS_NEG_USE_SSL );
 
     // =-=-=-=-=-=-=-
-    // create an encryption context, initialization vector
-    int iv_size = 0;
-    irods::buffer_crypt::array_t iv;
-    irods::buffer_crypt::array_t this_iv;
-    irods::buffer_crypt::array_t cipher;
-    irods::buffer_crypt::array_t plain;
-    irods::buffer_crypt::array_t shared_secret;
-    irods::buffer_crypt crypt(
+    // create the decryption context of this stream, keyed once with
+    // the shared secret
+    irods::stream_crypt crypt(
         myInput->key_size,
-        myInput->salt_size,
-        myInput->num_hash_rounds,
         myInput->encryption_algorithm );
-
-    // =-=-=-=-=-=-=-
-    // compute an iv to determine how large it
-    // is for this implementation
     if ( use_encryption_flg ) {
-        iv_size = crypt.key_size();
-        shared_secret.assign(
+        irods::buffer_crypt::array_t shared_secret(
             &myInput->shared_secret[0],
-            &myInput->shared_secret[iv_size] );
+            &myInput->shared_secret[ crypt.key_size() ] );
+        irods::error ret = crypt.init( shared_secret, false );
+        if ( !ret.ok() ) {
+            irods::log( PASS( ret ) );
+            myInput->status = ret.code();
+            if ( myInput->threadNum > 0 ) {
+                _l3Close( myInput->rsComm, destL3descInx );
+            }
+            CLOSE_SOCK( srcFd );
+            return;
+        }
     }
 
     int trans_buff_size = 0;
@@ -1163,40 +1182,27 @@ remToLocPartialCopy( portalTransferInp_t *myInput ) {
             }
 
             // =-=-=-=-=-=-=-
-            // if using encryption, strip off the iv
-            // and decrypt before writing
+            // if using encryption, decrypt in place, leaving the
+            // plain text after the iv
             int plain_size = bytesRead;
+            unsigned char* plain_buf = buf;
             if ( use_encryption_flg ) {
-                this_iv.assign(
-                    &buf[ 0 ],
-                    &buf[ iv_size ] );
-                cipher.assign(
-                    &buf[ iv_size ],
-                    &buf[ new_size ] );
-
                 irods::error ret = crypt.decrypt(
-                                       shared_secret,
-                                       this_iv,
-                                       cipher,
-                                       plain );
+                                       buf,
+                                       new_size,
+                                       plain_size );
                 if ( !ret.ok() ) {
                     irods::log( PASS( ret ) );
                     myInput->status = SYS_COPY_LEN_ERR;
                     break;
                 }
-
-                std::copy(
-                    plain.begin(),
-                    plain.end(),
-                    &buf[0] );
-                plain_size = plain.size();
-
+                plain_buf = buf + crypt.iv_size();
             }
 
             bytesWritten = _l3Write(
                                myInput->rsComm,
                                destL3descInx,
-                               buf,
+                               plain_buf,
                                plain_size );
 
             if ( bytesWritten != plain_size ) {
@@ -1746,28 +1752,32 @@ locToRemPartialCopy( portalTransferInp_t *myInput ) {
           irods::CS_NEG_USE_SSL );
 
     // =-=-=-=-=-=-=-
-    // create an encryption context
-    int iv_size = 0;
-    irods::buffer_crypt::array_t iv;
-    irods::buffer_crypt::array_t cipher;
-    irods::buffer_crypt::array_t in_buf;
-    irods::buffer_crypt::array_t shared_secret;
-    irods::buffer_crypt crypt(
+    // create the encryption context of this stream, keyed once with
+    // the shared secret
+    irods::stream_crypt crypt(
         myInput->key_size,
-        myInput->salt_size,
-        myInput->num_hash_rounds,
         myInput->encryption_algorithm );
-
-    // =-=-=-=-=-=-=-
-    // set iv size
     if ( use_encryption_flg ) {
-        iv_size = crypt.key_size();
-        shared_secret.assign(
+        irods::buffer_crypt::array_t shared_secret(
             &myInput->shared_secret[0],
-            &myInput->shared_secret[iv_size] );
-
+            &myInput->shared_secret[ crypt.key_size() ] );
+        irods::error ret = crypt.init( shared_secret, true );
+        if ( !ret.ok() ) {
+            irods::log( PASS( ret ) );
+            myInput->status = ret.code();
+            if ( myInput->threadNum > 0 ) {
+                _l3Close( myInput->rsComm, srcL3descInx );
+            }
+            CLOSE_SOCK( destFd );
+            return;
+        }
     }
 
+    // =-=-=-=-=-=-=-
+    // the plain text is read in behind room for the iv, so it can be
+    // encrypted where it lies
+    int plain_offset = use_encryption_flg ? crypt.iv_size() : 0;
+
     int trans_buff_size = 0;
     irods::error ret = irods::get_advanced_setting<int>(
                            irods::CFG_TRANS_BUFFER_SIZE_FOR_PARA_TRANS,
@@ -1816,7 +1826,7 @@ locToRemPartialCopy( portalTransferInp_t *myInput ) {
                 toRead = toGet;
             }
 
-            bytesRead = _l3Read( myInput->rsComm, srcL3descInx, buf, toRead );
+            bytesRead = _l3Read( myInput->rsComm, srcL3descInx, buf + plain_offset, toRead );
 
             if ( bytesRead != toRead ) {
                 if ( bytesRead < 0 ) {
@@ -1834,47 +1844,20 @@ locToRemPartialCopy( portalTransferInp_t *myInput ) {
             }
 
             // =-=-=-=-=-=-=-
-            // compute an iv for this particular transmission and use
-            // it to encrypt this buffer
+            // encrypt the buffer where it lies, behind the iv of this
+            // particular transmission
             int new_size = bytesRead;
             if ( use_encryption_flg ) {
-                irods::error ret = crypt.initialization_vector( iv );
-                if ( !ret.ok() ) {
-                    ret = PASS( ret );
-                    printf( "%s", ret.result().c_str() );
-                    break;
-                }
-
-                // =-=-=-=-=-=-=-
-                // encrypt
-                in_buf.assign(
-                    &buf[0],
-                    &buf[ bytesRead ] );
-
-                ret = crypt.encrypt(
-                          shared_secret,
-                          iv,
-                          in_buf,
-                          cipher );
+                irods::error ret = crypt.encrypt(
+                                       buf,
+                                       bytesRead,
+                                       new_size );
                 if ( !ret.ok() ) {
-                    ret = PASS( ret );
-                    printf( "%s", ret.result().c_str() );
+                    irods::log( PASS( ret ) );
+                    myInput->status = ret.code();
                     break;
                 }
 
-                // =-=-=-=-=-=-=-
-                // capture the iv with the cipher text
-                std::copy(
-                    iv.begin(),
-                    iv.end(),
-                    &buf[0] );
-                std::copy(
-                    cipher.begin(),
-                    cipher.end(),
-                    &buf[iv_size] );
-
-                new_size = iv.size() + cipher.size();
-
                 // =-=-=-=-=-=-=-
                 // need to send the incoming size as encryption might change
                 // the size of the data from the written values
@@ -27,26 +27,24 @@
 #include "irods_resource_backport.hpp"
 #include "irods_hierarchy_parser.hpp"
 #include "irods_stacktrace.hpp"
+#include "irods_transfer_tuner.hpp"
+#include "irods_l1desc_table.hpp"
 
 int
 initL1desc() {
-    memset( L1desc, 0, sizeof( L1desc ) );
+    L1desc.clear();
     return 0;
 }
 
 int
 allocL1desc() {
-    int i;
-
-    for ( i = 3; i < NUM_L1_DESC; i++ ) {
-        if ( L1desc[i].inuseFlag <= FD_FREE ) {
-            L1desc[i].inuseFlag = FD_INUSE;
-            return i;
-        };
+    try {
+        return L1desc.alloc();
+    }
+    catch ( std::bad_alloc& ) {
+        rodsLog( LOG_NOTICE,
+                 "allocL1desc: out of L1desc" );
     }
-
-    rodsLog( LOG_NOTICE,
-             "allocL1desc: out of L1desc" );
 
     return SYS_OUT_OF_FILE_DESC;
 }
@@ -55,7 +53,7 @@ int
 isL1descInuse() {
     int i;
 
-    for ( i = 3; i < NUM_L1_DESC; i++ ) {
+    for ( i = 3; i < L1desc.size(); i++ ) {
         if ( L1desc[i].inuseFlag == FD_INUSE ) {
             return 1;
         };
@@ -110,7 +108,7 @@ closeAllL1desc( rsComm_t *rsComm ) {
     if ( rsComm == NULL ) {
         return 0;
     }
-    for ( i = 3; i < NUM_L1_DESC; i++ ) {
+    for ( i = 3; i < L1desc.size(); i++ ) {
         if ( L1desc[i].inuseFlag == FD_INUSE &&
                 L1desc[i].l3descInx > 2 ) {
             l3Close( rsComm, i );
@@ -121,7 +119,7 @@ closeAllL1desc( rsComm_t *rsComm ) {
 
 int
 freeL1desc( int l1descInx ) {
-    if ( l1descInx < 3 || l1descInx >= NUM_L1_DESC ) {
+    if ( l1descInx < 3 || l1descInx >= L1desc.size() ) {
         rodsLog( LOG_NOTICE,
                  "freeL1desc: l1descInx %d out of range", l1descInx );
         return SYS_FILE_DESC_OUT_OF_RANGE;
@@ -144,7 +142,11 @@ freeL1desc( int l1descInx ) {
         clearDataObjInp( L1desc[l1descInx].dataObjInp );
         free( L1desc[l1descInx].dataObjInp );
     }
+    int wasInuse = L1desc[l1descInx].inuseFlag == FD_INUSE;
     memset( &L1desc[l1descInx], 0, sizeof( l1desc_t ) );
+    if ( wasInuse ) {
+        L1desc.release( l1descInx );
+    }
 
     return 0;
 }
@@ -246,7 +248,7 @@ initDataObjInfoWithInp( dataObjInfo_t *dataObjInfo, dataObjInp_t *dataObjInp ) {
 int
 getL1descIndexByDataObjInfo( const dataObjInfo_t * dataObjInfo ) {
     int index;
-    for ( index = 3; index < NUM_L1_DESC; index++ ) {
+    for ( index = 3; index < L1desc.size(); index++ ) {
         if ( L1desc[index].dataObjInfo == dataObjInfo ) {
             return index;
         }
@@ -254,15 +256,15 @@ getL1descIndexByDataObjInfo( const dataObjInfo_t * dataObjInfo ) {
     return -1;
 }
 
-/* getNumThreads - get the number of threads.
+/* getRuleNumThreads - get the number of threads from acSetNumThreads.
  * inpNumThr - 0 - server decide
  *             < 0 - NO_THREADING
  *             > 0 - num of threads wanted
  */
 
-int
-getNumThreads( rsComm_t *rsComm, rodsLong_t dataSize, int inpNumThr,
-               keyValPair_t *condInput, char *destRescHier, char *srcRescHier, int oprType ) {
+static int
+getRuleNumThreads( rsComm_t *rsComm, rodsLong_t dataSize, int inpNumThr,
+                   keyValPair_t *condInput, char *destRescHier, char *srcRescHier, int oprType ) {
     ruleExecInfo_t rei;
     dataObjInp_t doinp;
     int status;
@@ -410,6 +412,33 @@ getNumThreads( rsComm_t *rsComm, rodsLong_t dataSize, int inpNumThr,
     }
 }
 
+/* getNumThreads - get the number of threads.
+ * inpNumThr - 0 - server decide
+ *             < 0 - NO_THREADING
+ *             > 0 - num of threads wanted
+ * When the server decides a client put or get, the count from
+ * acSetNumThreads is the upper bound for the adaptive transfer tuner.
+ */
+
+int
+getNumThreads( rsComm_t *rsComm, rodsLong_t dataSize, int inpNumThr,
+               keyValPair_t *condInput, char *destRescHier, char *srcRescHier, int oprType ) {
+    int numThr = getRuleNumThreads( rsComm, dataSize, inpNumThr, condInput,
+                                    destRescHier, srcRescHier, oprType );
+    if ( numThr <= 1 || inpNumThr != 0 ||
+            ( oprType != PUT_OPR && oprType != GET_OPR ) ||
+            getValByKey( condInput, RBUDP_TRANSFER_KW ) != NULL ) {
+        return numThr;
+    }
+
+    irods::transfer_tuner& tuner = irods::transfer_tuner::instance();
+    if ( !tuner.enabled() ) {
+        return numThr;
+    }
+
+    return tuner.num_threads( rsComm->clientAddr, oprType, numThr );
+}
+
 int
 initDataOprInp( dataOprInp_t *dataOprInp, int l1descInx, int oprType ) {
     dataObjInfo_t *dataObjInfo;
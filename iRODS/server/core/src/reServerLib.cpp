@@ -95,151 +95,6 @@ getReInfoById( rsComm_t *rsComm, char *ruleExecId, genQueryOut_t **genQueryOut )
     return status;
 }
 
-/* getNextQueuedRuleExec - get the next RuleExec in queue to run
- * jobType -   0 - run exeStatus = RE_IN_QUEUE and RE_RUNNING
- * 		  RE_FAILED_STATUS -  run the RE_FAILED too
- */
-
-int
-getNextQueuedRuleExec( genQueryOut_t **inGenQueryOut,
-                       int startInx, ruleExecSubmitInp_t *queuedRuleExec,
-                       reExec_t *reExec, int jobType ) {
-    sqlResult_t *ruleExecId, *ruleName, *reiFilePath, *userName, *exeAddress,
-                *exeTime, *exeFrequency, *priority, *lastExecTime, *exeStatus,
-                *estimateExeTime, *notificationAddr;
-    int i, status;
-    genQueryOut_t *genQueryOut;
-
-    if ( inGenQueryOut == NULL || *inGenQueryOut == NULL ||
-            queuedRuleExec == NULL || queuedRuleExec->packedReiAndArgBBuf == NULL ||
-            queuedRuleExec->packedReiAndArgBBuf->buf == NULL ) {
-        rodsLog( LOG_ERROR,
-                 "getNextQueuedRuleExec: NULL input" );
-        return SYS_INTERNAL_NULL_INPUT_ERR;
-    }
-
-    genQueryOut = *inGenQueryOut;
-    if ( ( ruleExecId = getSqlResultByInx( genQueryOut,
-                                           COL_RULE_EXEC_ID ) ) == NULL ) {
-        rodsLog( LOG_NOTICE,
-                 "getNextQueuedRuleExec: getSqlResultByInx for EXEC_ID failed" );
-        return UNMATCHED_KEY_OR_INDEX;
-    }
-    if ( ( ruleName = getSqlResultByInx( genQueryOut,
-                                         COL_RULE_EXEC_NAME ) ) == NULL ) {
-        rodsLog( LOG_NOTICE,
-                 "getNextQueuedRuleExec: getSqlResultByInx for EXEC_NAME failed" );
-        return UNMATCHED_KEY_OR_INDEX;
-    }
-    if ( ( reiFilePath = getSqlResultByInx( genQueryOut,
-                                            COL_RULE_EXEC_REI_FILE_PATH ) ) == NULL ) {
-        rodsLog( LOG_NOTICE,
-                 "getNextQueuedRuleExec: getSqlResultByInx for REI_FILE_PATH failed" );
-        return UNMATCHED_KEY_OR_INDEX;
-    }
-    if ( ( userName = getSqlResultByInx( genQueryOut,
-                                         COL_RULE_EXEC_USER_NAME ) ) == NULL ) {
-        rodsLog( LOG_NOTICE,
-                 "getNextQueuedRuleExec: getSqlResultByInx for USER_NAME failed" );
-        return UNMATCHED_KEY_OR_INDEX;
-    }
-    if ( ( exeAddress = getSqlResultByInx( genQueryOut,
-                                           COL_RULE_EXEC_ADDRESS ) ) == NULL ) {
-        rodsLog( LOG_NOTICE,
-                 "getNextQueuedRuleExec: getSqlResultByInx for EXEC_ADDRESS failed" );
-        return UNMATCHED_KEY_OR_INDEX;
-    }
-    if ( ( exeTime = getSqlResultByInx( genQueryOut,
-                                        COL_RULE_EXEC_TIME ) ) == NULL ) {
-        rodsLog( LOG_NOTICE,
-                 "getNextQueuedRuleExec: getSqlResultByInx for EXEC_TIME failed" );
-        return UNMATCHED_KEY_OR_INDEX;
-    }
-    if ( ( exeFrequency = getSqlResultByInx( genQueryOut,
-                          COL_RULE_EXEC_FREQUENCY ) ) == NULL ) {
-        rodsLog( LOG_NOTICE,
-                 "getNextQueuedRuleExec:getResultByInx for RULE_EXEC_FREQUENCY failed" );
-        return UNMATCHED_KEY_OR_INDEX;
-    }
-    if ( ( priority = getSqlResultByInx( genQueryOut,
-                                         COL_RULE_EXEC_PRIORITY ) ) == NULL ) {
-        rodsLog( LOG_NOTICE,
-                 "getNextQueuedRuleExec: getSqlResultByInx for PRIORITY failed" );
-        return UNMATCHED_KEY_OR_INDEX;
-    }
-    if ( ( lastExecTime = getSqlResultByInx( genQueryOut,
-                          COL_RULE_EXEC_LAST_EXE_TIME ) ) == NULL ) {
-        rodsLog( LOG_NOTICE,
-                 "getNextQueuedRuleExec: getSqlResultByInx for LAST_EXE_TIME failed" );
-        return UNMATCHED_KEY_OR_INDEX;
-    }
-    if ( ( exeStatus = getSqlResultByInx( genQueryOut,
-                                          COL_RULE_EXEC_STATUS ) ) == NULL ) {
-        rodsLog( LOG_NOTICE,
-                 "getNextQueuedRuleExec: getSqlResultByInx for EXEC_STATUS failed" );
-        return UNMATCHED_KEY_OR_INDEX;
-    }
-    if ( ( estimateExeTime = getSqlResultByInx( genQueryOut,
-                             COL_RULE_EXEC_ESTIMATED_EXE_TIME ) ) == NULL ) {
-        rodsLog( LOG_NOTICE,
-                 "getNextQueuedRuleExec: getResultByInx for ESTIMATED_EXE_TIME failed" );
-        return UNMATCHED_KEY_OR_INDEX;
-    }
-    if ( ( notificationAddr = getSqlResultByInx( genQueryOut,
-                              COL_RULE_EXEC_NOTIFICATION_ADDR ) ) == NULL ) {
-        rodsLog( LOG_NOTICE,
-                 "getNextQueuedRuleExec:getResultByInx for NOTIFICATION_ADDR failed" );
-        return UNMATCHED_KEY_OR_INDEX;
-    }
-
-    for ( i = startInx; i < genQueryOut->rowCnt; i++ ) {
-        char *exeStatusStr, *exeTimeStr, *ruleExecIdStr;
-
-
-        exeStatusStr = &exeStatus->value[exeStatus->len * i];
-        exeTimeStr = &exeTime->value[exeTime->len * i];
-        ruleExecIdStr =  &ruleExecId->value[ruleExecId->len * i];
-
-        if ( ( jobType & RE_FAILED_STATUS ) == 0 &&
-                strcmp( exeStatusStr, RE_FAILED ) == 0 ) {
-            /* failed request */
-            continue;
-        }
-        else if ( atoi( exeTimeStr ) > time( 0 ) ) {
-            /* not time yet */
-            continue;
-        }
-        else if ( strcmp( exeStatusStr, RE_RUNNING ) == 0 ) {
-            /* is already running */
-            if ( reExec->doFork == 1 &&	/* multiProc */
-                    matchRuleExecId( reExec, ruleExecIdStr, RE_PROC_RUNNING ) ) {
-                /* the job is running in multiProc env */
-                continue;
-            }
-            else {
-                rodsLog( LOG_NOTICE,
-                         "getNextQueuedRuleExec: reId %s in RUNNING state. Run again",
-                         ruleExecIdStr );
-            }
-        }
-        status = fillExecSubmitInp( queuedRuleExec, exeStatusStr, exeTimeStr,
-                                    ruleExecIdStr,
-                                    &reiFilePath->value[reiFilePath->len * i],
-                                    &ruleName->value[ruleName->len * i],
-                                    &userName->value[userName->len * i],
-                                    &exeAddress->value[exeAddress->len * i],
-                                    &exeFrequency->value[exeFrequency->len * i],
-                                    &priority->value[priority->len * i],
-                                    &estimateExeTime->value[estimateExeTime->len * i],
-                                    &notificationAddr->value[notificationAddr->len * i] );
-        if ( status < 0 ) {
-            continue;
-        }
-        return i;
-    }
-    return -1;
-}
-
 int
 modExeInfoForRepeat( rsComm_t *rsComm, char *ruleExecId, char* pastTime,
                      char *delay, int opStatus ) {
@@ -356,34 +211,58 @@ regExeStatus( rsComm_t *rsComm, char *ruleExecId, char *exeStatus ) {
     return status;
 }
 
-/* runQueuedRuleExec - given the job queue given in genQueryOut (from
- * a getReInfo call), run the jobs with the input jobType.
- * Valid jobType = 0 ==> normal job.
- * jobType = RE_FAILED_STATUS ==> job have failed as least once
+/* runQueuedRuleExec - start the jobs of the queue which are due, best
+ * first, until they or the free process slots run out. A job which
+ * failed before is run with jobType RE_FAILED_STATUS.
  */
 
 int
 runQueuedRuleExec( rsComm_t *rsComm, reExec_t *reExec,
-                   genQueryOut_t **genQueryOut, time_t endTime, int jobType ) {
-    int inx, status;
+                   irods::rule_exec_queue& ruleExecQueue ) {
+    int status;
     ruleExecSubmitInp_t *myRuleExecInp;
     int runCnt = 0;
     int thrInx;
+    irods::rule_exec_entry entry;
 
-    inx = -1;
-    while ( time( NULL ) <= endTime && ( thrInx = allocReThr( reExec ) ) >= 0 ) { // JMC - backport 4695
+    while ( ruleExecQueue.has_ready( time( NULL ) ) &&
+            ( thrInx = allocReThr( reExec ) ) >= 0 ) { // JMC - backport 4695
         myRuleExecInp = &reExec->reExecProc[thrInx].ruleExecSubmitInp;
         chkAndUpdateResc( rsComm );
-        if ( ( inx = getNextQueuedRuleExec( genQueryOut, inx + 1,
-                                            myRuleExecInp, reExec, jobType ) ) < 0 ) {
+        if ( !ruleExecQueue.next( time( NULL ), entry ) ) {
             /* no job to run */
             freeReThr( reExec, thrInx );
             break;
         }
-        else {
-            reExec->reExecProc[thrInx].jobType = jobType;
+
+        if ( entry.status_ == RE_RUNNING ) {
+            /* marked running but not by one of our processes */
+            rodsLog( LOG_NOTICE,
+                     "runQueuedRuleExec: reId %s in RUNNING state. Run again",
+                     entry.id_str_.c_str() );
         }
 
+        status = fillExecSubmitInp( myRuleExecInp,
+                                    ( char * ) entry.status_.c_str(),
+                                    ( char * ) entry.exe_time_.c_str(),
+                                    ( char * ) entry.id_str_.c_str(),
+                                    ( char * ) entry.rei_file_path_.c_str(),
+                                    ( char * ) entry.name_.c_str(),
+                                    ( char * ) entry.user_name_.c_str(),
+                                    ( char * ) entry.address_.c_str(),
+                                    ( char * ) entry.frequency_.c_str(),
+                                    ( char * ) entry.priority_str_.c_str(),
+                                    ( char * ) entry.estimated_exe_time_.c_str(),
+                                    ( char * ) entry.notification_addr_.c_str() );
+        if ( status < 0 ) {
+            /* tried again at the next resync */
+            ruleExecQueue.drop( entry.id_str_ );
+            freeReThr( reExec, thrInx );
+            continue;
+        }
+        reExec->reExecProc[thrInx].jobType =
+            entry.status_ == RE_FAILED ? RE_FAILED_STATUS : 0;
+
         /* mark running */
         status = regExeStatus( rsComm, myRuleExecInp->ruleExecId,
                                RE_RUNNING );
@@ -391,6 +270,7 @@ runQueuedRuleExec( rsComm_t *rsComm, reExec_t *reExec,
             rodsLog( LOG_ERROR,
                      "runQueuedRuleExec: regExeStatus of id %s failed,stat = %d",
                      myRuleExecInp->ruleExecId, status );
+            ruleExecQueue.drop( entry.id_str_ );
             freeReThr( reExec, thrInx );
             continue;
         }
@@ -404,6 +284,7 @@ runQueuedRuleExec( rsComm_t *rsComm, reExec_t *reExec,
             }
             postProcRunRuleExec( rsComm, &reExec->reExecProc[thrInx] );
             freeReThr( reExec, thrInx );
+            ruleExecQueue.refresh_entry( rsComm, entry.id_str_ );
             continue;
         }
         else {
@@ -457,13 +338,6 @@ runQueuedRuleExec( rsComm_t *rsComm, reExec_t *reExec,
             }
         }
     }
-    if ( reExec->doFork == 1 ) {
-        /* wait for all jobs to finish */
-        while ( reExec->runCnt + 1 >= reExec->maxRunCnt &&
-                waitAndFreeReThr( rsComm, reExec ) >= 0 ) {
-            ;    // JMC - backport 4695
-        }
-    }
 
     return runCnt;
 }
@@ -658,14 +532,24 @@ allocReThr( reExec_t * reExec ) { // JMC - backport 4695
     return thrInx;
 }
 
+/* waitAndFreeReThr - reap a finished job process and read its row into
+ * the queue again. waitOpt is passed to waitpid, with WNOHANG it returns
+ * SYS_NO_FREE_RE_THREAD if no process has finished.
+ */
+
 int
-waitAndFreeReThr( rsComm_t * rsComm, reExec_t * reExec ) { // JMC - backport 4695
+waitAndFreeReThr( rsComm_t * rsComm, reExec_t * reExec, int waitOpt,
+                  irods::rule_exec_queue& ruleExecQueue ) { // JMC - backport 4695
     pid_t childPid;
     int status = 0;
     int thrInx = SYS_NO_FREE_RE_THREAD;
 
-    childPid = waitpid( -1, &status, WUNTRACED );
-    if ( childPid < 0 ) {
+    childPid = waitpid( -1, &status, WUNTRACED | waitOpt );
+    if ( childPid == 0 ) {
+        /* none finished yet */
+        return SYS_NO_FREE_RE_THREAD;
+    }
+    else if ( childPid < 0 ) {
         if ( reExec->runCnt > 0 ) {
             int i;
             rodsLog( LOG_NOTICE,
@@ -677,6 +561,7 @@ waitAndFreeReThr( rsComm_t * rsComm, reExec_t * reExec ) { // JMC - backport 469
                 }
             }
             reExec->runCnt = 0;
+            ruleExecQueue.clear_running();
             thrInx = 0;
         }
     }
@@ -733,7 +618,12 @@ waitAndFreeReThr( rsComm_t * rsComm, reExec_t * reExec ) { // JMC - backport 469
                 }
                 freeGenQueryOut( &genQueryOut );
             }
+            std::string finishedId = ruleExecId;
             freeReThr( reExec, thrInx );
+            irods::error ret = ruleExecQueue.refresh_entry( rsComm, finishedId );
+            if ( !ret.ok() ) {
+                irods::log( PASS( ret ) );
+            }
         }
         // =-=-=-=-=-=-=-
     }
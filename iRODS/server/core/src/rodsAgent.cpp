@@ -5,6 +5,7 @@
  */
 
 #include <syslog.h>
+#include <fcntl.h>
 #include "rodsAgent.hpp"
 #include "reconstants.hpp"
 #include "rsApiHandler.hpp"
@@ -31,7 +32,9 @@ static void NtAgentSetEnvsFromArgs( int ac, char **av );
 #include "irods_client_api_table.hpp"
 #include "irods_pack_table.hpp"
 #include "irods_threads.hpp"
+#include "irods_agent_pool.hpp"
 #include "procLog.h"
+#include "specColl.hpp"
 #include "initServer.hpp"
 
 #include "readServerConfig.hpp"
@@ -49,12 +52,13 @@ int getAgentProcPIDs(
 }
 
 
+static int serveClientConnection( bool& _reusable );
+static int agentPoolMain( int ctrlSock );
+
 /* #define SERVER_DEBUG 1   */
 int
 main( int, char ** ) {
 
-    int status;
-    rsComm_t rsComm;
     char *tmpStr;
 
     ProcessType = AGENT_PT;
@@ -92,24 +96,6 @@ main( int, char ** ) {
 #endif
 #endif
 
-    memset( &rsComm, 0, sizeof( rsComm ) );
-    rsComm.thread_ctx = ( thread_context* )malloc( sizeof( thread_context ) );
-
-    status = initRsCommWithStartupPack( &rsComm, NULL );
-
-    // =-=-=-=-=-=-=-
-    // manufacture a network object for comms
-    irods::network_object_ptr net_obj;
-    irods::error ret = irods::network_factory( &rsComm, net_obj );
-    if ( !ret.ok() ) {
-        irods::log( PASS( ret ) );
-    }
-
-    if ( status < 0 ) {
-        sendVersion( net_obj, status, 0, NULL, 0 );
-        cleanupAndExit( status );
-    }
-
     /* Handle option to log sql commands */
     tmpStr = getenv( SP_LOG_SQL );
     if ( tmpStr != NULL ) {
@@ -136,15 +122,8 @@ main( int, char ** ) {
     /* Open a connection to syslog */
     openlog( "rodsAgent", LOG_ODELAY | LOG_PID, LOG_DAEMON );
 #endif
-    status = getRodsEnv( &rsComm.myEnv );
-
-    if ( status < 0 ) {
-        rodsLog( LOG_ERROR, "agentMain :: getRodsEnv failed" );
-        sendVersion( net_obj, SYS_AGENT_INIT_ERR, 0, NULL, 0 );
-        cleanupAndExit( status );
-    }
 
-    ret = setRECacheSaltFromEnv();
+    irods::error ret = setRECacheSaltFromEnv();
     if ( !ret.ok() ) {
         rodsLog( LOG_ERROR, "rodsAgent::main: Failed to set RE cache mutex name\n%s", ret.result().c_str() );
         exit( 1 );
@@ -175,8 +154,127 @@ main( int, char ** ) {
         return 1;
     }
 
+#ifndef windows_platform
+    // =-=-=-=-=-=-=-
+    // a pooled agent has been started ahead of any connection and
+    // waits here for the server to hand it one
+    tmpStr = getenv( SP_AGENT_POOL_SOCK );
+    if ( tmpStr != NULL ) {
+        return agentPoolMain( atoi( tmpStr ) );
+    }
+#endif
+
+    bool reusable = false;
+    int status = serveClientConnection( reusable );
+    rodsLog( LOG_NOTICE, "Agent exiting with status = %d", status );
+    return status;
+}
+
+#ifndef windows_platform
+/* agentPoolMain - serve connections handed over by the server until the
+ * per agent request limit is reached or the server closes the pool */
+static int
+agentPoolMain( int ctrlSock ) {
+    int status = 0;
+    int poolSize = 0;
+    int maxRequests = 0;
+
+    fcntl( ctrlSock, F_SETFD, FD_CLOEXEC );
+
+    irods::error ret = irods::agent_pool::get_settings( poolSize, maxRequests );
+    if ( !ret.ok() ) {
+        irods::log( PASS( ret ) );
+        maxRequests = irods::DEFAULT_AGENT_POOL_MAX_REQUESTS;
+    }
+
+    for ( int served = 0; served < maxRequests; served++ ) {
+        ret = irods::agent_pool::signal_ready( ctrlSock, served );
+        if ( !ret.ok() ) {
+            irods::log( PASS( ret ) );
+            break;
+        }
+
+        int newSock = -1;
+        startupPack_t startupPack;
+        ret = irods::agent_pool::wait_for_connection( ctrlSock, newSock, startupPack );
+        if ( !ret.ok() ) {
+            /* the server is shutting down or has shrunk the pool */
+            rodsLog( LOG_DEBUG, "agentPoolMain: %s", ret.result().c_str() );
+            break;
+        }
+
+        setStartupPackEnv( newSock, &startupPack );
+
+        bool reusable = false;
+        status = serveClientConnection( reusable );
+        close( newSock );
+        if ( status < 0 || !reusable ) {
+            break;
+        }
+
+        /* reset the per connection state before going back to the pool.
+         * what a connection leaves behind is reset as follows:
+         * - here: the process log entry, InitialState and ThisComm, and
+         *   the cached special collection mounts
+         * - cleanup: the catalog connection and its session ticket, open
+         *   descriptors and server to server connections
+         * - initAgent: the descriptor tables, rule engine, server host
+         *   list and quota globals
+         * - init_from_catalog: the resource table and its maintenance
+         *   operations, when the published resources have changed
+         * - AUTH_AGENT_START: the native auth session generation
+         * - set_rule_engine_globals: the client user properties
+         * a new global kept per connection must be added to this list */
+        rodsLog( LOG_DEBUG, "Agent returning to the pool with status = %d", status );
+        rmProcLog( getpid() );
+        freeSpecCollCache();
+        InitialState = INITIAL_NOT_DONE;
+        ThisComm = NULL;
+    }
+
+    close( ctrlSock );
+    rodsLog( LOG_NOTICE, "Agent exiting with status = %d", status );
+    return status;
+}
+#endif
+
+/* serveClientConnection - initialize the agent for the connection
+ * described by the startup pack env variables and process the client
+ * requests until it disconnects. _reusable is set if the process state
+ * may be reset and the agent used for another connection */
+static int
+serveClientConnection( bool& _reusable ) {
+
+    int status;
+    rsComm_t rsComm;
+
+    _reusable = false;
+
+    memset( &rsComm, 0, sizeof( rsComm ) );
+    rsComm.thread_ctx = ( thread_context* )malloc( sizeof( thread_context ) );
+
+    status = initRsCommWithStartupPack( &rsComm, NULL );
 
+    // =-=-=-=-=-=-=-
+    // manufacture a network object for comms
+    irods::network_object_ptr net_obj;
+    irods::error ret = irods::network_factory( &rsComm, net_obj );
+    if ( !ret.ok() ) {
+        irods::log( PASS( ret ) );
+    }
 
+    if ( status < 0 ) {
+        sendVersion( net_obj, status, 0, NULL, 0 );
+        cleanupAndExit( status );
+    }
+
+    status = getRodsEnv( &rsComm.myEnv );
+
+    if ( status < 0 ) {
+        rodsLog( LOG_ERROR, "agentMain :: getRodsEnv failed" );
+        sendVersion( net_obj, SYS_AGENT_INIT_ERR, 0, NULL, 0 );
+        cleanupAndExit( status );
+    }
 
 #if RODS_CAT
     if ( strstr( rsComm.myEnv.rodsDebug, "CAT" ) != NULL ) {
@@ -268,9 +366,12 @@ main( int, char ** ) {
 
     new_net_obj->to_server( &rsComm );
     cleanup();
+
+    /* the reconnection thread holds on to rsComm, so do not reuse */
+    _reusable = ( rsComm.reconnFlag != RECONN_TIMEOUT );
+
     free( rsComm.thread_ctx );
     free( rsComm.auth_scheme );
-    rodsLog( LOG_NOTICE, "Agent exiting with status = %d", status );
     return status;
 }
 
@@ -30,6 +30,11 @@
 #include "irods_network_factory.hpp"
 #include "irods_server_properties.hpp"
 #include "irods_server_control_plane.hpp"
+#include "irods_agent_pool.hpp"
+#include "irods_resource_cache.hpp"
+#include "irods_rule_profiler.hpp"
+#include "irods_auth_session_cache.hpp"
+#include "irods_round_robin_cursor.hpp"
 #include "readServerConfig.hpp"
 #include "initServer.hpp"
 #include "procLog.h"
@@ -330,6 +335,21 @@ serverMain( char *logDir ) {
         irods::server_control_plane ctrl_plane(
             irods::CFG_SERVER_CONTROL_PLANE_PORT );
 
+        // =-=-=-=-=-=-=-
+        // start the warm pool of agents, if configured
+        irods::agent_pool& pool = irods::agent_pool::instance();
+        ret = pool.configure();
+        if ( !ret.ok() ) {
+            irods::log( PASS( ret ) );
+        }
+        else if ( pool.enabled() ) {
+            mySetenvInt( SERVER_BOOT_TIME, ServerBootTime );
+            ret = pool.replenish();
+            if ( !ret.ok() ) {
+                irods::log( PASS( ret ) );
+            }
+        }
+
         startProcConnReqThreads();
 #if RODS_CAT // JMC - backport 4612
         try {
@@ -401,6 +421,7 @@ serverMain( char *logDir ) {
             }
 
             procChildren( &ConnectedAgentHead );
+            procAgentPool( &ConnectedAgentHead );
 
             if ( 0 == numSock ) {
                 continue;
@@ -467,6 +488,7 @@ serverMain( char *logDir ) {
         catch ( const boost::thread_resource_error& ) {
             rodsLog( LOG_ERROR, "boost encountered a thread_resource_error during join in serverMain." );
         }
+        pool.shutdown();
         procChildren( &ConnectedAgentHead );
         stopProcConnReqThreads();
 
@@ -497,6 +519,10 @@ serverExit()
     rodsLog( LOG_NOTICE, "rodsServer is exiting." );
 #endif
     recordServerProcess( NULL ); /* unlink the process id file */
+    irods::resource_cache::remove();
+    irods::rule_profiler::remove();
+    irods::auth_session_cache::remove();
+    irods::round_robin_cursor::remove();
     exit( 1 );
 }
 
@@ -521,11 +547,17 @@ procChildren( agentProc_t **agentProcHead ) {
 #ifndef _WIN32
     while ( ( childPid = waitpid( -1, &status, WNOHANG ) ) > 0 ) {
         tmpAgentProc = getAgentProcByPid( childPid, agentProcHead );
+        bool pooled = irods::agent_pool::instance().reap( childPid );
         if ( tmpAgentProc != NULL ) {
             rodsLog( LOG_NOTICE, "Agent process %d exited with status %d",
                      childPid, status );
             free( tmpAgentProc );
         }
+        else if ( pooled ) {
+            rodsLog( LOG_DEBUG,
+                     "Idle pooled agent process %d exited with status %d",
+                     childPid, status );
+        }
         else {
             rodsLog( LOG_NOTICE,
                      "Agent process %d exited with status %d but not in queue",
@@ -538,6 +570,38 @@ procChildren( agentProc_t **agentProcHead ) {
     return 0;
 }
 
+/* procAgentPool - collect pooled agents which finished a connection and
+ * went back to the pool, and refill the pool with new agents */
+int
+procAgentPool( agentProc_t **agentProcHead ) {
+    irods::agent_pool& pool = irods::agent_pool::instance();
+    if ( !pool.enabled() ) {
+        return 0;
+    }
+
+    std::vector<int> recycled;
+    irods::error ret = pool.poll( recycled );
+    if ( !ret.ok() ) {
+        irods::log( PASS( ret ) );
+    }
+
+    for ( size_t i = 0; i < recycled.size(); ++i ) {
+        agentProc_t *tmpAgentProc = getAgentProcByPid( recycled[i], agentProcHead );
+        if ( tmpAgentProc != NULL ) {
+            rodsLog( LOG_DEBUG, "Agent process %d returned to the pool",
+                     recycled[i] );
+            free( tmpAgentProc );
+        }
+    }
+
+    ret = pool.replenish();
+    if ( !ret.ok() ) {
+        irods::log( PASS( ret ) );
+        return ret.code();
+    }
+
+    return 0;
+}
 
 agentProc_t *
 getAgentProcByPid( int childPid, agentProc_t **agentProcHead ) {
@@ -583,6 +647,19 @@ spawnAgent( agentProc_t *connReq, agentProc_t **agentProcHead ) {
     startupPack = &connReq->startupPack;
 
 #ifndef windows_platform
+    /* hand the connection to a warm agent if one is idle */
+    irods::agent_pool& pool = irods::agent_pool::instance();
+    if ( pool.enabled() ) {
+        irods::error ret = pool.dispatch( newSock, startupPack, childPid );
+        if ( ret.ok() ) {
+            queConnectedAgentProc( childPid, connReq, agentProcHead );
+            return childPid;
+        }
+        else if ( SYS_NO_AGENT_POOL_SLOT_ERR != ret.code() ) {
+            irods::log( PASS( ret ) );
+        }
+    }
+
     childPid = fork();	/* use fork instead of vfork because of multi-thread
 			 * env */
 
@@ -640,33 +717,7 @@ execAgent( int newSock, startupPack_t *startupPack ) {
     int status;
     char buf[NAME_LEN];
 
-    mySetenvInt( SP_NEW_SOCK, newSock );
-    mySetenvInt( SP_PROTOCOL, startupPack->irodsProt );
-    mySetenvInt( SP_RECONN_FLAG, startupPack->reconnFlag );
-    mySetenvInt( SP_CONNECT_CNT, startupPack->connectCnt );
-    mySetenvStr( SP_PROXY_USER, startupPack->proxyUser );
-    mySetenvStr( SP_PROXY_RODS_ZONE, startupPack->proxyRodsZone );
-    mySetenvStr( SP_CLIENT_USER, startupPack->clientUser );
-    mySetenvStr( SP_CLIENT_RODS_ZONE, startupPack->clientRodsZone );
-    mySetenvStr( SP_REL_VERSION, startupPack->relVersion );
-    mySetenvStr( SP_API_VERSION, startupPack->apiVersion );
-
-    // =-=-=-=-=-=-=-
-    // if the client-server negotiation request is in the
-    // option variable, set that env var and strip it out
-    std::string opt_str( startupPack->option );
-    size_t pos = opt_str.find( REQ_SVR_NEG );
-    if ( std::string::npos != pos ) {
-        std::string trunc_str = opt_str.substr( 0, pos );
-        mySetenvStr( SP_OPTION,           trunc_str.c_str() );
-        mySetenvStr( irods::RODS_CS_NEG, REQ_SVR_NEG );
-
-    }
-    else {
-        mySetenvStr( SP_OPTION, startupPack->option );
-
-    }
-
+    setStartupPackEnv( newSock, startupPack );
     mySetenvInt( SERVER_BOOT_TIME, ServerBootTime );
 
 
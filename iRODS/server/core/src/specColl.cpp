@@ -225,6 +225,17 @@ queueSpecCollCacheWithObjStat( rodsObjStat_t *rodsObjStatOut ) {
 
 }
 
+/* freeSpecCollCache - forget the cached mounts, which another agent may
+ * have changed since they were read */
+void
+freeSpecCollCache() {
+    while ( SpecCollCacheHead != NULL ) {
+        specCollCache_t *tmpSpecCollCache = SpecCollCacheHead;
+        SpecCollCacheHead = tmpSpecCollCache->next;
+        free( tmpSpecCollCache );
+    }
+}
+
 specCollCache_t *
 matchSpecCollCache( char *objPath ) {
     specCollCache_t *tmpSpecCollCache = SpecCollCacheHead;
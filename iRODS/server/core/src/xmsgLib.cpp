@@ -22,16 +22,27 @@
 
 #include "sockCommNetworkInterface.hpp"
 
+#ifdef linux_platform
+#include <sys/epoll.h>
+#endif
+
 static boost::mutex			     ReqQueCondMutex;
-static boost::mutex			     MessQueCondMutex;
+static boost::mutex			     MsgCondMutex;     /* guards XMsgMsParamArray */
 static boost::thread*			 ProcReqThread[ NUM_XMSG_THR ];
 static boost::condition_variable ReqQueCond;
 
-static xmsgQue_t      XmsgQue;
 static xmsgReq_t*     XmsgReqHead = NULL;
 static xmsgReq_t*     XmsgReqTail = NULL; /* points to last item in queue */
 static msParamArray_t XMsgMsParamArray;
 
+/* each hash slot is a shard with its own lock, which guards the slot's
+ * ticketMsgStruct_t list and the messages queued on those tickets */
+static boost::mutex   XmsgHashSlotMutex[NUM_HASH_SLOT];
+
+#ifdef linux_platform
+static int XmsgPollFd = -1;
+#endif
+
 // =-=-=-=-=-=-=-
 // globally referenced variable
 ticketHashQue_t XmsgHashQue[NUM_HASH_SLOT];
@@ -44,18 +55,12 @@ initThreadEnv() {
 }
 
 
+/* the caller holds the ticket's hash slot lock */
+
 int
 addXmsgToQues( irodsXmsg_t *irodsXmsg,  ticketMsgStruct_t *ticketMsgStruct ) {
 
-
-    MessQueCondMutex.lock();
-
-    addXmsgToXmsgQue( irodsXmsg, &XmsgQue );
-    int status = addXmsgToTicketMsgStruct( irodsXmsg, ticketMsgStruct );
-
-    MessQueCondMutex.unlock();
-
-    return status;
+    return addXmsgToTicketMsgStruct( irodsXmsg, ticketMsgStruct );
 
 }
 
@@ -182,6 +187,8 @@ int checkMsgCondition( irodsXmsg_t *irodsXmsg, char *msgCond ) {
 
     strcpy( condStr, msgCond );
 
+    /* the parameter array is shared by all the slots */
+    boost::mutex::scoped_lock lock( MsgCondMutex );
     XMsgMsParamArray.msParam[0]->inOutStruct = ( char * ) irodsXmsg->sendXmsgInfo->msgType; /* *XHDR*/
     XMsgMsParamArray.msParam[1]->inOutStruct = ( char * ) irodsXmsg->sendUserName;        /* *XUSER*/
     XMsgMsParamArray.msParam[2]->inOutStruct = ( char * ) irodsXmsg->sendAddr;            /* *XADDR*/
@@ -204,7 +211,8 @@ int checkMsgCondition( irodsXmsg_t *irodsXmsg, char *msgCond ) {
 
 
 
-
+/* the caller holds the hash slot lock of rcvXmsgInp->rcvTicket until it is
+ * done with the returned irodsXmsg */
 
 int getIrodsXmsg( rcvXmsgInp_t *rcvXmsgInp, irodsXmsg_t **outIrodsXmsg ) {
     int rcvTicket = rcvXmsgInp->rcvTicket;
@@ -227,7 +235,6 @@ int getIrodsXmsg( rcvXmsgInp_t *rcvXmsgInp, irodsXmsg_t **outIrodsXmsg ) {
 
     /* now locate the irodsXmsg_t */
 
-    MessQueCondMutex.lock();
     irodsXmsg_t *tmpIrodsXmsg = ticketMsgStruct->xmsgQue.head;
 
     while ( tmpIrodsXmsg != NULL && checkMsgCondition( tmpIrodsXmsg, msgCond ) != 0 ) {
@@ -235,7 +242,6 @@ int getIrodsXmsg( rcvXmsgInp_t *rcvXmsgInp, irodsXmsg_t **outIrodsXmsg ) {
     }
 
     *outIrodsXmsg = tmpIrodsXmsg;
-    MessQueCondMutex.unlock();
     if ( tmpIrodsXmsg == NULL ) {
         return SYS_NO_XMSG_FOR_MSG_NUMBER;
     }
@@ -409,57 +415,48 @@ addReqToQue( int sock ) {
 
     myXmsgReq->sock = sock;
 
+    return addXmsgReqToQue( myXmsgReq );
+}
+
+/* queue a new connection, or a parked one which has a request waiting */
+
+int
+addXmsgReqToQue( xmsgReq_t *xmsgReq ) {
+    xmsgReq->next = NULL;
+
     ReqQueCondMutex.lock();
 
     if ( XmsgReqHead == NULL ) {
-        XmsgReqHead = myXmsgReq;
-        XmsgReqTail = myXmsgReq; /* points to last item in queue */
+        XmsgReqHead = xmsgReq;
+        XmsgReqTail = xmsgReq; /* points to last item in queue */
     }
     else {
-        XmsgReqTail->next  = myXmsgReq;
-        XmsgReqTail = myXmsgReq;
+        XmsgReqTail->next  = xmsgReq;
+        XmsgReqTail = xmsgReq;
     }
 
     ReqQueCondMutex.unlock();
 
-    ReqQueCond.notify_all();
+    /* one request needs one thread */
+    ReqQueCond.notify_one();
 
     return 0;
 }
 
 xmsgReq_t *
 getReqFromQue() {
-    xmsgReq_t *myXmsgReq = NULL;
-
-    while ( myXmsgReq == NULL ) {
-
-        ReqQueCondMutex.lock();
-
-        if ( XmsgReqHead != NULL ) {
-            myXmsgReq = XmsgReqHead;
-            XmsgReqHead = XmsgReqHead->next;
-            ReqQueCondMutex.unlock();
+    boost::unique_lock<boost::mutex> boost_lock( ReqQueCondMutex );
 
-            break;
-        }
-
-        ReqQueCondMutex.unlock();
-
-        boost::unique_lock<boost::mutex> boost_lock( ReqQueCondMutex );
+    while ( XmsgReqHead == NULL ) {
         ReqQueCond.wait( boost_lock );
-        if ( XmsgReqHead == NULL ) {
-            boost_lock.unlock();
-
-            continue;
-        }
-        else {
-            myXmsgReq = XmsgReqHead;
-            XmsgReqHead = XmsgReqHead->next;
-            boost_lock.unlock();
+    }
 
-            break;
-        }
+    xmsgReq_t *myXmsgReq = XmsgReqHead;
+    XmsgReqHead = XmsgReqHead->next;
+    if ( XmsgReqHead == NULL ) {
+        XmsgReqTail = NULL;
     }
+    myXmsgReq->next = NULL;
 
     return myXmsgReq;
 }
@@ -478,60 +475,149 @@ startXmsgThreads() {
     return 0;
 }
 
+/* read the startup pack of a new connection and answer with our version */
+
+static int
+startXmsgConn( xmsgReq_t *xmsgReq ) {
+    xmsgConn_t *myConn = ( xmsgConn_t* )calloc( 1, sizeof( xmsgConn_t ) );
+    myConn->rsComm.sock = xmsgReq->sock;
+    xmsgReq->conn = myConn;
+
+    // =-=-=-=-=-=-=-
+    // manufacture a network object
+    irods::network_object_ptr net_obj;
+    irods::error ret = irods::network_factory( &myConn->rsComm, net_obj );
+    if ( !ret.ok() ) {
+        irods::log( PASS( ret ) );
+        return ret.code();
+    }
+
+    startupPack_t *startupPack;
+    ret = readStartupPack( net_obj, &startupPack, NULL );
+    if ( !ret.ok() ) {
+        rodsLog( LOG_ERROR,
+                 "procReqRoutine: readStartupPack error, status = %d", ret.code() );
+        return ret.code();
+    }
+    initRsCommWithStartupPack( &myConn->rsComm, startupPack );
+    free( startupPack );
+
+    ret = sendVersion( net_obj, 0, 0, NULL, 0 );
+    if ( !ret.ok() ) {
+        sendVersion( net_obj, SYS_AGENT_INIT_ERR, 0, NULL, 0 );
+        return ret.code();
+    }
+
+    return 0;
+}
+
 void
-procReqRoutine() {
-    struct timeval msgTimeout;
-    memset( &msgTimeout, 0, sizeof( msgTimeout ) );
-    msgTimeout.tv_sec = REQ_MSG_TIMEOUT_TIME;
+closeXmsgReq( xmsgReq_t *xmsgReq ) {
+    close( xmsgReq->sock );
+    free( xmsgReq->conn );
+    free( xmsgReq );
+}
+
+#ifdef linux_platform
+
+/* set up the poll set with the listening socket, which is the entry with
+ * no xmsgReq_t */
+
+int
+initXmsgPoll( int listenSock ) {
+    XmsgPollFd = epoll_create( XMSG_POLL_EVENTS );
+    if ( XmsgPollFd < 0 ) {
+        rodsLog( LOG_ERROR, "initXmsgPoll: epoll_create error, errno = %d", errno );
+        return SYS_INTERNAL_ERR;
+    }
+
+    struct epoll_event myEvent;
+    memset( &myEvent, 0, sizeof( myEvent ) );
+    myEvent.events = EPOLLIN;
+    myEvent.data.ptr = NULL;
+    if ( epoll_ctl( XmsgPollFd, EPOLL_CTL_ADD, listenSock, &myEvent ) < 0 ) {
+        rodsLog( LOG_ERROR, "initXmsgPoll: epoll_ctl error, errno = %d", errno );
+        return SYS_INTERNAL_ERR;
+    }
+
+    return XmsgPollFd;
+}
+
+/* hand an idle connection back to the poll set. it is armed for one event,
+ * so only one worker picks it up when its next request arrives. a client
+ * which closes its end makes it readable too, and the worker closes it */
 
+int
+parkXmsgReq( xmsgReq_t *xmsgReq ) {
+    struct epoll_event myEvent;
+    memset( &myEvent, 0, sizeof( myEvent ) );
+    myEvent.events = EPOLLIN | EPOLLONESHOT;
+    myEvent.data.ptr = xmsgReq;
+
+    int op = xmsgReq->conn->polled ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+    if ( epoll_ctl( XmsgPollFd, op, xmsgReq->sock, &myEvent ) < 0 ) {
+        rodsLog( LOG_ERROR, "parkXmsgReq: epoll_ctl error, errno = %d", errno );
+        return SYS_INTERNAL_ERR;
+    }
+    xmsgReq->conn->polled = 1;
+
+    return 0;
+}
+
+/* a worker serves one request of a connection and parks it again, so the
+ * number of open connections is not bound by NUM_XMSG_THR */
+
+void
+procReqRoutine() {
     while ( 1 ) {
         xmsgReq_t * myXmsgReq = getReqFromQue();
-        if ( myXmsgReq == NULL ) {
-            /* someone else took care of it */
+
+        if ( myXmsgReq->conn == NULL ) {
+            if ( startXmsgConn( myXmsgReq ) < 0 ) {
+                closeXmsgReq( myXmsgReq );
+                continue;
+            }
+        }
+        else if ( readAndProcClientMsg( &myXmsgReq->conn->rsComm, 0 ) < 0 ) {
+            closeXmsgReq( myXmsgReq );
             continue;
         }
 
-        rsComm_t rsComm;
-        memset( &rsComm, 0, sizeof( rsComm ) );
-        rsComm.sock = myXmsgReq->sock;
-
-        // =-=-=-=-=-=-=-
-        // manufacture a network object
-        irods::network_object_ptr net_obj;
-        irods::error ret = irods::network_factory( &rsComm, net_obj );
-        if ( !ret.ok() ) {
-            irods::log( PASS( ret ) );
+        if ( parkXmsgReq( myXmsgReq ) < 0 ) {
+            closeXmsgReq( myXmsgReq );
         }
+    }
+}
 
-        startupPack_t *startupPack;
-        ret = readStartupPack( net_obj, &startupPack, NULL );
-        if ( !ret.ok() ) {
-            rodsLog( LOG_ERROR,
-                     "procReqRoutine: readStartupPack error, status = %d", ret.code() );
-            free( myXmsgReq );
-            continue;
-        }
-        initRsCommWithStartupPack( &rsComm, startupPack );
-        free( startupPack );
+#else
+
+void
+procReqRoutine() {
+    struct timeval msgTimeout;
+    memset( &msgTimeout, 0, sizeof( msgTimeout ) );
+    msgTimeout.tv_sec = REQ_MSG_TIMEOUT_TIME;
+
+    while ( 1 ) {
+        xmsgReq_t * myXmsgReq = getReqFromQue();
 
-        ret = sendVersion( net_obj, 0, 0, NULL, 0 );
-        if ( !ret.ok() ) {
-            sendVersion( net_obj, SYS_AGENT_INIT_ERR, 0, NULL, 0 );
-            free( myXmsgReq );
+        if ( startXmsgConn( myXmsgReq ) < 0 ) {
+            closeXmsgReq( myXmsgReq );
             continue;
         }
+
+        rsComm_t *rsComm = &myXmsgReq->conn->rsComm;
         fd_set sockMask;
         FD_ZERO( &sockMask );
         while ( 1 ) {
             int numSock;
 
-            FD_SET( rsComm.sock, &sockMask );
-            while ( ( numSock = select( rsComm.sock + 1, &sockMask,
+            FD_SET( rsComm->sock, &sockMask );
+            while ( ( numSock = select( rsComm->sock + 1, &sockMask,
                                         ( fd_set * ) NULL, ( fd_set * ) NULL, &msgTimeout ) ) <= 0 ) {
                 if ( errno == EINTR ) {
                     rodsLog( LOG_NOTICE,
                              "procReqRoutine: select() interrupted" );
-                    FD_SET( rsComm.sock, &sockMask );
+                    FD_SET( rsComm->sock, &sockMask );
                     continue;
                 }
                 else {
@@ -541,15 +627,16 @@ procReqRoutine() {
             if ( numSock < 0 ) {
                 break;
             }
-            if ( readAndProcClientMsg( &rsComm, 0 ) < 0 ) {
+            if ( readAndProcClientMsg( rsComm, 0 ) < 0 ) {
                 break;
             }
         }
-        close( rsComm.sock );
-        free( myXmsgReq );
+        closeXmsgReq( myXmsgReq );
     }
 }
 
+#endif
+
 /* The hash function which use rcvTicket as the key. It take the modulo of
  * rcvTicket/NUM_HASH_SLOT
  */
@@ -560,6 +647,15 @@ ticketHashFunc( uint rcvTicket ) {
     return mySlot;
 }
 
+/* The lock of the hash slot holding rcvTicket. It is held across the lookup
+ * of the ticket and any use of its ticketMsgStruct_t and messages.
+ */
+
+boost::mutex&
+ticketHashSlotMutex( uint rcvTicket ) {
+    return XmsgHashSlotMutex[ticketHashFunc( rcvTicket )];
+}
+
 int
 initXmsgHashQue() {
 
@@ -568,7 +664,6 @@ initXmsgHashQue() {
     int hashSlotNum;
 
     memset( XmsgHashQue, 0, NUM_HASH_SLOT * sizeof( ticketHashQue_t ) );
-    memset( &XmsgQue, 0, sizeof( XmsgQue ) );
 
     /***  have a permanent message queue with ticket-id =1,2,3,4,5***/
 
@@ -668,7 +763,6 @@ _rsRcvXmsg( irodsXmsg_t *irodsXmsg, rcvXmsgOut_t *rcvXmsgOut ) {
     if ( irodsXmsg == NULL || rcvXmsgOut == NULL ) {
         rodsLog( LOG_ERROR,
                  "_rsRcvXmsg: input irodsXmsg or rcvXmsgOut is NULL" );
-        MessQueCondMutex.unlock();
         return SYS_INTERNAL_NULL_INPUT_ERR;
     }
 
@@ -693,7 +787,6 @@ _rsRcvXmsg( irodsXmsg_t *irodsXmsg, rcvXmsgOut_t *rcvXmsgOut ) {
                  NAME_LEN );
         rstrcpy( rcvXmsgOut->sendAddr, irodsXmsg->sendAddr,
                  NAME_LEN );
-        rmXmsgFromXmsgQue( irodsXmsg, &XmsgQue );
         rmXmsgFromXmsgTcketQue( irodsXmsg, &ticketMsgStruct->xmsgQue );
         clearSendXmsgInfo( sendXmsgInfo );
         free( sendXmsgInfo );
@@ -709,7 +802,6 @@ _rsRcvXmsg( irodsXmsg_t *irodsXmsg, rcvXmsgOut_t *rcvXmsgOut ) {
         rstrcpy( rcvXmsgOut->sendAddr, irodsXmsg->sendAddr,
                  NAME_LEN );
     }
-    MessQueCondMutex.unlock();
     return 0;
 }
 
@@ -722,7 +814,6 @@ clearOneXMessage( ticketMsgStruct_t *ticketMsgStruct, int seqNum ) {
     tmpIrodsXmsg = ticketMsgStruct->xmsgQue.head;
     while ( tmpIrodsXmsg != NULL ) {
         if ( ( int ) tmpIrodsXmsg->seqNumber == seqNum ) {
-            rmXmsgFromXmsgQue( tmpIrodsXmsg, &XmsgQue );
             rmXmsgFromXmsgTcketQue( tmpIrodsXmsg, &ticketMsgStruct->xmsgQue );
             clearSendXmsgInfo( tmpIrodsXmsg->sendXmsgInfo );
             free( tmpIrodsXmsg->sendXmsgInfo );
@@ -744,7 +835,6 @@ clearAllXMessages( ticketMsgStruct_t *ticketMsgStruct ) {
     tmpIrodsXmsg = ticketMsgStruct->xmsgQue.head;
     while ( tmpIrodsXmsg != NULL ) {
         tmpIrodsXmsg2 = tmpIrodsXmsg->tnext;
-        rmXmsgFromXmsgQue( tmpIrodsXmsg, &XmsgQue );
         clearSendXmsgInfo( tmpIrodsXmsg->sendXmsgInfo );
         free( tmpIrodsXmsg->sendXmsgInfo );
         free( tmpIrodsXmsg );
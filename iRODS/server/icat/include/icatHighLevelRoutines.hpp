@@ -35,6 +35,7 @@ int chlModDataObjMeta( rsComm_t *rsComm, dataObjInfo_t *dataObjInfo,
                        keyValPair_t *regParam );
 int chlUpdateRescObjCount( const std::string& _resc, int _delta );
 int chlRegDataObj( rsComm_t *rsComm, dataObjInfo_t *dataObjInfo );
+int chlRegDataObjBatch( rsComm_t *rsComm, dataObjInfo_t *dataObjInfoHead );
 int chlRegRuleExecObj( rsComm_t *rsComm,
                        ruleExecSubmitInp_t *ruleExecSubmitInp );
 int chlRegReplica( rsComm_t *rsComm, dataObjInfo_t *srcDataObjInfo,
@@ -67,6 +68,8 @@ int chlGeneralUpdate( generalUpdateInp_t generalUpdateInp );
 
 int chlDelCollByAdmin( rsComm_t *rsComm, collInfo_t *collInfo );
 int chlDelColl( rsComm_t *rsComm, collInfo_t *collInfo );
+int chlDelCollTreeBatch( rsComm_t *rsComm, collInfo_t *collInfo,
+                         int batchSize, dataObjInfo_t **removed );
 int chlCheckAuth( rsComm_t *rsComm, const char* scheme, const char *challenge, const char *response,
                   const char *username, int *userPrivLevel, int *clientPrivLevel );
 int chlMakeTempPw( rsComm_t *rsComm, const char *pwValueToHash, const char *otherUser );
@@ -132,6 +135,7 @@ int chlRegServerLoadDigest( rsComm_t *rsComm, const char *rescName, const char *
 int chlPurgeServerLoadDigest( rsComm_t *rsComm, const char *secondsAgo );
 
 int chlCalcUsageAndQuota( rsComm_t *rsComm );
+int chlReconcileQuotaUsage( rsComm_t *rsComm, int count );
 int chlSetQuota( rsComm_t *rsComm, const char *type, const char *name, const char *rescName,
                  const char *limit );
 int chlCheckQuota( rsComm_t *rsComm, const char *userName, const char *rescName,
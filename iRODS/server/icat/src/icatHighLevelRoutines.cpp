@@ -537,6 +537,62 @@ int chlRegDataObj(
 
 } // chlRegDataObj
 
+// =-=-=-=-=-=-=-
+// chlRegDataObjBatch - Register a batch of new iRODS files (data objects)
+// in one transaction
+// Input - rsComm_t *rsComm  - the server handle
+//         dataObjInfo_t *dataObjInfoHead - list of data objects linked
+//         through next.  The dataId of each is set on success.  As with
+//         chlRegDataObj, NO_COMMIT_FLAG in the head's flags leaves the
+//         commit to the caller.
+int chlRegDataObjBatch(
+    rsComm_t*      _comm,
+    dataObjInfo_t* _data_obj_info_head ) {
+    // =-=-=-=-=-=-=-
+    // call factory for database object
+    irods::database_object_ptr db_obj_ptr;
+    irods::error ret = irods::database_factory(
+                           database_plugin_type,
+                           db_obj_ptr );
+    if ( !ret.ok() ) {
+        irods::log( PASS( ret ) );
+        return ret.code();
+    }
+
+    // =-=-=-=-=-=-=-
+    // resolve a plugin for that object
+    irods::plugin_ptr db_plug_ptr;
+    ret = db_obj_ptr->resolve(
+              irods::DATABASE_INTERFACE,
+              db_plug_ptr );
+    if ( !ret.ok() ) {
+        irods::log(
+            PASSMSG(
+                "failed to resolve database interface",
+                ret ) );
+        return ret.code();
+    }
+
+    // =-=-=-=-=-=-=-
+    // cast plugin and object to db and fco for call
+    irods::first_class_object_ptr ptr = boost::dynamic_pointer_cast <
+                                        irods::first_class_object > ( db_obj_ptr );
+    irods::database_ptr           db = boost::dynamic_pointer_cast <
+                                       irods::database > ( db_plug_ptr );
+
+    // =-=-=-=-=-=-=-
+    // call the operation on the plugin
+    ret = db->call <
+          dataObjInfo_t* > (
+              _comm,
+              irods::DATABASE_OP_REG_DATA_OBJ_BATCH,
+              ptr,
+              _data_obj_info_head );
+
+    return ret.code();
+
+} // chlRegDataObjBatch
+
 // =-=-=-=-=-=-=-
 // chlRegReplica - Register a new iRODS replica file (data object)
 // Input - rsComm_t *rsComm  - the server handle
@@ -1886,6 +1942,71 @@ int chlDelColl(
 
 } // chlDelColl
 
+// =-=-=-=-=-=-=-
+// chlDelCollTreeBatch - Remove a batch of the data objects below a
+// collection, or once none is left, the collections below it.
+// Input - rsComm_t *rsComm  - the server handle
+//         collInfo_t *collInfo - the top collection, which is not removed.
+//         ADMIN_RMTRASH_KW in its condInput removes trash as admin.
+//         int batchSize - the most data objects removed by one call
+// Output - dataObjInfo_t **removed - the replicas removed, to be
+//         unlinked and freed by the caller.  Their removal is not
+//         committed: the caller calls chlCommit once the files are
+//         unlinked.  NULL once the collections have been removed.
+int chlDelCollTreeBatch(
+    rsComm_t*       _comm,
+    collInfo_t*     _coll_info,
+    int             _batch_size,
+    dataObjInfo_t** _removed ) {
+    // =-=-=-=-=-=-=-
+    // call factory for database object
+    irods::database_object_ptr db_obj_ptr;
+    irods::error ret = irods::database_factory(
+                           database_plugin_type,
+                           db_obj_ptr );
+    if ( !ret.ok() ) {
+        irods::log( PASS( ret ) );
+        return ret.code();
+    }
+
+    // =-=-=-=-=-=-=-
+    // resolve a plugin for that object
+    irods::plugin_ptr db_plug_ptr;
+    ret = db_obj_ptr->resolve(
+              irods::DATABASE_INTERFACE,
+              db_plug_ptr );
+    if ( !ret.ok() ) {
+        irods::log(
+            PASSMSG(
+                "failed to resolve database interface",
+                ret ) );
+        return ret.code();
+    }
+
+    // =-=-=-=-=-=-=-
+    // cast plugin and object to db and fco for call
+    irods::first_class_object_ptr ptr = boost::dynamic_pointer_cast <
+                                        irods::first_class_object > ( db_obj_ptr );
+    irods::database_ptr           db = boost::dynamic_pointer_cast <
+                                       irods::database > ( db_plug_ptr );
+
+    // =-=-=-=-=-=-=-
+    // call the operation on the plugin
+    ret = db->call <
+          collInfo_t*,
+          int,
+          dataObjInfo_t** > (
+              _comm,
+              irods::DATABASE_OP_DEL_COLL_TREE_BATCH,
+              ptr,
+              _coll_info,
+              _batch_size,
+              _removed );
+
+    return ret.code();
+
+} // chlDelCollTreeBatch
+
 /* Check an authentication response.
 
    Input is the challange, response, and username; the response is checked
@@ -3481,6 +3602,54 @@ int chlCalcUsageAndQuota(
 
 } // chlCalcUsageAndQuota
 
+int chlReconcileQuotaUsage(
+    rsComm_t* _comm,
+    int       _count ) {
+    // =-=-=-=-=-=-=-
+    // call factory for database object
+    irods::database_object_ptr db_obj_ptr;
+    irods::error ret = irods::database_factory(
+                           database_plugin_type,
+                           db_obj_ptr );
+    if ( !ret.ok() ) {
+        irods::log( PASS( ret ) );
+        return ret.code();
+    }
+
+    // =-=-=-=-=-=-=-
+    // resolve a plugin for that object
+    irods::plugin_ptr db_plug_ptr;
+    ret = db_obj_ptr->resolve(
+              irods::DATABASE_INTERFACE,
+              db_plug_ptr );
+    if ( !ret.ok() ) {
+        irods::log(
+            PASSMSG(
+                "failed to resolve database interface",
+                ret ) );
+        return ret.code();
+    }
+
+    // =-=-=-=-=-=-=-
+    // cast plugin and object to db and fco for call
+    irods::first_class_object_ptr ptr = boost::dynamic_pointer_cast <
+                                        irods::first_class_object > ( db_obj_ptr );
+    irods::database_ptr           db = boost::dynamic_pointer_cast <
+                                       irods::database > ( db_plug_ptr );
+
+    // =-=-=-=-=-=-=-
+    // call the operation on the plugin
+    ret = db->call <
+          int > (
+              _comm,
+              irods::DATABASE_OP_RECONCILE_QUOTA_USAGE,
+              ptr,
+              _count );
+
+    return ret.code();
+
+} // chlReconcileQuotaUsage
+
 int chlSetQuota(
     rsComm_t*   _comm,
     const char* _type,
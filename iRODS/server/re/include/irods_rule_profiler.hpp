@@ -0,0 +1,101 @@
+#ifndef IRODS_RULE_PROFILER_HPP
+#define IRODS_RULE_PROFILER_HPP
+
+#include "rodsType.h"
+#include "irods_error.hpp"
+
+#include <string>
+#include <vector>
+
+namespace irods {
+
+    /// =-=-=-=-=-=-=-
+    /// @brief default for rule_engine_profiling, zero disables the profiler
+    static const int DEFAULT_RULE_ENGINE_PROFILING = 0;
+
+    /// =-=-=-=-=-=-=-
+    /// @brief the totals of one rule or microservice
+    struct rule_profile_entry {
+        char        kind_;
+        std::string name_;
+        rodsULong_t calls_;
+        rodsULong_t inclusive_usec_;
+        rodsULong_t exclusive_usec_;
+        rodsULong_t region_bytes_;
+    };
+
+    /// =-=-=-=-=-=-=-
+    /// @brief times the rules and microservices run by the rule engine of
+    ///        this process.  each rule and microservice has its call count,
+    ///        its inclusive and exclusive wall time, and the region bytes
+    ///        allocated while it ran.  the time and bytes of a recursive
+    ///        call are counted once, by its outermost frame.
+    ///
+    ///        a process keeps its counts in memory and adds them to a shared
+    ///        memory table when its rule engine is finalized, so the table
+    ///        holds the totals of all the agents and rule engine server
+    ///        jobs of the host since the server started.  the table is
+    ///        reported by irods-grid rule_profile
+    class rule_profiler {
+        public:
+            enum kind_t {
+                RULE         = 'r',
+                MICROSERVICE = 'm'
+            };
+
+            /// =-=-=-=-=-=-=-
+            /// @brief true if rule_engine_profiling is set
+            static bool enabled();
+
+            /// =-=-=-=-=-=-=-
+            /// @brief open and close the frame of a call, see
+            ///        rule_profile_scope
+            static void enter( kind_t _kind, const char* _name );
+            static void leave();
+
+            /// =-=-=-=-=-=-=-
+            /// @brief add the counts of this process to the shared table
+            ///        and clear them
+            static void flush();
+
+            /// =-=-=-=-=-=-=-
+            /// @brief read the shared table, the largest exclusive time
+            ///        first
+            static error report( std::vector< rule_profile_entry >& _entries );
+
+            /// =-=-=-=-=-=-=-
+            /// @brief remove the shared table, when the server exits
+            static void remove();
+
+    }; // class rule_profiler
+
+    /// =-=-=-=-=-=-=-
+    /// @brief profiles the enclosing call when the profiler is enabled
+    class rule_profile_scope {
+        public:
+            rule_profile_scope(
+                rule_profiler::kind_t _kind,
+                const char*           _name ) :
+                active_( rule_profiler::enabled() ) {
+                if ( active_ ) {
+                    rule_profiler::enter( _kind, _name );
+                }
+            }
+
+            ~rule_profile_scope() {
+                if ( active_ ) {
+                    rule_profiler::leave();
+                }
+            }
+
+        private:
+            rule_profile_scope( const rule_profile_scope& );
+            rule_profile_scope& operator=( const rule_profile_scope& );
+
+            bool active_;
+
+    }; // class rule_profile_scope
+
+}; // namespace irods
+
+#endif // IRODS_RULE_PROFILER_HPP
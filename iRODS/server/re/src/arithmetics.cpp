@@ -14,6 +14,7 @@
 #include "reVariableMap.gen.hpp"
 #include "reVariableMap.hpp"
 #include "debug.hpp"
+#include "irods_rule_profiler.hpp"
 
 //    #include "irods_ms_plugin.hpp"
 //    extern irods::ms_table MicrosTable;
@@ -834,6 +835,7 @@ Res* execAction3( char *actionName, Res** args, unsigned int nargs, int applyAll
  * execute micro service msiName
  */
 Res* execMicroService3( char *msName, Res **args, unsigned int nargs, Node *node, Env *env, ruleExecInfo_t *rei, rError_t *errmsg, Region *r ) {
+    irods::rule_profile_scope profile( irods::rule_profiler::MICROSERVICE, msName );
     msParamArray_t *origMsParamArray = rei->msParamArray;
     funcPtr myFunc = NULL;
     int actionInx;
@@ -1273,6 +1275,7 @@ void copyFromEnv( Res **args, char **inParams, int inParamsCount, Hashtable *env
  * create a new environment and intialize it with parameters
  */
 Res* execRuleNodeRes( Node *rule, Res** args, unsigned int argc, int applyAll, Env *env, ruleExecInfo_t *rei, int reiSaveFlag, rError_t *errmsg, Region *r ) {
+    irods::rule_profile_scope profile( irods::rule_profiler::RULE, RULE_NAME( rule ) );
     int restoreGlobalREAuditFlag = 0;
     int globalREAuditFlag = 0;
     if ( GlobalREAuditFlag > 0 ) {
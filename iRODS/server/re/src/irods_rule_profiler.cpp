@@ -0,0 +1,370 @@
+#include "rodsDef.h"
+#include "rodsErrorTable.h"
+#include "rodsLog.h"
+#include "rodsConnect.h"
+#include "rcMisc.h"
+#include "region.h"
+#include "irods_log.hpp"
+#include "irods_rule_profiler.hpp"
+#include "irods_configuration_keywords.hpp"
+#include "irods_server_properties.hpp"
+
+#include <sys/time.h>
+#include <sched.h>
+#include <unistd.h>
+#include <string.h>
+#include <algorithm>
+
+#include <boost/unordered_map.hpp>
+#include <boost/interprocess/creation_tags.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+namespace bi = boost::interprocess;
+
+namespace irods {
+
+    /// =-=-=-=-=-=-=-
+    /// @brief the size of the shared table.  once it is full the calls
+    ///        of rules and microservices not yet in it are not shared
+    static const unsigned int RULE_PROFILE_SLOTS = 4096;
+
+    /// =-=-=-=-=-=-=-
+    /// @brief a slot claimed for longer than this many yields was left by
+    ///        a process which died while naming it, and is skipped
+    static const int RULE_PROFILE_CLAIM_SPINS = 1000;
+
+    /// =-=-=-=-=-=-=-
+    /// @brief a slot is claimed by the first process to flush its name,
+    ///        and is ready once the name is written.  the counts are
+    ///        updated atomically, so no lock is taken
+    enum {
+        RULE_PROFILE_SLOT_EMPTY = 0,
+        RULE_PROFILE_SLOT_CLAIMED,
+        RULE_PROFILE_SLOT_READY
+    };
+
+    struct rule_profile_slot {
+        volatile unsigned int state;
+        char                  kind;
+        char                  name[ NAME_LEN ];
+        volatile rodsULong_t  calls;
+        volatile rodsULong_t  inclusive_usec;
+        volatile rodsULong_t  exclusive_usec;
+        volatile rodsULong_t  region_bytes;
+    };
+
+    static const bi::offset_t RULE_PROFILE_SIZE =
+        sizeof( rule_profile_slot ) * RULE_PROFILE_SLOTS;
+
+    /// =-=-=-=-=-=-=-
+    /// @brief the counts of this process
+    struct local_entry {
+        rodsULong_t calls;
+        rodsULong_t inclusive_usec;
+        rodsULong_t exclusive_usec;
+        rodsULong_t region_bytes;
+        int         depth;
+    };
+
+    struct profile_frame {
+        local_entry* entry;
+        rodsULong_t  start;
+        size_t       region_bytes;
+        rodsULong_t  child_usec;
+    };
+
+    typedef boost::unordered_map< std::string, local_entry > local_table_t;
+
+    static int                          profiling    = -1;
+    static pid_t                        owner        = 0;
+    static local_table_t                local_table;
+    static std::vector< profile_frame > frames;
+    static bi::shared_memory_object*    table_obj    = NULL;
+    static bi::mapped_region*           table_region = NULL;
+
+    static rodsULong_t now_usec() {
+        struct timeval tv;
+        gettimeofday( &tv, NULL );
+        return ( rodsULong_t )tv.tv_sec * 1000000 + tv.tv_usec;
+
+    } // now_usec
+
+    /// =-=-=-=-=-=-=-
+    /// @brief a forked child starts with the counts of its parent, which
+    ///        the parent flushes itself
+    static void claim_local_table() {
+        pid_t pid = getpid();
+        if ( owner != pid ) {
+            local_table.clear();
+            frames.clear();
+            owner = pid;
+        }
+
+    } // claim_local_table
+
+    /// =-=-=-=-=-=-=-
+    /// @brief salted like the rule engine cache, so each server run has
+    ///        its own table
+    static error segment_name( std::string& _name ) {
+        std::string salt;
+        error ret = server_properties::getInstance().get_property< std::string >( RE_CACHE_SALT_KW, salt );
+        if ( !ret.ok() ) {
+            return PASS( ret );
+        }
+
+        _name = "irods_rule_profile_shared_memory_" + salt;
+        return SUCCESS();
+
+    } // segment_name
+
+    static rule_profile_slot* table_ptr() {
+        if ( !table_region ) {
+            std::string name;
+            error ret = segment_name( name );
+            if ( !ret.ok() ) {
+                irods::log( PASS( ret ) );
+                return NULL;
+            }
+
+            try {
+                table_obj = new bi::shared_memory_object( bi::open_or_create, name.c_str(), bi::read_write, 0600 );
+                bi::offset_t size = 0;
+                if ( table_obj->get_size( size ) && size == 0 ) {
+                    table_obj->truncate( RULE_PROFILE_SIZE );
+                }
+                table_region = new bi::mapped_region( *table_obj, bi::read_write );
+            }
+            catch ( const bi::interprocess_exception& e ) {
+                rodsLog( LOG_ERROR, "rule_profiler - failed to map [%s]. Exception caught [%s]",
+                         name.c_str(), e.what() );
+                delete table_obj;
+                table_obj = NULL;
+                return NULL;
+            }
+        }
+
+        return static_cast< rule_profile_slot* >( table_region->get_address() );
+
+    } // table_ptr
+
+    /// =-=-=-=-=-=-=-
+    /// @brief find the slot of a name, claiming an empty one if it is new
+    static rule_profile_slot* find_slot(
+        rule_profile_slot* _table,
+        char               _kind,
+        const char*        _name ) {
+        unsigned int hash = 2166136261u ^ ( unsigned char )_kind;
+        for ( const char* c = _name; *c; ++c ) {
+            hash = ( hash ^ ( unsigned char )*c ) * 16777619u;
+        }
+
+        unsigned int idx = hash % RULE_PROFILE_SLOTS;
+        int spins = 0;
+        for ( unsigned int probe = 0; probe < RULE_PROFILE_SLOTS; ) {
+            rule_profile_slot* slot = &_table[ idx ];
+            unsigned int state = slot->state;
+            if ( RULE_PROFILE_SLOT_EMPTY == state ) {
+                if ( __sync_bool_compare_and_swap(
+                            &slot->state,
+                            RULE_PROFILE_SLOT_EMPTY,
+                            RULE_PROFILE_SLOT_CLAIMED ) ) {
+                    slot->kind = _kind;
+                    snprintf( slot->name, sizeof( slot->name ), "%s", _name );
+                    __sync_synchronize();
+                    slot->state = RULE_PROFILE_SLOT_READY;
+                    return slot;
+                }
+                // =-=-=-=-=-=-=-
+                // another process claimed it first, look again
+                continue;
+            }
+
+            if ( RULE_PROFILE_SLOT_CLAIMED == state &&
+                    spins++ < RULE_PROFILE_CLAIM_SPINS ) {
+                sched_yield();
+                continue;
+            }
+
+            if ( RULE_PROFILE_SLOT_READY == state &&
+                    slot->kind == _kind &&
+                    strcmp( slot->name, _name ) == 0 ) {
+                return slot;
+            }
+
+            spins = 0;
+            idx = ( idx + 1 ) % RULE_PROFILE_SLOTS;
+            ++probe;
+        }
+
+        return NULL;
+
+    } // find_slot
+
+    bool rule_profiler::enabled() {
+        if ( profiling < 0 ) {
+            error ret = get_advanced_setting<int>(
+                            CFG_RULE_ENGINE_PROFILING,
+                            profiling );
+            if ( !ret.ok() ) {
+                if ( KEY_NOT_FOUND != ret.code() ) {
+                    irods::log( PASS( ret ) );
+                }
+                profiling = DEFAULT_RULE_ENGINE_PROFILING;
+            }
+        }
+
+        return profiling > 0;
+
+    } // enabled
+
+    void rule_profiler::enter(
+        kind_t      _kind,
+        const char* _name ) {
+        claim_local_table();
+
+        char key[ NAME_LEN + 1 ];
+        key[ 0 ] = ( char )_kind;
+        snprintf( key + 1, NAME_LEN, "%s", _name ? _name : "" );
+
+        profile_frame frame;
+        frame.entry        = &local_table[ key ];
+        frame.entry->depth++;
+        frame.child_usec   = 0;
+        frame.region_bytes = region_allocated_bytes();
+        frame.start        = now_usec();
+        frames.push_back( frame );
+
+    } // enter
+
+    void rule_profiler::leave() {
+        rodsULong_t now   = now_usec();
+        size_t      bytes = region_allocated_bytes();
+        if ( owner != getpid() || frames.empty() ) {
+            return;
+        }
+
+        profile_frame frame = frames.back();
+        frames.pop_back();
+
+        rodsULong_t elapsed = now > frame.start ? now - frame.start : 0;
+        local_entry* entry = frame.entry;
+        entry->calls++;
+        entry->exclusive_usec += elapsed > frame.child_usec ? elapsed - frame.child_usec : 0;
+        if ( --entry->depth == 0 ) {
+            entry->inclusive_usec += elapsed;
+            entry->region_bytes   += bytes - frame.region_bytes;
+        }
+
+        if ( !frames.empty() ) {
+            frames.back().child_usec += elapsed;
+        }
+
+    } // leave
+
+    void rule_profiler::flush() {
+        if ( profiling <= 0 || owner != getpid() || local_table.empty() ) {
+            return;
+        }
+
+        rule_profile_slot* table = table_ptr();
+        if ( !table ) {
+            return;
+        }
+
+        // =-=-=-=-=-=-=-
+        // the counts are zeroed rather than erased, an open frame may
+        // still point at its entry
+        int dropped = 0;
+        local_table_t::iterator itr;
+        for ( itr = local_table.begin(); itr != local_table.end(); ++itr ) {
+            local_entry& entry = itr->second;
+            if ( 0 == entry.calls ) {
+                continue;
+            }
+
+            rule_profile_slot* slot = find_slot(
+                                          table,
+                                          itr->first[ 0 ],
+                                          itr->first.c_str() + 1 );
+            if ( slot ) {
+                __sync_fetch_and_add( &slot->calls, entry.calls );
+                __sync_fetch_and_add( &slot->inclusive_usec, entry.inclusive_usec );
+                __sync_fetch_and_add( &slot->exclusive_usec, entry.exclusive_usec );
+                __sync_fetch_and_add( &slot->region_bytes, entry.region_bytes );
+            }
+            else {
+                dropped++;
+            }
+
+            entry.calls          = 0;
+            entry.inclusive_usec = 0;
+            entry.exclusive_usec = 0;
+            entry.region_bytes   = 0;
+        }
+
+        if ( dropped > 0 ) {
+            rodsLog( LOG_NOTICE, "rule_profiler - table is full, dropped %d entries", dropped );
+        }
+
+    } // flush
+
+    static bool by_exclusive_time(
+        const rule_profile_entry& _lhs,
+        const rule_profile_entry& _rhs ) {
+        return _lhs.exclusive_usec_ > _rhs.exclusive_usec_;
+
+    } // by_exclusive_time
+
+    error rule_profiler::report( std::vector< rule_profile_entry >& _entries ) {
+        std::string name;
+        error ret = segment_name( name );
+        if ( !ret.ok() ) {
+            return PASS( ret );
+        }
+
+        try {
+            bi::shared_memory_object shm( bi::open_only, name.c_str(), bi::read_only );
+            bi::mapped_region region( shm, bi::read_only );
+            if ( region.get_size() < ( size_t )RULE_PROFILE_SIZE ) {
+                return SUCCESS();
+            }
+
+            const rule_profile_slot* table =
+                static_cast< const rule_profile_slot* >( region.get_address() );
+            for ( unsigned int i = 0; i < RULE_PROFILE_SLOTS; ++i ) {
+                const rule_profile_slot& slot = table[ i ];
+                if ( RULE_PROFILE_SLOT_READY != slot.state ) {
+                    continue;
+                }
+
+                rule_profile_entry entry;
+                entry.kind_           = slot.kind;
+                entry.name_           = std::string( slot.name, strnlen( slot.name, NAME_LEN ) );
+                entry.calls_          = slot.calls;
+                entry.inclusive_usec_ = slot.inclusive_usec;
+                entry.exclusive_usec_ = slot.exclusive_usec;
+                entry.region_bytes_   = slot.region_bytes;
+                _entries.push_back( entry );
+            }
+        }
+        catch ( const bi::interprocess_exception& ) {
+            // =-=-=-=-=-=-=-
+            // nothing has been flushed yet
+            return SUCCESS();
+        }
+
+        std::sort( _entries.begin(), _entries.end(), by_exclusive_time );
+        return SUCCESS();
+
+    } // report
+
+    void rule_profiler::remove() {
+        std::string name;
+        if ( segment_name( name ).ok() ) {
+            bi::shared_memory_object::remove( name.c_str() );
+        }
+
+    } // remove
+
+}; // namespace irods
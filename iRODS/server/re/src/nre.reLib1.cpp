@@ -18,6 +18,7 @@
 
 #include "irods_log.hpp"
 #include "irods_get_full_path_for_config_file.hpp"
+#include "irods_rule_profiler.hpp"
 
 #ifdef MYMALLOC
 # Within reLib1.c here, change back the redefines of malloc back to normal
@@ -1553,6 +1554,7 @@ writeMSrvcsIntoFile( char * inFileName, msrvcStruct_t *myMsrvcStruct,
 
 int
 finalizeRuleEngine() {
+    irods::rule_profiler::flush();
     if ( GlobalREDebugFlag > 5 ) {
         _writeXMsg( GlobalREDebugFlag, "idbug", "PROCESS END" );
     }
@@ -6,6 +6,7 @@
 #include "icatHighLevelRoutines.hpp"
 #include "rs_set_round_robin_context.hpp"
 #include "irods_resource_manager.hpp"
+#include "irods_resource_cache.hpp"
 
 extern irods::resource_manager resc_mgr;
 
@@ -126,6 +127,13 @@ extern "C" {
 
         } // else
 
+        // =-=-=-=-=-=-=-
+        // the next agent on this host must see the new context rather
+        // than the shared copy of the resource table
+        if ( status >= 0 ) {
+            irods::resource_cache::invalidate();
+        }
+
         // =-=-=-=-=-=-=-
         // bad, bad things have happened.
         if ( status < 0 ) {
@@ -17,6 +17,7 @@
 #include "irods_native_auth_object.hpp"
 #include "irods_stacktrace.hpp"
 #include "irods_kvp_string_parser.hpp"
+#include "irods_auth_session_cache.hpp"
 
 // =-=-=-=-=-=-=-
 // stl includes
@@ -52,6 +53,122 @@ static irods::error check_proxy_user_privileges(
     return result;
 }
 
+/// =-=-=-=-=-=-=-
+/// @brief the session cache generation read before this agent checked
+///        its client, which a session it issues must still match.  reset
+///        by native_auth_agent_start for each new connection
+static bool         session_generation_set = false;
+static unsigned int session_generation     = 0;
+
+/// =-=-=-=-=-=-=-
+/// @brief the user of a session, who must be the client as well as the
+///        proxy, and whose catalog must be on this server so that a change
+///        to the user revokes the session
+static irods::error get_session_user(
+    rsComm_t*    _comm,
+    std::string& _user,
+    std::string& _zone ) {
+    if ( strcmp( _comm->proxyUser.userName, _comm->clientUser.userName ) != 0 ||
+            ( strlen( _comm->clientUser.rodsZone ) > 0 &&
+              strcmp( _comm->proxyUser.rodsZone, _comm->clientUser.rodsZone ) != 0 ) ) {
+        return ERROR( SYS_NOT_SUPPORTED, "sessions are not available to a proxy user" );
+    }
+
+    _user = _comm->proxyUser.userName;
+    _zone = _comm->proxyUser.rodsZone;
+    if ( _zone.empty() ) {
+        zoneInfo_t* zone_info = NULL;
+        int status = getLocalZoneInfo( &zone_info );
+        if ( status < 0 ) {
+            return ERROR( status, "getLocalZoneInfo failed." );
+        }
+        _zone = zone_info->zoneName;
+    }
+
+    rodsServerHost_t* rcat_host = NULL;
+    int status = getAndConnRcatHostNoLogin( _comm, MASTER_RCAT, ( char* )_zone.c_str(), &rcat_host );
+    if ( status < 0 ) {
+        return ERROR( status, "Connecting to rcat host failed." );
+    }
+    if ( rcat_host->localFlag != LOCAL_HOST ) {
+        return ERROR( SYS_NOT_SUPPORTED, "sessions are only kept by the catalog server" );
+    }
+
+    return SUCCESS();
+
+} // get_session_user
+
+/// =-=-=-=-=-=-=-
+/// @brief hand an authenticated connection a token to resume its session
+///        with on a later connection
+static irods::error native_auth_session_issue(
+    rsComm_t*    _comm,
+    std::string& _token ) {
+    if ( _comm->proxyUser.authInfo.authFlag < LOCAL_USER_AUTH ) {
+        return ERROR( CAT_INVALID_AUTHENTICATION, "connection is not authenticated" );
+    }
+
+    std::string user, zone;
+    irods::error ret = get_session_user( _comm, user, zone );
+    if ( !ret.ok() ) {
+        return PASS( ret );
+    }
+
+    if ( !session_generation_set ) {
+        return ERROR( CAT_INVALID_AUTHENTICATION, "connection was not authenticated by this plugin" );
+    }
+
+    ret = irods::auth_session_cache::issue( user, zone, _comm->proxyUser.authInfo.authFlag,
+                                            session_generation, _token );
+    if ( !ret.ok() ) {
+        return PASS( ret );
+    }
+
+    return SUCCESS();
+
+} // native_auth_session_issue
+
+/// =-=-=-=-=-=-=-
+/// @brief authenticate the connection with a session token instead of
+///        the challenge and response
+static irods::error native_auth_session_resume(
+    rsComm_t*          _comm,
+    const std::string& _token ) {
+    std::string user, zone;
+    irods::error ret = get_session_user( _comm, user, zone );
+    if ( !ret.ok() ) {
+        return PASS( ret );
+    }
+
+    int priv_level = NO_USER_AUTH;
+    unsigned int generation = irods::auth_session_cache::generation();
+    ret = irods::auth_session_cache::resume( _token, user, zone, priv_level );
+    if ( !ret.ok() ) {
+        return PASS( ret );
+    }
+
+    session_generation     = generation;
+    session_generation_set = true;
+
+    if ( strlen( _comm->clientUser.rodsZone ) == 0 ) {
+        strncpy( _comm->clientUser.rodsZone, zone.c_str(), NAME_LEN );
+    }
+
+    _comm->proxyUser.authInfo.authFlag =
+        _comm->clientUser.authInfo.authFlag = priv_level;
+
+    if ( _comm->auth_scheme != NULL ) {
+        free( _comm->auth_scheme );
+    }
+    _comm->auth_scheme = strdup( irods::AUTH_NATIVE_SCHEME.c_str() );
+
+    rodsLog( LOG_DEBUG, "native_auth_session_resume - resumed session of %s#%s with authFlag %d",
+             user.c_str(), zone.c_str(), priv_level );
+
+    return SUCCESS();
+
+} // native_auth_session_resume
+
 
 extern "C" {
 
@@ -270,15 +387,37 @@ extern "C" {
 
             if ( ( result = ASSERT_ERROR( _ctx.comm(), SYS_INVALID_INPUT_PARAM, "Null comm pointer." ) ).ok() ) {
 
+                // =-=-=-=-=-=-=-
+                // get the auth object
+                irods::native_auth_object_ptr ptr = boost::dynamic_pointer_cast<irods::native_auth_object >( _ctx.fco() );
+
+                // =-=-=-=-=-=-=-
+                // a request through rcAuthPluginRequest may carry a session
+                // to start or resume in place of a challenge
+                irods::kvp_map_t kvp;
+                if ( !ptr->context().empty() &&
+                        irods::parse_kvp_string( ptr->context(), kvp ).ok() &&
+                        kvp.end() != kvp.find( irods::AUTH_SESSION_KEY ) ) {
+                    std::string token;
+                    if ( irods::AUTH_SESSION_NEW == kvp[ irods::AUTH_SESSION_KEY ] ) {
+                        ret = native_auth_session_issue( _ctx.comm(), token );
+                    }
+                    else {
+                        ret = native_auth_session_resume( _ctx.comm(), kvp[ irods::AUTH_SESSION_KEY ] );
+                    }
+                    if ( !ret.ok() ) {
+                        return PASS( ret );
+                    }
+
+                    ptr->request_result( token );
+                    return SUCCESS();
+                }
+
                 // =-=-=-=-=-=-=-
                 // generate a random buffer and copy it to the challenge
                 char buf[ CHALLENGE_LEN + 2 ];
                 get64RandomBytes( buf );
 
-                // =-=-=-=-=-=-=-
-                // get the auth object
-                irods::native_auth_object_ptr ptr = boost::dynamic_pointer_cast<irods::native_auth_object >( _ctx.fco() );
-
                 // =-=-=-=-=-=-=-
                 // cache the challenge
                 ptr->request_result( buf );
@@ -383,6 +522,8 @@ extern "C" {
                     authCheckInp.username = _resp->username;
 
                     if ( rodsServerHost->localFlag == LOCAL_HOST ) {
+                        session_generation     = irods::auth_session_cache::generation();
+                        session_generation_set = true;
                         status = rsAuthCheck( _ctx.comm(), &authCheckInp, &authCheckOut );
                     }
                     else {
@@ -558,13 +699,19 @@ extern "C" {
 
 
     // =-=-=-=-=-=-=-
-    // stub for ops that the native plug does
-    // not need to support
-    irods::error native_auth_success_stub(
-        irods::auth_plugin_context& ) {
+    // called before each request.  until the connection is authenticated,
+    // forget the session generation, which a pooled agent would otherwise
+    // carry over from the client it served before
+    irods::error native_auth_agent_start(
+        irods::auth_plugin_context& _ctx,
+        const char* ) {
+        if ( _ctx.comm()->proxyUser.authInfo.authFlag < LOCAL_USER_AUTH ) {
+            session_generation_set = false;
+            session_generation     = 0;
+        }
         return SUCCESS();
 
-    } // native_auth_success_stub
+    } // native_auth_agent_start
 
     // =-=-=-=-=-=-=-
     // derive a new native_auth auth plugin from
@@ -600,7 +747,7 @@ extern "C" {
         // fill in the operation table mapping call
         // names to function names
         nat->add_operation( irods::AUTH_CLIENT_START,         "native_auth_client_start" );
-        nat->add_operation( irods::AUTH_AGENT_START,          "native_auth_success_stub" );
+        nat->add_operation( irods::AUTH_AGENT_START,          "native_auth_agent_start" );
         nat->add_operation( irods::AUTH_ESTABLISH_CONTEXT,    "native_auth_establish_context" );
         nat->add_operation( irods::AUTH_CLIENT_AUTH_REQUEST,  "native_auth_client_request" );
         nat->add_operation( irods::AUTH_AGENT_AUTH_REQUEST,   "native_auth_agent_request" );
@@ -19,6 +19,9 @@
 
 #define MAX_BIND_VARS 32000
 
+/* number of prepared statements cached per catalog connection */
+#define PREPARED_STMT_CACHE_SIZE 128
+
 extern int cllBindVarCount;
 extern const char *cllBindVars[MAX_BIND_VARS];
 
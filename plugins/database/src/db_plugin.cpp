@@ -44,6 +44,9 @@
 #include <string>
 #include <iostream>
 #include <vector>
+#include <map>
+#include <set>
+#include <algorithm>
 #include <boost/regex.hpp>
 
 extern int get64RandomBytes( char *buf );
@@ -77,6 +80,31 @@ static rodsLong_t MAX_PASSWORDS = 40;
 
 #define MAX_HOST_STR 2700
 
+/* Number of rows written by each multi-row insert in chlRegDataObjBatch.
+   Each R_DATA_MAIN row uses 18 bind variables.  Oracle does not support
+   the multi-row values syntax so it inserts one row per statement. */
+#ifdef ORA_ICAT
+#define REG_DATA_OBJ_ROWS_PER_INSERT 1
+#else
+#define REG_DATA_OBJ_ROWS_PER_INSERT 32
+#endif
+
+/* Number of data ids in each "in" list of chlDelCollTreeBatch */
+#define DEL_COLL_TREE_IDS_PER_STATEMENT 32
+
+/* A data object staged for insertion by chlRegDataObjBatch.  The strings
+   are bound directly through cllBindVars so must outlive the insert. */
+typedef struct {
+    dataObjInfo_t* info;
+    std::string    dataId;
+    std::string    collId;
+    std::string    dataName;
+    std::string    replNum;
+    std::string    dataSize;
+    std::string    replStatus;
+    int            inheritFlag;
+} regDataObjRow_t;
+
 // =-=-=-=-=-=-=-
 // local variables externed for config file setting in
 bool irods_pam_auth_no_extend = false;
@@ -315,6 +343,174 @@ _updateObjCountOfResources(
     return result;
 }
 
+// =-=-=-=-=-=-=-
+// @brief the owner, resource and size of a replica, as charged to R_QUOTA_USAGE
+struct quotaUsageRow {
+    std::string owner;
+    std::string zone;
+    std::string resc;
+    rodsLong_t  size;
+};
+
+// =-=-=-=-=-=-=-
+// @brief true if incremental_quota_usage is set in the advanced settings,
+//        read once per agent
+static bool
+_quotaUsageIsIncremental() {
+    static int incremental = -1;
+    if ( incremental < 0 ) {
+        irods::error ret = irods::get_advanced_setting<int>(
+                               irods::CFG_INCREMENTAL_QUOTA_USAGE,
+                               incremental );
+        if ( !ret.ok() ) {
+            if ( KEY_NOT_FOUND != ret.code() ) {
+                irods::log( PASS( ret ) );
+            }
+            incremental = 0;
+        }
+    }
+    return incremental > 0;
+}
+
+// =-=-=-=-=-=-=-
+// @brief Adds _delta bytes to the usage of the owner on the resource and to
+//        the over quota values of the quotas covering them, so that
+//        chlCheckQuota sees the change without a full chlCalcUsageAndQuota.
+//        modify_ts of the usage row is left alone; it records when the row
+//        was last reconciled against R_DATA_MAIN.
+static int
+_updateQuotaUsage(
+    const std::string& _owner,
+    const std::string& _zone,
+    const std::string& _resc,
+    rodsLong_t         _delta ) {
+    char deltaStr[MAX_NAME_LEN];
+    int status;
+
+    if ( _delta == 0 ) {
+        return 0;
+    }
+    snprintf( deltaStr, sizeof( deltaStr ), "%lld", _delta );
+
+    cllBindVars[cllBindVarCount++] = deltaStr;
+    cllBindVars[cllBindVarCount++] = _owner.c_str();
+    cllBindVars[cllBindVarCount++] = _zone.c_str();
+    cllBindVars[cllBindVarCount++] = _resc.c_str();
+    if ( logSQL != 0 ) {
+        rodsLog( LOG_SQL, "_updateQuotaUsage SQL 1" );
+    }
+    status = cmlExecuteNoAnswerSql(
+                 "update R_QUOTA_USAGE set quota_usage = quota_usage + ? where user_id = (select user_id from R_USER_MAIN where user_name=? and zone_name=?) and resc_id = (select resc_id from R_RESC_MAIN where resc_name=?)",
+                 &icss );
+    if ( status == CAT_SUCCESS_BUT_WITH_NO_INFO && _delta > 0 ) {
+        /* first usage of this resource by this user since the last full
+           calculation; the zero modify_ts makes it the first to be
+           reconciled */
+        cllBindVars[cllBindVarCount++] = deltaStr;
+        cllBindVars[cllBindVarCount++] = _resc.c_str();
+        cllBindVars[cllBindVarCount++] = _owner.c_str();
+        cllBindVars[cllBindVarCount++] = _zone.c_str();
+        if ( logSQL != 0 ) {
+            rodsLog( LOG_SQL, "_updateQuotaUsage SQL 2" );
+        }
+        status = cmlExecuteNoAnswerSql(
+                     "insert into R_QUOTA_USAGE (quota_usage, resc_id, user_id, modify_ts) (select ?, R_RESC_MAIN.resc_id, R_USER_MAIN.user_id, '0' from R_RESC_MAIN, R_USER_MAIN where R_RESC_MAIN.resc_name=? and R_USER_MAIN.user_name=? and R_USER_MAIN.zone_name=?)",
+                     &icss );
+    }
+    if ( status != 0 && status != CAT_SUCCESS_BUT_WITH_NO_INFO ) {
+        rodsLog( LOG_NOTICE, "_updateQuotaUsage usage update failure %d", status );
+        return status;
+    }
+
+    /* the per-user and per-group quotas, on this resource or in total,
+       all move by the same amount */
+    cllBindVars[cllBindVarCount++] = deltaStr;
+    cllBindVars[cllBindVarCount++] = _owner.c_str();
+    cllBindVars[cllBindVarCount++] = _zone.c_str();
+    cllBindVars[cllBindVarCount++] = _owner.c_str();
+    cllBindVars[cllBindVarCount++] = _zone.c_str();
+    cllBindVars[cllBindVarCount++] = _resc.c_str();
+    if ( logSQL != 0 ) {
+        rodsLog( LOG_SQL, "_updateQuotaUsage SQL 3" );
+    }
+    status = cmlExecuteNoAnswerSql(
+                 "update R_QUOTA_MAIN set quota_over = quota_over + ? where (user_id in (select user_id from R_USER_MAIN where user_name=? and zone_name=?) or user_id in (select UG.group_user_id from R_USER_GROUP UG, R_USER_MAIN UM where UG.user_id = UM.user_id and UM.user_name=? and UM.zone_name=?)) and (resc_id = '0' or resc_id in (select resc_id from R_RESC_MAIN where resc_name=?))",
+                 &icss );
+    if ( status == CAT_SUCCESS_BUT_WITH_NO_INFO ) {
+        status = 0;    /* no quotas apply */
+    }
+    if ( status != 0 ) {
+        rodsLog( LOG_NOTICE, "_updateQuotaUsage quota update failure %d", status );
+    }
+    return status;
+}
+
+// =-=-=-=-=-=-=-
+// @brief Reads the quota relevant columns of the R_DATA_MAIN rows matching
+//        _where.  Rows are collected before any update is made so the
+//        statement is not held open across them.
+static int
+_getQuotaUsageRows(
+    const std::string&          _where,
+    std::vector<std::string>&   _bindVars,
+    std::vector<quotaUsageRow>& _rows ) {
+    int statementNum = 0;
+    std::string sql( "select data_size, data_owner_name, data_owner_zone, resc_name from R_DATA_MAIN where " );
+    sql += _where;
+
+    if ( logSQL != 0 ) {
+        rodsLog( LOG_SQL, "_getQuotaUsageRows SQL 1" );
+    }
+    int status = cmlGetFirstRowFromSqlBV( sql.c_str(), _bindVars, &statementNum, &icss );
+    while ( status == 0 ) {
+        quotaUsageRow row;
+        row.size  = atoll( icss.stmtPtr[statementNum]->resultValue[0] );
+        row.owner = icss.stmtPtr[statementNum]->resultValue[1];
+        row.zone  = icss.stmtPtr[statementNum]->resultValue[2];
+        row.resc  = icss.stmtPtr[statementNum]->resultValue[3];
+        _rows.push_back( row );
+        status = cmlGetNextRowFromStatement( statementNum, &icss );
+    }
+    if ( status == CAT_NO_ROWS_FOUND ) {
+        status = 0;
+    }
+    return status;
+}
+
+// =-=-=-=-=-=-=-
+// @brief Charges (_sign > 0) or credits (_sign < 0) the sizes of _rows
+static int
+_applyQuotaUsageRows(
+    const std::vector<quotaUsageRow>& _rows,
+    int                               _sign ) {
+    int status = 0;
+    for ( size_t i = 0; status == 0 && i < _rows.size(); ++i ) {
+        status = _updateQuotaUsage( _rows[i].owner, _rows[i].zone,
+                                    _rows[i].resc, _sign * _rows[i].size );
+    }
+    return status;
+}
+
+// =-=-=-=-=-=-=-
+// @brief Charges or credits the replicas matching _where, if quota usage
+//        is kept incrementally
+static int
+_updateQuotaUsageOfReplicas(
+    const std::string&        _where,
+    std::vector<std::string>& _bindVars,
+    int                       _sign ) {
+    if ( !_quotaUsageIsIncremental() ) {
+        return 0;
+    }
+
+    std::vector<quotaUsageRow> rows;
+    int status = _getQuotaUsageRows( _where, _bindVars, rows );
+    if ( status == 0 ) {
+        status = _applyQuotaUsageRows( rows, _sign );
+    }
+    return status;
+}
+
 /*
  * removeMetaMapAndAVU - remove AVU (user defined metadata) for an object,
  *   the metadata mapping information, if any.  Optionally, also remove
@@ -2133,6 +2329,10 @@ extern "C" {
 
     // =-=-=-=-=-=-=-
     // close a database connection
+    // =-=-=-=-=-=-=-
+    // from general_query.cpp ::
+    void chl_gen_query_ticket_clear_impl();
+
     irods::error db_close_op(
         irods::plugin_context& _ctx ) {
         // =-=-=-=-=-=-=-
@@ -2165,6 +2365,13 @@ extern "C" {
                        "failed to close db connection" );
         }
 
+        // =-=-=-=-=-=-=-
+        // a session ticket ends with the connection, so that a pooled
+        // agent does not carry it over to its next client
+        mySessionTicket[0] = '\0';
+        mySessionClientAddr[0] = '\0';
+        chl_gen_query_ticket_clear_impl();
+
         // =-=-=-=-=-=-=-
         // set success flag
         icss.status = 0;
@@ -2691,6 +2898,35 @@ extern "C" {
             }
         }
 
+        // =-=-=-=-=-=-=-
+        // a change of size, resource or owner moves quota usage, read the
+        // replicas as they are before the update.  an overwrite comes in
+        // mode 1, which only changes the size of the replica written
+        std::vector<quotaUsageRow> quotaRows;
+        char* newDataSize  = getValByKey( _reg_param, DATA_SIZE_KW );
+        char* newRescName  = getValByKey( _reg_param, RESC_NAME_KW );
+        char* newOwner     = getValByKey( _reg_param, DATA_OWNER_KW );
+        char* newOwnerZone = getValByKey( _reg_param, DATA_OWNER_ZONE_KW );
+        bool updateQuota = _quotaUsageIsIncremental() &&
+                           ( newDataSize || newRescName || newOwner || newOwnerZone );
+        if ( updateQuota ) {
+            std::string where;
+            std::vector<std::string> bindVars;
+            for ( i = 0; i < numConditions; i++ ) {
+                if ( i > 0 ) {
+                    where += " and ";
+                }
+                where += whereColsAndConds[i];
+                where += "?";
+                bindVars.push_back( whereValues[i] );
+            }
+            status = _getQuotaUsageRows( where, bindVars, quotaRows );
+            if ( status != 0 ) {
+                _rollback( "chlModDataObjMeta" );
+                return ERROR( status, "_getQuotaUsageRows failed" );
+            }
+        }
+
         if ( mode == 0 ) {
             if ( logSQL != 0 ) {
                 rodsLog( LOG_SQL, "chlModDataObjMeta SQL 4" );
@@ -2763,6 +2999,42 @@ extern "C" {
                        "cmlModifySingleTable failure" );
         }
 
+        if ( updateQuota ) {
+            for ( size_t k = 0; status == 0 && k < quotaRows.size(); ++k ) {
+                quotaUsageRow newRow = quotaRows[k];
+                if ( newDataSize ) {
+                    newRow.size = atoll( newDataSize );
+                }
+                if ( newRescName ) {
+                    newRow.resc = newRescName;
+                }
+                if ( newOwner ) {
+                    newRow.owner = newOwner;
+                }
+                if ( newOwnerZone ) {
+                    newRow.zone = newOwnerZone;
+                }
+                if ( newRow.owner == quotaRows[k].owner &&
+                        newRow.zone == quotaRows[k].zone &&
+                        newRow.resc == quotaRows[k].resc ) {
+                    status = _updateQuotaUsage( newRow.owner, newRow.zone, newRow.resc,
+                                                newRow.size - quotaRows[k].size );
+                }
+                else {
+                    status = _updateQuotaUsage( quotaRows[k].owner, quotaRows[k].zone,
+                                                quotaRows[k].resc, -quotaRows[k].size );
+                    if ( status == 0 ) {
+                        status = _updateQuotaUsage( newRow.owner, newRow.zone, newRow.resc,
+                                                    newRow.size );
+                    }
+                }
+            }
+            if ( status != 0 ) {
+                _rollback( "chlModDataObjMeta" );
+                return ERROR( status, "_updateQuotaUsage failed" );
+            }
+        }
+
         if ( !( _data_obj_info->flags & NO_COMMIT_FLAG ) ) {
             status =  cmlExecuteNoAnswerSql( "commit", &icss );
             if ( status != 0 ) {
@@ -2953,6 +3225,17 @@ extern "C" {
             return ERROR( status, "_updateObjCountOfResources failed" );
         }
 
+        if ( _quotaUsageIsIncremental() ) {
+            status = _updateQuotaUsage( _ctx.comm()->clientUser.userName,
+                                        _ctx.comm()->clientUser.rodsZone,
+                                        _data_obj_info->rescName,
+                                        _data_obj_info->dataSize );
+            if ( status != 0 ) {
+                _rollback( "chlRegDataObj" );
+                return ERROR( status, "_updateQuotaUsage failed" );
+            }
+        }
+
         if ( inheritFlag ) {
             /* If inherit is set (sticky bit), then add access rows for this
                dataobject that match those of the parent collection */
@@ -3014,7 +3297,353 @@ extern "C" {
             status =  cmlExecuteNoAnswerSql( "commit", &icss );
             if ( status != 0 ) {
                 rodsLog( LOG_NOTICE,
-                         "chlRegDataObj cmlExecuteNoAnswerSql commit failure %d",
+                         "chlRegDataObj cmlExecuteNoAnswerSql commit failure %d",
+                         status );
+                return ERROR( status, "cmlExecuteNoAnswerSql commit failure" );
+            }
+        }
+
+        return SUCCESS();
+
+    } // db_reg_data_obj_op
+
+    // =-=-=-=-=-=-=-
+    // register a list of new data objects, linked through
+    // dataObjInfo_t::next, as a single transaction.  the collection
+    // lookup and permission check, the data type check, the owner lookup
+    // and the resource object counts are done once per batch rather than
+    // once per object, and R_DATA_MAIN and R_OBJT_ACCESS are written with
+    // multi-row inserts.
+    irods::error db_reg_data_obj_batch_op(
+        irods::plugin_context& _ctx,
+        dataObjInfo_t*         _data_obj_info ) {
+        // =-=-=-=-=-=-=-
+        // check the context
+        irods::error ret = _ctx.valid();
+        if ( !ret.ok() ) {
+            return PASS( ret );
+        }
+
+        // =-=-=-=-=-=-=-
+        // check the params
+        if ( !_data_obj_info ) {
+            return ERROR(
+                       CAT_INVALID_ARGUMENT,
+                       "null parameter" );
+        }
+
+        char myTime[50];
+        char logicalFileName[MAX_NAME_LEN];
+        char logicalDirName[MAX_NAME_LEN];
+        char data_expiry_ts[] = { "00000000000" };
+        char idNum[MAX_NAME_LEN];
+        rodsLong_t seqNum;
+        rodsLong_t iVal;
+        int status;
+
+        if ( logSQL != 0 ) {
+            rodsLog( LOG_SQL, "chlRegDataObjBatch" );
+        }
+        if ( !icss.status ) {
+            return ERROR( CATALOG_NOT_CONNECTED, "catalog not connected" );
+        }
+
+        rsComm_t* comm = _ctx.comm();
+        getNowStr( myTime );
+
+        // =-=-=-=-=-=-=-
+        // resolve each distinct collection and data type once, and
+        // allocate the object ids
+        std::vector< regDataObjRow_t >                         rows;
+        std::map< std::string, std::pair< rodsLong_t, int > > colls;
+        std::set< std::string >                               dataTypes;
+        std::map< std::string, int >                          rescCounts;
+        std::map< std::string, rodsLong_t >                   rescBytes;
+        for ( dataObjInfo_t* info = _data_obj_info; info; info = info->next ) {
+            status = splitPathByKey( info->objPath,
+                                     logicalDirName, MAX_NAME_LEN, logicalFileName, MAX_NAME_LEN, '/' );
+            if ( status < 0 ) {
+                return ERROR( status, info->objPath );
+            }
+
+            std::map< std::string, std::pair< rodsLong_t, int > >::iterator coll_itr =
+                colls.find( logicalDirName );
+            if ( coll_itr == colls.end() ) {
+                int inheritFlag = 0;
+                if ( logSQL != 0 ) {
+                    rodsLog( LOG_SQL, "chlRegDataObjBatch SQL 1 " );
+                }
+                iVal = cmlCheckDirAndGetInheritFlag( logicalDirName,
+                                                     comm->clientUser.userName,
+                                                     comm->clientUser.rodsZone,
+                                                     ACCESS_MODIFY_OBJECT,
+                                                     &inheritFlag,
+                                                     mySessionTicket,
+                                                     mySessionClientAddr,
+                                                     &icss );
+                if ( iVal < 0 ) {
+                    if ( iVal == CAT_UNKNOWN_COLLECTION ) {
+                        std::stringstream errMsg;
+                        errMsg << "collection '" << logicalDirName << "' is unknown";
+                        addRErrorMsg( &comm->rError, 0, errMsg.str().c_str() );
+                    }
+                    else if ( iVal == CAT_NO_ACCESS_PERMISSION ) {
+                        std::stringstream errMsg;
+                        errMsg << "no permission to update collection '" << logicalDirName << "'";
+                        addRErrorMsg( &comm->rError, 0, errMsg.str().c_str() );
+                    }
+                    return ERROR( iVal, "" );
+                }
+                coll_itr = colls.insert( std::make_pair(
+                                             std::string( logicalDirName ),
+                                             std::make_pair( iVal, inheritFlag ) ) ).first;
+            }
+
+            if ( dataTypes.find( info->dataType ) == dataTypes.end() ) {
+                if ( logSQL != 0 ) {
+                    rodsLog( LOG_SQL, "chlRegDataObjBatch SQL 2" );
+                }
+                status = cmlCheckNameToken( "data_type", info->dataType, &icss );
+                if ( status != 0 ) {
+                    return ERROR( CAT_INVALID_DATA_TYPE, "invalid data type" );
+                }
+                dataTypes.insert( info->dataType );
+            }
+
+            if ( logSQL != 0 ) {
+                rodsLog( LOG_SQL, "chlRegDataObjBatch SQL 3" );
+            }
+            seqNum = cmlGetNextSeqVal( &icss );
+            if ( seqNum < 0 ) {
+                rodsLog( LOG_NOTICE, "chlRegDataObjBatch cmlGetNextSeqVal failure %d",
+                         seqNum );
+                _rollback( "chlRegDataObjBatch" );
+                return ERROR( seqNum, "chlRegDataObjBatch cmlGetNextSeqVal failure" );
+            }
+            info->dataId = seqNum; /* store as output parameter */
+
+            regDataObjRow_t row;
+            row.info = info;
+            snprintf( idNum, MAX_NAME_LEN, "%lld", seqNum );
+            row.dataId = idNum;
+            snprintf( idNum, MAX_NAME_LEN, "%lld", coll_itr->second.first );
+            row.collId = idNum;
+            row.dataName = logicalFileName;
+            snprintf( idNum, MAX_NAME_LEN, "%d", info->replNum );
+            row.replNum = idNum;
+            snprintf( idNum, MAX_NAME_LEN, "%lld", info->dataSize );
+            row.dataSize = idNum;
+            snprintf( idNum, MAX_NAME_LEN, "%d", info->replStatus );
+            row.replStatus = idNum;
+            row.inheritFlag = coll_itr->second.second;
+            rows.push_back( row );
+
+            rescCounts[ info->rescHier ]++;
+            rescBytes[ info->rescName ] += info->dataSize;
+        }
+
+        // =-=-=-=-=-=-=-
+        // write the rows in groups, first making sure that no collection
+        // already exists by any of the names
+        for ( size_t first = 0; first < rows.size(); first += REG_DATA_OBJ_ROWS_PER_INSERT ) {
+            size_t last = std::min( rows.size(), first + REG_DATA_OBJ_ROWS_PER_INSERT );
+
+            std::vector<std::string> bindVars;
+            std::string collSql( "select coll_id from R_COLL_MAIN where coll_name in (" );
+            for ( size_t i = first; i < last; ++i ) {
+                collSql += ( i == first ) ? "?" : ", ?";
+                bindVars.push_back( rows[i].info->objPath );
+            }
+            collSql += ")";
+            if ( logSQL != 0 ) {
+                rodsLog( LOG_SQL, "chlRegDataObjBatch SQL 4" );
+            }
+            status = cmlGetIntegerValueFromSql( collSql.c_str(), &iVal, bindVars, &icss );
+            if ( status == 0 ) {
+                return ERROR( CAT_NAME_EXISTS_AS_COLLECTION, "collection exists" );
+            }
+
+            std::string insertSql( "insert into R_DATA_MAIN (data_id, coll_id, data_name, data_repl_num, data_version, data_type_name, data_size, resc_name, resc_hier, data_path, data_owner_name, data_owner_zone, data_is_dirty, data_checksum, data_mode, create_ts, modify_ts, data_expiry_ts) values " );
+            cllBindVarCount = 0;
+            for ( size_t i = first; i < last; ++i ) {
+                if ( i != first ) {
+                    insertSql += ", ";
+                }
+                insertSql += "(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
+                cllBindVars[cllBindVarCount++] = rows[i].dataId.c_str();
+                cllBindVars[cllBindVarCount++] = rows[i].collId.c_str();
+                cllBindVars[cllBindVarCount++] = rows[i].dataName.c_str();
+                cllBindVars[cllBindVarCount++] = rows[i].replNum.c_str();
+                cllBindVars[cllBindVarCount++] = rows[i].info->version;
+                cllBindVars[cllBindVarCount++] = rows[i].info->dataType;
+                cllBindVars[cllBindVarCount++] = rows[i].dataSize.c_str();
+                cllBindVars[cllBindVarCount++] = rows[i].info->rescName;
+                cllBindVars[cllBindVarCount++] = rows[i].info->rescHier;
+                cllBindVars[cllBindVarCount++] = rows[i].info->filePath;
+                cllBindVars[cllBindVarCount++] = comm->clientUser.userName;
+                cllBindVars[cllBindVarCount++] = comm->clientUser.rodsZone;
+                cllBindVars[cllBindVarCount++] = rows[i].replStatus.c_str();
+                cllBindVars[cllBindVarCount++] = rows[i].info->chksum;
+                cllBindVars[cllBindVarCount++] = rows[i].info->dataMode;
+                cllBindVars[cllBindVarCount++] = myTime;
+                cllBindVars[cllBindVarCount++] = myTime;
+                cllBindVars[cllBindVarCount++] = data_expiry_ts;
+            }
+            if ( logSQL != 0 ) {
+                rodsLog( LOG_SQL, "chlRegDataObjBatch SQL 5" );
+            }
+            status = cmlExecuteNoAnswerSql( insertSql.c_str(), &icss );
+            if ( status != 0 ) {
+                rodsLog( LOG_NOTICE,
+                         "chlRegDataObjBatch cmlExecuteNoAnswerSql failure %d", status );
+                _rollback( "chlRegDataObjBatch" );
+                return ERROR( status, "chlRegDataObjBatch cmlExecuteNoAnswerSql failure" );
+            }
+        }
+
+        // =-=-=-=-=-=-=-
+        // one object count update per resource hierarchy
+        std::string zone;
+        ret = getLocalZone(
+                  _ctx.prop_map(),
+                  &icss,
+                  zone );
+        if ( !ret.ok() ) {
+            rodsLog( LOG_ERROR, "chlRegDataObjBatch - failed in getLocalZone" );
+            return PASS( ret );
+        }
+
+        for ( std::map< std::string, int >::iterator itr = rescCounts.begin();
+                itr != rescCounts.end(); ++itr ) {
+            if ( ( status = _updateObjCountOfResources( &icss, itr->first, zone.c_str(), itr->second ) ) != 0 ) {
+                return ERROR( status, "_updateObjCountOfResources failed" );
+            }
+        }
+
+        // =-=-=-=-=-=-=-
+        // and one quota usage update per resource, all owned by the client
+        if ( _quotaUsageIsIncremental() ) {
+            for ( std::map< std::string, rodsLong_t >::iterator itr = rescBytes.begin();
+                    itr != rescBytes.end(); ++itr ) {
+                status = _updateQuotaUsage( comm->clientUser.userName,
+                                            comm->clientUser.rodsZone,
+                                            itr->first, itr->second );
+                if ( status != 0 ) {
+                    _rollback( "chlRegDataObjBatch" );
+                    return ERROR( status, "_updateQuotaUsage failed" );
+                }
+            }
+        }
+
+        // =-=-=-=-=-=-=-
+        // objects in collections with the inherit (sticky) bit get the
+        // access rows of their collection, the rest are owned by the client
+        std::vector< size_t > ownedRows;
+        for ( size_t i = 0; i < rows.size(); ++i ) {
+            if ( !rows[i].inheritFlag ) {
+                ownedRows.push_back( i );
+                continue;
+            }
+
+            cllBindVars[0] = rows[i].dataId.c_str();
+            cllBindVars[1] = myTime;
+            cllBindVars[2] = myTime;
+            cllBindVars[3] = rows[i].collId.c_str();
+            cllBindVarCount = 4;
+            if ( logSQL != 0 ) {
+                rodsLog( LOG_SQL, "chlRegDataObjBatch SQL 6" );
+            }
+            status =  cmlExecuteNoAnswerSql(
+                          "insert into R_OBJT_ACCESS (object_id, user_id, access_type_id, create_ts, modify_ts) (select ?, user_id, access_type_id, ?, ? from R_OBJT_ACCESS where object_id = ?)",
+                          &icss );
+            if ( status != 0 ) {
+                rodsLog( LOG_NOTICE,
+                         "chlRegDataObjBatch cmlExecuteNoAnswerSql insert access failure %d",
+                         status );
+                _rollback( "chlRegDataObjBatch" );
+                return ERROR( status, "cmlExecuteNoAnswerSql insert access failure" );
+            }
+        }
+
+        if ( !ownedRows.empty() ) {
+            char userIdNum[MAX_NAME_LEN];
+            char accessIdNum[MAX_NAME_LEN];
+            std::vector<std::string> bindVars;
+            bindVars.push_back( comm->clientUser.userName );
+            bindVars.push_back( comm->clientUser.rodsZone );
+            if ( logSQL != 0 ) {
+                rodsLog( LOG_SQL, "chlRegDataObjBatch SQL 7" );
+            }
+            status = cmlGetIntegerValueFromSql(
+                         "select user_id from R_USER_MAIN where user_name=? and zone_name=?",
+                         &iVal, bindVars, &icss );
+            if ( status != 0 ) {
+                _rollback( "chlRegDataObjBatch" );
+                return ERROR( status, "failed to get the user id" );
+            }
+            snprintf( userIdNum, MAX_NAME_LEN, "%lld", iVal );
+
+            bindVars.clear();
+            bindVars.push_back( ACCESS_OWN );
+            if ( logSQL != 0 ) {
+                rodsLog( LOG_SQL, "chlRegDataObjBatch SQL 8" );
+            }
+            status = cmlGetIntegerValueFromSql(
+                         "select token_id from R_TOKN_MAIN where token_namespace = 'access_type' and token_name = ?",
+                         &iVal, bindVars, &icss );
+            if ( status != 0 ) {
+                _rollback( "chlRegDataObjBatch" );
+                return ERROR( status, "failed to get the access type id" );
+            }
+            snprintf( accessIdNum, MAX_NAME_LEN, "%lld", iVal );
+
+            for ( size_t first = 0; first < ownedRows.size(); first += REG_DATA_OBJ_ROWS_PER_INSERT ) {
+                size_t last = std::min( ownedRows.size(), first + REG_DATA_OBJ_ROWS_PER_INSERT );
+                std::string accessSql( "insert into R_OBJT_ACCESS (object_id, user_id, access_type_id, create_ts, modify_ts) values " );
+                cllBindVarCount = 0;
+                for ( size_t i = first; i < last; ++i ) {
+                    if ( i != first ) {
+                        accessSql += ", ";
+                    }
+                    accessSql += "(?, ?, ?, ?, ?)";
+                    cllBindVars[cllBindVarCount++] = rows[ ownedRows[i] ].dataId.c_str();
+                    cllBindVars[cllBindVarCount++] = userIdNum;
+                    cllBindVars[cllBindVarCount++] = accessIdNum;
+                    cllBindVars[cllBindVarCount++] = myTime;
+                    cllBindVars[cllBindVarCount++] = myTime;
+                }
+                if ( logSQL != 0 ) {
+                    rodsLog( LOG_SQL, "chlRegDataObjBatch SQL 9" );
+                }
+                status = cmlExecuteNoAnswerSql( accessSql.c_str(), &icss );
+                if ( status != 0 ) {
+                    rodsLog( LOG_NOTICE,
+                             "chlRegDataObjBatch cmlExecuteNoAnswerSql insert access failure %d",
+                             status );
+                    _rollback( "chlRegDataObjBatch" );
+                    return ERROR( status, "cmlExecuteNoAnswerSql insert access failure" );
+                }
+            }
+        }
+
+        for ( size_t i = 0; i < rows.size(); ++i ) {
+            status = cmlAudit3( AU_REGISTER_DATA_OBJ, rows[i].dataId.c_str(),
+                                comm->clientUser.userName,
+                                comm->clientUser.rodsZone, "", &icss );
+            if ( status != 0 ) {
+                rodsLog( LOG_NOTICE,
+                         "chlRegDataObjBatch cmlAudit3 failure %d",
+                         status );
+                _rollback( "chlRegDataObjBatch" );
+                return ERROR( status, "cmlAudit3 failure" );
+            }
+        }
+
+        if ( !( _data_obj_info->flags & NO_COMMIT_FLAG ) ) {
+            status =  cmlExecuteNoAnswerSql( "commit", &icss );
+            if ( status != 0 ) {
+                rodsLog( LOG_NOTICE,
+                         "chlRegDataObjBatch cmlExecuteNoAnswerSql commit failure %d",
                          status );
                 return ERROR( status, "cmlExecuteNoAnswerSql commit failure" );
             }
@@ -3022,7 +3651,7 @@ extern "C" {
 
         return SUCCESS();
 
-    } // db_reg_data_obj_op
+    } // db_reg_data_obj_batch_op
 
 
     // =-=-=-=-=-=-=-
@@ -3228,6 +3857,17 @@ extern "C" {
             return ERROR( status, "_updateObjCountOfResources failed" );
         }
 
+        {
+            std::vector<std::string> bindVars;
+            bindVars.push_back( objIdString );
+            bindVars.push_back( nextRepl );
+            status = _updateQuotaUsageOfReplicas( "data_id=? and data_repl_num=?", bindVars, 1 );
+        }
+        if ( status != 0 ) {
+            _rollback( "chlRegReplica" );
+            return ERROR( status, "_updateQuotaUsageOfReplicas failed" );
+        }
+
         status = cmlFreeStatement( statementNumber, &icss );
         if ( status < 0 ) {
             rodsLog( LOG_NOTICE, "chlRegReplica cmlFreeStatement failure %d", status );
@@ -3440,6 +4080,24 @@ extern "C" {
             resc_hier = std::string( _data_obj_info->rescHier );
         }
 
+        /* credit the quota usage of the replicas about to be removed */
+        {
+            std::vector<std::string> bindVars;
+            bindVars.push_back( logicalDirName );
+            bindVars.push_back( logicalFileName );
+            std::string where( "coll_id=(select coll_id from R_COLL_MAIN where coll_name=?) and data_name=?" );
+            if ( _data_obj_info->replNum >= 0 ) {
+                snprintf( replNumber, sizeof replNumber, "%d", _data_obj_info->replNum );
+                bindVars.push_back( replNumber );
+                where += " and data_repl_num=?";
+            }
+            int quota_status = _updateQuotaUsageOfReplicas( where, bindVars, -1 );
+            if ( quota_status != 0 ) {
+                _rollback( "chlUnregDataObj" );
+                return ERROR( quota_status, "_updateQuotaUsageOfReplicas failed" );
+            }
+        }
+
         cllBindVars[0] = logicalDirName;
         cllBindVars[1] = logicalFileName;
         if ( _data_obj_info->replNum >= 0 ) {
@@ -6828,6 +7486,328 @@ extern "C" {
 
     } // db_del_coll_op
 
+    // =-=-=-=-=-=-=-
+    // remove up to _batch_size data objects below a collection, all
+    // replicas of each, in one transaction.  the removed replicas are
+    // returned in _removed and the transaction is left open, so that the
+    // caller can unlink their files and then commit, or roll back.  once
+    // no data object is left the collections below _coll_info, but not
+    // _coll_info itself, are removed and committed and _removed is left
+    // NULL.
+    //
+    // only objects the client may delete, and which are not bundles, are
+    // taken, so anything left over can be handled one object at a time
+    // by the caller.  the per object delete rules are not run.
+    irods::error db_del_coll_tree_batch_op(
+        irods::plugin_context& _ctx,
+        collInfo_t*            _coll_info,
+        int                    _batch_size,
+        dataObjInfo_t**        _removed ) {
+        // =-=-=-=-=-=-=-
+        // check the context
+        irods::error ret = _ctx.valid();
+        if ( !ret.ok() ) {
+            return PASS( ret );
+        }
+
+        // =-=-=-=-=-=-=-
+        // check the params
+        if ( !_coll_info || !_removed || _batch_size <= 0 ) {
+            return ERROR(
+                       CAT_INVALID_ARGUMENT,
+                       "null parameter" );
+        }
+        *_removed = NULL;
+
+        rodsLong_t iVal;
+        int statementNum = 0;
+        int status;
+
+        if ( logSQL != 0 ) {
+            rodsLog( LOG_SQL, "chlDelCollTreeBatch" );
+        }
+        if ( !icss.status ) {
+            return ERROR( CATALOG_NOT_CONNECTED, "catalog not connected" );
+        }
+
+        rsComm_t* comm = _ctx.comm();
+        std::string zone;
+        ret = getLocalZone( _ctx.prop_map(), &icss, zone );
+        if ( !ret.ok() ) {
+            return PASS( ret );
+        }
+
+        bool adminMode = getValByKey( &_coll_info->condInput, ADMIN_RMTRASH_KW ) != NULL;
+        if ( adminMode ) {
+            if ( comm->clientUser.authInfo.authFlag < LOCAL_PRIV_USER_AUTH ||
+                    comm->proxyUser.authInfo.authFlag < LOCAL_PRIV_USER_AUTH ) {
+                return ERROR( CAT_INSUFFICIENT_PRIVILEGE_LEVEL, "insufficient privilege" );
+            }
+            std::string trash = "/" + zone + "/trash";
+            if ( strncmp( trash.c_str(), _coll_info->collName, trash.size() ) != 0 ) {
+                addRErrorMsg( &comm->rError, 0, "TRASH_KW but not zone/trash path" );
+                return ERROR( CAT_INVALID_ARGUMENT, "TRASH_KW but not zone/trash path" );
+            }
+        }
+
+        std::string pathStart = makeEscapedPath( _coll_info->collName ) + "/%";
+        std::string bundleType = std::string( "%" ) + BUNDLE_STR + "%";
+
+        // =-=-=-=-=-=-=-
+        // the ids of the next batch
+        std::vector<std::string> bindVars;
+        bindVars.push_back( _coll_info->collName );
+        bindVars.push_back( pathStart );
+        bindVars.push_back( bundleType );
+        std::string idSql( "select distinct DM.data_id from R_DATA_MAIN DM, R_COLL_MAIN CM where DM.coll_id=CM.coll_id and (CM.coll_name=? or CM.coll_name like ?) and DM.data_type_name not like ?" );
+        if ( !adminMode ) {
+            idSql += " and exists (select OA.object_id from R_OBJT_ACCESS OA, R_USER_GROUP UG, R_USER_MAIN UM, R_TOKN_MAIN TM where OA.object_id=DM.data_id and UM.user_name=? and UM.zone_name=? and UM.user_type_name!='rodsgroup' and UM.user_id = UG.user_id and UG.group_user_id = OA.user_id and OA.access_type_id >= TM.token_id and TM.token_namespace ='access_type' and TM.token_name = ?)";
+            bindVars.push_back( comm->clientUser.userName );
+            bindVars.push_back( comm->clientUser.rodsZone );
+            bindVars.push_back( ACCESS_DELETE_OBJECT );
+        }
+
+        std::vector<std::string> ids;
+        if ( logSQL != 0 ) {
+            rodsLog( LOG_SQL, "chlDelCollTreeBatch SQL 1" );
+        }
+        status = cmlGetFirstRowFromSqlBV( idSql.c_str(), bindVars, &statementNum, &icss );
+        while ( status == 0 ) {
+            ids.push_back( icss.stmtPtr[statementNum]->resultValue[0] );
+            if ( ( int )ids.size() >= _batch_size ) {
+                cmlFreeStatement( statementNum, &icss );
+                break;
+            }
+            status = cmlGetNextRowFromStatement( statementNum, &icss );
+        }
+        if ( status != 0 && status != CAT_NO_ROWS_FOUND ) {
+            return ERROR( status, "failed to select the data objects" );
+        }
+
+        if ( !ids.empty() ) {
+            dataObjInfo_t* head = NULL;
+            dataObjInfo_t* tail = NULL;
+            std::map< std::string, int > rescCounts;
+            for ( size_t first = 0; first < ids.size(); first += DEL_COLL_TREE_IDS_PER_STATEMENT ) {
+                size_t last = std::min( ids.size(), first + DEL_COLL_TREE_IDS_PER_STATEMENT );
+                std::string inList;
+                std::vector<std::string> idVars;
+                for ( size_t i = first; i < last; ++i ) {
+                    inList += ( i == first ) ? "?" : ", ?";
+                    idVars.push_back( ids[i] );
+                }
+
+                // =-=-=-=-=-=-=-
+                // read the replicas before they are gone
+                std::string rowSql( "select DM.data_id, DM.data_repl_num, DM.data_path, DM.resc_name, DM.resc_hier, DM.data_size, DM.data_type_name, CM.coll_name, DM.data_name from R_DATA_MAIN DM, R_COLL_MAIN CM where DM.coll_id=CM.coll_id and DM.data_id in (" );
+                rowSql += inList + ")";
+                if ( logSQL != 0 ) {
+                    rodsLog( LOG_SQL, "chlDelCollTreeBatch SQL 2" );
+                }
+                status = cmlGetFirstRowFromSqlBV( rowSql.c_str(), idVars, &statementNum, &icss );
+                while ( status == 0 ) {
+                    char** vals = icss.stmtPtr[statementNum]->resultValue;
+                    dataObjInfo_t* info = ( dataObjInfo_t* )malloc( sizeof( dataObjInfo_t ) );
+                    memset( info, 0, sizeof( dataObjInfo_t ) );
+                    info->dataId   = strtoll( vals[0], 0, 0 );
+                    info->replNum  = atoi( vals[1] );
+                    rstrcpy( info->filePath, vals[2], MAX_NAME_LEN );
+                    rstrcpy( info->rescName, vals[3], NAME_LEN );
+                    rstrcpy( info->rescHier, vals[4], MAX_NAME_LEN );
+                    info->dataSize = strtoll( vals[5], 0, 0 );
+                    rstrcpy( info->dataType, vals[6], NAME_LEN );
+                    snprintf( info->objPath, MAX_NAME_LEN, "%s/%s", vals[7], vals[8] );
+                    if ( tail ) {
+                        tail->next = info;
+                    }
+                    else {
+                        head = info;
+                    }
+                    tail = info;
+                    rescCounts[ info->rescHier ]++;
+                    status = cmlGetNextRowFromStatement( statementNum, &icss );
+                }
+                if ( status != CAT_NO_ROWS_FOUND ) {
+                    freeAllDataObjInfo( head );
+                    return ERROR( status, "failed to read the replicas" );
+                }
+
+                std::vector<std::string> quotaVars( idVars );
+                status = _updateQuotaUsageOfReplicas( "data_id in (" + inList + ")", quotaVars, -1 );
+                if ( status != 0 ) {
+                    _rollback( "chlDelCollTreeBatch" );
+                    freeAllDataObjInfo( head );
+                    return ERROR( status, "_updateQuotaUsageOfReplicas failed" );
+                }
+
+                const char* deletes[] = {
+                    "delete from R_DATA_MAIN where data_id in (",
+                    "delete from R_OBJT_ACCESS where object_id in (",
+                    "delete from R_OBJT_METAMAP where object_id in ("
+                };
+                for ( size_t d = 0; d < sizeof( deletes ) / sizeof( deletes[0] ); ++d ) {
+                    std::string delSql( deletes[d] );
+                    delSql += inList + ")";
+                    cllBindVarCount = 0;
+                    for ( size_t i = 0; i < idVars.size(); ++i ) {
+                        cllBindVars[cllBindVarCount++] = idVars[i].c_str();
+                    }
+                    if ( logSQL != 0 ) {
+                        rodsLog( LOG_SQL, "chlDelCollTreeBatch SQL 3" );
+                    }
+                    status = cmlExecuteNoAnswerSql( delSql.c_str(), &icss );
+                    if ( status != 0 && status != CAT_SUCCESS_BUT_WITH_NO_INFO ) {
+                        rodsLog( LOG_NOTICE,
+                                 "chlDelCollTreeBatch cmlExecuteNoAnswerSql delete failure %d",
+                                 status );
+                        _rollback( "chlDelCollTreeBatch" );
+                        freeAllDataObjInfo( head );
+                        return ERROR( status, "cmlExecuteNoAnswerSql delete failure" );
+                    }
+                }
+            }
+
+            for ( std::map< std::string, int >::iterator itr = rescCounts.begin();
+                    itr != rescCounts.end(); ++itr ) {
+                if ( ( status = _updateObjCountOfResources( &icss, itr->first, zone.c_str(), -itr->second ) ) != 0 ) {
+                    _rollback( "chlDelCollTreeBatch" );
+                    freeAllDataObjInfo( head );
+                    return ERROR( status, "_updateObjCountOfResources failed" );
+                }
+            }
+
+            for ( size_t i = 0; i < ids.size(); ++i ) {
+                status = cmlAudit3( AU_UNREGISTER_DATA_OBJ, ids[i].c_str(),
+                                    comm->clientUser.userName,
+                                    comm->clientUser.rodsZone, "", &icss );
+                if ( status != 0 ) {
+                    rodsLog( LOG_NOTICE,
+                             "chlDelCollTreeBatch cmlAudit3 failure %d",
+                             status );
+                    _rollback( "chlDelCollTreeBatch" );
+                    freeAllDataObjInfo( head );
+                    return ERROR( status, "cmlAudit3 failure" );
+                }
+            }
+
+            *_removed = head;
+            return SUCCESS();
+        }
+
+        // =-=-=-=-=-=-=-
+        // no data object is left that this call may remove.  the
+        // collections go only if nothing at all is left, none is special
+        // and the client may delete each of them
+        if ( logSQL != 0 ) {
+            rodsLog( LOG_SQL, "chlDelCollTreeBatch SQL 4" );
+        }
+        bindVars.clear();
+        bindVars.push_back( _coll_info->collName );
+        bindVars.push_back( pathStart );
+        status = cmlGetIntegerValueFromSql(
+                     "select DM.data_id from R_DATA_MAIN DM, R_COLL_MAIN CM where DM.coll_id=CM.coll_id and (CM.coll_name=? or CM.coll_name like ?)",
+                     &iVal, bindVars, &icss );
+        if ( status != CAT_NO_ROWS_FOUND ) {
+            return ERROR( status == 0 ? CAT_COLLECTION_NOT_EMPTY : status, "data objects are left" );
+        }
+
+        if ( logSQL != 0 ) {
+            rodsLog( LOG_SQL, "chlDelCollTreeBatch SQL 5" );
+        }
+        bindVars.clear();
+        bindVars.push_back( pathStart );
+        status = cmlGetIntegerValueFromSql(
+                     "select coll_id from R_COLL_MAIN where coll_name like ? and length(coll_type) > 0",
+                     &iVal, bindVars, &icss );
+        if ( status != CAT_NO_ROWS_FOUND ) {
+            return ERROR( status == 0 ? CAT_COLLECTION_NOT_EMPTY : status, "special collections are left" );
+        }
+
+        if ( !adminMode ) {
+            if ( logSQL != 0 ) {
+                rodsLog( LOG_SQL, "chlDelCollTreeBatch SQL 6" );
+            }
+            bindVars.clear();
+            bindVars.push_back( pathStart );
+            bindVars.push_back( comm->clientUser.userName );
+            bindVars.push_back( comm->clientUser.rodsZone );
+            bindVars.push_back( ACCESS_DELETE_OBJECT );
+            status = cmlGetIntegerValueFromSql(
+                         "select CM.coll_id from R_COLL_MAIN CM where CM.coll_name like ? and not exists (select OA.object_id from R_OBJT_ACCESS OA, R_USER_GROUP UG, R_USER_MAIN UM, R_TOKN_MAIN TM where OA.object_id=CM.coll_id and UM.user_name=? and UM.zone_name=? and UM.user_type_name!='rodsgroup' and UM.user_id = UG.user_id and UG.group_user_id = OA.user_id and OA.access_type_id >= TM.token_id and TM.token_namespace ='access_type' and TM.token_name = ?)",
+                         &iVal, bindVars, &icss );
+            if ( status != CAT_NO_ROWS_FOUND ) {
+                return ERROR( status == 0 ? CAT_NO_ACCESS_PERMISSION : status, "no permission to remove a collection" );
+            }
+        }
+
+        std::vector<std::string> collIds;
+        bindVars.clear();
+        bindVars.push_back( pathStart );
+        if ( logSQL != 0 ) {
+            rodsLog( LOG_SQL, "chlDelCollTreeBatch SQL 7" );
+        }
+        status = cmlGetFirstRowFromSqlBV( "select coll_id from R_COLL_MAIN where coll_name like ?",
+                                          bindVars, &statementNum, &icss );
+        while ( status == 0 ) {
+            collIds.push_back( icss.stmtPtr[statementNum]->resultValue[0] );
+            status = cmlGetNextRowFromStatement( statementNum, &icss );
+        }
+        if ( status != CAT_NO_ROWS_FOUND ) {
+            return ERROR( status, "failed to select the collections" );
+        }
+        if ( collIds.empty() ) {
+            return SUCCESS();
+        }
+
+        // =-=-=-=-=-=-=-
+        // audit before the rows are gone
+        for ( size_t i = 0; i < collIds.size(); ++i ) {
+            status = cmlAudit3( AU_DELETE_COLL, collIds[i].c_str(),
+                                comm->clientUser.userName,
+                                comm->clientUser.rodsZone,
+                                _coll_info->collName, &icss );
+            if ( status != 0 ) {
+                rodsLog( LOG_NOTICE,
+                         "chlDelCollTreeBatch cmlAudit3 failure %d",
+                         status );
+                _rollback( "chlDelCollTreeBatch" );
+                return ERROR( status, "cmlAudit3 failure" );
+            }
+        }
+
+        const char* collDeletes[] = {
+            "delete from R_OBJT_ACCESS where object_id in (select coll_id from R_COLL_MAIN where coll_name like ?)",
+            "delete from R_OBJT_METAMAP where object_id in (select coll_id from R_COLL_MAIN where coll_name like ?)",
+            "delete from R_COLL_MAIN where coll_name like ?"
+        };
+        for ( size_t d = 0; d < sizeof( collDeletes ) / sizeof( collDeletes[0] ); ++d ) {
+            cllBindVars[cllBindVarCount++] = pathStart.c_str();
+            if ( logSQL != 0 ) {
+                rodsLog( LOG_SQL, "chlDelCollTreeBatch SQL 8" );
+            }
+            status = cmlExecuteNoAnswerSql( collDeletes[d], &icss );
+            if ( status != 0 && status != CAT_SUCCESS_BUT_WITH_NO_INFO ) {
+                rodsLog( LOG_NOTICE,
+                         "chlDelCollTreeBatch cmlExecuteNoAnswerSql delete failure %d",
+                         status );
+                _rollback( "chlDelCollTreeBatch" );
+                return ERROR( status, "cmlExecuteNoAnswerSql delete failure" );
+            }
+        }
+
+        status = cmlExecuteNoAnswerSql( "commit", &icss );
+        if ( status != 0 ) {
+            rodsLog( LOG_NOTICE,
+                     "chlDelCollTreeBatch cmlExecuteNoAnswerSql commit failure %d",
+                     status );
+            _rollback( "chlDelCollTreeBatch" );
+            return ERROR( status, "commit failed" );
+        }
+
+        return SUCCESS();
+
+    } // db_del_coll_tree_batch_op
+
     // =-=-=-=-=-=-=-
     // authenticate user
     irods::error db_check_auth_op(
@@ -13304,6 +14284,156 @@ checkLevel:
 
     } // db_calc_usage_and_quota_op
 
+    // =-=-=-=-=-=-=-
+    // Recompute R_QUOTA_USAGE from R_DATA_MAIN for the _count users whose
+    // usage was verified longest ago.  With incremental_quota_usage set the
+    // usage is kept current as objects change, and this is run in place of
+    // chlCalcUsageAndQuota to correct drift a slice of the catalog at a time.
+    irods::error db_reconcile_quota_usage_op(
+        irods::plugin_context& _ctx,
+        int                    _count ) {
+        // =-=-=-=-=-=-=-
+        // check the context
+        irods::error ret = _ctx.valid();
+        if ( !ret.ok() ) {
+            return PASS( ret );
+        }
+
+        if ( _ctx.comm()->clientUser.authInfo.authFlag < LOCAL_PRIV_USER_AUTH ) {
+            return ERROR( CAT_INSUFFICIENT_PRIVILEGE_LEVEL, "insufficient privilege" );
+        }
+        if ( _count <= 0 ) {
+            return ERROR( CAT_INVALID_ARGUMENT, "count must be positive" );
+        }
+
+        int status;
+        int statementNum = 0;
+        char myTime[50];
+
+        /* users never reconciled, or only charged since, come first */
+        std::vector<std::string> userIds;
+        std::vector<std::string> userNames;
+        {
+            std::vector<std::string> bindVars;
+            if ( logSQL != 0 ) {
+                rodsLog( LOG_SQL, "chlReconcileQuotaUsage SQL 1" );
+            }
+            status = cmlGetFirstRowFromSqlBV(
+                         "select UM.user_id, UM.user_name from R_USER_MAIN UM where UM.user_type_name != 'rodsgroup' order by coalesce((select min(QU.modify_ts) from R_QUOTA_USAGE QU where QU.user_id = UM.user_id), '0'), UM.user_id",
+                         bindVars, &statementNum, &icss );
+        }
+        while ( status == 0 ) {
+            userIds.push_back( icss.stmtPtr[statementNum]->resultValue[0] );
+            userNames.push_back( icss.stmtPtr[statementNum]->resultValue[1] );
+            if ( ( int )userIds.size() >= _count ) {
+                cmlFreeStatement( statementNum, &icss );
+                break;
+            }
+            status = cmlGetNextRowFromStatement( statementNum, &icss );
+        }
+        if ( status != 0 && status != CAT_NO_ROWS_FOUND ) {
+            return ERROR( status, "select users failed" );
+        }
+
+        getNowStr( myTime );
+        for ( size_t i = 0; i < userIds.size(); ++i ) {
+            rodsLong_t before = 0;
+            rodsLong_t after = 0;
+            {
+                std::vector<std::string> bindVars;
+                bindVars.push_back( userIds[i] );
+                if ( logSQL != 0 ) {
+                    rodsLog( LOG_SQL, "chlReconcileQuotaUsage SQL 2" );
+                }
+                status = cmlGetIntegerValueFromSql(
+                             "select coalesce(sum(quota_usage), 0) from R_QUOTA_USAGE where user_id=?",
+                             &before, bindVars, &icss );
+                if ( status != 0 && status != CAT_NO_ROWS_FOUND ) {
+                    _rollback( "chlReconcileQuotaUsage" );
+                    return ERROR( status, "select usage failed" );
+                }
+            }
+
+            cllBindVars[cllBindVarCount++] = userIds[i].c_str();
+            if ( logSQL != 0 ) {
+                rodsLog( LOG_SQL, "chlReconcileQuotaUsage SQL 3" );
+            }
+            status = cmlExecuteNoAnswerSql(
+                         "delete from R_QUOTA_USAGE where user_id=?", &icss );
+            if ( status != 0 && status != CAT_SUCCESS_BUT_WITH_NO_INFO ) {
+                _rollback( "chlReconcileQuotaUsage" );
+                return ERROR( status, "delete failed" );
+            }
+
+            cllBindVars[cllBindVarCount++] = myTime;
+            cllBindVars[cllBindVarCount++] = userIds[i].c_str();
+            if ( logSQL != 0 ) {
+                rodsLog( LOG_SQL, "chlReconcileQuotaUsage SQL 4" );
+            }
+            status = cmlExecuteNoAnswerSql(
+                         "insert into R_QUOTA_USAGE (quota_usage, resc_id, user_id, modify_ts) (select sum(R_DATA_MAIN.data_size), R_RESC_MAIN.resc_id, R_USER_MAIN.user_id, ? from R_DATA_MAIN, R_USER_MAIN, R_RESC_MAIN where R_USER_MAIN.user_id = ? and R_USER_MAIN.user_name = R_DATA_MAIN.data_owner_name and R_USER_MAIN.zone_name = R_DATA_MAIN.data_owner_zone and R_RESC_MAIN.resc_name = R_DATA_MAIN.resc_name group by R_RESC_MAIN.resc_id, R_USER_MAIN.user_id)",
+                         &icss );
+            if ( status != 0 && status != CAT_SUCCESS_BUT_WITH_NO_INFO ) {
+                _rollback( "chlReconcileQuotaUsage" );
+                return ERROR( status, "insert failed" );
+            }
+
+            /* a zero row on resc_id 0 (the 'total' id, never charged by
+               the incremental updates) records when this user was
+               verified, even when they own nothing */
+            cllBindVars[cllBindVarCount++] = userIds[i].c_str();
+            cllBindVars[cllBindVarCount++] = myTime;
+            if ( logSQL != 0 ) {
+                rodsLog( LOG_SQL, "chlReconcileQuotaUsage SQL 5" );
+            }
+            status = cmlExecuteNoAnswerSql(
+                         "insert into R_QUOTA_USAGE (quota_usage, resc_id, user_id, modify_ts) values ('0', '0', ?, ?)",
+                         &icss );
+            if ( status != 0 ) {
+                _rollback( "chlReconcileQuotaUsage" );
+                return ERROR( status, "insert marker failed" );
+            }
+
+            {
+                std::vector<std::string> bindVars;
+                bindVars.push_back( userIds[i] );
+                if ( logSQL != 0 ) {
+                    rodsLog( LOG_SQL, "chlReconcileQuotaUsage SQL 6" );
+                }
+                status = cmlGetIntegerValueFromSql(
+                             "select coalesce(sum(quota_usage), 0) from R_QUOTA_USAGE where user_id=?",
+                             &after, bindVars, &icss );
+                if ( status != 0 && status != CAT_NO_ROWS_FOUND ) {
+                    _rollback( "chlReconcileQuotaUsage" );
+                    return ERROR( status, "select usage failed" );
+                }
+            }
+            if ( before != after ) {
+                rodsLog( LOG_NOTICE,
+                         "chlReconcileQuotaUsage: usage of [%s] corrected from %lld to %lld",
+                         userNames[i].c_str(), before, after );
+            }
+        }
+
+        /* Set the over_quota flags from the corrected usage */
+        status = setOverQuota( _ctx.comm() );
+        if ( status != 0 ) {
+            _rollback( "chlReconcileQuotaUsage" );
+            return ERROR( status, "setOverQuota failed" );
+        }
+
+        status =  cmlExecuteNoAnswerSql( "commit", &icss );
+        if ( status < 0 ) {
+            return ERROR( status, "commit failed" );
+        }
+
+        rodsLog( LOG_NOTICE,
+                 "chlReconcileQuotaUsage reconciled %d users",
+                 ( int )userIds.size() );
+        return SUCCESS();
+
+    } // db_reconcile_quota_usage_op
+
     irods::error db_set_quota_op(
         irods::plugin_context& _ctx,
         char*                  _type,
@@ -16098,6 +17228,7 @@ checkLevel:
         pg->add_operation( irods::DATABASE_OP_UPDATE_RESC_OBJ_COUNT,    "db_update_resc_obj_count_op" );
         pg->add_operation( irods::DATABASE_OP_MOD_DATA_OBJ_META,        "db_mod_data_obj_meta_op" );
         pg->add_operation( irods::DATABASE_OP_REG_DATA_OBJ,             "db_reg_data_obj_op" );
+        pg->add_operation( irods::DATABASE_OP_REG_DATA_OBJ_BATCH,       "db_reg_data_obj_batch_op" );
         pg->add_operation( irods::DATABASE_OP_REG_REPLICA,              "db_reg_replica_op" );
         pg->add_operation( irods::DATABASE_OP_UNREG_REPLICA,            "db_unreg_replica_op" );
         pg->add_operation( irods::DATABASE_OP_REG_RULE_EXEC,            "db_reg_rule_exec_op" );
@@ -16122,6 +17253,7 @@ checkLevel:
         pg->add_operation( irods::DATABASE_OP_SIMPLE_QUERY,             "db_simple_query_op" );
         pg->add_operation( irods::DATABASE_OP_DEL_COLL_BY_ADMIN,        "db_del_coll_by_admin_op" );
         pg->add_operation( irods::DATABASE_OP_DEL_COLL,                 "db_del_coll_op" );
+        pg->add_operation( irods::DATABASE_OP_DEL_COLL_TREE_BATCH,      "db_del_coll_tree_batch_op" );
         pg->add_operation( irods::DATABASE_OP_CHECK_AUTH,               "db_check_auth_op" );
         pg->add_operation( irods::DATABASE_OP_MAKE_TEMP_PW,             "db_make_temp_pw_op" );
         pg->add_operation( irods::DATABASE_OP_UPDATE_PAM_PASSWORD,      "db_update_pam_password_op" );
@@ -16149,6 +17281,7 @@ checkLevel:
         pg->add_operation( irods::DATABASE_OP_REG_SERVER_LOAD_DIGEST,   "db_reg_server_load_digest_op" );
         pg->add_operation( irods::DATABASE_OP_PURGE_SERVER_LOAD_DIGEST, "db_purge_server_load_digest_op" );
         pg->add_operation( irods::DATABASE_OP_CALC_USAGE_AND_QUOTA,     "db_calc_usage_and_quota_op" );
+        pg->add_operation( irods::DATABASE_OP_RECONCILE_QUOTA_USAGE,    "db_reconcile_quota_usage_op" );
         pg->add_operation( irods::DATABASE_OP_SET_QUOTA,                "db_set_quota_op" );
         pg->add_operation( irods::DATABASE_OP_CHECK_QUOTA,              "db_check_quota_op" );
         pg->add_operation( irods::DATABASE_OP_DEL_UNUSED_AVUS,          "db_del_unused_avus_op" );
@@ -28,6 +28,10 @@
 #include "mid_level.hpp"
 #include "low_level.hpp"
 
+#include <map>
+#include <string>
+#include <vector>
+
 extern int logSQLGenQuery;
 
 void icatGeneralQuerySetup();
@@ -1702,6 +1706,222 @@ generateSpecialQuery( genQueryInp_t genQueryInp, char *resultingSQL ) {
     return 0;
 }
 
+/*
+ Cache of the SQL generated for each query shape.  The tables, joins
+ and clauses that generateSQL produces depend on the columns, the
+ operators and the options of a query but not on the quoted values,
+ which always become bind variables.  So the SQL is saved under a key
+ built from everything but those values, and when the same shape is
+ asked for again (as the clients do with each object, collection or
+ user they look up) only the bind variables have to be pulled out of
+ the conditions; the table linking (setTable, tScan) is skipped.
+
+ Compound (|| and &&) and parent_of conditions are not cached, the
+ number of bind variables they use depends on the values.
+ */
+#define GENQ_SQL_CACHE_SIZE 256
+#define GENQ_SQL_CACHE_REPORT_INTERVAL 1000
+
+/* where each bind variable of a cached statement comes from */
+#define GENQ_BIND_VALUE 0    /* a quoted value of a condition, in order */
+#define GENQ_BIND_USER 1     /* accessControlUserName */
+#define GENQ_BIND_ZONE 2     /* accessControlZone */
+#define GENQ_BIND_TICKET 3   /* sessionTicket */
+#define GENQ_BIND_OFFSET 4   /* the rowOffset */
+
+typedef struct {
+    std::string sql;
+    std::string countSql;
+    std::vector<int> bindKinds;
+    int nValues;
+} genqSqlCacheEntry_t;
+
+static std::map<std::string, genqSqlCacheEntry_t> genqSqlCache;
+static std::vector<std::string> genqSqlCacheValues;
+static long genqSqlCacheHits = 0;
+static long genqSqlCacheMisses = 0;
+
+/* the room insertWhere and addInClauseToWhereForIn have used for the
+   values of the query so far, to apply their length checks to a query
+   before it is looked up */
+static int genqSqlCacheBindIx = 0;
+static int genqSqlCacheInStrIx = 0;
+
+/*
+ Add the shape of one condition to the cache key and its quoted values
+ to genqSqlCacheValues, splitting the condition up the same way
+ insertWhere and the routines it calls do.  Returns -1 if the
+ condition is one that is not cached, including one with a value
+ longer than those routines accept, so that the query takes the
+ uncached path and gets the same error.
+ */
+static int
+genqSqlCacheCondition( char *condition, std::string &key ) {
+    char *condStart, *cp, *cp1;
+    char *cpFirstQuote, *cpSecondQuote;
+    int quoteState;
+    int isIn, valueLen;
+    int betweenIx = 0;
+
+    if ( compoundConditionSpecified( condition ) ) {
+        return -1;
+    }
+
+    condStart = condition;
+    while ( *condStart == ' ' ) {
+        condStart++;
+    }
+
+    cp = strstr( condition, "in" );
+    if ( cp == NULL ) {
+        cp = strstr( condition, "IN" );
+    }
+    isIn = cp != NULL && cp == condStart;
+    if ( !isIn ) {
+        cp = strstr( condition, "between" );
+        if ( cp == NULL ) {
+            cp = strstr( condition, "BETWEEN" );
+        }
+    }
+    if ( cp != NULL && cp == condStart ) {
+        /* each pair of quotes holds one value */
+        quoteState = 0;
+        cpFirstQuote = 0;
+        for ( cp1 = condition; *cp1 != '\0'; cp1++ ) {
+            if ( *cp1 == '\'' ) {
+                quoteState++;
+                if ( quoteState == 1 ) {
+                    cpFirstQuote = cp1;
+                }
+                if ( quoteState == 2 ) {
+                    quoteState = 0;
+                    valueLen = cp1 - cpFirstQuote - 1;
+                    if ( valueLen >= MAX_SQL_SIZE_GQ ) {
+                        return -1;
+                    }
+                    if ( isIn ) {
+                        if ( valueLen >= ( MAX_SQL_SIZE_GQ * 2 ) - genqSqlCacheInStrIx ) {
+                            return -1;
+                        }
+                        genqSqlCacheInStrIx += valueLen + 1;
+                    }
+                    else {
+                        if ( valueLen >= MAX_SQL_SIZE_GQ - betweenIx ) {
+                            return -1;
+                        }
+                        betweenIx += valueLen + 1;
+                    }
+                    genqSqlCacheValues.push_back(
+                        std::string( cpFirstQuote + 1, cp1 - cpFirstQuote - 1 ) );
+                    key += "''";
+                }
+                continue;
+            }
+            if ( quoteState == 0 ) {
+                key += *cp1;
+            }
+        }
+        if ( quoteState == 1 ) {
+            key += cpFirstQuote;
+        }
+        return 0;
+    }
+
+    if ( strcmp( condition, "IS NULL" ) == 0 ||
+            strcmp( condition, "IS NOT NULL" ) == 0 ) {
+        key += condition;
+        return 0;
+    }
+
+    /* everything from the first to the last quote is one value */
+    cpFirstQuote = 0;
+    cpSecondQuote = 0;
+    for ( cp1 = condition; *cp1 != '\0'; cp1++ ) {
+        if ( *cp1 == '\'' ) {
+            if ( cpFirstQuote == 0 ) {
+                cpFirstQuote = cp1;
+            }
+            else {
+                cpSecondQuote = cp1;
+            }
+        }
+    }
+    if ( cpFirstQuote == 0 || cpSecondQuote == 0 ) {
+        return -1; /* invalid, leave it to insertWhere to report */
+    }
+    genqSqlCacheBindIx++;
+    if ( ( cpSecondQuote - cpFirstQuote ) + genqSqlCacheBindIx > MAX_SQL_SIZE_GQ + 90 ) {
+        return -1; /* too long, leave it to insertWhere to report */
+    }
+    genqSqlCacheBindIx += cpSecondQuote - cpFirstQuote;
+    key.append( condition, cpFirstQuote - condition );
+    if ( key.find( "parent_of" ) != std::string::npos ) {
+        return -1;
+    }
+    key += "''";
+    key += cpSecondQuote + 1;
+    genqSqlCacheValues.push_back(
+        std::string( cpFirstQuote + 1, cpSecondQuote - cpFirstQuote - 1 ) );
+    return 0;
+}
+
+/*
+ Build the cache key for a query and collect its quoted values.  The
+ key includes the state genqAppendAccessCheck works from, since that
+ changes the SQL for the same query.  Returns -1 if the query is not
+ cached.
+ */
+static int
+genqSqlCacheKey( genQueryInp_t *genQueryInp, std::string &key ) {
+    char tmpStr[100];
+    int offsetKey;
+    int i;
+
+    genqSqlCacheValues.clear();
+    genqSqlCacheBindIx = 0;
+    genqSqlCacheInStrIx = 0;
+    key.clear();
+
+    offsetKey = genQueryInp->rowOffset > 0;
+#if MY_ICAT
+    /* MySQL has the offset in the SQL text */
+    offsetKey = genQueryInp->rowOffset;
+#endif
+    snprintf( tmpStr, sizeof tmpStr, "%d %d %d %d %d %d|",
+              genQueryInp->options & ( NO_DISTINCT | UPPER_CASE_WHERE ),
+              offsetKey,
+              accessControlPriv == LOCAL_PRIV_USER_AUTH,
+              accessControlControlFlag > 1,
+              strncmp( accessControlUserName, ANONYMOUS_USER, MAX_NAME_LEN ) == 0,
+              sessionTicket[0] != '\0' );
+    key += tmpStr;
+
+    for ( i = 0; i < genQueryInp->selectInp.len; i++ ) {
+        snprintf( tmpStr, sizeof tmpStr, "%d:%d,",
+                  genQueryInp->selectInp.inx[i], genQueryInp->selectInp.value[i] );
+        key += tmpStr;
+    }
+    for ( i = 0; i < genQueryInp->sqlCondInp.len; i++ ) {
+        snprintf( tmpStr, sizeof tmpStr, "|%d:", genQueryInp->sqlCondInp.inx[i] );
+        key += tmpStr;
+        if ( genqSqlCacheCondition( genQueryInp->sqlCondInp.value[i], key ) < 0 ) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void
+genqSqlCacheReport() {
+    if ( ( genqSqlCacheHits + genqSqlCacheMisses ) %
+            GENQ_SQL_CACHE_REPORT_INTERVAL == 0 ) {
+        rodsLog( LOG_DEBUG,
+                 "generateSQL: SQL cache %ld hits, %ld misses, %d shapes",
+                 genqSqlCacheHits, genqSqlCacheMisses,
+                 ( int )genqSqlCache.size() );
+    }
+}
+
 /*
 Called by chlGenQuery to generate the SQL.
 */
@@ -1725,12 +1945,61 @@ generateSQL( genQueryInp_t genQueryInp, char *resultingSQL,
 #else
     static char offsetStr[20];
 #endif
+    std::string cacheKey;
+    int useCache;
+    int bindStart;
 
     if ( firstCall ) {
         icatGeneralQuerySetup(); /* initialize */
     }
     firstCall = 0;
 
+    bindStart = cllBindVarCount;
+    useCache = genqSqlCacheKey( &genQueryInp, cacheKey ) == 0;
+    if ( useCache ) {
+        std::map<std::string, genqSqlCacheEntry_t>::iterator it =
+            genqSqlCache.find( cacheKey );
+        if ( it != genqSqlCache.end() &&
+                it->second.nValues == ( int )genqSqlCacheValues.size() &&
+                bindStart + ( int )it->second.bindKinds.size() < MAX_BIND_VARS ) {
+            int valueIx = 0;
+            for ( i = 0; i < ( int )it->second.bindKinds.size(); i++ ) {
+                switch ( it->second.bindKinds[i] ) {
+                case GENQ_BIND_USER:
+                    cllBindVars[cllBindVarCount++] = accessControlUserName;
+                    break;
+                case GENQ_BIND_ZONE:
+                    cllBindVars[cllBindVarCount++] = accessControlZone;
+                    break;
+                case GENQ_BIND_TICKET:
+                    cllBindVars[cllBindVarCount++] = sessionTicket;
+                    break;
+#if !ORA_ICAT
+                case GENQ_BIND_OFFSET:
+                    snprintf( offsetStr, sizeof offsetStr, "%d", genQueryInp.rowOffset );
+                    cllBindVars[cllBindVarCount++] = offsetStr;
+                    break;
+#endif
+                default:
+                    cllBindVars[cllBindVarCount++] =
+                        ( char * )genqSqlCacheValues[valueIx++].c_str();
+                    break;
+                }
+            }
+            rstrcpy( resultingSQL, ( char * )it->second.sql.c_str(), MAX_SQL_SIZE_GQ );
+#if ORA_ICAT
+            rstrcpy( resultingCountSQL, ( char * )it->second.countSql.c_str(),
+                     MAX_SQL_SIZE_GQ );
+#endif
+            genqSqlCacheHits++;
+            genqSqlCacheReport();
+            if ( debug ) {
+                printf( "cached combinedSQL=:%s:\n", resultingSQL );
+            }
+            return 0;
+        }
+    }
+
     nToFind = 0;
     for ( i = 0; i < nTables; i++ ) {
         Tables[i].flag = 0;
@@ -1980,6 +2249,44 @@ generateSQL( genQueryInp_t genQueryInp, char *resultingSQL,
     }
     strncpy( resultingCountSQL, countSQL, MAX_SQL_SIZE_GQ );
 #endif
+
+    if ( useCache ) {
+        genqSqlCacheEntry_t entry;
+        entry.sql = combinedSQL;
+#if ORA_ICAT
+        entry.countSql = countSQL;
+#endif
+        entry.nValues = 0;
+        for ( i = bindStart; i < cllBindVarCount; i++ ) {
+            if ( cllBindVars[i] == accessControlUserName ) {
+                entry.bindKinds.push_back( GENQ_BIND_USER );
+            }
+            else if ( cllBindVars[i] == accessControlZone ) {
+                entry.bindKinds.push_back( GENQ_BIND_ZONE );
+            }
+            else if ( cllBindVars[i] == sessionTicket ) {
+                entry.bindKinds.push_back( GENQ_BIND_TICKET );
+            }
+#if !ORA_ICAT
+            else if ( cllBindVars[i] == offsetStr ) {
+                entry.bindKinds.push_back( GENQ_BIND_OFFSET );
+            }
+#endif
+            else {
+                entry.bindKinds.push_back( GENQ_BIND_VALUE );
+                entry.nValues++;
+            }
+        }
+        /* only keep it if the values line up with what was bound */
+        if ( entry.nValues == ( int )genqSqlCacheValues.size() ) {
+            if ( genqSqlCache.size() >= GENQ_SQL_CACHE_SIZE ) {
+                genqSqlCache.clear();
+            }
+            genqSqlCache[cacheKey] = entry;
+        }
+        genqSqlCacheMisses++;
+        genqSqlCacheReport();
+    }
     return 0;
 }
 
@@ -2170,6 +2477,12 @@ extern "C" int chl_gen_query_ticket_setup_impl(
     return 0;
 }
 
+/* forget the session ticket when the catalog connection closes */
+extern "C" void chl_gen_query_ticket_clear_impl() {
+    sessionTicket[0] = '\0';
+    sessionClientAddr[0] = '\0';
+}
+
 
 /* General Query */
 extern "C" int chl_gen_query_impl(
@@ -2376,7 +2689,7 @@ extern "C" int chl_gen_query_impl(
             if ( debug ) {
                 printf( "attriTextLen=%d\n", attriTextLen );
             }
-            totalLen = attriTextLen * genQueryInp.maxRows;
+            totalLen = maxColSize * genQueryInp.maxRows; /* one column */
             for ( j = 0; j < numOfCols; j++ ) {
                 tResult = ( char* )malloc( totalLen );
                 if ( tResult == NULL ) {
@@ -2408,7 +2721,7 @@ extern "C" int chl_gen_query_impl(
             if ( debug ) {
                 printf( "attriTextLen=%d\n", attriTextLen );
             }
-            totalLen = attriTextLen * genQueryInp.maxRows;
+            totalLen = maxColSize * genQueryInp.maxRows; /* one column */
             for ( j = 0; j < numOfCols; j++ ) {
                 char *cp1, *cp2;
                 int k;
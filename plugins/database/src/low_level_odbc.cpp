@@ -38,6 +38,9 @@ int _cllFreeStatementColumns( icatSessionStruct *icss, int statementNumber );
 int
 _cllExecSqlNoResult( icatSessionStruct *icss, const char *sql, int option );
 
+static void _cllFlushPreparedStatements();
+static void _cllLogPreparedStatementStats( int level );
+
 
 int cllBindVarCount = 0;
 const char *cllBindVars[MAX_BIND_VARS];
@@ -68,10 +71,35 @@ SQLINTEGER columnLength[MAX_TOKEN];  /* change me ! */
 
 #include <vector>
 #include <string>
+#include <list>
+#include <map>
 
 static int didBegin = 0;
 static int noResultRowCount = 0;
 
+/*
+  Cache of prepared statements for the current connection, keyed by the
+  SQL text and kept in least recently used order (most recent first).
+  A statement is prepared once with SQLPrepare and then re-executed with
+  SQLExecute after binding the variables for that call.  An entry which
+  is in use by an open result set is not handed out a second time; the
+  caller gets a private, uncached statement instead.
+*/
+typedef struct {
+    std::string sql;
+    HSTMT       hstmt;
+    int         inUse;
+} cllPreparedStmt_t;
+
+typedef std::list<cllPreparedStmt_t> cllPreparedStmtList_t;
+
+static HDBC preparedStmtConn = NULL;
+static cllPreparedStmtList_t preparedStmtLru;
+static std::map<std::string, cllPreparedStmtList_t::iterator> preparedStmtIndex;
+static int preparedStmtHits = 0;
+static int preparedStmtMisses = 0;
+static int preparedStmtEvictions = 0;
+
 // =-=-=-=-=-=-=-
 // JMC :: Needed to add this due to crash issues with the SQLBindCol + SQLFetch
 //     :: combination where the fetch fails if a var is not passed to the bind for
@@ -393,6 +421,11 @@ cllDisconnect( icatSessionStruct *icss ) {
         /* Nothing to do if it fails */
     }
 
+    if ( preparedStmtConn == icss->connectPtr ) {
+        _cllLogPreparedStatementStats( LOG_DEBUG );
+        _cllFlushPreparedStatements();
+    }
+
     SQLRETURN stat = SQLDisconnect( icss->connectPtr );
     if ( stat != SQL_SUCCESS ) {
         rodsLog( LOG_ERROR, "cllDisconnect: SQLDisconnect failed: %d", stat );
@@ -499,6 +532,148 @@ static int cmp_stmt( const char *str1, const char *str2 ) {
     return *str1 == *str2 ;
 }
 
+/*
+  Drop every cached prepared statement.  Statements still in use by a
+  result set are only forgotten; cllFreeStatement will free them.
+*/
+static void
+_cllFlushPreparedStatements() {
+    for ( cllPreparedStmtList_t::iterator itr = preparedStmtLru.begin();
+            itr != preparedStmtLru.end(); ++itr ) {
+        if ( !itr->inUse ) {
+            SQLFreeHandle( SQL_HANDLE_STMT, itr->hstmt );
+        }
+    }
+    preparedStmtLru.clear();
+    preparedStmtIndex.clear();
+    preparedStmtConn = NULL;
+}
+
+/*
+  Log the prepared statement cache counters for this session.
+*/
+static void
+_cllLogPreparedStatementStats( int level ) {
+    rodsLog( level,
+             "prepared statement cache: hits=%d misses=%d evictions=%d cached=%d",
+             preparedStmtHits, preparedStmtMisses, preparedStmtEvictions,
+             ( int ) preparedStmtLru.size() );
+}
+
+/*
+  Get a prepared statement handle for sql, from the cache when possible.
+  cached is set to 1 if the handle belongs to the cache and must be
+  returned with _cllReleasePreparedStatement rather than freed.
+  Returns 0 on success or the error from logPsgError if SQLPrepare fails.
+*/
+static int
+_cllGetPreparedStatement(
+    icatSessionStruct* icss,
+    const char*        sql,
+    HSTMT*             hstmt,
+    int*               cached ) {
+
+    HDBC myHdbc = icss->connectPtr;
+    if ( preparedStmtConn != myHdbc ) {
+        /* new session, the old handles are no longer valid */
+        _cllFlushPreparedStatements();
+        preparedStmtConn = myHdbc;
+    }
+
+    *cached = 0;
+    std::string key( sql );
+    std::map<std::string, cllPreparedStmtList_t::iterator>::iterator found =
+        preparedStmtIndex.find( key );
+    if ( found != preparedStmtIndex.end() && !found->second->inUse ) {
+        preparedStmtLru.splice( preparedStmtLru.begin(), preparedStmtLru,
+                                found->second );
+        found->second->inUse = 1;
+        *hstmt = found->second->hstmt;
+        *cached = 1;
+        preparedStmtHits++;
+        return 0;
+    }
+
+    preparedStmtMisses++;
+    SQLRETURN stat = SQLAllocHandle( SQL_HANDLE_STMT, myHdbc, hstmt );
+    if ( stat != SQL_SUCCESS ) {
+        rodsLog( LOG_ERROR, "_cllGetPreparedStatement: SQLAllocHandle failed for statement: %d",
+                 stat );
+        return -1;
+    }
+
+    stat = SQLPrepare( *hstmt, ( unsigned char * )sql, strlen( sql ) );
+    if ( stat != SQL_SUCCESS && stat != SQL_SUCCESS_WITH_INFO ) {
+        rodsLog( LOG_NOTICE, "_cllGetPreparedStatement: SQLPrepare error: %d sql:%s",
+                 stat, sql );
+        int status = logPsgError( LOG_NOTICE, icss->environPtr, myHdbc, *hstmt,
+                                  icss->databaseType );
+        SQLFreeHandle( SQL_HANDLE_STMT, *hstmt );
+        return status < 0 ? status : -1;
+    }
+
+    if ( found != preparedStmtIndex.end() ) {
+        /* the cached copy is busy with an open result set */
+        return 0;
+    }
+
+    cllPreparedStmt_t entry;
+    entry.sql = key;
+    entry.hstmt = *hstmt;
+    entry.inUse = 1;
+    preparedStmtLru.push_front( entry );
+    preparedStmtIndex[key] = preparedStmtLru.begin();
+    *cached = 1;
+
+    /* evict the least recently used statements which are not busy */
+    cllPreparedStmtList_t::iterator itr = preparedStmtLru.end();
+    while ( preparedStmtLru.size() > PREPARED_STMT_CACHE_SIZE &&
+            itr != preparedStmtLru.begin() ) {
+        --itr;
+        if ( itr->inUse ) {
+            continue;
+        }
+        SQLFreeHandle( SQL_HANDLE_STMT, itr->hstmt );
+        preparedStmtIndex.erase( itr->sql );
+        itr = preparedStmtLru.erase( itr );
+        preparedStmtEvictions++;
+    }
+
+    return 0;
+}
+
+/*
+  Return a statement obtained from _cllGetPreparedStatement to the cache:
+  close any open cursor and drop the column and parameter bindings, which
+  point at buffers owned by the caller.  Returns 0 if hstmt is not owned
+  by the cache, in which case the caller must free it.
+*/
+static int
+_cllReleasePreparedStatement( HSTMT hstmt ) {
+    for ( cllPreparedStmtList_t::iterator itr = preparedStmtLru.begin();
+            itr != preparedStmtLru.end(); ++itr ) {
+        if ( itr->hstmt == hstmt && itr->inUse ) {
+            SQLFreeStmt( hstmt, SQL_CLOSE );
+            SQLFreeStmt( hstmt, SQL_UNBIND );
+            SQLFreeStmt( hstmt, SQL_RESET_PARAMS );
+            itr->inUse = 0;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+  Release or free a statement handle, as appropriate.
+*/
+static SQLRETURN
+_cllFreeStatementHandle( HSTMT hstmt, int cached ) {
+    if ( cached && _cllReleasePreparedStatement( hstmt ) ) {
+        return SQL_SUCCESS;
+    }
+    return SQLFreeHandle( SQL_HANDLE_STMT, hstmt );
+}
+
 /*
   Execute a SQL command which has no resulting table.  With optional
   bind variables.
@@ -514,19 +689,44 @@ _cllExecSqlNoResult(
 
     HDBC myHdbc = icss->connectPtr;
     HSTMT myHstmt;
-    SQLRETURN stat = SQLAllocHandle( SQL_HANDLE_STMT, myHdbc, &myHstmt );
-    if ( stat != SQL_SUCCESS ) {
-        rodsLog( LOG_ERROR, "_cllExecSqlNoResult: SQLAllocHandle failed for statement: %d", stat );
-        return -1;
+    SQLRETURN stat;
+
+    /* transaction control is not worth preparing */
+    int usePrepared = ( option == 0 &&
+                        ! cmp_stmt( sql, "begin" )  &&
+                        ! cmp_stmt( sql, "commit" ) &&
+                        ! cmp_stmt( sql, "rollback" ) );
+    int cached = 0;
+    if ( usePrepared ) {
+        int status = _cllGetPreparedStatement( icss, sql, &myHstmt, &cached );
+        if ( status != 0 ) {
+            cllBindVarCountPrev = cllBindVarCount;
+            cllBindVarCount = 0;
+            logTheBindVariables( LOG_NOTICE );
+            return status;
+        }
+    }
+    else {
+        stat = SQLAllocHandle( SQL_HANDLE_STMT, myHdbc, &myHstmt );
+        if ( stat != SQL_SUCCESS ) {
+            rodsLog( LOG_ERROR, "_cllExecSqlNoResult: SQLAllocHandle failed for statement: %d", stat );
+            return -1;
+        }
     }
 
     if ( option == 0 && bindTheVariables( myHstmt, sql ) != 0 ) {
+        _cllFreeStatementHandle( myHstmt, cached );
         return -1;
     }
 
     rodsLogSql( sql );
 
-    stat = SQLExecDirect( myHstmt, ( unsigned char * )sql, strlen( sql ) );
+    if ( usePrepared ) {
+        stat = SQLExecute( myHstmt );
+    }
+    else {
+        stat = SQLExecDirect( myHstmt, ( unsigned char * )sql, strlen( sql ) );
+    }
     SQL_INT_OR_LEN rowCount = 0;
     SQLRowCount( myHstmt, ( SQL_INT_OR_LEN * )&rowCount );
     switch ( stat ) {
@@ -580,13 +780,13 @@ _cllExecSqlNoResult(
         if ( option == 0 ) {
             logTheBindVariables( LOG_NOTICE );
         }
-        rodsLog( LOG_NOTICE, "_cllExecSqlNoResult: SQLExecDirect error: %d sql:%s",
+        rodsLog( LOG_NOTICE, "_cllExecSqlNoResult: SQL execute error: %d sql:%s",
                  stat, sql );
         result = logPsgError( LOG_NOTICE, icss->environPtr, myHdbc, myHstmt,
                               icss->databaseType );
     }
 
-    stat = SQLFreeHandle( SQL_HANDLE_STMT, myHstmt );
+    stat = _cllFreeStatementHandle( myHstmt, cached );
     if ( stat != SQL_SUCCESS ) {
         rodsLog( LOG_ERROR, "_cllExecSqlNoResult: SQLFreeHandle for statement error: %d", stat );
     }
@@ -614,13 +814,6 @@ cllExecSqlWithResult( icatSessionStruct *icss, int *stmtNum, const char *sql ) {
     rodsLog( LOG_DEBUG1, sql );
 
     HDBC myHdbc = icss->connectPtr;
-    HSTMT hstmt;
-    SQLRETURN stat = SQLAllocHandle( SQL_HANDLE_STMT, myHdbc, &hstmt );
-    if ( stat != SQL_SUCCESS ) {
-        rodsLog( LOG_ERROR, "cllExecSqlWithResult: SQLAllocHandle failed for statement: %d",
-                 stat );
-        return -1;
-    }
 
     int statementNumber = -1;
     for ( int i = 0; i < MAX_NUM_OF_CONCURRENT_STMTS && statementNumber < 0; i++ ) {
@@ -634,17 +827,29 @@ cllExecSqlWithResult( icatSessionStruct *icss, int *stmtNum, const char *sql ) {
         return -2;
     }
 
+    HSTMT hstmt;
+    int cached = 0;
+    int status = _cllGetPreparedStatement( icss, sql, &hstmt, &cached );
+    if ( status != 0 ) {
+        cllBindVarCountPrev = cllBindVarCount;
+        cllBindVarCount = 0;
+        logTheBindVariables( LOG_NOTICE );
+        return -1;
+    }
+
     icatStmtStrct * myStatement = ( icatStmtStrct * )malloc( sizeof( icatStmtStrct ) );
+    memset( myStatement, 0, sizeof( icatStmtStrct ) );
     icss->stmtPtr[statementNumber] = myStatement;
 
     myStatement->stmtPtr = hstmt;
 
     if ( bindTheVariables( hstmt, sql ) != 0 ) {
+        cllFreeStatement( icss, statementNumber );
         return -1;
     }
 
     rodsLogSql( sql );
-    stat = SQLExecDirect( hstmt, ( unsigned char * )sql, strlen( sql ) );
+    SQLRETURN stat = SQLExecute( hstmt );
 
     switch ( stat ) {
     case SQL_SUCCESS:
@@ -671,10 +876,11 @@ cllExecSqlWithResult( icatSessionStruct *icss, int *stmtNum, const char *sql ) {
             stat != SQL_NO_DATA_FOUND ) {
         logTheBindVariables( LOG_NOTICE );
         rodsLog( LOG_NOTICE,
-                 "cllExecSqlWithResult: SQLExecDirect error: %d, sql:%s",
+                 "cllExecSqlWithResult: SQLExecute error: %d, sql:%s",
                  stat, sql );
         logPsgError( LOG_NOTICE, icss->environPtr, myHdbc, hstmt,
                      icss->databaseType );
+        cllFreeStatement( icss, statementNumber );
         return -1;
     }
 
@@ -683,6 +889,7 @@ cllExecSqlWithResult( icatSessionStruct *icss, int *stmtNum, const char *sql ) {
     if ( stat != SQL_SUCCESS ) {
         rodsLog( LOG_ERROR, "cllExecSqlWithResult: SQLNumResultCols failed: %d",
                  stat );
+        cllFreeStatement( icss, statementNumber );
         return -2;
     }
     myStatement->numOfCols = numColumns;
@@ -697,6 +904,7 @@ cllExecSqlWithResult( icatSessionStruct *icss, int *stmtNum, const char *sql ) {
         if ( stat != SQL_SUCCESS ) {
             rodsLog( LOG_ERROR, "cllExecSqlWithResult: SQLDescribeCol failed: %d",
                      stat );
+            cllFreeStatement( icss, statementNumber );
             return -3;
         }
         /*  printf("colName='%s' precision=%d\n",colName, precision); */
@@ -708,6 +916,7 @@ cllExecSqlWithResult( icatSessionStruct *icss, int *stmtNum, const char *sql ) {
             rodsLog( LOG_ERROR,
                      "cllExecSqlWithResult: SQLColAttributes failed: %d",
                      stat );
+            cllFreeStatement( icss, statementNumber );
             return -3;
         }
 
@@ -730,6 +939,7 @@ cllExecSqlWithResult( icatSessionStruct *icss, int *stmtNum, const char *sql ) {
             rodsLog( LOG_ERROR,
                      "cllExecSqlWithResult: SQLColAttributes failed: %d",
                      stat );
+            cllFreeStatement( icss, statementNumber );
             return -4;
         }
 
@@ -773,13 +983,6 @@ cllExecSqlWithResultBV(
     rodsLog( LOG_DEBUG1, sql );
 
     HDBC myHdbc = icss->connectPtr;
-    HSTMT hstmt;
-    SQLRETURN stat = SQLAllocHandle( SQL_HANDLE_STMT, myHdbc, &hstmt );
-    if ( stat != SQL_SUCCESS ) {
-        rodsLog( LOG_ERROR, "cllExecSqlWithResultBV: SQLAllocHandle failed for statement: %d",
-                 stat );
-        return -1;
-    }
 
     int statementNumber = -1;
     for ( int i = 0; i < MAX_NUM_OF_CONCURRENT_STMTS && statementNumber < 0; i++ ) {
@@ -793,7 +996,17 @@ cllExecSqlWithResultBV(
         return -2;
     }
 
+    HSTMT hstmt;
+    int cached = 0;
+    int status = _cllGetPreparedStatement( icss, sql, &hstmt, &cached );
+    if ( status != 0 ) {
+        logBindVars( LOG_NOTICE, bindVars );
+        return -1;
+    }
+    SQLRETURN stat;
+
     icatStmtStrct * myStatement = ( icatStmtStrct * )malloc( sizeof( icatStmtStrct ) );
+    memset( myStatement, 0, sizeof( icatStmtStrct ) );
     icss->stmtPtr[statementNumber] = myStatement;
 
     myStatement->stmtPtr = hstmt;
@@ -809,12 +1022,13 @@ cllExecSqlWithResultBV(
             if ( stat != SQL_SUCCESS ) {
                 rodsLog( LOG_ERROR,
                          "cllExecSqlWithResultBV: SQLBindParameter failed: %d", stat );
+                cllFreeStatement( icss, statementNumber );
                 return -1;
             }
         }
     }
     rodsLogSql( sql );
-    stat = SQLExecDirect( hstmt, ( unsigned char * )sql, strlen( sql ) );
+    stat = SQLExecute( hstmt );
 
     switch ( stat ) {
     case SQL_SUCCESS:
@@ -841,10 +1055,11 @@ cllExecSqlWithResultBV(
             stat != SQL_NO_DATA_FOUND ) {
         logBindVars( LOG_NOTICE, bindVars );
         rodsLog( LOG_NOTICE,
-                 "cllExecSqlWithResultBV: SQLExecDirect error: %d, sql:%s",
+                 "cllExecSqlWithResultBV: SQLExecute error: %d, sql:%s",
                  stat, sql );
         logPsgError( LOG_NOTICE, icss->environPtr, myHdbc, hstmt,
                      icss->databaseType );
+        cllFreeStatement( icss, statementNumber );
         return -1;
     }
 
@@ -853,6 +1068,7 @@ cllExecSqlWithResultBV(
     if ( stat != SQL_SUCCESS ) {
         rodsLog( LOG_ERROR, "cllExecSqlWithResultBV: SQLNumResultCols failed: %d",
                  stat );
+        cllFreeStatement( icss, statementNumber );
         return -2;
     }
     myStatement->numOfCols = numColumns;
@@ -868,6 +1084,7 @@ cllExecSqlWithResultBV(
         if ( stat != SQL_SUCCESS ) {
             rodsLog( LOG_ERROR, "cllExecSqlWithResultBV: SQLDescribeCol failed: %d",
                      stat );
+            cllFreeStatement( icss, statementNumber );
             return -3;
         }
         /*  printf("colName='%s' precision=%d\n",colName, precision); */
@@ -879,6 +1096,7 @@ cllExecSqlWithResultBV(
             rodsLog( LOG_ERROR,
                      "cllExecSqlWithResultBV: SQLColAttributes failed: %d",
                      stat );
+            cllFreeStatement( icss, statementNumber );
             return -3;
         }
 
@@ -901,6 +1119,7 @@ cllExecSqlWithResultBV(
             rodsLog( LOG_ERROR,
                      "cllExecSqlWithResultBV: SQLColAttributes failed: %d",
                      stat );
+            cllFreeStatement( icss, statementNumber );
             return -4;
         }
 
@@ -991,7 +1210,7 @@ cllFreeStatement( icatSessionStruct *icss, int statementNumber ) {
 
     _cllFreeStatementColumns( icss, statementNumber );
 
-    SQLRETURN stat = SQLFreeHandle( SQL_HANDLE_STMT, myStatement->stmtPtr );
+    SQLRETURN stat = _cllFreeStatementHandle( myStatement->stmtPtr, 1 );
     if ( stat != SQL_SUCCESS ) {
         rodsLog( LOG_ERROR, "cllFreeStatement SQLFreeHandle for statement error: %d", stat );
     }
@@ -1028,7 +1247,9 @@ _cllFreeStatementColumns( icatSessionStruct *icss, int statementNumber ) {
 extern "C" int cllTest( const char *userArg, const char *pwArg ) {
 
     icatSessionStruct icss;
-    icss.stmtPtr[0] = 0;
+    for ( int i = 0; i < MAX_NUM_OF_CONCURRENT_STMTS; i++ ) {
+        icss.stmtPtr[i] = 0;
+    }
     strncpy( icss.database_plugin_type, "postgres", DB_TYPENAME_LEN );
     icss.databaseType = DB_TYPE_POSTGRES; // JMC - backport 4712
 #ifdef MY_ICAT
@@ -1129,6 +1350,41 @@ extern "C" int cllTest( const char *userArg, const char *pwArg ) {
         }
     }
 
+    /* a statement which fails gives back its slot and its cached
+       handle, so the same sql runs again more times than there are slots */
+    bindVars.clear();
+    bindVars.push_back( "not a number" );
+    for ( int i = 0; i <= MAX_NUM_OF_CONCURRENT_STMTS; i++ ) {
+        status = cllExecSqlWithResultBV( &icss, &stmt,
+                                         "select * from test where i = ?",
+                                         bindVars );
+        if ( status == 0 ) {
+            cllFreeStatement( &icss, stmt );
+        }
+#ifndef MY_ICAT
+        OK &= !!status; /* should fail, if not it's not OK */
+#endif
+        OK &= !cllExecSqlNoResult( &icss, "rollback" ); /* close the bad transaction*/
+    }
+    for ( int i = 0; i < MAX_NUM_OF_CONCURRENT_STMTS; i++ ) {
+        OK &= icss.stmtPtr[i] == 0;
+    }
+
+    bindVars.clear();
+    bindVars.push_back( "2" );
+    status = cllExecSqlWithResultBV( &icss, &stmt,
+                                     "select * from test where i = ?",
+                                     bindVars );
+    OK &= !status;
+    if ( status == 0 ) {
+        OK &= !cllGetRow( &icss, stmt );
+        OK &= icss.stmtPtr[stmt]->numOfCols == 3;
+        if ( icss.stmtPtr[stmt]->numOfCols == 3 ) {
+            OK &= strcmp( icss.stmtPtr[stmt]->resultValue[2], "a" ) == 0;
+        }
+        cllFreeStatement( &icss, stmt );
+    }
+
     status = cllExecSqlNoResult( &icss, "drop table test;" );
     OK &= ( status == 0 || status == CAT_SUCCESS_BUT_WITH_NO_INFO );
     OK &= !cllExecSqlNoResult( &icss, "commit" );
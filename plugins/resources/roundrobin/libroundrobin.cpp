@@ -15,6 +15,8 @@
 #include "irods_resource_redirect.hpp"
 #include "irods_stacktrace.hpp"
 #include "irods_server_api_call.hpp"
+#include "irods_kvp_string_parser.hpp"
+#include "irods_round_robin_cursor.hpp"
 #include "rs_set_round_robin_context.hpp"
 
 // =-=-=-=-=-=-=-
@@ -23,6 +25,7 @@
 #include <sstream>
 #include <vector>
 #include <string>
+#include <algorithm>
 
 // =-=-=-=-=-=-=-
 // boost includes
@@ -191,6 +194,25 @@ extern "C" {
     /// @brief token to index the vector of children
     const std::string CHILD_VECTOR_PROP( "round_robin_child_vector" );
 
+    /// =-=-=-=-=-=-=-
+    /// @brief token to index the next child to be written to the catalog
+    ///        once the create succeeds, empty when no write is due
+    const std::string CONTEXT_DUE_PROP( "round_robin_context_due" );
+
+    /// =-=-=-=-=-=-=-
+    /// @brief key in the context string and token in the property map for
+    ///        how children are chosen, in turn by default or in proportion
+    ///        to their free space
+    const std::string MODE_PROP( "round_robin_mode" );
+    const std::string MODE_FREE_SPACE( "free_space" );
+
+    /// =-=-=-=-=-=-=-
+    /// @brief the fractional part of the golden ratio in 64 bits.  the
+    ///        fractions of its multiples spread evenly over [0,1) whatever
+    ///        their count, so one counter spreads creates over the free
+    ///        space of all the children
+    const rodsULong_t GOLDEN_RATIO_FRACTION = 0x9E3779B97F4A7C15ULL;
+
     /// =-=-=-=-=-=-=-
     /// @brief build a sorted list of children based on hints in the context
     ///        string for them and their positoin in the child map
@@ -895,14 +917,19 @@ extern "C" {
         }
 
         // =-=-=-=-=-=-=-
-        // if file modified is successful then we will update the next
-        // child in the round robin within the database
+        // if file modified is successful and a create made by this agent
+        // left a write due, we will update the next child in the round
+        // robin within the database
+        std::string next_child;
+        _ctx.prop_map().get< std::string >( CONTEXT_DUE_PROP, next_child );
+        if ( next_child.empty() ) {
+            return SUCCESS();
+        }
+        _ctx.prop_map().set< std::string >( CONTEXT_DUE_PROP, "" );
+
         std::string name;
         _ctx.prop_map().get< std::string >( irods::RESOURCE_NAME, name );
 
-        std::string next_child;
-        _ctx.prop_map().get< std::string >( NEXT_CHILD_PROP, next_child );
-
         setRoundRobinContextInp_t inp;
         snprintf( inp.resc_name_, sizeof( inp.resc_name_ ), "%s", name.c_str() );
         snprintf( inp.context_, sizeof( inp.context_ ), "%s", next_child.c_str() );
@@ -1017,6 +1044,116 @@ extern "C" {
 
     } // get_next_valid_child_resource
 
+    /// =-=-=-=-=-=-=-
+    /// @brief find the child resource for a create operation from the
+    ///        position of this resource kept in shared memory, so that the
+    ///        agents on this server take turns without the catalog
+    irods::error get_next_child_from_cursor(
+        irods::plugin_property_map& _prop_map,
+        irods::resource_child_map&  _cmap,
+        irods::resource_ptr&        _resc ) {
+        std::string name;
+        irods::error err = _prop_map.get< std::string >( irods::RESOURCE_NAME, name );
+        if ( !err.ok() ) {
+            return PASSMSG( "failed to get property 'name'.", err );
+        }
+
+        std::vector< std::string > child_vector;
+        err = _prop_map.get( CHILD_VECTOR_PROP, child_vector );
+        if ( !err.ok() || child_vector.empty() ) {
+            return ERROR( -1, "get_next_child_from_cursor - failed to get child vector" );
+        }
+
+        std::string mode;
+        _prop_map.get< std::string >( MODE_PROP, mode );
+        bool free_space = ( MODE_FREE_SPACE == mode );
+
+        // =-=-=-=-=-=-=-
+        // gather the children which are not down, and their free space
+        // for the weighted mode
+        std::vector< size_t > up;
+        std::vector< double > weights;
+        double total = 0.0;
+        for ( size_t i = 0; i < child_vector.size(); ++i ) {
+            if ( !_cmap.has_entry( child_vector[ i ] ) ) {
+                continue;
+            }
+
+            irods::resource_ptr resc = _cmap[ child_vector[ i ] ].second;
+            int resc_status = 0;
+            err = resc->get_property<int>( irods::RESOURCE_STATUS, resc_status );
+            if ( !err.ok() ) {
+                return PASSMSG( "failed to get property", err );
+            }
+            if ( INT_RESC_STATUS_DOWN == resc_status ) {
+                continue;
+            }
+
+            long freespace = 0;
+            if ( free_space ) {
+                resc->get_property< long >( irods::RESOURCE_FREESPACE, freespace );
+            }
+            up.push_back( i );
+            weights.push_back( freespace > 0 ? ( double )freespace : 0.0 );
+            total += weights.back();
+        }
+
+        if ( up.empty() ) {
+            return ERROR( NO_NEXT_RESC_FOUND, "no valid child found" );
+        }
+
+        // =-=-=-=-=-=-=-
+        // the cursor counts turns among the children which are up.  a
+        // server seeing this resource for the first time carries on from
+        // the next child in the catalog, or the first one up after it
+        std::string next_child;
+        _prop_map.get< std::string >( NEXT_CHILD_PROP, next_child );
+        rodsULong_t seed = 0;
+        for ( size_t i = 0; i < child_vector.size(); ++i ) {
+            if ( next_child == child_vector[ i ] ) {
+                seed = std::lower_bound( up.begin(), up.end(), i ) - up.begin();
+                if ( seed >= up.size() ) {
+                    seed = 0;
+                }
+                break;
+            }
+        }
+
+        rodsULong_t position = 0;
+        err = irods::round_robin_cursor::next( name, seed, position );
+        if ( !err.ok() ) {
+            return PASS( err );
+        }
+
+        size_t pick = position % up.size();
+        if ( free_space && total > 0.0 ) {
+            rodsULong_t fraction = position * GOLDEN_RATIO_FRACTION;
+            double      target   = ( fraction / 18446744073709551616.0 ) * total;
+            for ( pick = 0; pick < up.size() - 1; ++pick ) {
+                if ( target < weights[ pick ] ) {
+                    break;
+                }
+                target -= weights[ pick ];
+            }
+        }
+
+        _resc = _cmap[ child_vector[ up[ pick ] ] ].second;
+
+        // =-=-=-=-=-=-=-
+        // every so many creates leave the next child to be written to
+        // the catalog, for a server which starts up to carry on from.
+        // a context string which sets a mode is kept as it was set
+        int interval = irods::round_robin_cursor::context_update_interval();
+        if ( mode.empty() && interval > 0 && 0 == ( position + 1 ) % interval ) {
+            _prop_map.set< std::string >(
+                CONTEXT_DUE_PROP,
+                child_vector[ up[ ( pick + 1 ) % up.size() ] ] );
+        }
+
+        return SUCCESS();
+
+    } // get_next_child_from_cursor
+
     /// =-=-=-=-=-=-=-
     /// @brief used to allow the resource to determine which host
     ///        should provide the requested operation
@@ -1096,12 +1233,23 @@ extern "C" {
         }
         else if ( irods::CREATE_OPERATION == ( *_opr ) ) {
             // =-=-=-=-=-=-=-
-            // get the next available child resource
+            // get the next available child resource, from the position
+            // shared by the agents on this server if it can be taken,
+            // otherwise from the next child held by this agent
             irods::resource_ptr resc;
-            irods::error err = get_next_valid_child_resource(
+            bool from_cursor = true;
+            irods::error err = get_next_child_from_cursor(
                                    _ctx.prop_map(),
                                    _ctx.child_map(),
                                    resc );
+            if ( !err.ok() && NO_NEXT_RESC_FOUND != err.code() ) {
+                irods::log( LOG_DEBUG, PASS( err ).result() );
+                from_cursor = false;
+                err = get_next_valid_child_resource(
+                          _ctx.prop_map(),
+                          _ctx.child_map(),
+                          resc );
+            }
             if ( !err.ok() ) {
                 return PASS( err );
 
@@ -1136,6 +1284,10 @@ extern "C" {
             std::string new_hier;
             _out_parser->str( new_hier );
 
+            if ( from_cursor ) {
+                return SUCCESS();
+            }
+
             // =-=-=-=-=-=-=-
             // update the next_child appropriately as the above succeeded
             err = update_next_child_resource( _ctx.prop_map() );
@@ -1144,6 +1296,17 @@ extern "C" {
 
             }
 
+            // =-=-=-=-=-=-=-
+            // without the shared position every create writes the next
+            // child to the catalog, unless the context string sets a mode
+            std::string mode;
+            _ctx.prop_map().get< std::string >( MODE_PROP, mode );
+            if ( mode.empty() ) {
+                std::string next_child;
+                _ctx.prop_map().get< std::string >( NEXT_CHILD_PROP, next_child );
+                _ctx.prop_map().set< std::string >( CONTEXT_DUE_PROP, next_child );
+            }
+
             return SUCCESS();
         }
 
@@ -1221,10 +1384,29 @@ extern "C" {
                                  const std::string& _context ) :
                 irods::resource( _inst_name, _context ) {
                 // =-=-=-=-=-=-=-
-                // assign context string as the next_child string
-                // in the property map.  this is used to keep track
-                // of the last used child in the vector
-                properties_.set< std::string >( NEXT_CHILD_PROP, context_ );
+                // a context string of key value pairs sets the mode,
+                // otherwise it is the next_child string written by a
+                // previous create
+                irods::kvp_map_t kvp;
+                irods::error ret = irods::parse_kvp_string(
+                                       _context,
+                                       kvp );
+                if ( ret.ok() && kvp.end() != kvp.find( MODE_PROP ) ) {
+                    properties_.set< std::string >( MODE_PROP, kvp[ MODE_PROP ] );
+                    properties_.set< std::string >( NEXT_CHILD_PROP, "" );
+                    if ( MODE_FREE_SPACE != kvp[ MODE_PROP ] ) {
+                        rodsLog( LOG_NOTICE, "roundrobin_resource :: unknown mode [%s], children are chosen in turn",
+                                 kvp[ MODE_PROP ].c_str() );
+                    }
+                }
+                else {
+                    // =-=-=-=-=-=-=-
+                    // assign context string as the next_child string
+                    // in the property map.  this is used to keep track
+                    // of the last used child in the vector
+                    properties_.set< std::string >( NEXT_CHILD_PROP, context_ );
+                }
+                properties_.set< std::string >( CONTEXT_DUE_PROP, "" );
                 rodsLog( LOG_DEBUG, "roundrobin_resource :: next_child [%s]", context_.c_str() );
 
                 set_start_operation( "round_robin_start_operation" );
@@ -17,6 +17,7 @@
 #include <string>
 #include <sstream>
 #include <fstream>
+#include <map>
 
 // =-=-=-=-=-=-=-
 // boost includes
@@ -40,16 +41,58 @@ typedef struct structFileDesc {
 
 #define CACHE_DIR_STR "cacheDir"
 
+#define INDEX_FILE_MAGIC "irods_struct_file_index"
+#define INDEX_FILE_VERSION 1
+#define INDEX_READ_SIZE (4*1024*1024)   /* archive read size when indexing */
+
+// =-=-=-=-=-=-=-
+// where the data of an open sub file comes from
+#define SUB_FILE_IN_CACHE   0   /* a file or dir in the cache dir */
+#define SUB_FILE_IN_ARCHIVE 1   /* a member read in place from the archive */
+#define SUB_DIR_IN_INDEX    2   /* a dir listed from the member index */
+
 typedef struct tarSubFileDesc {
     int inuseFlag;
     int structFileInx;
     int fd;                         /* the fd of the opened cached subFile */
     char cacheFilePath[MAX_NAME_LEN];   /* the phy path name of the cached
                                          * subFile */
+    int source;                     /* SUB_FILE_IN_CACHE, ... */
+    rodsLong_t dataOffset;          /* offset of the member data in the
+                                     * archive */
+    rodsLong_t dataSize;
+    rodsLong_t position;            /* read position in the member, or the
+                                     * next entry of an index dir listing */
+    rodsLong_t archivePosition;     /* offset of fd in the archive */
 } tarSubFileDesc_t;
 
 #define NUM_TAR_SUB_FILE_DESC 20
 
+// =-=-=-=-=-=-=-
+// a member of a struct file as recorded in its index.  members whose data
+// is stored uncompressed and contiguously in a tar file are read in place
+struct struct_file_member {
+    bool       dir_;
+    bool       in_place_;
+    rodsLong_t offset_;
+    rodsLong_t size_;
+    long       mtime_;
+    int        mode_;
+};
+
+typedef std::map< std::string, struct_file_member > struct_file_members;
+
+// =-=-=-=-=-=-=-
+// the members of a struct file keyed by their path within it, with the
+// size and mtime of the archive they were read from.  an index which is
+// not complete could not record every member
+struct member_index {
+    rodsLong_t          archive_size_;
+    long                archive_mtime_;
+    bool                complete_;
+    struct_file_members members_;
+};
+
 // =-=-=-=-=-=-=-
 // irods includes
 #include "rsGlobalExtern.hpp"
@@ -72,6 +115,12 @@ const int NUM_STRUCT_FILE_DESC = 16;
 structFileDesc_t PluginStructFileDesc[ NUM_STRUCT_FILE_DESC  ];
 tarSubFileDesc_t PluginTarSubFileDesc[ NUM_TAR_SUB_FILE_DESC ];
 
+// =-=-=-=-=-=-=-=-
+// member indices loaded by this agent, keyed by the physical path of the
+// struct file, and the names listed by dirs opened from an index
+std::map< std::string, member_index > PluginStructFileIndex;
+std::vector< std::string > PluginTarSubDirListing[ NUM_TAR_SUB_FILE_DESC ];
+
 // =-=-=-=-=-=-=-=-
 // manager of resource plugins which are resolved and cached
 extern irods::resource_manager resc_mgr;
@@ -90,6 +139,7 @@ extern "C" {
     void tarfilesystem_resource_stop() {
         memset( PluginStructFileDesc, 0, sizeof( structFileDesc_t ) * NUM_STRUCT_FILE_DESC );
         memset( PluginTarSubFileDesc, 0, sizeof( tarSubFileDesc_t ) * NUM_TAR_SUB_FILE_DESC );
+        PluginStructFileIndex.clear();
     }
 
     // =-=-=-=-=-=-=-
@@ -244,6 +294,78 @@ extern "C" {
 
     } // irods_file_read
 
+    // =-=-=-=-=-=-=-
+    // READ callback for use by libarchive which reads the archive a block
+    // at a time, so that member data can be skipped by irods_file_skip
+    ssize_t irods_file_read_block(
+        struct archive* _arch,
+        void*           _data,
+        const void**    _buff ) {
+        if ( !_arch ||
+                !_data ||
+                !_buff ) {
+            rodsLog( LOG_ERROR, "irods_file_read_block - null input" );
+            return ARCHIVE_FATAL;
+        }
+
+        // =-=-=-=-=-=-=-
+        // cast data pointer to the cb_struct
+        cb_ctx_t* cb_ctx = static_cast< cb_ctx_t* >( _data );
+
+        if ( !cb_ctx->read_buf.buf ) {
+            cb_ctx->read_buf.buf = malloc( INDEX_READ_SIZE );
+        }
+        cb_ctx->read_buf.len = INDEX_READ_SIZE;
+
+        fileReadInp_t r_inp;
+        memset( &r_inp, 0, sizeof( r_inp ) );
+        r_inp.fileInx = cb_ctx->idx_;
+        r_inp.len     = INDEX_READ_SIZE;
+        int status = rsFileRead( cb_ctx->desc_->rsComm, &r_inp, &cb_ctx->read_buf );
+        if ( status < 0 ) {
+            return -1;
+        }
+        else {
+            ( *_buff ) = cb_ctx->read_buf.buf;
+            return status;
+        }
+
+    } // irods_file_read_block
+
+    // =-=-=-=-=-=-=-
+    // SKIP callback for use by libarchive which seeks over data rather
+    // than reading it.  returning zero has libarchive read through instead
+    int64_t irods_file_skip(
+        struct archive* _arch,
+        void*           _data,
+        int64_t         _request ) {
+        if ( !_arch ||
+                !_data ) {
+            rodsLog( LOG_ERROR, "irods_file_skip - null input" );
+            return ARCHIVE_FATAL;
+        }
+
+        // =-=-=-=-=-=-=-
+        // cast data pointer to the cb_struct
+        cb_ctx_t* cb_ctx = static_cast< cb_ctx_t* >( _data );
+
+        fileLseekInp_t l_inp;
+        memset( &l_inp, 0, sizeof( l_inp ) );
+        l_inp.fileInx = cb_ctx->idx_;
+        l_inp.offset  = _request;
+        l_inp.whence  = SEEK_CUR;
+
+        fileLseekOut_t* l_out = NULL;
+        int status = rsFileLseek( cb_ctx->desc_->rsComm, &l_inp, &l_out );
+        if ( status < 0 || NULL == l_out ) {
+            return 0;
+        }
+
+        free( l_out );
+        return _request;
+
+    } // irods_file_skip
+
     // =-=-=-=-=-=-=-
     // CLOSE callback for use by libarchive which makes use of the
     // irods rsFile API for file access
@@ -616,13 +738,56 @@ extern "C" {
     } // match_struct_file_desc
 
     // =-=-=-=-=-=-=-
-    // local function to manage the open of a tar file
+    // resolve the name of the host of the leaf resource in a hierarchy
+    irods::error resolve_struct_file_host(
+        const std::string& _resc_hier,
+        std::string&       _resc_host ) {
+        // =-=-=-=-=-=-=-
+        // resolve the child resource by name
+        irods::resource_ptr resc;
+        std::string last_resc;
+        irods::hierarchy_parser parser;
+        parser.set_string( _resc_hier );
+        parser.last_resc( last_resc );
+        irods::error resc_err = resc_mgr.resolve( last_resc, resc );
+        if ( !resc_err.ok() ) {
+            std::stringstream msg;
+            msg << "resolve_struct_file_host - error returned from resolveResc for resource [";
+            msg << last_resc;
+            msg << "], status: ";
+            msg << resc_err.code();
+            return PASSMSG( msg.str(), resc_err );
+        }
+
+        // =-=-=-=-=-=-=-
+        // extract the name of the host of the resource from the resource plugin
+        rodsServerHost_t* rods_host = 0;
+        irods::error get_err = resc->get_property< rodsServerHost_t* >( irods::RESOURCE_HOST, rods_host );
+        if ( !get_err.ok() ) {
+            return PASSMSG( "failed to call get_property", get_err );
+        }
+
+        if ( !rods_host->hostName ) {
+            return ERROR( -1, "null rods server host" );
+        }
+
+        _resc_host = rods_host->hostName->name;
+
+        return SUCCESS();
+
+    } // resolve_struct_file_host
+
+    // =-=-=-=-=-=-=-
+    // local function to manage the open of a tar file.  the tar file is
+    // extracted into the cache dir unless _stage is false, for callers
+    // which can be served from the member index
     irods::error tar_struct_file_open(
         rsComm_t*          _comm,
         specColl_t*        _spec_coll,
         int&               _struct_desc_index,
         const std::string& _resc_hier,
-        std::string&       _resc_host ) {
+        std::string&       _resc_host,
+        bool               _stage = true ) {
         int status                  = 0;
         specCollCache_t* spec_cache = 0;
 
@@ -642,6 +807,20 @@ extern "C" {
         // look for opened PluginStructFileDesc
         _struct_desc_index = match_struct_file_desc( _spec_coll );
         if ( _struct_desc_index > 0 ) {
+            // =-=-=-=-=-=-=-
+            // the desc may have been opened without staging the tar file
+            irods::error host_err = resolve_struct_file_host( _resc_hier, _resc_host );
+            if ( !host_err.ok() ) {
+                return PASSMSG( "tar_struct_file_open - failed to resolve the host", host_err );
+            }
+
+            if ( _stage ) {
+                irods::error stage_err = stage_tar_struct_file( _struct_desc_index, _resc_host );
+                if ( !stage_err.ok() ) {
+                    return PASSMSG( "stage_tar_struct_file failed.", stage_err );
+                }
+            }
+
             return SUCCESS();
         }
 
@@ -683,46 +862,28 @@ extern "C" {
         PluginStructFileDesc[ _struct_desc_index ].rsComm = _comm;
 
         // =-=-=-=-=-=-=-
-        // resolve the child resource by name
-        irods::resource_ptr resc;
-        std::string last_resc;
-        irods::hierarchy_parser parser;
-        parser.set_string( _resc_hier );
-        parser.last_resc( last_resc );
-        irods::error resc_err = resc_mgr.resolve( last_resc, resc );
-        if ( !resc_err.ok() ) {
+        // resolve the host of the child resource
+        irods::error host_err = resolve_struct_file_host( _resc_hier, _resc_host );
+        if ( !host_err.ok() ) {
             std::stringstream msg;
-            msg << "tar_struct_file_open - error returned from resolveResc for resource [";
+            msg << "tar_struct_file_open - failed to resolve the host for resource [";
             msg << _spec_coll->resource;
-            msg << "], status: ";
-            msg << resc_err.code();
+            msg << "]";
             free_struct_file_desc( _struct_desc_index );
-            return PASSMSG( msg.str(), resc_err );
-        }
-
-        // =-=-=-=-=-=-=-
-        // extract the name of the host of the resource from the resource plugin
-        rodsServerHost_t* rods_host = 0;
-        irods::error get_err = resc->get_property< rodsServerHost_t* >( irods::RESOURCE_HOST, rods_host );
-        if ( !get_err.ok() ) {
-            return PASSMSG( "failed to call get_property", get_err );
+            return PASSMSG( msg.str(), host_err );
         }
 
-        if ( !rods_host->hostName ) {
-            return ERROR( -1, "null rods server host" );
-        }
-
-        _resc_host = rods_host->hostName->name;
-
         // =-=-=-=-=-=-=-
         // TODO :: need to deal with remote open here
 
         // =-=-=-=-=-=-=-
         // stage the tar file so we can get at its tasty innards
-        irods::error stage_err = stage_tar_struct_file( _struct_desc_index, _resc_host );
-        if ( !stage_err.ok() ) {
-            free_struct_file_desc( _struct_desc_index );
-            return PASSMSG( "stage_tar_struct_file failed.", stage_err );
+        if ( _stage ) {
+            irods::error stage_err = stage_tar_struct_file( _struct_desc_index, _resc_host );
+            if ( !stage_err.ok() ) {
+                free_struct_file_desc( _struct_desc_index );
+                return PASSMSG( "stage_tar_struct_file failed.", stage_err );
+            }
         }
 
         // =-=-=-=-=-=-=-
@@ -761,6 +922,547 @@ extern "C" {
 
     } // compose_cache_dir_physical_path
 
+    // =-=-=-=-=-=-=-
+    // the path of a member within its struct file, without a leading ./
+    // or / and without a trailing /.  the top of the struct file is ""
+    std::string normalize_member_path( const std::string& _path ) {
+        std::string path( _path );
+        while ( true ) {
+            if ( path.compare( 0, 2, "./" ) == 0 ) {
+                path.erase( 0, 2 );
+            }
+            else if ( path.compare( 0, 1, "/" ) == 0 ) {
+                path.erase( 0, 1 );
+            }
+            else {
+                break;
+            }
+        }
+
+        while ( !path.empty() && path[ path.size() - 1 ] == '/' ) {
+            path.erase( path.size() - 1 );
+        }
+
+        if ( path == "." ) {
+            path.clear();
+        }
+
+        return path;
+
+    } // normalize_member_path
+
+    // =-=-=-=-=-=-=-
+    // the key of a sub file in the member index of its struct file
+    irods::error compose_member_key(
+        specColl_t*        _spec_coll,
+        const std::string& _sub_file_path,
+        std::string&       _key ) {
+        size_t len = strlen( _spec_coll->collection );
+        if ( _sub_file_path.compare( 0, len, _spec_coll->collection ) != 0 ||
+                ( _sub_file_path.size() > len && _sub_file_path[ len ] != '/' ) ) {
+            std::stringstream msg;
+            msg << "compose_member_key - collection [";
+            msg << _spec_coll->collection;
+            msg << "] sub file path [";
+            msg << _sub_file_path;
+            msg << "] mismatch";
+            return ERROR( SYS_STRUCT_FILE_PATH_ERR, msg.str() );
+        }
+
+        _key = normalize_member_path( _sub_file_path.substr( len ) );
+
+        return SUCCESS();
+
+    } // compose_member_key
+
+    // =-=-=-=-=-=-=-
+    // stat the struct file itself for the size and mtime its index must match
+    irods::error stat_struct_file(
+        int                _index,
+        const std::string& _host,
+        rodsLong_t&        _size,
+        long&              _mtime ) {
+        specColl_t* spec_coll = PluginStructFileDesc[ _index ].specColl;
+
+        fileStatInp_t stat_inp;
+        memset( &stat_inp, 0, sizeof( stat_inp ) );
+        rstrcpy( stat_inp.fileName, spec_coll->phyPath, MAX_NAME_LEN );
+        snprintf( stat_inp.addr.hostAddr, NAME_LEN,     "%s", _host.c_str() );
+        snprintf( stat_inp.rescHier,      MAX_NAME_LEN, "%s", spec_coll->rescHier );
+        snprintf( stat_inp.objPath,       MAX_NAME_LEN, "%s", spec_coll->objPath );
+
+        rodsStat_t* stat_out = NULL;
+        int status = rsFileStat( PluginStructFileDesc[ _index ].rsComm, &stat_inp, &stat_out );
+        if ( status < 0 || NULL == stat_out ) {
+            std::stringstream msg;
+            msg << "stat_struct_file - failed on call to rsFileStat for [";
+            msg << spec_coll->phyPath;
+            msg << "]";
+            return ERROR( status, msg.str() );
+        }
+
+        _size  = stat_out->st_size;
+        _mtime = stat_out->st_mtim;
+        free( stat_out );
+
+        return SUCCESS();
+
+    } // stat_struct_file
+
+    // =-=-=-=-=-=-=-
+    // open the index kept alongside a struct file, or the struct file itself
+    int open_struct_file_path(
+        int                _index,
+        const std::string& _host,
+        const std::string& _path,
+        int                _flags ) {
+        specColl_t* spec_coll = PluginStructFileDesc[ _index ].specColl;
+
+        fileOpenInp_t f_inp;
+        memset( &f_inp, 0, sizeof( f_inp ) );
+        rstrcpy( f_inp.resc_name_,    spec_coll->resource, MAX_NAME_LEN );
+        rstrcpy( f_inp.resc_hier_,    spec_coll->rescHier, MAX_NAME_LEN );
+        rstrcpy( f_inp.objPath,       spec_coll->objPath,  MAX_NAME_LEN );
+        rstrcpy( f_inp.addr.hostAddr, _host.c_str(),       NAME_LEN );
+        rstrcpy( f_inp.fileName,      _path.c_str(),       MAX_NAME_LEN );
+        f_inp.mode  = getDefFileMode();
+        f_inp.flags = _flags;
+
+        return rsFileOpen( PluginStructFileDesc[ _index ].rsComm, &f_inp );
+
+    } // open_struct_file_path
+
+    // =-=-=-=-=-=-=-
+    // remove a file kept alongside a struct file
+    int unlink_struct_file_path(
+        int                _index,
+        const std::string& _host,
+        const std::string& _path ) {
+        specColl_t* spec_coll = PluginStructFileDesc[ _index ].specColl;
+
+        fileUnlinkInp_t unlink_inp;
+        memset( &unlink_inp, 0, sizeof( unlink_inp ) );
+        snprintf( unlink_inp.fileName,      MAX_NAME_LEN, "%s", _path.c_str() );
+        snprintf( unlink_inp.addr.hostAddr, NAME_LEN,     "%s", _host.c_str() );
+        snprintf( unlink_inp.rescHier,      MAX_NAME_LEN, "%s", spec_coll->rescHier );
+        snprintf( unlink_inp.objPath,       MAX_NAME_LEN, "%s", spec_coll->objPath );
+        return rsFileUnlink( PluginStructFileDesc[ _index ].rsComm, &unlink_inp );
+
+    } // unlink_struct_file_path
+
+    std::string struct_file_index_path( specColl_t* _spec_coll ) {
+        return std::string( _spec_coll->phyPath ) + STRUCT_FILE_INDEX_EXT;
+    }
+
+    // =-=-=-=-=-=-=-
+    // read the index kept alongside a struct file.  _writable is set if
+    // the index is missing or stale, but not if the file in its place is
+    // not an index
+    irods::error read_struct_file_index(
+        int                _index,
+        const std::string& _host,
+        member_index&      _idx,
+        bool&              _writable ) {
+        rsComm_t*   comm = PluginStructFileDesc[ _index ].rsComm;
+        std::string path = struct_file_index_path( PluginStructFileDesc[ _index ].specColl );
+
+        _writable = false;
+        int fd = open_struct_file_path( _index, _host, path, O_RDONLY );
+        if ( fd < 0 ) {
+            _writable = ( getErrno( fd ) == ENOENT );
+            return ERROR( fd, "read_struct_file_index - no index" );
+        }
+
+        // =-=-=-=-=-=-=-
+        // read the whole index
+        std::string contents;
+        bytesBuf_t  read_buf;
+        memset( &read_buf, 0, sizeof( read_buf ) );
+        read_buf.buf = malloc( INDEX_READ_SIZE );
+        int status = 0;
+        while ( true ) {
+            fileReadInp_t r_inp;
+            memset( &r_inp, 0, sizeof( r_inp ) );
+            r_inp.fileInx = fd;
+            r_inp.len     = read_buf.len = INDEX_READ_SIZE;
+            status = rsFileRead( comm, &r_inp, &read_buf );
+            if ( status <= 0 ) {
+                break;
+            }
+            contents.append( static_cast< char* >( read_buf.buf ), status );
+        }
+
+        free( read_buf.buf );
+
+        fileCloseInp_t close_inp;
+        memset( &close_inp, 0, sizeof( close_inp ) );
+        close_inp.fileInx = fd;
+        rsFileClose( comm, &close_inp );
+
+        if ( status < 0 ) {
+            return ERROR( status, "read_struct_file_index - failed to read the index" );
+        }
+
+        // =-=-=-=-=-=-=-
+        // the first line names the format and the archive it describes
+        std::istringstream in( contents );
+        std::string line;
+        std::getline( in, line );
+        std::istringstream header( line );
+        std::string magic;
+        int         version  = 0;
+        int         complete = 0;
+        header >> magic >> version >> _idx.archive_size_ >> _idx.archive_mtime_ >> complete;
+        if ( magic != INDEX_FILE_MAGIC ) {
+            return ERROR( SYS_STRUCT_FILE_PATH_ERR, "read_struct_file_index - not an index" );
+        }
+
+        _writable = true;
+        if ( version != INDEX_FILE_VERSION || header.fail() ) {
+            return ERROR( SYS_STRUCT_FILE_PATH_ERR, "read_struct_file_index - unsupported index version" );
+        }
+
+        _idx.complete_ = ( complete != 0 );
+        _idx.members_.clear();
+
+        // =-=-=-=-=-=-=-
+        // one member per line, the path last as it may hold spaces
+        while ( std::getline( in, line ) ) {
+            std::istringstream entry( line );
+            char               type     = 0;
+            int                in_place = 0;
+            struct_file_member member;
+            std::string        key;
+            entry >> type >> in_place >> member.offset_ >> member.size_ >> member.mtime_ >> member.mode_;
+            entry.get();
+            std::getline( entry, key );
+            if ( entry.fail() || key.empty() ) {
+                _idx.members_.clear();
+                return ERROR( SYS_STRUCT_FILE_PATH_ERR, "read_struct_file_index - malformed index" );
+            }
+
+            member.dir_      = ( type == 'd' );
+            member.in_place_ = ( in_place != 0 );
+            _idx.members_[ key ] = member;
+        }
+
+        return SUCCESS();
+
+    } // read_struct_file_index
+
+    // =-=-=-=-=-=-=-
+    // write the index alongside a struct file
+    irods::error write_struct_file_index(
+        int                 _index,
+        const std::string&  _host,
+        const member_index& _idx ) {
+        rsComm_t*   comm      = PluginStructFileDesc[ _index ].rsComm;
+        specColl_t* spec_coll = PluginStructFileDesc[ _index ].specColl;
+        std::string path      = struct_file_index_path( spec_coll );
+
+        std::stringstream out;
+        out << INDEX_FILE_MAGIC << " " << INDEX_FILE_VERSION << " "
+            << _idx.archive_size_ << " " << _idx.archive_mtime_ << " "
+            << ( _idx.complete_ ? 1 : 0 ) << "\n";
+        struct_file_members::const_iterator itr = _idx.members_.begin();
+        for ( ; itr != _idx.members_.end(); ++itr ) {
+            out << ( itr->second.dir_ ? 'd' : 'f' ) << " "
+                << ( itr->second.in_place_ ? 1 : 0 ) << " "
+                << itr->second.offset_ << " "
+                << itr->second.size_ << " "
+                << itr->second.mtime_ << " "
+                << itr->second.mode_ << " "
+                << itr->first << "\n";
+        }
+
+        // =-=-=-=-=-=-=-
+        // write a file of our own and rename it over the index, so that
+        // readers never see a partial index
+        std::stringstream tmp_path;
+        tmp_path << path << "." << getpid();
+        int fd = open_struct_file_path( _index, _host, tmp_path.str(), O_WRONLY | O_CREAT | O_TRUNC );
+        if ( fd < 0 ) {
+            std::stringstream msg;
+            msg << "write_struct_file_index - failed to open [";
+            msg << tmp_path.str();
+            msg << "]";
+            return ERROR( fd, msg.str() );
+        }
+
+        std::string contents = out.str();
+        fileWriteInp_t w_inp;
+        memset( &w_inp, 0, sizeof( w_inp ) );
+        w_inp.fileInx = fd;
+        w_inp.len     = contents.size();
+
+        bytesBuf_t write_buf;
+        write_buf.buf = const_cast< char* >( contents.c_str() );
+        write_buf.len = contents.size();
+        int status = rsFileWrite( comm, &w_inp, &write_buf );
+
+        fileCloseInp_t close_inp;
+        memset( &close_inp, 0, sizeof( close_inp ) );
+        close_inp.fileInx = fd;
+        rsFileClose( comm, &close_inp );
+
+        if ( status != ( int )contents.size() ) {
+            unlink_struct_file_path( _index, _host, tmp_path.str() );
+            std::stringstream msg;
+            msg << "write_struct_file_index - short write to [";
+            msg << tmp_path.str();
+            msg << "]";
+            return ERROR( status < 0 ? status : SYS_COPY_LEN_ERR, msg.str() );
+        }
+
+        fileRenameInp_t rename_inp;
+        memset( &rename_inp, 0, sizeof( rename_inp ) );
+        snprintf( rename_inp.oldFileName,   MAX_NAME_LEN, "%s", tmp_path.str().c_str() );
+        snprintf( rename_inp.newFileName,   MAX_NAME_LEN, "%s", path.c_str() );
+        snprintf( rename_inp.addr.hostAddr, NAME_LEN,     "%s", _host.c_str() );
+        snprintf( rename_inp.rescHier,      MAX_NAME_LEN, "%s", spec_coll->rescHier );
+        snprintf( rename_inp.objPath,       MAX_NAME_LEN, "%s", spec_coll->objPath );
+        fileRenameOut_t* ren_out = 0;
+        status = rsFileRename( comm, &rename_inp, &ren_out );
+        free( ren_out );
+        if ( status < 0 ) {
+            unlink_struct_file_path( _index, _host, tmp_path.str() );
+            std::stringstream msg;
+            msg << "write_struct_file_index - failed to rename [";
+            msg << tmp_path.str();
+            msg << "] to [";
+            msg << path;
+            msg << "]";
+            return ERROR( status, msg.str() );
+        }
+
+        return SUCCESS();
+
+    } // write_struct_file_index
+
+    // =-=-=-=-=-=-=-
+    // remove the index kept alongside a struct file
+    void unlink_struct_file_index(
+        int                _index,
+        const std::string& _host ) {
+        specColl_t* spec_coll = PluginStructFileDesc[ _index ].specColl;
+        PluginStructFileIndex.erase( spec_coll->phyPath );
+        unlink_struct_file_path( _index, _host, struct_file_index_path( spec_coll ) );
+
+    } // unlink_struct_file_index
+
+    // =-=-=-=-=-=-=-
+    // build the member index of a struct file by reading its headers.  the
+    // data of members is skipped, seeking over it when the archive is not
+    // compressed
+    irods::error build_struct_file_index(
+        int                _index,
+        const std::string& _host,
+        member_index&      _idx ) {
+        specColl_t* spec_coll = PluginStructFileDesc[ _index ].specColl;
+
+        struct archive* arch = archive_read_new();
+        archive_read_support_filter_all( arch );
+        archive_read_support_format_all( arch );
+
+        cb_ctx_t cb_ctx;
+        memset( &cb_ctx, 0, sizeof( cb_ctx_t ) );
+        cb_ctx.desc_ = &PluginStructFileDesc[ _index ];
+        snprintf( cb_ctx.loc_, sizeof( cb_ctx.loc_ ), "%s", _host.c_str() );
+
+        if ( archive_read_open2(
+                    arch,
+                    &cb_ctx,
+                    irods_file_open_for_read,
+                    irods_file_read_block,
+                    irods_file_skip,
+                    irods_file_close ) != ARCHIVE_OK ||
+                cb_ctx.idx_ < 0 ) {
+            std::stringstream msg;
+            msg << "build_struct_file_index - failed to open archive [";
+            msg << spec_coll->phyPath;
+            msg << "]";
+            archive_read_free( arch );
+            free( cb_ctx.read_buf.buf );
+            return ERROR( cb_ctx.idx_ < 0 ? cb_ctx.idx_ : SYS_STRUCT_FILE_PATH_ERR, msg.str() );
+        }
+
+        _idx.complete_ = true;
+        _idx.members_.clear();
+
+        int status = ARCHIVE_OK;
+        struct archive_entry* entry;
+        while ( true ) {
+            status = archive_read_next_header( arch, &entry );
+            if ( ARCHIVE_OK != status && ARCHIVE_WARN != status ) {
+                break;
+            }
+
+            std::string key = normalize_member_path( archive_entry_pathname( entry ) );
+            if ( key.empty() ) {
+                continue;
+            }
+
+            if ( key.find( '\n' ) != std::string::npos ) {
+                _idx.complete_ = false;
+                continue;
+            }
+
+            // =-=-=-=-=-=-=-
+            // only files and dirs are served.  symlinks in particular are
+            // left out, as they are when the archive is staged
+            mode_t type = archive_entry_filetype( entry );
+            if ( AE_IFREG != type && AE_IFDIR != type ) {
+                continue;
+            }
+
+            // =-=-=-=-=-=-=-
+            // once the header is read the archive has consumed everything
+            // before the data of the member, so in an uncompressed tar file
+            // the consumed byte count is where the data starts
+            struct_file_member member;
+            member.dir_      = ( AE_IFDIR == type );
+            member.offset_   = archive_filter_bytes( arch, 0 );
+            member.size_     = member.dir_ ? 0 : archive_entry_size( entry );
+            member.mtime_    = archive_entry_mtime( entry );
+            member.mode_     = archive_entry_perm( entry );
+            member.in_place_ = !member.dir_ &&
+                               ARCHIVE_FILTER_NONE == archive_filter_code( arch, 0 ) &&
+                               ARCHIVE_FORMAT_TAR == ( archive_format( arch ) & ARCHIVE_FORMAT_BASE_MASK ) &&
+                               NULL == archive_entry_hardlink( entry ) &&
+                               0 == archive_entry_sparse_count( entry ) &&
+                               member.offset_ >= 0 &&
+                               member.offset_ + member.size_ <= _idx.archive_size_;
+            _idx.members_[ key ] = member;
+
+            // =-=-=-=-=-=-=-
+            // archives need not list the parents of their members
+            size_t pos = key.rfind( '/' );
+            while ( pos != std::string::npos && pos > 0 ) {
+                std::string parent = key.substr( 0, pos );
+                if ( _idx.members_.find( parent ) != _idx.members_.end() ) {
+                    break;
+                }
+
+                struct_file_member dir;
+                dir.dir_      = true;
+                dir.in_place_ = false;
+                dir.offset_   = 0;
+                dir.size_     = 0;
+                dir.mtime_    = _idx.archive_mtime_;
+                dir.mode_     = DEFAULT_DIR_MODE;
+                _idx.members_[ parent ] = dir;
+                pos = parent.rfind( '/' );
+            }
+
+        } // while
+
+        archive_read_free( arch );
+        free( cb_ctx.read_buf.buf );
+
+        if ( ARCHIVE_EOF != status ) {
+            std::stringstream msg;
+            msg << "build_struct_file_index - failed to read the headers of [";
+            msg << spec_coll->phyPath;
+            msg << "]";
+            _idx.members_.clear();
+            return ERROR( SYS_STRUCT_FILE_PATH_ERR, msg.str() );
+        }
+
+        return SUCCESS();
+
+    } // build_struct_file_index
+
+    // =-=-=-=-=-=-=-
+    // find the member index of a struct file, loading it from alongside the
+    // struct file or building it if it is missing or does not match the
+    // struct file as it is now.  _rebuild builds it regardless, for a
+    // struct file just written
+    irods::error load_struct_file_index(
+        int                _index,
+        const std::string& _host,
+        member_index*&     _idx,
+        bool               _rebuild = false ) {
+        specColl_t* spec_coll = PluginStructFileDesc[ _index ].specColl;
+        if ( !spec_coll || strlen( spec_coll->phyPath ) == 0 ) {
+            return ERROR( SYS_STRUCT_FILE_DESC_ERR, "load_struct_file_index - bad special collection" );
+        }
+
+        rodsLong_t size  = 0;
+        long       mtime = 0;
+        irods::error ret = stat_struct_file( _index, _host, size, mtime );
+        if ( !ret.ok() ) {
+            return PASS( ret );
+        }
+
+        std::map< std::string, member_index >::iterator itr =
+            PluginStructFileIndex.find( spec_coll->phyPath );
+        if ( !_rebuild &&
+                itr != PluginStructFileIndex.end() &&
+                itr->second.archive_size_  == size &&
+                itr->second.archive_mtime_ == mtime ) {
+            _idx = &itr->second;
+            return SUCCESS();
+        }
+
+        member_index idx;
+        bool writable = false;
+        ret = read_struct_file_index( _index, _host, idx, writable );
+        if ( _rebuild || !ret.ok() || idx.archive_size_ != size || idx.archive_mtime_ != mtime ) {
+            idx.archive_size_  = size;
+            idx.archive_mtime_ = mtime;
+            ret = build_struct_file_index( _index, _host, idx );
+            if ( !ret.ok() ) {
+                return PASS( ret );
+            }
+
+            if ( writable ) {
+                ret = write_struct_file_index( _index, _host, idx );
+                if ( !ret.ok() ) {
+                    irods::log( PASS( ret ) );
+                }
+            }
+        }
+
+        member_index& cached = PluginStructFileIndex[ spec_coll->phyPath ];
+        cached.archive_size_  = idx.archive_size_;
+        cached.archive_mtime_ = idx.archive_mtime_;
+        cached.complete_      = idx.complete_;
+        cached.members_.swap( idx.members_ );
+        _idx = &cached;
+
+        return SUCCESS();
+
+    } // load_struct_file_index
+
+    // =-=-=-=-=-=-=-
+    // look up a sub file of a struct file which has not been staged.  fails
+    // if the struct file is staged, as the cache dir is then authoritative,
+    // or if it cannot be indexed
+    irods::error lookup_struct_file_member(
+        int                _index,
+        const std::string& _host,
+        const std::string& _sub_file_path,
+        member_index*&     _idx,
+        std::string&       _key ) {
+        specColl_t* spec_coll = PluginStructFileDesc[ _index ].specColl;
+        if ( !spec_coll || strlen( spec_coll->cacheDir ) > 0 ) {
+            return ERROR( SYS_STRUCT_FILE_DESC_ERR, "lookup_struct_file_member - struct file is staged" );
+        }
+
+        irods::error ret = compose_member_key( spec_coll, _sub_file_path, _key );
+        if ( !ret.ok() ) {
+            return PASS( ret );
+        }
+
+        ret = load_struct_file_index( _index, _host, _idx );
+        if ( !ret.ok() ) {
+            return PASS( ret );
+        }
+
+        return SUCCESS();
+
+    } // lookup_struct_file_member
+
     // =-=-=-=-=-=-=-
     // assign an new entry in the tar desc table
     int alloc_tar_sub_file_desc() {
@@ -788,6 +1490,7 @@ extern "C" {
         }
 
         memset( &PluginTarSubFileDesc[ _idx ], 0, sizeof( tarSubFileDesc_t ) );
+        PluginTarSubDirListing[ _idx ].clear();
 
         return 0;
     }
@@ -923,11 +1626,12 @@ extern "C" {
         }
 
         // =-=-=-=-=-=-=-
-        // open and stage the tar file, get its index
+        // open the tar file, get its index.  it is staged below unless the
+        // member can be read in place
         int struct_file_index = 0;
         std::string resc_host;
         irods::error open_err =  tar_struct_file_open( comm, spec_coll, struct_file_index,
-                                 fco->resc_hier(), resc_host );
+                                 fco->resc_hier(), resc_host, false );
         if ( !open_err.ok() ) {
             std::stringstream msg;
             msg << "tar_struct_file_open error for [";
@@ -950,6 +1654,47 @@ extern "C" {
         // cache struct file index into sub file index
         PluginTarSubFileDesc[ sub_index ].structFileInx = struct_file_index;
 
+        // =-=-=-=-=-=-=-
+        // a member of an unstaged tar file opened for read whose data is
+        // stored in place is read straight from the archive
+        member_index* idx = 0;
+        std::string key;
+        if ( ( fco->flags() & O_ACCMODE ) == O_RDONLY &&
+                lookup_struct_file_member( struct_file_index, resc_host, fco->sub_file_path(), idx, key ).ok() ) {
+            struct_file_members::iterator itr = idx->members_.find( key );
+            if ( itr != idx->members_.end() && itr->second.in_place_ ) {
+                int fd = open_struct_file_path( struct_file_index, resc_host, spec_coll->phyPath, O_RDONLY );
+                if ( fd < 0 ) {
+                    free_tar_sub_file_desc( sub_index );
+                    std::stringstream msg;
+                    msg << "tar_file_open_plugin - rsFileOpen failed for [";
+                    msg << spec_coll->phyPath;
+                    msg << "], status = ";
+                    msg << fd;
+                    return ERROR( fd, msg.str() );
+                }
+
+                PluginTarSubFileDesc[ sub_index ].fd              = fd;
+                PluginTarSubFileDesc[ sub_index ].source          = SUB_FILE_IN_ARCHIVE;
+                PluginTarSubFileDesc[ sub_index ].dataOffset      = itr->second.offset_;
+                PluginTarSubFileDesc[ sub_index ].dataSize        = itr->second.size_;
+                PluginTarSubFileDesc[ sub_index ].position        = 0;
+                PluginTarSubFileDesc[ sub_index ].archivePosition = 0;
+                PluginStructFileDesc[ struct_file_index ].openCnt++;
+                fco->file_descriptor( sub_index );
+                return CODE( sub_index );
+            }
+        }
+
+        // =-=-=-=-=-=-=-
+        // stage the tar file so we can get at its tasty innards
+        irods::error stage_err = stage_tar_struct_file( struct_file_index, resc_host );
+        if ( !stage_err.ok() ) {
+            free_tar_sub_file_desc( sub_index );
+            free_struct_file_desc( struct_file_index );
+            return PASSMSG( "stage_tar_struct_file failed.", stage_err );
+        }
+
         // =-=-=-=-=-=-=-
         // build a file open structure to pass off to the server api call
         fileOpenInp_t fileOpenInp;
@@ -1019,13 +1764,44 @@ extern "C" {
             return ERROR( SYS_STRUCT_FILE_DESC_ERR, msg.str() );
         }
 
+        // =-=-=-=-=-=-=-
+        // a member read in place is bounded by its extent in the archive,
+        // and the archive is only repositioned when a seek moved the member
+        tarSubFileDesc_t& sub_desc = PluginTarSubFileDesc[ fco->file_descriptor() ];
+        if ( SUB_FILE_IN_ARCHIVE == sub_desc.source ) {
+            rodsLong_t remaining = sub_desc.dataSize - sub_desc.position;
+            if ( remaining <= 0 ) {
+                return CODE( 0 );
+            }
+            if ( _len > remaining ) {
+                _len = ( int )remaining;
+            }
+
+            rodsLong_t offset = sub_desc.dataOffset + sub_desc.position;
+            if ( sub_desc.archivePosition != offset ) {
+                fileLseekInp_t fileLseekInp;
+                memset( &fileLseekInp, 0, sizeof( fileLseekInp ) );
+                fileLseekInp.fileInx = sub_desc.fd;
+                fileLseekInp.offset  = offset;
+                fileLseekInp.whence  = SEEK_SET;
+
+                fileLseekOut_t* fileLseekOut = NULL;
+                int status = rsFileLseek( fco->comm(), &fileLseekInp, &fileLseekOut );
+                if ( status < 0 || NULL == fileLseekOut ) {
+                    return ERROR( status, "rsFileLseek failed" );
+                }
+                free( fileLseekOut );
+                sub_desc.archivePosition = offset;
+            }
+        }
+
         // =-=-=-=-=-=-=-
         // build a read structure and make the rs call
         fileReadInp_t fileReadInp;
         bytesBuf_t fileReadOutBBuf;
         memset( &fileReadInp, 0, sizeof( fileReadInp ) );
         memset( &fileReadOutBBuf, 0, sizeof( fileReadOutBBuf ) );
-        fileReadInp.fileInx = PluginTarSubFileDesc[ fco->file_descriptor() ].fd;
+        fileReadInp.fileInx = sub_desc.fd;
         fileReadInp.len     = _len;
         fileReadOutBBuf.buf = _buf;
 
@@ -1036,6 +1812,10 @@ extern "C" {
             return ERROR( status, "rsFileRead failed" );
         }
         else {
+            if ( SUB_FILE_IN_ARCHIVE == sub_desc.source ) {
+                sub_desc.position        += status;
+                sub_desc.archivePosition += status;
+            }
             return CODE( status );
         }
 
@@ -1070,6 +1850,12 @@ extern "C" {
             return ERROR( SYS_STRUCT_FILE_DESC_ERR, msg.str() );
         }
 
+        // =-=-=-=-=-=-=-
+        // members read in place are only ever opened for read
+        if ( SUB_FILE_IN_CACHE != PluginTarSubFileDesc[ fco->file_descriptor() ].source ) {
+            return ERROR( UNIX_FILE_WRITE_ERR - EBADF, "tar_file_write_plugin - sub file is open for read" );
+        }
+
         // =-=-=-=-=-=-=-
         // build a write structure and make the rs call
         fileWriteInp_t fileWriteInp;
@@ -1276,7 +2062,7 @@ extern "C" {
         int struct_file_index = 0;
         std::string resc_host;
         irods::error open_err =  tar_struct_file_open( comm, spec_coll, struct_file_index,
-                                 fco->resc_hier(), resc_host );
+                                 fco->resc_hier(), resc_host, false );
         if ( !open_err.ok() ) {
             std::stringstream msg;
             msg << "tar_file_stat_plugin - tar_struct_file_open error for [";
@@ -1288,6 +2074,45 @@ extern "C" {
         // use the cached specColl. specColl may have changed
         spec_coll = PluginStructFileDesc[ struct_file_index ].specColl;
 
+        // =-=-=-=-=-=-=-
+        // a sub file of an unstaged tar file is answered from the index
+        member_index* idx = 0;
+        std::string key;
+        if ( lookup_struct_file_member( struct_file_index, resc_host, fco->sub_file_path(), idx, key ).ok() ) {
+            struct_file_member member;
+            member.dir_   = true;
+            member.size_  = 0;
+            member.mtime_ = idx->archive_mtime_;
+            member.mode_  = DEFAULT_DIR_MODE;
+
+            struct_file_members::iterator itr = idx->members_.find( key );
+            if ( itr != idx->members_.end() ) {
+                member = itr->second;
+            }
+            else if ( !key.empty() && idx->complete_ ) {
+                return ERROR( UNIX_FILE_STAT_ERR - ENOENT, "tar_file_stat_plugin - no such member" );
+            }
+
+            if ( key.empty() || itr != idx->members_.end() ) {
+                memset( _statbuf, 0, sizeof( struct stat ) );
+                _statbuf->st_mode  = ( member.dir_ ? S_IFDIR : S_IFREG ) | member.mode_;
+                _statbuf->st_size  = member.size_;
+                _statbuf->st_nlink = 1;
+                _statbuf->st_atime = member.mtime_;
+                _statbuf->st_mtime = member.mtime_;
+                _statbuf->st_ctime = member.mtime_;
+                return CODE( 0 );
+            }
+        }
+
+        // =-=-=-=-=-=-=-
+        // stage the tar file so we can get at its tasty innards
+        irods::error stage_err = stage_tar_struct_file( struct_file_index, resc_host );
+        if ( !stage_err.ok() ) {
+            free_struct_file_desc( struct_file_index );
+            return PASSMSG( "stage_tar_struct_file failed.", stage_err );
+        }
+
 
         // =-=-=-=-=-=-=-
         // build a file stat structure to pass off to the server api call
@@ -1359,6 +2184,29 @@ extern "C" {
             return ERROR( -1, "tar_file_lseek_plugin - null comm pointer in structure_object" );
         }
 
+        // =-=-=-=-=-=-=-
+        // a member read in place only moves its own position
+        tarSubFileDesc_t& sub_desc = PluginTarSubFileDesc[ fco->file_descriptor() ];
+        if ( SUB_FILE_IN_ARCHIVE == sub_desc.source ) {
+            rodsLong_t position = _offset;
+            if ( SEEK_CUR == _whence ) {
+                position += sub_desc.position;
+            }
+            else if ( SEEK_END == _whence ) {
+                position += sub_desc.dataSize;
+            }
+            else if ( SEEK_SET != _whence ) {
+                return ERROR( UNIX_FILE_LSEEK_ERR - EINVAL, "tar_file_lseek_plugin - bad whence" );
+            }
+
+            if ( position < 0 ) {
+                return ERROR( UNIX_FILE_LSEEK_ERR - EINVAL, "tar_file_lseek_plugin - negative offset" );
+            }
+
+            sub_desc.position = position;
+            return CODE( position );
+        }
+
         // =-=-=-=-=-=-=-
         // build a lseek structure and make the rs call
         fileLseekInp_t fileLseekInp;
@@ -1589,7 +2437,7 @@ extern "C" {
         int struct_file_index = 0;
         std::string resc_host;
         irods::error open_err =  tar_struct_file_open( comm, spec_coll, struct_file_index,
-                                 fco->resc_hier(), resc_host );
+                                 fco->resc_hier(), resc_host, false );
         if ( !open_err.ok() ) {
             std::stringstream msg;
             msg << "tar_file_opendir_plugin - tar_struct_file_open error for [";
@@ -1613,6 +2461,44 @@ extern "C" {
             return ERROR( sub_index, "tar_file_opendir_plugin - alloc_tar_sub_file_desc failed." );
         }
 
+        // =-=-=-=-=-=-=-
+        // a dir of an unstaged tar file is listed from the index, the
+        // members sorting directly after the dir's own path
+        PluginTarSubFileDesc[ sub_index ].structFileInx = struct_file_index;
+        member_index* idx = 0;
+        std::string key;
+        if ( lookup_struct_file_member( struct_file_index, resc_host, fco->sub_file_path(), idx, key ).ok() ) {
+            struct_file_members::iterator itr = idx->members_.find( key );
+            if ( key.empty() || ( itr != idx->members_.end() && itr->second.dir_ ) ) {
+                std::string prefix = key.empty() ? key : key + "/";
+                std::vector< std::string >& listing = PluginTarSubDirListing[ sub_index ];
+                listing.clear();
+                for ( itr = idx->members_.lower_bound( prefix );
+                        itr != idx->members_.end() && itr->first.compare( 0, prefix.size(), prefix ) == 0;
+                        ++itr ) {
+                    std::string name = itr->first.substr( prefix.size() );
+                    if ( name.find( '/' ) == std::string::npos ) {
+                        listing.push_back( name );
+                    }
+                }
+
+                PluginTarSubFileDesc[ sub_index ].source   = SUB_DIR_IN_INDEX;
+                PluginTarSubFileDesc[ sub_index ].position = 0;
+                PluginStructFileDesc[ struct_file_index ].openCnt++;
+                fco->file_descriptor( sub_index );
+                return CODE( sub_index );
+            }
+        }
+
+        // =-=-=-=-=-=-=-
+        // stage the tar file so we can get at its tasty innards
+        irods::error stage_err = stage_tar_struct_file( struct_file_index, resc_host );
+        if ( !stage_err.ok() ) {
+            free_tar_sub_file_desc( sub_index );
+            free_struct_file_desc( struct_file_index );
+            return PASSMSG( "stage_tar_struct_file failed.", stage_err );
+        }
+
         // =-=-=-=-=-=-=-
         // build a file open structure to pass off to the server api call
         fileOpendirInp_t fileOpendirInp;
@@ -1682,13 +2568,17 @@ extern "C" {
         }
 
         // =-=-=-=-=-=-=-
-        // build a file close dir structure to pass off to the server api call
-        fileClosedirInp_t fileClosedirInp;
-        memset( &fileClosedirInp, 0, sizeof( fileClosedirInp ) );
-        fileClosedirInp.fileInx = PluginTarSubFileDesc[ fco->file_descriptor() ].fd;
-        int status = rsFileClosedir( _ctx.comm(), &fileClosedirInp );
-        if ( status < 0 ) {
-            return ERROR( status, "tar_file_closedir_plugin - failed on call to rsFileClosedir" );
+        // build a file close dir structure to pass off to the server api call.
+        // a dir listed from the index has nothing open
+        int status = 0;
+        if ( SUB_DIR_IN_INDEX != PluginTarSubFileDesc[ fco->file_descriptor() ].source ) {
+            fileClosedirInp_t fileClosedirInp;
+            memset( &fileClosedirInp, 0, sizeof( fileClosedirInp ) );
+            fileClosedirInp.fileInx = PluginTarSubFileDesc[ fco->file_descriptor() ].fd;
+            status = rsFileClosedir( _ctx.comm(), &fileClosedirInp );
+            if ( status < 0 ) {
+                return ERROR( status, "tar_file_closedir_plugin - failed on call to rsFileClosedir" );
+            }
         }
 
         // =-=-=-=-=-=-=-
@@ -1730,6 +2620,26 @@ extern "C" {
             return ERROR( SYS_STRUCT_FILE_DESC_ERR, msg.str() );
         }
 
+        // =-=-=-=-=-=-=-
+        // hand out the next name of a dir listed from the index, -1 at the end
+        tarSubFileDesc_t& sub_desc = PluginTarSubFileDesc[ fco->file_descriptor() ];
+        if ( SUB_DIR_IN_INDEX == sub_desc.source ) {
+            std::vector< std::string >& listing = PluginTarSubDirListing[ fco->file_descriptor() ];
+            if ( sub_desc.position >= ( rodsLong_t )listing.size() ) {
+                return CODE( -1 );
+            }
+
+            if ( !( *_dirent_ptr ) ) {
+                ( *_dirent_ptr ) = ( rodsDirent_t* )malloc( sizeof( rodsDirent_t ) );
+            }
+            memset( *_dirent_ptr, 0, sizeof( rodsDirent_t ) );
+            rstrcpy( ( *_dirent_ptr )->d_name, listing[ sub_desc.position ].c_str(), DIR_LEN );
+            ( *_dirent_ptr )->d_namlen = strlen( ( *_dirent_ptr )->d_name );
+            ( *_dirent_ptr )->d_offset = ++sub_desc.position;
+
+            return CODE( 0 );
+        }
+
         // =-=-=-=-=-=-=-
         // build a file read dir structure to pass off to the server api call
         fileReaddirInp_t fileReaddirInp;
@@ -2435,6 +3345,15 @@ extern "C" {
 
         }
 
+        // =-=-=-=-=-=-=-
+        // index the members of the new tar file now, rather than on the
+        // first access once the cache dir is purged
+        member_index* idx = 0;
+        irods::error idx_err = load_struct_file_index( _index, _host, idx, true );
+        if ( !idx_err.ok() ) {
+            irods::log( PASSMSG( "sync_cache_dir_to_tar_file - failed to index the tar file", idx_err ) );
+        }
+
         // =-=-=-=-=-=-=-
         // update icat with the new size of the file
         if ( ( _opr_type & NO_REG_COLL_INFO ) == 0 ) {
@@ -2479,11 +3398,12 @@ extern "C" {
         }
 
         // =-=-=-=-=-=-=-
-        // open and stage the tar file, get its index
+        // open the tar file, get its index.  there is nothing to sync
+        // unless it has already been staged
         int struct_file_index = 0;
         std::string resc_host;
         irods::error open_err = tar_struct_file_open( comm, spec_coll, struct_file_index,
-                                fco->resc_hier(), resc_host );
+                                fco->resc_hier(), resc_host, false );
         if ( !open_err.ok() ) {
             std::stringstream msg;
             msg << "tar_file_sync_plugin - tar_struct_file_open error for [";
@@ -2509,6 +3429,7 @@ extern "C" {
         // delete operation
         if ( ( fco->opr_type() & DELETE_STRUCT_FILE ) != 0 ) {
             /* remove cache and the struct file */
+            unlink_struct_file_index( struct_file_index, resc_host );
             free_struct_file_desc( struct_file_index );
             return SUCCESS();
         }
@@ -172,3 +172,30 @@ class Test_Auth(resource_suite.ResourceBase, unittest.TestCase):
         print initial_contents
         print final_contents
         assert initial_contents == final_contents
+
+    @unittest.skipIf(configuration.TOPOLOGY_FROM_RESOURCE_SERVER, "Skip for topology testing from resource server")
+    def test_authentication_session_cache(self):
+        self.auth_session.environment_file_contents['irods_authentication_session_cache'] = 1
+        password_file = os.path.join(self.auth_session.local_session_dir, 'irods_authentication')
+        session_file = password_file + '.session'
+        try:
+            # the first login saves a token, the next resumes with it alone
+            self.auth_session.assert_icommand('ils', 'STDOUT_SINGLELINE', self.auth_session.home_collection)
+            assert os.path.exists(session_file)
+            os.unlink(password_file)
+            self.auth_session.assert_icommand('ils', 'STDOUT_SINGLELINE', self.auth_session.home_collection)
+
+            # a password change revokes the token, and there is no password
+            # to fall back on
+            self.admin.assert_icommand(['iadmin', 'moduser', self.auth_session.username, 'password', 'newsessionpassword'])
+            self.auth_session.assert_icommand('ils', 'STDERR_SINGLELINE', 'CAT_INVALID_AUTHENTICATION')
+            self.auth_session.assert_icommand(['iinit', 'newsessionpassword'])
+            self.auth_session.assert_icommand('ils', 'STDOUT_SINGLELINE', self.auth_session.home_collection)
+
+            # iexit drops the token with the password
+            self.auth_session.assert_icommand('iexit full')
+            assert not os.path.exists(session_file)
+        finally:
+            del self.auth_session.environment_file_contents['irods_authentication_session_cache']
+            self.admin.assert_icommand(['iadmin', 'moduser', self.auth_session.username, 'password', self.auth_session.password])
+            self.auth_session.assert_icommand(['iinit', self.auth_session.password])
@@ -184,6 +184,70 @@ class Test_Catalog(ResourceBase, unittest.TestCase):
         self.admin.assert_icommand("iquest \"%s %s\" \"select COLL_NAME where COLL_NAME like '%home%'\"",
                                    'STDERR_SINGLELINE', 'boost::too_few_args: format-string referred to more arguments than were passed')
 
+    def test_iquest_no_page_streams_all_rows(self):
+        # more rows than a single default page
+        local_dir = 'iquest_stream_dir'
+        file_count = 600
+        file_names = set(lib.make_large_local_tmp_dir(local_dir, file_count, 10))
+        self.admin.assert_icommand(['iput', '-r', local_dir])
+        rc, stdout, stderr = self.admin.run_icommand(['iquest', '--no-page', '%s',
+                                                      "select DATA_NAME where COLL_NAME like '%/" + local_dir + "'"])
+        self.assertEqual(rc, 0, msg=stderr)
+        self.assertEqual(file_names, set(stdout.split()))
+        self.assertEqual(file_count, len(stdout.split()))
+        self.admin.assert_icommand(['irm', '-rf', local_dir])
+        lib.run_command(['rm', '-rf', local_dir])
+
+    def test_genquery_repeated_shapes_with_different_values(self):
+        # each shape is asked for more than once with other values by the
+        # same agent, so the later queries reuse the SQL of the first
+        expected = [
+            ("DATA_NAME = 'f1'", ['f1']),
+            ("DATA_NAME = 'f2'", ['f2']),
+            ("DATA_NAME = 'none'", []),
+            ("DATA_NAME in ('f1', 'f2')", ['f1', 'f2']),
+            ("DATA_NAME in ('f3')", ['f3']),
+            ("DATA_NAME in ('f1', 'f2', 'f3')", ['f1', 'f2', 'f3']),
+            ("DATA_SIZE between '2' '3'", ['f2', 'f3']),
+            ("DATA_SIZE between '1' '1'", ['f1']),
+            ("DATA_NAME like 'f%'", ['f1', 'f2', 'f3']),
+            ("DATA_NAME like '%3'", ['f3']),
+            ("DATA_NAME = 'f3'", ['f3']),
+        ]
+        for i in range(1, 4):
+            filename = 'f' + str(i)
+            lib.make_file(os.path.join(self.user0.local_session_dir, filename), i)
+            self.user0.assert_icommand(['iput', os.path.join(self.user0.local_session_dir, filename)])
+
+        rule_file = os.path.join(self.user0.local_session_dir, 'genquery_shapes.r')
+        with open(rule_file, 'w') as f:
+            f.write('''genqueryShapes {
+    foreach(*c in list(%s)) {
+        msiMakeGenQuery("DATA_NAME", "COLL_NAME = '*coll' and *c", *q);
+        *names = "";
+        *e = errorcode(msiExecGenQuery(*q, *r));
+        if (*e == 0) {
+            foreach(*r) {
+                msiGetValByKey(*r, "DATA_NAME", *n);
+                *names = *names ++ " " ++ *n;
+            }
+        }
+        writeLine("stdout", "*c:*names");
+    }
+}
+INPUT *coll="%s"
+OUTPUT ruleExecOut
+''' % (', '.join('"' + c + '"' for c, _ in expected), self.user0.session_collection))
+
+        # the owner sees the objects, another user none of them
+        for session, visible in ((self.user0, True), (self.user1, False)):
+            rc, stdout, stderr = session.run_icommand(['irule', '-F', rule_file])
+            self.assertEqual(rc, 0, msg=stderr)
+            results = [line.split(':', 1) for line in stdout.splitlines() if ':' in line]
+            self.assertEqual([c for c, _ in expected], [c for c, _ in results])
+            for (condition, names), (_, found) in zip(expected, results):
+                self.assertEqual(names if visible else [], sorted(found.split()), msg=condition)
+
     ###################
     # isysmeta
     ###################
@@ -4,6 +4,7 @@ if sys.version_info >= (2, 7):
 else:
     import unittest2 as unittest
 import commands
+import filecmp
 import os
 import stat
 import datetime
@@ -58,6 +59,7 @@ class ChunkyDevTest(ResourceBase):
         self.admin.assert_icommand("iexecmd hello", 'STDOUT_SINGLELINE', "Hello world")
         self.admin.assert_icommand("ips -v", 'STDOUT_SINGLELINE', "ips")
         self.admin.assert_icommand("iqstat", 'STDOUT_SINGLELINE', "No delayed rules pending for user " + self.admin.username)
+        self.admin.assert_icommand("iqstat -s", 'STDOUT_SINGLELINE', "due:     0")
 
         # put and list basic file information
         self.admin.assert_icommand("ils -AL", 'STDOUT_SINGLELINE', "home")  # debug
@@ -497,6 +499,77 @@ class ChunkyDevTest(ResourceBase):
         if os.path.exists(myldir):
             shutil.rmtree(myldir)
 
+    def test_mcoll_tar_member_index(self):
+        irodshome = self.admin.session_collection
+        progname = __file__
+        self.admin.assert_icommand("imkdir " + irodshome + "/icmdtest_idx")
+        self.admin.assert_icommand("iput " + progname + " " + irodshome + "/icmdtest_idx/foo1")
+        self.admin.assert_icommand("ibun -c " + irodshome + "/icmdtest_idx.tar " + irodshome + "/icmdtest_idx")
+        self.admin.assert_icommand("imkdir " + irodshome + "/icmdtest_idx_mcol")
+        self.admin.assert_icommand("imcoll -m tar " + irodshome + "/icmdtest_idx.tar " + irodshome + "/icmdtest_idx_mcol")
+        tar_path = self.admin.run_icommand(['iquest', '%s', "select DATA_PATH where COLL_NAME = '" + irodshome +
+                                            "' and DATA_NAME = 'icmdtest_idx.tar'"])[1].strip()
+        index_path = tar_path + ".structFileIndex"
+        member = irodshome + "/icmdtest_idx_mcol/icmdtest_idx/foo1"
+        local_member = "./foo1_idx"
+
+        def get_member():
+            if os.path.exists(local_member):
+                os.unlink(local_member)
+            self.admin.assert_icommand("iget " + member + " " + local_member)
+            assert filecmp.cmp(progname, local_member, shallow=False)
+
+        # the first read builds the index beside the tar file
+        get_member()
+        assert os.path.exists(index_path)
+        with open(index_path) as f:
+            header = f.readline().split()
+        assert header[0] == "irods_struct_file_index"
+        assert int(header[2]) == os.stat(tar_path).st_size
+
+        # a missing index is rebuilt
+        os.unlink(index_path)
+        get_member()
+        assert os.path.exists(index_path)
+
+        # so is one describing another archive, and no partial file is left
+        with open(index_path, 'w') as f:
+            f.write("irods_struct_file_index 1 1 1 1\nf 1 0 1 1 33188 icmdtest_idx/foo1\n")
+        get_member()
+        with open(index_path) as f:
+            header = f.readline().split()
+        assert int(header[2]) == os.stat(tar_path).st_size
+        assert [p for p in os.listdir(os.path.dirname(tar_path))
+                if p.startswith(os.path.basename(index_path) + ".")] == []
+
+        # the index goes with the tar file
+        self.admin.assert_icommand("imcoll -U " + irodshome + "/icmdtest_idx_mcol")
+        self.admin.assert_icommand("irm -f " + irodshome + "/icmdtest_idx.tar")
+        assert not os.path.exists(tar_path)
+        assert not os.path.exists(index_path)
+
+        # a tar put as a generic file is given the tar data type when mounted,
+        # so its index is still found on delete
+        self.admin.assert_icommand("ibun -c " + irodshome + "/icmdtest_idx.tar " + irodshome + "/icmdtest_idx")
+        self.admin.assert_icommand("iget " + irodshome + "/icmdtest_idx.tar ./icmdtest_idx_local.tar")
+        self.admin.assert_icommand("irm -f " + irodshome + "/icmdtest_idx.tar")
+        self.admin.assert_icommand("iput -D generic ./icmdtest_idx_local.tar " + irodshome + "/icmdtest_idx.tar")
+        os.unlink("./icmdtest_idx_local.tar")
+        self.admin.assert_icommand("imcoll -m tar " + irodshome + "/icmdtest_idx.tar " + irodshome + "/icmdtest_idx_mcol")
+        self.admin.assert_icommand(['iquest', '%s', "select DATA_TYPE_NAME where COLL_NAME = '" + irodshome +
+                                    "' and DATA_NAME = 'icmdtest_idx.tar'"], 'STDOUT_SINGLELINE', 'tar file')
+        tar_path = self.admin.run_icommand(['iquest', '%s', "select DATA_PATH where COLL_NAME = '" + irodshome +
+                                            "' and DATA_NAME = 'icmdtest_idx.tar'"])[1].strip()
+        index_path = tar_path + ".structFileIndex"
+        get_member()
+        assert os.path.exists(index_path)
+        self.admin.assert_icommand("imcoll -U " + irodshome + "/icmdtest_idx_mcol")
+        self.admin.assert_icommand("irm -f " + irodshome + "/icmdtest_idx.tar")
+        assert not os.path.exists(index_path)
+
+        os.unlink(local_member)
+        self.admin.assert_icommand("irm -rf " + irodshome + "/icmdtest_idx " + irodshome + "/icmdtest_idx_mcol")
+
     def test_phybun_from_devtest(self):
         with lib.make_session_for_existing_admin() as rods_admin:
             rods_admin.run_icommand(['ichmod', 'own', self.admin.username, '/' + self.admin.zone_name])
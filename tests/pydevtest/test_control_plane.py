@@ -5,6 +5,7 @@ if sys.version_info < (2, 7):
 else:
     import unittest
 
+import json
 import os
 import time
 
@@ -31,6 +32,47 @@ class TestControlPlane(unittest.TestCase):
         # test grid status
         lib.assert_command('irods-grid status --all', 'STDOUT_SINGLELINE', 'hosts')
 
+    @unittest.skipIf(configuration.RUN_IN_TOPOLOGY, 'Skip for Topology Testing: No way to restart grid')
+    def test_rule_profile(self):
+        rule_file = 'test_rule_profile.r'
+        with open(rule_file, 'w') as f:
+            f.write('test_rule_profile_rule {\n    msiGetSystemTime(*t, "");\n}\nINPUT null\nOUTPUT ruleExecOut\n')
+
+        server_config_filename = lib.get_irods_config_dir() + '/server_config.json'
+        with lib.file_backed_up(server_config_filename):
+            with open(server_config_filename) as f:
+                server_config = json.load(f)
+            server_config['advanced_settings']['rule_engine_profiling'] = 1
+            lib.update_json_file_from_dict(server_config_filename, server_config)
+            lib.restart_irods_server()
+
+            try:
+                # each agent adds its counts to the report as it exits
+                with lib.make_session_for_existing_admin() as admin_session:
+                    for i in range(3):
+                        admin_session.assert_icommand('irule -F ' + rule_file)
+
+                _, out, _ = lib.run_command('irods-grid rule_profile --all', check_rc=True)
+                hosts = json.loads(out)['hosts']
+                assert [h for h in hosts if h['enabled']], out
+                entries = {}
+                for h in hosts:
+                    for e in h['rules']:
+                        entries[(e['type'], e['name'])] = e
+
+                rule = entries.get(('rule', 'test_rule_profile_rule'))
+                assert rule, out
+                assert rule['calls'] == 3, rule
+                assert rule['inclusive_milliseconds'] >= rule['exclusive_milliseconds'], rule
+
+                microservice = entries.get(('microservice', 'msiGetSystemTime'))
+                assert microservice, out
+                assert microservice['calls'] >= 3, microservice
+            finally:
+                os.unlink(rule_file)
+
+        lib.restart_irods_server()
+
     @unittest.skipIf(configuration.RUN_IN_TOPOLOGY, 'Skip for Topology Testing: No way to restart grid')
     def test_shutdown(self):
         # test shutdown
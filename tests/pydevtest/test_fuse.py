@@ -6,10 +6,12 @@ else:
 from resource_suite import ResourceBase
 import commands
 import distutils.spawn
+import hashlib
 import os
 import subprocess
 import stat
 import socket
+import time
 import lib
 
 
@@ -21,6 +23,33 @@ class Test_Fuse(ResourceBase, unittest.TestCase):
     def tearDown(self):
         super(Test_Fuse, self).tearDown()
 
+    def mount_irodsFs(self, mount_point, settings):
+        # the cache settings are read from the environment when irodsFs starts
+        if not os.path.isdir(mount_point):
+            os.mkdir(mount_point)
+        env = os.environ.copy()
+        env.update(settings)
+        assert subprocess.call(['irodsFs', mount_point], env=env) == 0
+
+    def unmount_irodsFs(self, mount_point):
+        os.system("fusermount -uz " + mount_point)
+        if os.path.isdir(mount_point):
+            os.rmdir(mount_point)
+
+    def md5_of(self, filename):
+        with open(filename, 'rb') as f:
+            return hashlib.md5(f.read()).hexdigest()
+
+    def wait_for_data_size(self, data_name, size):
+        # a file is sent when the kernel releases it, which is after close
+        for _ in range(60):
+            _, out, _ = lib.run_command(['iquest', '%s',
+                "select DATA_SIZE where DATA_NAME = '" + data_name + "'"])
+            if out.strip() == str(size):
+                return
+            time.sleep(1)
+        assert False, data_name + " never reached " + str(size) + " bytes: " + out
+
     def test_irodsFs_issue_2252(self):
         # =-=-=-=-=-=-=-
         # set up a fuse mount
@@ -141,3 +170,96 @@ class Test_Fuse(ResourceBase, unittest.TestCase):
         os.system("fusermount -uz " + mount_point)
         if os.path.isdir(mount_point):
             os.rmdir(mount_point)
+
+    def test_irodsFs_block_cache_and_readahead(self):
+        mount_point = "fuse_block_cache_mount_point"
+        data_name = "block_cache_file"
+        file_size = 20 * 1024 * 1024
+        lib.make_file(data_name, file_size, source='/dev/urandom')
+        lib.run_command(['iput', '-f', data_name], check_rc=True)
+        with open(data_name, 'rb') as f:
+            local_data = f.read()
+
+        # small blocks and a budget well under the file size, so the reads
+        # below run through readahead, eviction and blocks read again
+        self.mount_irodsFs(mount_point, {'FuseBlockCacheSize': '4',
+                                         'FuseBlockCacheBlockSize': '64',
+                                         'FuseReadAheadBlocks': '8',
+                                         'FuseReadAheadThreads': '2'})
+        try:
+            mounted_name = os.path.join(mount_point, data_name)
+
+            # sequential reads, twice
+            for _ in range(2):
+                assert self.md5_of(mounted_name) == hashlib.md5(local_data).hexdigest()
+
+            # reads across block boundaries, in no particular order
+            with open(mounted_name, 'rb') as f:
+                for offset in [file_size - 100, 0, 65536 - 10, 7 * 65536 + 1, file_size / 2, 65536 - 10]:
+                    f.seek(offset)
+                    assert f.read(100) == local_data[offset:offset + 100], offset
+
+            # a write through the mount drops the cached blocks
+            patch = 'x' * 200
+            with open(mounted_name, 'r+b') as f:
+                f.seek(65536 - 100)
+                f.write(patch)
+            local_data = local_data[:65536 - 100] + patch + local_data[65536 + 100:]
+            with open(mounted_name, 'rb') as f:
+                f.seek(65536 - 150)
+                assert f.read(300) == local_data[65536 - 150:65536 + 150]
+        finally:
+            self.unmount_irodsFs(mount_point)
+
+        # and the object itself has the write
+        os.unlink(data_name)
+        lib.run_command(['iget', data_name], check_rc=True)
+        assert self.md5_of(data_name) == hashlib.md5(local_data).hexdigest()
+        os.unlink(data_name)
+        lib.run_command(['irm', '-f', data_name])
+
+        # with the block cache off the reads go to iRODS as before
+        self.mount_irodsFs(mount_point, {'FuseBlockCacheSize': '0'})
+        try:
+            lib.make_file(data_name, file_size, source='/dev/urandom')
+            lib.run_command(['iput', '-f', data_name], check_rc=True)
+            assert self.md5_of(os.path.join(mount_point, data_name)) == self.md5_of(data_name)
+        finally:
+            self.unmount_irodsFs(mount_point)
+            os.unlink(data_name)
+            lib.run_command(['irm', '-f', data_name])
+
+    def test_irodsFs_write_back(self):
+        mount_point = "fuse_write_back_mount_point"
+        # two files which fit in the spool together, one which waits for
+        # room, and one which never fits and is sent as it goes
+        sizes = {'write_back_small0': 6 * 1024 * 1024,
+                 'write_back_small1': 6 * 1024 * 1024,
+                 'write_back_small2': 6 * 1024 * 1024,
+                 'write_back_large': 40 * 1024 * 1024}
+        for name, size in sizes.items():
+            lib.make_file(name, size, source='/dev/urandom')
+
+        self.mount_irodsFs(mount_point, {'FuseWriteBackSize': '16'})
+        try:
+            copies = [subprocess.Popen(['cp', name, os.path.join(mount_point, name)]) for name in sizes]
+            for copy in copies:
+                assert copy.wait() == 0
+            for name, size in sizes.items():
+                self.wait_for_data_size(name, size)
+
+            # an existing object opened with truncation is spooled too
+            overwrite = 'write_back_small0'
+            lib.make_file(overwrite, 3 * 1024 * 1024, source='/dev/urandom')
+            sizes[overwrite] = 3 * 1024 * 1024
+            assert subprocess.call(['cp', overwrite, os.path.join(mount_point, overwrite)]) == 0
+            self.wait_for_data_size(overwrite, sizes[overwrite])
+        finally:
+            self.unmount_irodsFs(mount_point)
+
+        for name in sizes:
+            lib.run_command(['iget', '-f', name, name + '.get'], check_rc=True)
+            assert self.md5_of(name + '.get') == self.md5_of(name), name
+            os.unlink(name + '.get')
+            os.unlink(name)
+            lib.run_command(['irm', '-f', name])
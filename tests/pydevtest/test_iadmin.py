@@ -995,6 +995,102 @@ class Test_Iadmin(resource_suite.ResourceBase, unittest.TestCase):
         self.admin.assert_icommand('iadmin rum')
         self.admin.assert_icommand_fail('''iquest "select META_DATA_ATTR_NAME where META_DATA_ATTR_NAME = '{a}'"'''.format(**vars()), 'STDOUT_SINGLELINE', a)
 
+    def test_quota_usage_reconcile(self):
+        filename = 'quota_usage_reconcile_file'
+        lib.make_file(filename, 1024)
+        self.admin.assert_icommand('iput ' + filename)
+        self.admin.assert_icommand('iadmin suq {0} total 10'.format(self.admin.username))
+        try:
+            self.admin.assert_icommand('iadmin cu reconcile 1000')
+            self.admin.assert_icommand('iquota', 'STDOUT_SINGLELINE', 'OVER QUOTA')
+            self.admin.assert_icommand('iadmin cu reconcile 0', 'STDERR_SINGLELINE', 'CAT_INVALID_ARGUMENT')
+        finally:
+            self.admin.assert_icommand('iadmin suq {0} total 0'.format(self.admin.username))
+            self.admin.assert_icommand('irm -f ' + filename)
+            os.unlink(filename)
+
+    def test_resource_cache_invalidation(self):
+        filename = 'resource_cache_invalidation_file'
+        lib.make_file(filename, 100)
+        vault1 = lib.get_irods_top_level_dir() + '/cacheRescVault1'
+        vault2 = lib.get_irods_top_level_dir() + '/cacheRescVault2'
+        logical_path = os.path.join(self.admin.session_collection, filename)
+        server_config_filename = lib.get_irods_config_dir() + '/server_config.json'
+        with lib.file_backed_up(server_config_filename):
+            # a lifetime longer than the test, so only an invalidation
+            # makes a change visible to the next agent
+            with open(server_config_filename) as f:
+                server_config = json.load(f)
+            server_config['advanced_settings']['resource_cache_lifetime_in_seconds'] = 600
+            lib.update_json_file_from_dict(server_config_filename, server_config)
+
+            self.admin.assert_icommand('iadmin mkresc cachePtResc passthru', 'STDOUT_SINGLELINE', 'passthru')
+            self.admin.assert_icommand('iadmin mkresc cacheLeafResc unixfilesystem ' + configuration.HOSTNAME_1 + ':' + vault1,
+                                       'STDOUT_SINGLELINE', 'unixfilesystem')
+            try:
+                self.admin.assert_icommand('ils', 'STDOUT_SINGLELINE', self.admin.session_collection)
+
+                # a child added with addchildtoresc is used by the next put
+                self.admin.assert_icommand('iadmin addchildtoresc cachePtResc cacheLeafResc')
+                self.admin.assert_icommand('iput -R cachePtResc ' + filename)
+                self.admin.assert_icommand('ils -L ' + filename, 'STDOUT_SINGLELINE', 'cachePtResc;cacheLeafResc')
+                self.admin.assert_icommand('irm -f ' + filename)
+
+                # a vault path changed with modresc is used by the next put
+                self.admin.assert_icommand('iadmin modresc cacheLeafResc path ' + vault2, 'STDOUT_SINGLELINE', vault1)
+                self.admin.assert_icommand('iput -R cachePtResc ' + filename)
+                self.admin.assert_icommand('ils -L ' + filename, 'STDOUT_SINGLELINE', vault2)
+                self.admin.assert_icommand('irm -f ' + filename)
+            finally:
+                self.admin.run_icommand('irm -f ' + logical_path)
+                self.admin.run_icommand('iadmin rmchildfromresc cachePtResc cacheLeafResc')
+                self.admin.run_icommand('iadmin rmresc cacheLeafResc')
+                self.admin.run_icommand('iadmin rmresc cachePtResc')
+                shutil.rmtree(vault1, ignore_errors=True)
+                shutil.rmtree(vault2, ignore_errors=True)
+                os.unlink(filename)
+
+    def test_incremental_quota_usage(self):
+        def quota_over():
+            _, out, _ = self.admin.run_icommand(['iquest', '%s',
+                "select QUOTA_OVER where QUOTA_USER_NAME = '{0}'".format(self.admin.username)])
+            return int(out.strip())
+
+        filename = 'incremental_quota_usage_file'
+        server_config_filename = lib.get_irods_config_dir() + '/server_config.json'
+        with lib.file_backed_up(server_config_filename):
+            with open(server_config_filename) as f:
+                server_config = json.load(f)
+            server_config['advanced_settings']['incremental_quota_usage'] = 1
+            lib.update_json_file_from_dict(server_config_filename, server_config)
+
+            self.admin.assert_icommand('iadmin suq {0} total 1'.format(self.admin.username))
+            try:
+                self.admin.assert_icommand('iadmin cu')
+                baseline = quota_over()
+
+                # a put adds its size without another iadmin cu
+                lib.make_file(filename, 1024)
+                self.admin.assert_icommand('iput ' + filename)
+                self.assertEqual(baseline + 1024, quota_over())
+
+                # an overwrite moves the usage by the change in size
+                lib.make_file(filename, 4096)
+                self.admin.assert_icommand('iput -f ' + filename)
+                self.assertEqual(baseline + 4096, quota_over())
+                lib.make_file(filename, 512)
+                self.admin.assert_icommand('iput -f ' + filename)
+                self.assertEqual(baseline + 512, quota_over())
+
+                # a removal takes it back off
+                self.admin.assert_icommand('irm -f ' + filename)
+                self.assertEqual(baseline, quota_over())
+            finally:
+                self.admin.run_icommand('irm -f ' + filename)
+                self.admin.assert_icommand('iadmin suq {0} total 0'.format(self.admin.username))
+                if os.path.exists(filename):
+                    os.unlink(filename)
+
     @unittest.skipIf(configuration.TOPOLOGY_FROM_RESOURCE_SERVER, 'Skip for topology testing from resource server: reads re server log')
     def test_rule_engine_2521(self):
         corefile = lib.get_core_re_dir() + "/core.re"
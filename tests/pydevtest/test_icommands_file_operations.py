@@ -6,6 +6,8 @@ else:
 import os
 import time
 import shutil
+import hashlib
+import json
 
 import configuration
 import lib
@@ -52,6 +54,137 @@ class Test_ICommands_File_Operations(resource_suite.ResourceBase, unittest.TestC
     def test_iput_r(self):
         self.iput_r_large_collection(self.user0, "test_iput_r_dir", file_count=1000, file_size=100)
 
+    def test_iput_r_iget_r_with_transfers(self):
+        base_name = "test_iput_r_iget_r_with_transfers"
+        local_dir = os.path.join(self.testing_tmp_dir, base_name)
+        local_files = set(lib.make_large_local_tmp_dir(local_dir, file_count=200, file_size=100000))
+        self.user0.assert_icommand(['iput', '-r', '--transfers', '4', local_dir])
+        rods_files = set(lib.ils_output_to_entries(self.user0.run_icommand(['ils', base_name])[1]))
+        self.assertTrue(local_files == rods_files,
+                        msg="Files missing:\n" + str(local_files - rods_files) + "\n\n" +
+                            "Extra files:\n" + str(rods_files - local_files))
+
+        get_dir = os.path.join(self.testing_tmp_dir, base_name + "_get")
+        self.user0.assert_icommand(['iget', '-r', '--transfers', '4', base_name, get_dir])
+        self.assertTrue(local_files == set(os.listdir(get_dir)))
+
+    def test_iput_br_with_bulk_registration_batch_size(self):
+        def count_and_size():
+            _, out, _ = self.user0.run_icommand(['iquest', '%s %s',
+                "select count(DATA_ID), sum(DATA_SIZE) where COLL_NAME = '{0}'".format(collection)])
+            return tuple(int(v) for v in out.split())
+
+        base_name = "test_iput_br_with_bulk_registration_batch_size"
+        collection = self.user0.session_collection + '/' + base_name
+        local_dir = os.path.join(self.testing_tmp_dir, base_name)
+        file_count = 120
+        local_files = set(lib.make_large_local_tmp_dir(local_dir, file_count, file_size=100))
+
+        server_config_filename = lib.get_irods_config_dir() + '/server_config.json'
+        with lib.file_backed_up(server_config_filename):
+            with open(server_config_filename) as f:
+                server_config = json.load(f)
+            # not a divisor of the tarball size, so batches end mid tarball
+            server_config['advanced_settings']['bulk_registration_batch_size'] = 7
+            lib.update_json_file_from_dict(server_config_filename, server_config)
+
+            # new objects go through the batched registration
+            self.user0.assert_icommand(['iput', '-b', '-r', local_dir])
+            rods_files = set(lib.ils_output_to_entries(self.user0.run_icommand(['ils', base_name])[1]))
+            self.assertEqual(local_files, rods_files)
+            self.assertEqual((file_count, file_count * 100), count_and_size())
+            self.user0.assert_icommand(['ils', '-A', base_name + '/junk0000'], 'STDOUT_SINGLELINE',
+                                       self.user0.username + '#' + self.user0.zone_name + ':own')
+            self.user1.assert_icommand(['ils', collection + '/junk0000'], 'STDERR_SINGLELINE', 'does not exist')
+
+            # existing objects are updated in place
+            for name in local_files:
+                lib.make_file(os.path.join(local_dir, name), 200)
+            self.user0.assert_icommand(['iput', '-b', '-r', '-f', local_dir])
+            self.assertEqual((file_count, file_count * 200), count_and_size())
+
+            get_dir = os.path.join(self.testing_tmp_dir, base_name + "_get")
+            self.user0.assert_icommand(['iget', '-r', base_name, get_dir])
+            self.assertEqual(local_files, set(os.listdir(get_dir)))
+            for name in local_files:
+                self.assertEqual(200, os.path.getsize(os.path.join(get_dir, name)))
+
+    def test_irepl_r_with_transfers(self):
+        base_name = "test_irepl_r_with_transfers"
+        local_files = self.iput_r_large_collection(self.user0, base_name, file_count=100, file_size=100000)[1]
+        self.user0.assert_icommand(['irepl', '-r', '--transfers', '4', '-R', self.testresc, base_name])
+        _, out, _ = self.user0.run_icommand(['ils', '-l', base_name])
+        self.assertEqual(len(local_files), out.count(self.testresc))
+
+    def test_irepl_r_with_transfers_from_source_resource(self):
+        def physical_paths(resource):
+            _, out, _ = self.user0.run_icommand(['iquest', '%s %s',
+                "select DATA_NAME, DATA_PATH where COLL_NAME like '%/{0}' and DATA_RESC_NAME = '{1}'".format(base_name, resource)])
+            return dict(line.split(' ', 1) for line in out.splitlines() if line.strip())
+
+        base_name = "test_irepl_r_with_transfers_from_source_resource"
+        local_files = self.iput_r_large_collection(self.user0, base_name, file_count=20, file_size=1000)[1]
+        self.user0.assert_icommand(['irepl', '-r', '-R', self.testresc, base_name])
+
+        # give the non-default source different content of the same size
+        # behind the catalog's back, so the copies show where they came from
+        source_paths = physical_paths(self.testresc)
+        self.assertEqual(len(local_files), len(source_paths))
+        for path in source_paths.values():
+            with open(path, 'w') as f:
+                f.write('s' * 1000)
+
+        self.user0.assert_icommand(['irepl', '-r', '--transfers', '4', '-S', self.testresc, '-R', self.anotherresc, base_name])
+        target_paths = physical_paths(self.anotherresc)
+        self.assertEqual(len(local_files), len(target_paths))
+        for name, path in target_paths.items():
+            with open(path) as f:
+                self.assertEqual('s' * 1000, f.read(), msg=name + " was not replicated from " + self.testresc)
+
+    def test_many_open_data_objects_in_one_agent(self):
+        filepath = os.path.join(self.user0.local_session_dir, 'many_opens')
+        with open(filepath, 'w') as f:
+            f.write('many opens\n')
+        self.user0.assert_icommand(['iput', filepath])
+
+        # every open holds on to its descriptor until all of them are
+        # closed.  the second round runs on the descriptors the first one
+        # freed, so both top out at the same one
+        open_count = 600
+        rule_file = os.path.join(self.user0.local_session_dir, 'many_opens.r')
+        with open(rule_file, 'w') as f:
+            f.write('''manyOpens {
+    for (*round = 0; *round < 2; *round = *round + 1) {
+        *fds = list();
+        *max = 0;
+        for (*i = 0; *i < *count; *i = *i + 1) {
+            msiDataObjOpen("objPath=*obj++++openFlags=O_RDONLY", *fd);
+            *fds = cons(*fd, *fds);
+            if (*fd > *max) {
+                *max = *fd;
+                *last = *fd;
+            }
+        }
+        msiDataObjRead(*last, 10, *buf);
+        msiBytesBufToStr(*buf, *str);
+        writeLine("stdout", "round *round max *max read *str");
+        foreach (*fd in *fds) {
+            msiDataObjClose(*fd, *status);
+        }
+    }
+}
+INPUT *obj="%s", *count=%d
+OUTPUT ruleExecOut
+''' % (self.user0.session_collection + '/many_opens', open_count))
+
+        rc, stdout, stderr = self.user0.run_icommand(['irule', '-F', rule_file])
+        self.assertEqual(rc, 0, msg=stderr)
+        for r in range(2):
+            self.assertIn('round {0} max {1} read many opens'.format(r, open_count + 2), stdout)
+
+        # the table of the agent serving the report is part of it
+        self.admin.assert_icommand(['izonereport'], 'STDOUT_SINGLELINE', 'l1desc_table')
+
     def test_irm_r(self):
         base_name = "test_irm_r_dir"
         self.iput_r_large_collection(self.user0, base_name, file_count=1000, file_size=100)
@@ -64,6 +197,64 @@ class Test_ICommands_File_Operations(resource_suite.ResourceBase, unittest.TestC
         self.assertTrue(len(vault_files_post_irm) == 0,
                         msg="Files not removed from vault:\n" + str(vault_files_post_irm))
 
+    def test_irm_rf_and_irmtrash_with_collection_delete_batch_size(self):
+        def quota_over():
+            _, out, _ = self.admin.run_icommand(['iquest', '%s',
+                "select QUOTA_OVER where QUOTA_USER_NAME = '{0}'".format(self.user0.username)])
+            return int(out.strip())
+
+        def data_paths(collection):
+            _, out, _ = self.user0.run_icommand(['iquest', '%s',
+                "select DATA_PATH where COLL_NAME like '{0}%'".format(collection)])
+            if 'CAT_NO_ROWS_FOUND' in out:
+                return []
+            return out.split()
+
+        file_count = 200
+        file_size = 100
+        server_config_filename = lib.get_irods_config_dir() + '/server_config.json'
+        with lib.file_backed_up(server_config_filename):
+            with open(server_config_filename) as f:
+                server_config = json.load(f)
+            server_config['advanced_settings']['collection_delete_batch_size'] = 50
+            server_config['advanced_settings']['incremental_quota_usage'] = 1
+            lib.update_json_file_from_dict(server_config_filename, server_config)
+
+            self.admin.assert_icommand('iadmin suq {0} total 1'.format(self.user0.username))
+            try:
+                self.admin.assert_icommand('iadmin cu')
+                baseline = quota_over()
+
+                # a physical delete removes the rows, the files and the usage
+                base_name = 'test_irm_rf_batch_dir'
+                self.iput_r_large_collection(self.user0, base_name, file_count, file_size)
+                collection = self.user0.session_collection + '/' + base_name
+                paths = data_paths(collection)
+                self.assertEqual(file_count, len(paths))
+                self.assertEqual(baseline + file_count * file_size, quota_over())
+
+                self.user0.assert_icommand(['irm', '-rf', base_name], 'EMPTY')
+                self.user0.assert_icommand(['ils', base_name], 'STDERR_SINGLELINE', 'does not exist')
+                self.assertEqual([], data_paths(collection))
+                self.assertEqual([], [p for p in paths if os.path.exists(p)])
+                self.assertEqual(baseline, quota_over())
+
+                # and so does emptying the trash
+                base_name = 'test_irmtrash_batch_dir'
+                self.iput_r_large_collection(self.user0, base_name, file_count, file_size)
+                self.user0.assert_icommand(['irm', '-r', base_name], 'EMPTY')
+                collection = self.user0.session_collection_trash + '/' + base_name
+                paths = data_paths(collection)
+                self.assertEqual(file_count, len(paths))
+                self.assertEqual(baseline + file_count * file_size, quota_over())
+
+                self.user0.assert_icommand(['irmtrash'], 'EMPTY')
+                self.assertEqual([], data_paths(collection))
+                self.assertEqual([], [p for p in paths if os.path.exists(p)])
+                self.assertEqual(baseline, quota_over())
+            finally:
+                self.admin.assert_icommand('iadmin suq {0} total 0'.format(self.user0.username))
+
     def test_imv_r(self):
         base_name_source = "test_imv_r_dir_source"
         file_names = set(self.iput_r_large_collection(
@@ -216,3 +407,36 @@ class Test_ICommands_File_Operations(resource_suite.ResourceBase, unittest.TestC
         # wait for select() call to timeout, set to "SELECT_TIMEOUT_FOR_CONN", which is 60 seconds
         time.sleep(63)
         self.user0.assert_icommand('ils -l', 'STDOUT_SINGLELINE', [file_name, str(new_size)])
+
+    def test_sha256tree_checksum(self):
+        def sha256tree(data, block_size=4 * 1024 * 1024):
+            level = [hashlib.sha256('\x00' + data[i:i + block_size]).digest()
+                     for i in range(0, max(len(data), 1), block_size)]
+            while len(level) > 1:
+                next_level = []
+                for i in range(0, len(level), 2):
+                    if i + 1 < len(level):
+                        next_level.append(hashlib.sha256('\x01' + level[i] + level[i + 1]).digest())
+                    else:
+                        next_level.append(level[i])
+                level = next_level
+            return 'sha2t:' + level[0].encode('base64').strip()
+
+        # three blocks, the last a partial one, so the root has an odd node
+        file_name = 'test_sha256tree_checksum'
+        file_path = os.path.join(self.testing_tmp_dir, file_name)
+        lib.make_file(file_path, 9 * 1024 * 1024 + 5, source='/dev/urandom')
+        with open(file_path, 'rb') as f:
+            expected = sha256tree(f.read())
+
+        server_config_filename = lib.get_irods_config_dir() + '/server_config.json'
+        with lib.file_backed_up(server_config_filename):
+            lib.update_json_file_from_dict(server_config_filename, {'default_hash_scheme': 'SHA256TREE'})
+            self.user0.environment_file_contents['irods_default_hash_scheme'] = 'SHA256TREE'
+            try:
+                self.user0.assert_icommand(['iput', '-K', file_path])
+                self.user0.assert_icommand(['ils', '-L', file_name], 'STDOUT_SINGLELINE', expected)
+                self.user0.assert_icommand(['ichksum', '-f', file_name], 'STDOUT_SINGLELINE', expected)
+                self.user0.assert_icommand(['iget', '-K', file_name, file_path + '_get'])
+            finally:
+                self.user0.environment_file_contents['irods_default_hash_scheme'] = 'SHA256'
@@ -1,3 +1,4 @@
+import json
 import os
 import re
 import sys
@@ -37,3 +38,63 @@ class Test_iPut_Options(ResourceBase, unittest.TestCase):
         lib.make_file(new_filepath, 2)
         self.admin.assert_icommand('iput -f -- ' + filepath + ' ' + self.admin.session_collection + '/file')
         self.user1.assert_icommand('iput -f -- ' + new_filepath + ' ' + self.admin.session_collection + '/file')
+
+    def test_iput_and_iget_verbose_stream_stats(self):
+        filepath = os.path.join(self.admin.local_session_dir, 'file')
+        file_size = 60 * 1024 * 1024
+        lib.make_file(filepath, file_size)
+
+        # each stream of a parallel transfer has a line of its own, and
+        # together the streams moved the whole file
+        def check_streams(out):
+            streams = re.findall(r'^ *stream (\d+) +([\d.]+) MB', out, re.MULTILINE)
+            assert len(streams) > 1, out
+            assert [int(i) for i, _ in streams] == range(len(streams)), out
+            assert abs(sum(float(mb) for _, mb in streams) - file_size / 1048600.0) < 0.01, out
+
+        _, out, _ = self.admin.run_icommand('iput -v -N 4 ' + filepath)
+        check_streams(out)
+        _, out, _ = self.admin.run_icommand('iget -f -v -N 4 file ' + filepath)
+        check_streams(out)
+        assert os.path.getsize(filepath) == file_size
+
+        # a transfer over the main connection has no streams
+        _, out, _ = self.admin.run_icommand('iget -f -v -N 0 file ' + filepath)
+        assert not re.search(r'^ *stream \d+', out, re.MULTILINE), out
+
+    def test_iput_r_and_iget_r_adaptive_number_of_transfer_threads(self):
+        local_dir = os.path.join(self.admin.local_session_dir, 'adaptive')
+        get_dir = os.path.join(self.admin.local_session_dir, 'adaptive_get')
+        file_count = 4
+        lib.make_large_local_tmp_dir(local_dir, file_count, file_size=40 * 1024 * 1024)
+
+        # the stream count of each object transferred, in transfer order
+        def thread_counts(out):
+            counts = [int(n) for n in re.findall(r'\| (\d+) thr \|', out)]
+            assert len(counts) == file_count, out
+            return counts
+
+        server_config_filename = lib.get_irods_config_dir() + '/server_config.json'
+        with lib.file_backed_up(server_config_filename):
+            with open(server_config_filename) as f:
+                server_config = json.load(f)
+            server_config['advanced_settings']['adaptive_number_of_transfer_threads'] = 1
+            lib.update_json_file_from_dict(server_config_filename, server_config)
+            max_threads = server_config['advanced_settings']['default_number_of_transfer_threads']
+
+            # one agent starts at the configured count, doubles it after its
+            # first transfer and never goes over the rule's count
+            for cmd in (['iput', '-r', '-v', local_dir],
+                        ['iget', '-r', '-v', 'adaptive', get_dir]):
+                _, out, _ = self.admin.run_icommand(cmd)
+                counts = thread_counts(out)
+                assert counts[:2] == [1, 2], out
+                assert all(1 <= n <= max_threads for n in counts), out
+
+            # a count asked for by the client is used as is
+            _, out, _ = self.admin.run_icommand(['iput', '-r', '-f', '-v', '-N', '3', local_dir])
+            assert thread_counts(out) == [3] * file_count, out
+
+        # without the setting the rule's count is used throughout
+        _, out, _ = self.admin.run_icommand(['iget', '-r', '-f', '-v', 'adaptive', get_dir])
+        assert thread_counts(out) == [max_threads] * file_count, out
@@ -25,3 +25,29 @@ class Test_iRsync(ResourceBase, unittest.TestCase):
         lib.make_file(filepath, 1)
         self.admin.assert_icommand('iput ' + filepath)
         self.admin.assert_icommand('irsync -l ' + filepath + ' i:file')
+
+    def test_irsync_r_dir_to_coll_bulk_with_manifest(self):
+        base_name = 'test_irsync_r_dir_to_coll_bulk_with_manifest'
+        local_dir = os.path.join(self.admin.local_session_dir, base_name)
+        manifest = os.path.join(self.admin.local_session_dir, 'irsync_manifest')
+        file_names = set(lib.make_large_local_tmp_dir(local_dir, file_count=20, file_size=100))
+
+        self.admin.assert_icommand('irsync -r -b --manifest ' + manifest + ' ' + local_dir + ' i:' + base_name, 'EMPTY')
+        rods_files = set(lib.ils_output_to_entries(self.admin.run_icommand(['ils', base_name])[1]))
+        self.assertTrue(file_names == rods_files)
+
+        # only the changed file is listed on the second run
+        changed = sorted(file_names)[0]
+        with open(os.path.join(local_dir, changed), 'a') as f:
+            f.write('changed')
+        self.admin.assert_icommand('irsync -r -l --manifest ' + manifest + ' ' + local_dir + ' i:' + base_name, 'STDOUT_SINGLELINE', changed)
+        out = self.admin.run_icommand('irsync -r -l --manifest ' + manifest + ' ' + local_dir + ' i:' + base_name)[1]
+        self.assertEqual(1, len([l for l in out.splitlines() if l.strip()]))
+        self.assertTrue(os.path.exists(manifest))
+
+    def test_irsync_manifest_without_file(self):
+        local_dir = os.path.join(self.admin.local_session_dir, 'test_irsync_manifest_without_file')
+        lib.make_large_local_tmp_dir(local_dir, file_count=2, file_size=10)
+        self.admin.assert_icommand('irsync -r ' + local_dir + ' i:test_irsync_manifest_without_file --manifest', 'STDERR_SINGLELINE', 'needs a manifest file')
+        self.admin.assert_icommand('irsync -r --manifest -l ' + local_dir + ' i:test_irsync_manifest_without_file', 'STDERR_SINGLELINE', 'needs a manifest file')
+        self.admin.assert_icommand_fail('ils test_irsync_manifest_without_file', 'STDOUT_SINGLELINE', 'test_irsync_manifest_without_file')
@@ -1,7 +1,9 @@
+import json
 import os
 import re
 import sys
 import socket
+import time
 
 if sys.version_info < (2, 7):
     import unittest2 as unittest
@@ -56,6 +58,67 @@ class Test_Iticket(SessionsMixin, unittest.TestCase):
         self.ticket_put_on(data_obj, data_obj, filepath)
         self.ticket_put_on(collection, data_obj, filepath)
 
+    @unittest.skipIf(configuration.RUN_IN_TOPOLOGY, 'Skip for Topology Testing: No way to restart grid')
+    def test_agent_pool_isolates_clients(self):
+        filename = 'TicketTestFile'
+        filepath = os.path.join(self.admin.local_session_dir, filename)
+        lib.make_file(filepath, 1)
+        collection = self.admin.session_collection + '/dir'
+        data_obj = collection + '/' + filename
+        ticket = 'ticket'
+
+        self.admin.assert_icommand('imkdir ' + collection)
+        self.admin.assert_icommand('iput ' + filepath + ' ' + data_obj)
+        self.admin.assert_icommand('iticket create read ' + data_obj + ' ' + ticket)
+
+        def agent_pool():
+            _, out, _ = lib.run_command('irods-grid status --all', check_rc=True)
+            return json.loads(out)['hosts'][0]['agent_pool']
+
+        # the status request itself connects to the server, so an idle
+        # agent in the reply is ready for the next connection
+        def wait_for_idle_agent():
+            for i in range(100):
+                if agent_pool()['idle'] == 1:
+                    return
+                time.sleep(0.1)
+            assert False, agent_pool()
+
+        server_config_filename = lib.get_irods_config_dir() + '/server_config.json'
+        with lib.file_backed_up(server_config_filename):
+            with open(server_config_filename) as f:
+                server_config = json.load(f)
+            server_config['advanced_settings']['agent_pool_size'] = 1
+            server_config['advanced_settings']['agent_pool_maximum_requests_per_agent'] = 1000
+            lib.update_json_file_from_dict(server_config_filename, server_config)
+            lib.restart_irods_server()
+
+            try:
+                wait_for_idle_agent()
+                before = agent_pool()
+
+                # each connection is served by the one pooled agent, which
+                # keeps nothing of the client it served before
+                self.user.assert_icommand('iget -t ' + ticket + ' ' + data_obj + ' -', 'STDOUT')
+                wait_for_idle_agent()
+                self.user.assert_icommand('iget ' + data_obj + ' -', 'STDERR')
+                wait_for_idle_agent()
+                self.user.assert_icommand('ils -l ' + collection, 'STDERR')
+                wait_for_idle_agent()
+                self.admin.assert_icommand('ils -l ' + collection, 'STDOUT_SINGLELINE', filename)
+                wait_for_idle_agent()
+                self.user.assert_icommand('ils -l ' + collection, 'STDERR')
+                wait_for_idle_agent()
+                self.anon.assert_icommand('iget ' + data_obj + ' -', 'STDERR')
+                wait_for_idle_agent()
+
+                # no agent was replaced, so the one agent served them all
+                assert agent_pool()['spawned'] == before['spawned']
+            finally:
+                self.admin.assert_icommand('iticket delete ' + ticket)
+
+        lib.restart_irods_server()
+
     def ticket_get_on(self, ticket_target, data_obj):
         ticket = 'ticket'
         self.ticket_get_fail(ticket, data_obj)
@@ -1,5 +1,6 @@
 import commands
 import getpass
+import json
 import os
 import re
 import shutil
@@ -2986,6 +2987,131 @@ class Test_Resource_RoundRobin(ChunkyDevTest, ResourceSuite, unittest.TestCase):
         # local cleanup
         output = commands.getstatusoutput('rm ' + filepath)
 
+    def test_round_robin_free_space_mode(self):
+        # local setup
+        filename = "rrfreespacefile.txt"
+        filepath = os.path.abspath(filename)
+        with open(filepath, 'w') as f:
+            f.write("TESTFILE -- [" + filepath + "]")
+
+        # only unix2Resc has free space, so it takes every put
+        self.admin.assert_icommand("iadmin modresc unix2Resc freespace 1000")
+        self.admin.assert_icommand("iadmin modresc demoResc context round_robin_mode=free_space")
+
+        for i in range(4):
+            self.user1.assert_icommand("iput " + filename + " file" + str(i) + ".txt")
+
+        self.user1.assert_icommand("ils -l", 'STDOUT_SINGLELINE', "unix2Resc")
+        self.user1.assert_icommand_fail("ils -l", 'STDOUT_SINGLELINE', "unix1Resc")
+
+        # the context is not overwritten with a next child
+        self.admin.assert_icommand("iadmin lr demoResc", 'STDOUT_SINGLELINE', "round_robin_mode=free_space")
+
+        # local cleanup
+        output = commands.getstatusoutput('rm ' + filepath)
+
+    def test_round_robin_context_update_interval(self):
+        def child_of(data_name):
+            _, out, _ = self.user1.run_icommand(['iquest', '%s',
+                "select DATA_RESC_HIER where COLL_NAME = '{0}' and DATA_NAME = '{1}'".format(self.user1.session_collection, data_name)])
+            return out.strip().split(';')[-1]
+
+        def context():
+            _, out, _ = self.admin.run_icommand(['iadmin', 'lr', 'demoResc'])
+            return re.search(r'^resc_context: *(.*)$', out, re.MULTILINE).group(1).strip()
+
+        def set_interval(interval):
+            with open(server_config_filename) as f:
+                server_config = json.load(f)
+            server_config['advanced_settings']['round_robin_context_update_interval'] = interval
+            lib.update_json_file_from_dict(server_config_filename, server_config)
+
+        # local setup
+        filename = "rrintervalfile.txt"
+        filepath = os.path.abspath(filename)
+        with open(filepath, 'w') as f:
+            f.write("TESTFILE -- [" + filepath + "]")
+
+        other = {'unix1Resc': 'unix2Resc', 'unix2Resc': 'unix1Resc'}
+        server_config_filename = lib.get_irods_config_dir() + '/server_config.json'
+        with lib.file_backed_up(server_config_filename):
+            # 1 writes the child after the one taken on every put, and the
+            # shared position alternates the children
+            set_interval(1)
+            previous = None
+            for i in range(4):
+                self.user1.assert_icommand("iput " + filename + " file" + str(i) + ".txt")
+                child = child_of("file" + str(i) + ".txt")
+                if previous:
+                    self.assertEqual(other[previous], child)
+                self.assertEqual(other[child], context())
+                previous = child
+
+            # 0 never writes it, though the children still alternate
+            set_interval(0)
+            written = context()
+            for i in range(4, 8):
+                self.user1.assert_icommand("iput " + filename + " file" + str(i) + ".txt")
+                child = child_of("file" + str(i) + ".txt")
+                self.assertEqual(other[previous], child)
+                self.assertEqual(written, context())
+                previous = child
+
+        # local cleanup
+        output = commands.getstatusoutput('rm ' + filepath)
+
+    def test_round_robin_context_update_interval_with_child_down(self):
+        def child_of(data_name):
+            _, out, _ = self.user1.run_icommand(['iquest', '%s',
+                "select DATA_RESC_HIER where COLL_NAME = '{0}' and DATA_NAME = '{1}'".format(self.user1.session_collection, data_name)])
+            return out.strip().split(';')[-1]
+
+        def context():
+            _, out, _ = self.admin.run_icommand(['iadmin', 'lr', 'demoResc'])
+            return re.search(r'^resc_context: *(.*)$', out, re.MULTILINE).group(1).strip()
+
+        # local setup
+        filename = "rrdownfile.txt"
+        filepath = os.path.abspath(filename)
+        with open(filepath, 'w') as f:
+            f.write("TESTFILE -- [" + filepath + "]")
+
+        self.admin.assert_icommand("iadmin mkresc unix3Resc 'unixfilesystem' " + configuration.HOSTNAME_1 + ":" +
+                                   lib.get_irods_top_level_dir() + "/unix3RescVault", 'STDOUT_SINGLELINE', 'unixfilesystem')
+        self.admin.assert_icommand("iadmin addchildtoresc demoResc unix3Resc")
+        self.admin.assert_icommand("iadmin modresc unix2Resc status down")
+
+        # the turns, and the child written for the next server, are taken
+        # among the children which are up
+        other = {'unix1Resc': 'unix3Resc', 'unix3Resc': 'unix1Resc'}
+        server_config_filename = lib.get_irods_config_dir() + '/server_config.json'
+        try:
+            with lib.file_backed_up(server_config_filename):
+                with open(server_config_filename) as f:
+                    server_config = json.load(f)
+                server_config['advanced_settings']['round_robin_context_update_interval'] = 1
+                lib.update_json_file_from_dict(server_config_filename, server_config)
+
+                previous = None
+                for i in range(6):
+                    self.user1.assert_icommand("iput " + filename + " file" + str(i) + ".txt")
+                    child = child_of("file" + str(i) + ".txt")
+                    self.assertIn(child, other)
+                    if previous:
+                        self.assertEqual(other[previous], child)
+                    self.assertEqual(other[child], context())
+                    previous = child
+        finally:
+            for i in range(6):
+                self.user1.run_icommand("irm -f file" + str(i) + ".txt")
+            self.admin.assert_icommand("iadmin modresc unix2Resc status up")
+            self.admin.assert_icommand("iadmin rmchildfromresc demoResc unix3Resc")
+            self.admin.assert_icommand("iadmin rmresc unix3Resc")
+            shutil.rmtree(lib.get_irods_top_level_dir() + "/unix3RescVault", ignore_errors=True)
+
+            # local cleanup
+            output = commands.getstatusoutput('rm ' + filepath)
+
 
 class Test_Resource_Replication(ChunkyDevTest, ResourceSuite, unittest.TestCase):
 
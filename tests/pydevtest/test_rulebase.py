@@ -3,6 +3,7 @@ if sys.version_info >= (2, 7):
     import unittest
 else:
     import unittest2 as unittest
+import json
 import os
 import socket
 import time  # remove once file hash fix is commited #2279
@@ -145,3 +146,75 @@ OUTPUT ruleExecOut
         # cleanup
         os.unlink(test_re)
         os.unlink(rule_file)
+
+    def submit_prioritized_delay_rules(self, tag, delay=5):
+        # three rules due at the same time, submitted in the reverse order
+        # of their PRI. the first to run sleeps, so the others wait for the
+        # one process slot
+        rule_file = 'prioritized_delay_rules.r'
+        exec_time = int(time.time()) + delay
+        rule_body = 'prioritized_delay_rules {\n'
+        for priority in [9, 5, 1]:
+            action = 'writeLine("serverLog", "{0}_{1}");'.format(tag, priority)
+            if priority == 1:
+                action = 'msiSleep("20", "0"); ' + action
+            rule_body += '    delay("<ET>{0}</ET><PRI>{1}</PRI>") {{ {2} }}\n'.format(exec_time, priority, action)
+        rule_body += '}\nINPUT null\nOUTPUT ruleExecOut\n'
+        with open(rule_file, 'w') as f:
+            f.write(rule_body)
+        self.admin.assert_icommand('irule -F ' + rule_file)
+        os.unlink(rule_file)
+
+    def wait_for_delay_rules(self, timeout=120):
+        for i in range(timeout):
+            _, out, _ = self.admin.run_icommand('iqstat')
+            if 'No delayed rules pending' in out:
+                return
+            time.sleep(1)
+        assert False, 'delayed rules still pending'
+
+    def run_with_one_rule_engine_process(self, test):
+        server_config_filename = lib.get_irods_config_dir() + '/server_config.json'
+        with lib.file_backed_up(server_config_filename):
+            with open(server_config_filename) as f:
+                server_config = json.load(f)
+            server_config['advanced_settings']['maximum_number_of_concurrent_rule_engine_server_processes'] = 1
+            lib.update_json_file_from_dict(server_config_filename, server_config)
+            lib.restart_irods_server()
+            try:
+                test()
+            finally:
+                self.wait_for_delay_rules()
+        lib.restart_irods_server()
+
+    @unittest.skipIf(configuration.TOPOLOGY_FROM_RESOURCE_SERVER, 'Skip for topology testing from resource server: reads re server log')
+    def test_delay_rule_priority_order(self):
+        def test():
+            initial_log_size = lib.get_log_size('re')
+            self.submit_prioritized_delay_rules('TEST_DELAY_RULE_PRIORITY')
+            self.wait_for_delay_rules()
+            with open(lib.get_log_path('re')) as f:
+                f.seek(initial_log_size)
+                log = f.read()
+            positions = [log.find('TEST_DELAY_RULE_PRIORITY_{0}'.format(p)) for p in [1, 5, 9]]
+            assert -1 not in positions, positions
+            assert positions == sorted(positions), positions
+        self.run_with_one_rule_engine_process(test)
+
+    def test_delay_rule_due_count(self):
+        def test():
+            # due far enough ahead that none is due before the first count
+            self.submit_prioritized_delay_rules('TEST_DELAY_RULE_DUE_COUNT', delay=60)
+            self.admin.assert_icommand('iqstat -s', 'STDOUT_SINGLELINE', 'waiting: 3')
+            # while the first rule sleeps, the other two are due. poll until
+            # the rule engine has picked it up and both counts settle
+            for i in range(120):
+                _, out, _ = self.admin.run_icommand('iqstat -s')
+                if 'running: 1' in out and 'due:     2' in out:
+                    break
+                time.sleep(1)
+            assert 'running: 1' in out, out
+            assert 'due:     2' in out, out
+            assert 'waiting: 0' in out, out
+            assert 'lag:     oldest' in out, out
+        self.run_with_one_rule_engine_process(test)